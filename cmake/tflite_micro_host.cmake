@@ -0,0 +1,44 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Host build of the library sources under src/, for the host tools and tests.
+# src/ itself only holds device code: the Arduino, PlatformIO and ESP-IDF
+# builds compile everything in it.
+#
+
+if(NOT TARGET tflite_micro_host)
+  get_filename_component(TFLITE_MICRO_SRC_DIR
+    "${CMAKE_CURRENT_LIST_DIR}/../src" ABSOLUTE)
+
+  file(GLOB_RECURSE TFLITE_MICRO_HOST_SOURCES
+    "${TFLITE_MICRO_SRC_DIR}/tensorflow/*.cc"
+    "${TFLITE_MICRO_SRC_DIR}/tensorflow/*.c")
+
+  add_library(tflite_micro_host STATIC ${TFLITE_MICRO_HOST_SOURCES})
+  target_include_directories(tflite_micro_host PUBLIC
+    "${TFLITE_MICRO_SRC_DIR}"
+    "${TFLITE_MICRO_SRC_DIR}/third_party/gemmlowp"
+    "${TFLITE_MICRO_SRC_DIR}/third_party/flatbuffers/include"
+    "${TFLITE_MICRO_SRC_DIR}/third_party/ruy")
+  target_compile_definitions(tflite_micro_host PUBLIC TF_LITE_STATIC_MEMORY)
+  target_compile_options(tflite_micro_host PRIVATE
+    -Wsign-compare -Wdouble-promotion -Wshadow -Wunused-variable
+    -Wunused-function -Wswitch -Wvla
+    -Wno-maybe-uninitialized -Wno-missing-field-initializers -Wno-type-limits
+    $<$<COMPILE_LANGUAGE:CXX>:-Wno-return-type -Wno-strict-aliasing>)
+  set_target_properties(tflite_micro_host PROPERTIES
+    CXX_STANDARD 11 CXX_STANDARD_REQUIRED ON CXX_EXTENSIONS OFF)
+  target_link_libraries(tflite_micro_host PUBLIC m)
+endif()
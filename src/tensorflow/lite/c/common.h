@@ -40,6 +40,12 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
+#include "tensorflow/lite/c/log_config.h"
+
+#if defined(TF_LITE_LOG_INTERNING) && defined(__cplusplus)
+#include "tensorflow/lite/core/api/interned_log.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -56,11 +62,14 @@ typedef enum TfLiteStatus {
 // need. Access to the external contexts is controlled by one of the
 // corresponding support files.
 typedef enum TfLiteExternalContextType {
-  kTfLiteEigenContext = 0,       // include eigen_support.h to use.
-  kTfLiteGemmLowpContext = 1,    // include gemm_support.h to use.
-  kTfLiteEdgeTpuContext = 2,     // Placeholder for Edge TPU support.
-  kTfLiteCpuBackendContext = 3,  // include cpu_backend_context.h to use.
-  kTfLiteMaxExternalContexts = 4
+  kTfLiteEigenContext = 0,             // include eigen_support.h to use.
+  kTfLiteGemmLowpContext = 1,          // include gemm_support.h to use.
+  kTfLiteEdgeTpuContext = 2,           // Placeholder for Edge TPU support.
+  kTfLiteCpuBackendContext = 3,        // include cpu_backend_context.h to use.
+  kTfLiteMicroWeightCopyContext = 4,   // include weight_copy_engine.h to use.
+  kTfLiteMicroKernelTunerContext = 5,  // include kernel_tuner.h to use.
+  kTfLiteMicroParallelContext = 6,     // include parallel_executor.h to use.
+  kTfLiteMaxExternalContexts = 7
 } TfLiteExternalContextType;
 
 // Forward declare so dependent structs and methods can reference these types
@@ -155,8 +164,22 @@ void TfLiteFloatArrayFree(TfLiteFloatArray* a);
 
 // Try to make all reporting calls through TF_LITE_KERNEL_LOG rather than
 // calling the context->ReportError function directly, so that message strings
-// can be stripped out if the binary size needs to be severely optimized.
-#ifndef TF_LITE_STRIP_ERROR_STRINGS
+// can be stripped out if the binary size needs to be severely optimized, see
+// tensorflow/lite/c/log_config.h.
+#if TF_LITE_LOG_LEVEL < TF_LITE_LOG_LEVEL_ERROR
+#define TF_LITE_KERNEL_LOG(context, ...)
+#define TF_LITE_MAYBE_KERNEL_LOG(context, ...)
+#elif defined(TF_LITE_LOG_INTERNING) && defined(__cplusplus)
+#define TF_LITE_KERNEL_LOG(context, ...) \
+  TF_LITE_INTERNED_LOG(KernelLogInterned, (context), __VA_ARGS__)
+
+#define TF_LITE_MAYBE_KERNEL_LOG(context, ...)    \
+  do {                                            \
+    if ((context) != nullptr) {                   \
+      TF_LITE_KERNEL_LOG((context), __VA_ARGS__); \
+    }                                             \
+  } while (false)
+#else
 #define TF_LITE_KERNEL_LOG(context, ...)            \
   do {                                              \
     (context)->ReportError((context), __VA_ARGS__); \
@@ -168,10 +191,24 @@ void TfLiteFloatArrayFree(TfLiteFloatArray* a);
       (context)->ReportError((context), __VA_ARGS__); \
     }                                                 \
   } while (false)
-#else  // TF_LITE_STRIP_ERROR_STRINGS
-#define TF_LITE_KERNEL_LOG(context, ...)
-#define TF_LITE_MAYBE_KERNEL_LOG(context, ...)
-#endif  // TF_LITE_STRIP_ERROR_STRINGS
+#endif  // TF_LITE_LOG_LEVEL
+
+// Reports a failed check from the TF_LITE_ENSURE macros. `expression` is the
+// text of the check and `format` the rest of the message. When interning,
+// the location and the text become part of the interned format string.
+#if defined(TF_LITE_LOG_INTERNING) && defined(__cplusplus)
+#define TF_LITE_STRINGIFY_LINE(line) #line
+#define TF_LITE_LINE_STRING(line) TF_LITE_STRINGIFY_LINE(line)
+#define TF_LITE_ENSURE_LOG(context, expression, format, ...)        \
+  TF_LITE_KERNEL_LOG((context),                                     \
+                     __FILE__ ":" TF_LITE_LINE_STRING(__LINE__) " " \
+                         expression format,                         \
+                     __VA_ARGS__)
+#else
+#define TF_LITE_ENSURE_LOG(context, expression, format, ...)           \
+  TF_LITE_KERNEL_LOG((context), "%s:%d %s" format, __FILE__, __LINE__, \
+                     expression, __VA_ARGS__)
+#endif
 
 // Check whether value is true, and if not return kTfLiteError from
 // the current function (and report the error string msg).
@@ -185,6 +222,16 @@ void TfLiteFloatArrayFree(TfLiteFloatArray* a);
 
 // Check whether the value `a` is true, and if not return kTfLiteError from
 // the current function, while also reporting the location of the error.
+#if defined(TF_LITE_LOG_INTERNING) && defined(__cplusplus)
+#define TF_LITE_ENSURE(context, a)                                             \
+  do {                                                                         \
+    if (!(a)) {                                                                \
+      TF_LITE_KERNEL_LOG((context), __FILE__ ":" TF_LITE_LINE_STRING(__LINE__) \
+                         " " #a " was not true.");                             \
+      return kTfLiteError;                                                     \
+    }                                                                          \
+  } while (0)
+#else
 #define TF_LITE_ENSURE(context, a)                                      \
   do {                                                                  \
     if (!(a)) {                                                         \
@@ -193,6 +240,7 @@ void TfLiteFloatArrayFree(TfLiteFloatArray* a);
       return kTfLiteError;                                              \
     }                                                                   \
   } while (0)
+#endif
 
 #define TF_LITE_ENSURE_STATUS(a) \
   do {                           \
@@ -207,34 +255,31 @@ void TfLiteFloatArrayFree(TfLiteFloatArray* a);
 // `a` and `b` may be evaluated more than once, so no side effects or
 // extremely expensive computations should be done.
 // NOTE: Use TF_LITE_ENSURE_TYPES_EQ if comparing TfLiteTypes.
-#define TF_LITE_ENSURE_EQ(context, a, b)                                   \
-  do {                                                                     \
-    if ((a) != (b)) {                                                      \
-      TF_LITE_KERNEL_LOG((context), "%s:%d %s != %s (%d != %d)", __FILE__, \
-                         __LINE__, #a, #b, (a), (b));                      \
-      return kTfLiteError;                                                 \
-    }                                                                      \
+#define TF_LITE_ENSURE_EQ(context, a, b)                                    \
+  do {                                                                      \
+    if ((a) != (b)) {                                                       \
+      TF_LITE_ENSURE_LOG((context), #a " != " #b, " (%d != %d)", (a), (b)); \
+      return kTfLiteError;                                                  \
+    }                                                                       \
   } while (0)
 
-#define TF_LITE_ENSURE_TYPES_EQ(context, a, b)                             \
-  do {                                                                     \
-    if ((a) != (b)) {                                                      \
-      TF_LITE_KERNEL_LOG((context), "%s:%d %s != %s (%s != %s)", __FILE__, \
-                         __LINE__, #a, #b, TfLiteTypeGetName(a),           \
-                         TfLiteTypeGetName(b));                            \
-      return kTfLiteError;                                                 \
-    }                                                                      \
+#define TF_LITE_ENSURE_TYPES_EQ(context, a, b)                        \
+  do {                                                                \
+    if ((a) != (b)) {                                                 \
+      TF_LITE_ENSURE_LOG((context), #a " != " #b, " (%s != %s)",      \
+                         TfLiteTypeGetName(a), TfLiteTypeGetName(b)); \
+      return kTfLiteError;                                            \
+    }                                                                 \
   } while (0)
 
-#define TF_LITE_ENSURE_NEAR(context, a, b, epsilon)                          \
-  do {                                                                       \
-    auto delta = ((a) > (b)) ? ((a) - (b)) : ((b) - (a));                    \
-    if (delta > epsilon) {                                                   \
-      TF_LITE_KERNEL_LOG((context), "%s:%d %s not near %s (%f != %f)",       \
-                         __FILE__, __LINE__, #a, #b, static_cast<double>(a), \
-                         static_cast<double>(b));                            \
-      return kTfLiteError;                                                   \
-    }                                                                        \
+#define TF_LITE_ENSURE_NEAR(context, a, b, epsilon)                       \
+  do {                                                                    \
+    auto delta = ((a) > (b)) ? ((a) - (b)) : ((b) - (a));                 \
+    if (delta > epsilon) {                                                \
+      TF_LITE_ENSURE_LOG((context), #a " not near " #b, " (%f != %f)",    \
+                         static_cast<double>(a), static_cast<double>(b)); \
+      return kTfLiteError;                                                \
+    }                                                                     \
   } while (0)
 
 #define TF_LITE_ENSURE_OK(context, status) \
@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_C_LOG_CONFIG_H_
+#define TENSORFLOW_LITE_C_LOG_CONFIG_H_
+
+// Compile-time configuration of the error and log macros
+// (TF_LITE_KERNEL_LOG, TF_LITE_REPORT_ERROR, TF_LITE_REPORT_INFO).
+//
+// TF_LITE_LOG_LEVEL selects which messages are compiled in:
+//   TF_LITE_LOG_LEVEL_NONE   no messages, same as TF_LITE_STRIP_ERROR_STRINGS.
+//   TF_LITE_LOG_LEVEL_ERROR  errors only.
+//   TF_LITE_LOG_LEVEL_INFO   errors and diagnostic output such as allocation
+//                            and memory plan dumps or profiling events.
+// Stripped messages leave neither their strings nor the code that formats
+// them in the binary.
+//
+// TF_LITE_LOG_INTERNING keeps the format strings out of the image (GNU
+// toolchains, C++ sources only, C sources keep plain messages). Every message
+// format, which must be a string literal or a char array known at compile
+// time, is placed in a "tflite_log_strings" section and the message is
+// reported as the offset of its format in that section and the arguments as
+// 32-bit words, see tensorflow/lite/core/api/interned_log.h.
+// MicroErrorReporter writes it as a binary frame to DebugLogBinary(), which
+// the platform provides next to DebugLog(), without formatting it. The
+// tools/decode_interned_log host tool turns such logs back into text using
+// the ELF file of the application. To drop the strings from flash, keep the
+// section out of the loaded image, for example with
+//   tflite_log_strings 0 (INFO) : {
+//     __start_tflite_log_strings = .;
+//     KEEP(*(tflite_log_strings))
+//   }
+// in the linker script.
+#define TF_LITE_LOG_LEVEL_NONE 0
+#define TF_LITE_LOG_LEVEL_ERROR 1
+#define TF_LITE_LOG_LEVEL_INFO 2
+
+#ifndef TF_LITE_LOG_LEVEL
+#ifdef TF_LITE_STRIP_ERROR_STRINGS
+#define TF_LITE_LOG_LEVEL TF_LITE_LOG_LEVEL_NONE
+#else
+#define TF_LITE_LOG_LEVEL TF_LITE_LOG_LEVEL_INFO
+#endif  // TF_LITE_STRIP_ERROR_STRINGS
+#endif  // TF_LITE_LOG_LEVEL
+
+// The code guards message-only work with TF_LITE_STRIP_ERROR_STRINGS.
+#if TF_LITE_LOG_LEVEL == TF_LITE_LOG_LEVEL_NONE && \
+    !defined(TF_LITE_STRIP_ERROR_STRINGS)
+#define TF_LITE_STRIP_ERROR_STRINGS
+#endif
+
+#endif  // TENSORFLOW_LITE_C_LOG_CONFIG_H_
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include <cstdarg>
+#include <cstdint>
 
 namespace tflite {
 
@@ -35,4 +36,50 @@ int ErrorReporter::ReportError(void*, const char* format, ...) {
   return code;
 }
 
+int ErrorReporter::ReportFromContext(const char* format, va_list args) {
+#ifdef TF_LITE_LOG_INTERNING
+  if (format == kInternedLogMarker) {
+    const uint32_t id = va_arg(args, uint32_t);
+    const int num_words = va_arg(args, int);
+    const uint32_t* words = va_arg(args, const uint32_t*);
+    return ReportInterned(id, words, num_words);
+  }
+#endif
+  return Report(format, args);
+}
+
+#ifdef TF_LITE_LOG_INTERNING
+const char kInternedLogMarker[] = "@%x";
+
+namespace {
+
+// Indexed by the number of words.
+constexpr const char* kInternedLogFormats[kMaxInternedLogArgs + 1] = {
+    "@%x",
+    "@%x %x",
+    "@%x %x %x",
+    "@%x %x %x %x",
+    "@%x %x %x %x %x",
+    "@%x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x %x %x %x %x %x",
+    "@%x %x %x %x %x %x %x %x %x %x %x %x %x",
+};
+
+}  // namespace
+
+int ErrorReporter::ReportInterned(uint32_t id, const uint32_t* words,
+                                  int num_words) {
+  // The format only converts the first `num_words` words, the others are
+  // ignored.
+  return Report(kInternedLogFormats[num_words], id, words[0], words[1],
+                words[2], words[3], words[4], words[5], words[6], words[7],
+                words[8], words[9], words[10], words[11]);
+}
+#endif  // TF_LITE_LOG_INTERNING
+
 }  // namespace tflite
@@ -17,6 +17,12 @@ limitations under the License.
 
 #include <cstdarg>
 
+#include "tensorflow/lite/c/log_config.h"
+
+#ifdef TF_LITE_LOG_INTERNING
+#include "tensorflow/lite/core/api/interned_log.h"
+#endif
+
 namespace tflite {
 
 /// A functor that reports error to supporting system. Invoked similar to
@@ -38,6 +44,19 @@ class ErrorReporter {
   virtual int Report(const char* format, va_list args) = 0;
   int Report(const char* format, ...);
   int ReportError(void*, const char* format, ...);
+  /// Reports a message passed to TfLiteContext::ReportError(), for the
+  /// ReportError() implementations that forward kernel messages.
+  int ReportFromContext(const char* format, va_list args);
+
+#ifdef TF_LITE_LOG_INTERNING
+  /// Reports an interned message, see
+  /// tensorflow/lite/core/api/interned_log.h. `words` holds
+  /// kMaxInternedLogArgs words, of which the first `num_words` are the
+  /// arguments. The default passes it to Report() as "@%x %x ..." text;
+  /// reporters that keep it binary override it.
+  virtual int ReportInterned(uint32_t id, const uint32_t* words,
+                             int num_words);
+#endif
 };
 
 }  // namespace tflite
@@ -45,15 +64,31 @@ class ErrorReporter {
 // You should not make bare calls to the error reporter, instead use the
 // TF_LITE_REPORT_ERROR macro, since this allows message strings to be
 // stripped when the binary size has to be optimized. If you are looking to
-// reduce binary size, define TF_LITE_STRIP_ERROR_STRINGS when compiling and
-// every call will be stubbed out, taking no memory.
-#ifndef TF_LITE_STRIP_ERROR_STRINGS
+// reduce binary size, lower TF_LITE_LOG_LEVEL or define
+// TF_LITE_STRIP_ERROR_STRINGS when compiling and every call will be stubbed
+// out, taking no memory, see tensorflow/lite/c/log_config.h.
+//
+// TF_LITE_REPORT_INFO is for diagnostic output that is not an error, and is
+// only compiled in at TF_LITE_LOG_LEVEL_INFO.
+#if TF_LITE_LOG_LEVEL < TF_LITE_LOG_LEVEL_ERROR
+#define TF_LITE_REPORT_ERROR(reporter, ...)
+#elif defined(TF_LITE_LOG_INTERNING)
+#define TF_LITE_REPORT_ERROR(reporter, ...)                           \
+  TF_LITE_INTERNED_LOG(ReportErrorInterned,                           \
+                       static_cast<tflite::ErrorReporter*>(reporter), \
+                       __VA_ARGS__)
+#else
 #define TF_LITE_REPORT_ERROR(reporter, ...)                             \
   do {                                                                  \
     static_cast<tflite::ErrorReporter*>(reporter)->Report(__VA_ARGS__); \
   } while (false)
-#else  // TF_LITE_STRIP_ERROR_STRINGS
-#define TF_LITE_REPORT_ERROR(reporter, ...)
-#endif  // TF_LITE_STRIP_ERROR_STRINGS
+#endif  // TF_LITE_LOG_LEVEL
+
+#if TF_LITE_LOG_LEVEL < TF_LITE_LOG_LEVEL_INFO
+#define TF_LITE_REPORT_INFO(reporter, ...)
+#else
+#define TF_LITE_REPORT_INFO(reporter, ...) \
+  TF_LITE_REPORT_ERROR(reporter, __VA_ARGS__)
+#endif  // TF_LITE_LOG_LEVEL
 
 #endif  // TENSORFLOW_LITE_CORE_API_ERROR_REPORTER_H_
@@ -0,0 +1,169 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_API_INTERNED_LOG_H_
+#define TENSORFLOW_LITE_CORE_API_INTERNED_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Support for TF_LITE_LOG_INTERNING, see tensorflow/lite/c/log_config.h.
+//
+// An interned message is the id of its format string, which is the offset of
+// the string in the tflite_log_strings section, and its arguments converted
+// to 32-bit words. Ints and enums are kept as they are, floating point values
+// as the bits of a float and pointers, including %s strings, as their
+// address. TF_LITE_REPORT_ERROR passes it to ErrorReporter::ReportInterned()
+// and TF_LITE_KERNEL_LOG to TfLiteContext::ReportError() with
+// kInternedLogMarker as format, which ErrorReporter::ReportFromContext()
+// turns back into a ReportInterned() call. MicroErrorReporter writes it to
+// DebugLogBinary() as a binary frame, see EncodeInternedLogFrame(), so no
+// message is formatted on the device.
+
+extern "C" const char __start_tflite_log_strings[];
+
+#define TF_LITE_INTERNED_LOG_SECTION \
+  __attribute__((section("tflite_log_strings"), aligned(1)))
+
+// Places a copy of the format string of one call site in the string section
+// and passes it to `function`, one of the functions below. The format must be
+// a string literal or a char array known at compile time, a `const char*`
+// format does not compile: report it with ErrorReporter::Report() instead.
+// GNU ##__VA_ARGS__ drops the comma for messages without arguments.
+#define TF_LITE_INTERNED_LOG(function, target, format, ...)      \
+  do {                                                           \
+    static constexpr ::tflite::InternedLogFormat<sizeof(format)> \
+        tflite_interned_format TF_LITE_INTERNED_LOG_SECTION =    \
+            ::tflite::CopyInternedLogFormat(format);             \
+    ::tflite::function((target), tflite_interned_format.text,    \
+                       ##__VA_ARGS__);                           \
+  } while (false)
+
+namespace tflite {
+
+constexpr int kMaxInternedLogArgs = 12;
+
+// Format passed to TfLiteContext::ReportError() for an interned message,
+// followed by the id, the number of words and a pointer to the words. It
+// reads "@%x", so a forwarder that formats it still logs the id.
+extern const char kInternedLogMarker[];
+
+// Interned messages are written as binary frames of
+//   kInternedLogFrameStart, number of words, id, words
+// with the id and each word as 4 little-endian bytes. The start byte never
+// appears in ASCII or UTF-8 text, so frames can be mixed with text logs.
+constexpr uint8_t kInternedLogFrameStart = 0xfe;
+constexpr int kMaxInternedLogFrameSize = 2 + 4 * (kMaxInternedLogArgs + 1);
+
+// Writes the frame of a message with `num_words` words to `frame`, which has
+// room for kMaxInternedLogFrameSize bytes, and returns its size.
+inline int EncodeInternedLogFrame(uint32_t id, const uint32_t* words,
+                                  int num_words, uint8_t* frame) {
+  frame[0] = kInternedLogFrameStart;
+  frame[1] = static_cast<uint8_t>(num_words);
+  int size = 2;
+  for (int i = -1; i < num_words; ++i) {
+    const uint32_t word = i < 0 ? id : words[i];
+    for (int shift = 0; shift < 32; shift += 8) {
+      frame[size++] = static_cast<uint8_t>(word >> shift);
+    }
+  }
+  return size;
+}
+
+// The copy of a format string in the string section. It is built from the
+// array of the format at compile time, a C++11 constexpr function cannot
+// loop, so the characters are expanded from an index sequence.
+template <size_t N>
+struct InternedLogFormat {
+  char text[N];
+};
+
+template <size_t... Indices>
+struct InternedLogIndices {};
+
+template <size_t N, size_t... Indices>
+struct MakeInternedLogIndices
+    : MakeInternedLogIndices<N - 1, N - 1, Indices...> {};
+
+template <size_t... Indices>
+struct MakeInternedLogIndices<0, Indices...> {
+  typedef InternedLogIndices<Indices...> type;
+};
+
+template <size_t N, size_t... Indices>
+constexpr InternedLogFormat<N> CopyInternedLogFormat(
+    const char (&format)[N], InternedLogIndices<Indices...>) {
+  return {{format[Indices]...}};
+}
+
+template <size_t N>
+constexpr InternedLogFormat<N> CopyInternedLogFormat(const char (&format)[N]) {
+  return CopyInternedLogFormat(format,
+                               typename MakeInternedLogIndices<N>::type());
+}
+
+inline uint32_t InternedLogId(const char* format) {
+  return static_cast<uint32_t>(format - __start_tflite_log_strings);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value ||
+                                   std::is_enum<T>::value,
+                               uint32_t>::type
+InternedLogWord(T value) {
+  return static_cast<uint32_t>(value);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value,
+                               uint32_t>::type
+InternedLogWord(T value) {
+  const float float_value = static_cast<float>(value);
+  uint32_t word;
+  std::memcpy(&word, &float_value, sizeof(word));
+  return word;
+}
+
+inline uint32_t InternedLogWord(const void* value) {
+  return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value));
+}
+
+// Reports through TfLiteContext::ReportError(), for TF_LITE_KERNEL_LOG.
+template <typename Context, typename... Args>
+inline void KernelLogInterned(Context* context, const char* format,
+                              Args... args) {
+  static_assert(sizeof...(Args) <= kMaxInternedLogArgs,
+                "Too many arguments for an interned log message.");
+  const uint32_t words[kMaxInternedLogArgs] = {InternedLogWord(args)...};
+  context->ReportError(context, kInternedLogMarker, InternedLogId(format),
+                       static_cast<int>(sizeof...(Args)), words);
+}
+
+// Reports through an ErrorReporter, for TF_LITE_REPORT_ERROR.
+template <typename Reporter, typename... Args>
+inline void ReportErrorInterned(Reporter* reporter, const char* format,
+                                Args... args) {
+  static_assert(sizeof...(Args) <= kMaxInternedLogArgs,
+                "Too many arguments for an interned log message.");
+  const uint32_t words[kMaxInternedLogArgs] = {InternedLogWord(args)...};
+  reporter->ReportInterned(InternedLogId(format), words,
+                           static_cast<int>(sizeof...(Args)));
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_API_INTERNED_LOG_H_
@@ -31,13 +31,16 @@ AllOpsResolver::AllOpsResolver() {
   AddArgMax();
   AddArgMin();
   AddAveragePool2D();
+  AddBatchToSpaceNd();
   AddCeil();
   AddConcatenation();
   AddConv2D();
   AddCos();
+  AddDepthToSpace();
   AddDepthwiseConv2D();
   AddDequantize();
   AddEqual();
+  AddExp();
   AddFloor();
   AddFullyConnected();
   AddGreater();
@@ -70,8 +73,12 @@ AllOpsResolver::AllOpsResolver() {
   AddResizeNearestNeighbor();
   AddRound();
   AddRsqrt();
+  AddSelect();
+  AddSelectV2();
   AddSin();
   AddSoftmax();
+  AddSpaceToBatchNd();
+  AddSpaceToDepth();
   AddSplit();
   AddSplitV();
   AddSqrt();
@@ -80,6 +87,7 @@ AllOpsResolver::AllOpsResolver() {
   AddSub();
   AddSvdf();
   AddTanh();
+  AddTopKV2();
   AddUnpack();
 
   // TODO(b/159644355): Figure out if custom Ops belong in AllOpsResolver.
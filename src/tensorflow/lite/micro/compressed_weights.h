@@ -0,0 +1,132 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_COMPRESSED_WEIGHTS_H_
+#define TENSORFLOW_LITE_MICRO_COMPRESSED_WEIGHTS_H_
+
+#include <cstdint>
+
+namespace tflite {
+
+// Palette compressed int8 weights.
+//
+// The compress_weights host tool (tools/compress_weights.cc) replaces
+// the contents of int8 CONV_2D and FULLY_CONNECTED filter buffers with a
+// compressed stream and lists the compressed tensors in a metadata entry:
+//
+// | Metadata component |                 Value                                |
+// |    name:string     | “CompressedWeights”                                  |
+// |    buffer:unit     | Index of buffer containing the compression table     |
+//
+// The table is a list of 32-bit integers:
+//
+// |   Offset  |                            Value                              |
+// |     0     | Compressed weights format version – set to 0                  |
+// |     1     | Subgraph index to which the table applies                     |
+// |     2     | Number of entries following: n                                |
+// |  3 + 4*i  | Tensor index of entry #i                                      |
+// |  4 + 4*i  | CompressedWeightsCodec of entry #i                            |
+// |  5 + 4*i  | Bits per palette index of entry #i: 1, 2 or 4                 |
+// |  6 + 4*i  | Output channels per tile of entry #i                          |
+//
+// The stream is a sequence of tiles, each covering `tile_channels` output
+// channels (dimension 0) of the filter, the last one possibly fewer. A tile
+// is a palette of 2^bits int8 values followed by one index per weight in the
+// original order, packed least significant bits first and padded to a whole
+// byte. Every tile occupies CompressedTileSize() bytes, so tiles can be
+// decoded independently and in any order.
+//
+// Compressed tensors may only be the filter input of CONV_2D and
+// FULLY_CONNECTED nodes: those kernels decode one tile at a time into a
+// scratch buffer just ahead of the multiply-accumulate loop.
+constexpr char kCompressedWeightsMetadata[] = "CompressedWeights";
+constexpr int32_t kCompressedWeightsVersion = 0;
+
+enum CompressedWeightsCodec {
+  kCompressedWeightsPalette = 1,
+};
+
+// Compressed filter of one node. The MicroAllocator attaches it to the
+// consuming nodes, see node_weights.h. `data` references the model buffer.
+struct CompressedWeights {
+  CompressedWeightsCodec codec;
+  int index_bits;
+  int tile_channels;
+  const uint8_t* data;
+  int data_size;
+};
+
+// Size in bytes of one tile of `tile_channels` channels of `channel_size`
+// weights each.
+inline int CompressedTileSize(int index_bits, int tile_channels,
+                              int channel_size) {
+  return (1 << index_bits) +
+         (tile_channels * channel_size * index_bits + 7) / 8;
+}
+
+inline int CompressedTileCount(int tile_channels, int num_channels) {
+  return (num_channels + tile_channels - 1) / tile_channels;
+}
+
+// Size in bytes of a whole compressed tensor.
+inline int CompressedWeightsSize(int index_bits, int tile_channels,
+                                 int num_channels, int channel_size) {
+  return CompressedTileCount(tile_channels, num_channels) *
+         CompressedTileSize(index_bits, tile_channels, channel_size);
+}
+
+// Decodes tile `tile` into `output`, which must hold tile_channels *
+// channel_size values. Returns the number of channels in the tile.
+inline int DecompressTile(const CompressedWeights& compressed, int tile,
+                          int num_channels, int channel_size,
+                          int8_t* output) {
+  const int bits = compressed.index_bits;
+  const int first_channel = tile * compressed.tile_channels;
+  const int channels = num_channels - first_channel < compressed.tile_channels
+                           ? num_channels - first_channel
+                           : compressed.tile_channels;
+  const uint8_t* source =
+      compressed.data +
+      tile * CompressedTileSize(bits, compressed.tile_channels, channel_size);
+  const int8_t* palette = reinterpret_cast<const int8_t*>(source);
+  const uint8_t* indices = source + (1 << bits);
+  const int count = channels * channel_size;
+  if (bits == 4) {
+    int i = 0;
+    for (; i + 1 < count; i += 2) {
+      const uint8_t pair = *indices++;
+      output[i] = palette[pair & 0x0f];
+      output[i + 1] = palette[pair >> 4];
+    }
+    if (i < count) {
+      output[i] = palette[*indices & 0x0f];
+    }
+    return channels;
+  }
+  const int per_byte = 8 / bits;
+  const uint8_t mask = (1 << bits) - 1;
+  for (int i = 0; i < count; i += per_byte) {
+    uint8_t packed = *indices++;
+    const int n = count - i < per_byte ? count - i : per_byte;
+    for (int j = 0; j < n; ++j) {
+      output[i + j] = palette[packed & mask];
+      packed >>= bits;
+    }
+  }
+  return channels;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_COMPRESSED_WEIGHTS_H_
@@ -39,3 +39,7 @@ limitations under the License.
 #include <cstdio>
 
 extern "C" void DebugLog(const char* s) { fprintf(stderr, "%s", s); }
+
+extern "C" void DebugLogBinary(const void* data, int size) {
+  fwrite(data, 1, size, stderr);
+}
@@ -20,4 +20,9 @@ limitations under the License.
 // tensorflow/lite/micro/debug_log.cc.
 extern "C" void DebugLog(const char* s);
 
+// Writes `size` bytes of binary log data to the same stream as DebugLog().
+// Only needed with TF_LITE_LOG_INTERNING, for the interned message frames of
+// tensorflow/lite/core/api/interned_log.h.
+extern "C" void DebugLogBinary(const void* data, int size);
+
 #endif  // TENSORFLOW_LITE_MICRO_DEBUG_LOG_H_
@@ -0,0 +1,268 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/deferred_error_reporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+#include "tensorflow/lite/micro/debug_log.h"
+#include "tensorflow/lite/micro/micro_string.h"
+#endif
+
+#ifdef TF_LITE_LOG_INTERNING
+#include "tensorflow/lite/core/api/interned_log.h"
+#endif
+
+namespace tflite {
+
+DeferredErrorReporter::DeferredErrorReporter(DeferredLogRecord* records,
+                                             int num_records)
+    : records_(records),
+      num_records_(num_records),
+      head_(0),
+      tail_(0),
+      dropped_count_(0) {
+  TFLITE_DCHECK(num_records > 0);
+}
+
+DeferredLogRecord* DeferredErrorReporter::FreeRecord() {
+  const uint32_t head = head_.load(std::memory_order_relaxed);
+  const uint32_t tail = tail_.load(std::memory_order_acquire);
+  if ((head + 2 * num_records_ - tail) % (2 * num_records_) == num_records_) {
+    dropped_count_.store(dropped_count_.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+    return nullptr;
+  }
+  return &records_[head % num_records_];
+}
+
+void DeferredErrorReporter::AddRecord() {
+  const uint32_t head = head_.load(std::memory_order_relaxed);
+  head_.store((head + 1) % (2 * num_records_), std::memory_order_release);
+}
+
+const DeferredLogRecord* DeferredErrorReporter::OldestRecord() const {
+  const uint32_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail == head_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return &records_[tail % num_records_];
+}
+
+void DeferredErrorReporter::RemoveRecord() {
+  const uint32_t tail = tail_.load(std::memory_order_relaxed);
+  tail_.store((tail + 1) % (2 * num_records_), std::memory_order_release);
+}
+
+int DeferredErrorReporter::Report(const char* format, va_list args) {
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+  DeferredLogRecord* record = FreeRecord();
+  if (record == nullptr) {
+    return 0;
+  }
+
+  // Takes the arguments off the va_list the same way MicroVsnprintf() does,
+  // formatting is left to FormatNext().
+  record->format = format;
+  int num_args = 0;
+  for (const char* current = format;
+       *current != '\0' && num_args < kMaxDeferredLogArgs; ++current) {
+    if (*current != '%') {
+      continue;
+    }
+    ++current;
+    DeferredLogRecord::Arg& arg = record->args[num_args];
+    switch (*current) {
+      case 'd':
+        arg.i = va_arg(args, int32_t);
+        ++num_args;
+        break;
+      case 'u':
+      case 'x':
+        arg.u = va_arg(args, uint32_t);
+        ++num_args;
+        break;
+      case 'f':
+        arg.f = static_cast<float>(va_arg(args, double));
+        ++num_args;
+        break;
+      case 's':
+        arg.s = va_arg(args, const char*);
+        ++num_args;
+        break;
+      case '\0':
+        --current;
+        break;
+    }
+  }
+  record->num_args = num_args;
+  AddRecord();
+#endif
+  return 0;
+}
+
+#ifdef TF_LITE_LOG_INTERNING
+int DeferredErrorReporter::ReportInterned(uint32_t id, const uint32_t* words,
+                                          int num_words) {
+  DeferredLogRecord* record = FreeRecord();
+  if (record == nullptr) {
+    return 0;
+  }
+  record->format = nullptr;
+  record->interned_id = id;
+  record->num_args = std::min(num_words, kMaxDeferredLogArgs);
+  for (int i = 0; i < record->num_args; ++i) {
+    record->args[i].u = words[i];
+  }
+  AddRecord();
+  return 0;
+}
+#endif
+
+bool DeferredErrorReporter::FormatNext(char* output, int len) {
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+  const DeferredLogRecord* oldest = OldestRecord();
+  if (oldest == nullptr) {
+    return false;
+  }
+  const DeferredLogRecord& record = *oldest;
+#ifdef TF_LITE_LOG_INTERNING
+  if (record.format == nullptr) {
+    // The same text as ErrorReporter::ReportInterned(). MicroSnprintf()
+    // counts the terminator.
+    int written = MicroSnprintf(output, len, "@%x", record.interned_id) - 1;
+    for (int i = 0; i < record.num_args; ++i) {
+      written += MicroSnprintf(&output[written], len - written, " %x",
+                               record.args[i].u) -
+                 1;
+    }
+    RemoveRecord();
+    return true;
+  }
+#endif
+
+  // Copies the text between conversions and formats each stored argument
+  // with MicroSnprintf(), so the output matches MicroErrorReporter.
+  int output_index = 0;
+  int arg_index = 0;
+  const int usable_length = len - 1;
+  const char* current = record.format;
+  while (*current != '\0' && output_index < usable_length) {
+    if (*current != '%') {
+      output[output_index++] = *current++;
+      continue;
+    }
+    ++current;
+    const char conversion = *current;
+    const bool takes_arg = conversion == 'd' || conversion == 'u' ||
+                           conversion == 'x' || conversion == 'f' ||
+                           conversion == 's';
+    if (takes_arg && arg_index == record.num_args) {
+      // More conversions than kMaxDeferredLogArgs.
+      break;
+    }
+    if (!takes_arg) {
+      // '%%' prints '%', unsupported conversions print their letter.
+      if (conversion == '%') {
+        output[output_index++] = *current++;
+      }
+      continue;
+    }
+    const DeferredLogRecord::Arg& arg = record.args[arg_index++];
+    char* const end = &output[output_index];
+    const int remaining = len - output_index;
+    int written = 0;
+    switch (conversion) {
+      case 'd':
+        written = MicroSnprintf(end, remaining, "%d", arg.i);
+        break;
+      case 'u':
+        written = MicroSnprintf(end, remaining, "%u", arg.u);
+        break;
+      case 'x':
+        written = MicroSnprintf(end, remaining, "%x", arg.u);
+        break;
+      case 'f':
+        written =
+            MicroSnprintf(end, remaining, "%f", static_cast<double>(arg.f));
+        break;
+      case 's':
+        written = MicroSnprintf(end, remaining, "%s", arg.s);
+        break;
+    }
+    // MicroSnprintf() counts the terminator, and writes only the terminator
+    // when a number does not fit.
+    if (written <= 1 && conversion != 's') {
+      break;
+    }
+    output_index += written - 1;
+    ++current;
+  }
+  output[output_index] = '\0';
+  RemoveRecord();
+  return true;
+#else
+  return false;
+#endif
+}
+
+int DeferredErrorReporter::Flush() {
+  int num_logged = 0;
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+  static constexpr int kMaxLogLen = 256;
+  char log_buffer[kMaxLogLen];
+  while (true) {
+#ifdef TF_LITE_LOG_INTERNING
+    const DeferredLogRecord* oldest = OldestRecord();
+    if (oldest != nullptr && oldest->format == nullptr) {
+      uint32_t words[kMaxDeferredLogArgs];
+      for (int i = 0; i < oldest->num_args; ++i) {
+        words[i] = oldest->args[i].u;
+      }
+      uint8_t frame[kMaxInternedLogFrameSize];
+      const int frame_size = EncodeInternedLogFrame(
+          oldest->interned_id, words, oldest->num_args, frame);
+      RemoveRecord();
+      DebugLogBinary(frame, frame_size);
+      ++num_logged;
+      continue;
+    }
+#endif
+    if (!FormatNext(log_buffer, kMaxLogLen)) {
+      break;
+    }
+    DebugLog(log_buffer);
+    DebugLog("\r\n");
+    ++num_logged;
+  }
+  const uint32_t dropped = dropped_count();
+  if (dropped != flushed_drops_) {
+    MicroSnprintf(log_buffer, kMaxLogLen, "%u log messages dropped",
+                  dropped - flushed_drops_);
+    DebugLog(log_buffer);
+    DebugLog("\r\n");
+    flushed_drops_ = dropped;
+  }
+#endif
+  return num_logged;
+}
+
+}  // namespace tflite
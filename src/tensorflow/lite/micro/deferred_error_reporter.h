@@ -0,0 +1,128 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_DEFERRED_ERROR_REPORTER_H_
+#define TENSORFLOW_LITE_MICRO_DEFERRED_ERROR_REPORTER_H_
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/compatibility.h"
+
+namespace tflite {
+
+// Maximum number of arguments kept per message. Conversions past this many
+// are cut from the formatted message.
+constexpr int kMaxDeferredLogArgs = 6;
+
+// One reported message: the format string and its unformatted arguments.
+struct DeferredLogRecord {
+  union Arg {
+    int32_t i;
+    uint32_t u;
+    float f;
+    const char* s;
+  };
+  // nullptr for an interned message, whose arguments are its words.
+  const char* format;
+  Arg args[kMaxDeferredLogArgs];
+  int num_args;
+#ifdef TF_LITE_LOG_INTERNING
+  uint32_t interned_id;
+#endif
+};
+
+// ErrorReporter that keeps formatting and DebugLog() off the calling thread.
+//
+// Report() only copies the format pointer and the arguments into a ring of
+// records supplied by the application, which costs a few dozen cycles instead
+// of the time a blocking DebugLog() takes to send the message. Flush() formats
+// the stored messages and passes them to DebugLog(), from a low priority task,
+// the idle loop or after Invoke() returns:
+//
+//   DeferredLogRecord records[16];
+//   DeferredErrorReporter error_reporter(records, 16);
+//   MicroInterpreter interpreter(model, resolver, arena, arena_size,
+//                                &error_reporter);
+//   ...
+//   interpreter.Invoke();
+//   error_reporter.Flush();
+//
+// Report() and Flush()/FormatNext() may run concurrently on different threads
+// or in an interrupt handler and the main loop, as long as there is only one
+// of each. Messages reported while the ring is full are dropped and counted,
+// and the next Flush() logs how many were lost.
+//
+// Format strings and %s arguments are stored by pointer and must stay valid
+// until the message is flushed, which holds for string literals and the names
+// stored in the model. The conversions are the ones MicroVsnprintf supports.
+//
+// With TF_LITE_LOG_INTERNING, interned messages keep their id and up to
+// kMaxDeferredLogArgs words. Flush() writes them to DebugLogBinary() as the
+// binary frames MicroErrorReporter writes, FormatNext() as "@<id> <words>"
+// text.
+class DeferredErrorReporter : public ErrorReporter {
+ public:
+  // `records` must outlive the reporter. Holds up to `num_records` messages.
+  DeferredErrorReporter(DeferredLogRecord* records, int num_records);
+  ~DeferredErrorReporter() override {}
+
+  int Report(const char* format, va_list args) override;
+#ifdef TF_LITE_LOG_INTERNING
+  int ReportInterned(uint32_t id, const uint32_t* words,
+                     int num_words) override;
+#endif
+
+  // Formats the oldest stored message into `output` and removes it. Returns
+  // false if there is no message.
+  bool FormatNext(char* output, int len);
+
+  // Formats every stored message and passes it to DebugLog(). Returns the
+  // number of messages logged.
+  int Flush();
+
+  // Total number of messages dropped because the ring was full.
+  uint32_t dropped_count() const { return dropped_count_.load(); }
+
+ private:
+  // Returns the record that takes the next message, or nullptr if the ring
+  // is full, in which case the message is counted as dropped. The message is
+  // stored once AddRecord() is called.
+  DeferredLogRecord* FreeRecord();
+  void AddRecord();
+  // Returns the oldest stored message, or nullptr if there is none. It stays
+  // stored until RemoveRecord() is called.
+  const DeferredLogRecord* OldestRecord() const;
+  void RemoveRecord();
+
+  DeferredLogRecord* records_;
+  uint32_t num_records_;
+  // Positions of the next message to store and to remove, counted modulo
+  // twice the ring size so that a full ring differs from an empty one. Only
+  // the reporting thread writes head_ and dropped_count_, only the flushing
+  // thread writes tail_.
+  std::atomic<uint32_t> head_;
+  std::atomic<uint32_t> tail_;
+  std::atomic<uint32_t> dropped_count_;
+  // Drops already reported by Flush().
+  uint32_t flushed_drops_ = 0;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_DEFERRED_ERROR_REPORTER_H_
@@ -0,0 +1,61 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/early_exit.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace {
+
+template <typename T>
+T MaxValue(const T* data, int size) {
+  T max = data[0];
+  for (int i = 1; i < size; ++i) {
+    if (data[i] > max) {
+      max = data[i];
+    }
+  }
+  return max;
+}
+
+}  // namespace
+
+bool MaxScoreAtLeast(const TfLiteEvalTensor* head, void* user_data) {
+  const ScoreThreshold* threshold = static_cast<ScoreThreshold*>(user_data);
+  const int size = ElementCount(*head->dims);
+  if (size == 0) {
+    return false;
+  }
+  switch (head->type) {
+    case kTfLiteFloat32:
+      return MaxValue(head->data.f, size) >= threshold->threshold;
+    case kTfLiteInt8:
+      return (MaxValue(head->data.int8, size) - threshold->zero_point) *
+                 threshold->scale >=
+             threshold->threshold;
+    case kTfLiteUInt8:
+      return (MaxValue(head->data.uint8, size) - threshold->zero_point) *
+                 threshold->scale >=
+             threshold->threshold;
+    default:
+      return false;
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,51 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_EARLY_EXIT_H_
+#define TENSORFLOW_LITE_MICRO_EARLY_EXIT_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// An early exit of a cascaded model: after the operator at `op_index`,
+// MicroInterpreter::Invoke() passes the model output at `output_index`, an
+// auxiliary head computed by then, to `check` and skips the remaining
+// operators if it returns true. See MicroInterpreter::SetEarlyExits().
+struct EarlyExit {
+  int op_index;
+  int output_index;
+  bool (*check)(const TfLiteEvalTensor* head, void* user_data);
+  void* user_data;
+};
+
+// user_data of MaxScoreAtLeast(). `scale` and `zero_point` are the
+// quantization parameters of int8 and uint8 heads, ignored for float heads.
+struct ScoreThreshold {
+  float threshold;
+  float scale;
+  int32_t zero_point;
+};
+
+// Check that exits when the largest score of the head, for example the
+// output of a SOFTMAX, is at least the threshold of the ScoreThreshold in
+// `user_data`. Float32, int8 and uint8 heads are supported, other types
+// never exit.
+bool MaxScoreAtLeast(const TfLiteEvalTensor* head, void* user_data);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_EARLY_EXIT_H_
@@ -0,0 +1,774 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/micro/graph_rewriter.h"
+
+#include <cstdint>
+
+#include "third_party/flatbuffers/include/flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/select.h"
+#include "tensorflow/lite/micro/kernels/separable_conv.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/micro/simple_memory_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace internal {
+
+namespace {
+
+const TfLiteIntArray kEmptyIntArray = {0, {}};
+
+// Shared registration for nodes removed by a rewrite. All callbacks are null,
+// so the interpreter neither prepares nor invokes these nodes.
+const TfLiteRegistration kElidedNodeRegistration = {
+    /*init=*/nullptr,
+    /*free=*/nullptr,
+    /*prepare=*/nullptr,
+    /*invoke=*/nullptr,
+    /*profiling_string=*/nullptr,
+    /*builtin_code=*/BuiltinOperator_CUSTOM,
+    /*custom_name=*/"ELIDED",
+    /*version=*/0};
+
+// Input indices shared by SPACE_TO_BATCH_ND, BATCH_TO_SPACE_ND and the
+// convolutions; for the latter only kDataTensor applies.
+constexpr int kDataTensor = 0;
+constexpr int kBlockShapeTensor = 1;
+constexpr int kPaddingsTensor = 2;
+
+bool IsBuiltin(const NodeAndRegistration& node_and_registration,
+               BuiltinOperator op) {
+  return node_and_registration.registration != nullptr &&
+         node_and_registration.registration->builtin_code == op;
+}
+
+bool IsSubgraphOutput(const SubGraph* subgraph, int tensor_index) {
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    if (subgraph->outputs()->Get(i) == tensor_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the index of the only node reading `tensor_index`, or -1 if the
+// tensor has several consumers or none.
+int FindSoleConsumer(const NodeAndRegistration* node_and_registrations,
+                     int node_count, int tensor_index) {
+  int consumer = -1;
+  for (int i = 0; i < node_count; ++i) {
+    const TfLiteIntArray* inputs = node_and_registrations[i].node.inputs;
+    for (int n = 0; n < inputs->size; ++n) {
+      if (inputs->data[n] == tensor_index) {
+        if (consumer != -1 && consumer != i) {
+          return -1;
+        }
+        consumer = i;
+      }
+    }
+  }
+  return consumer;
+}
+
+// Before the static memory plan is committed only tensors backed by a
+// flatbuffer buffer have data, which makes them safe to read here.
+bool IsConstantInt32(const TfLiteEvalTensor& tensor, int element_count) {
+  if (tensor.type != kTfLiteInt32 || tensor.data.data == nullptr) {
+    return false;
+  }
+  int count = 1;
+  for (int i = 0; i < tensor.dims->size; ++i) {
+    count *= tensor.dims->data[i];
+  }
+  return count == element_count;
+}
+
+int32_t ReadInt32(const TfLiteEvalTensor& tensor, int index) {
+  // Runs before the interpreter converts buffers on big endian targets.
+  return flatbuffers::EndianScalar(tensor.data.i32[index]);
+}
+
+bool HaveSameQuantization(const Tensor* a, const Tensor* b) {
+  const QuantizationParameters* qa = a->quantization();
+  const QuantizationParameters* qb = b->quantization();
+  const bool a_quantized = qa != nullptr && qa->scale() != nullptr &&
+                           qa->scale()->size() > 0;
+  const bool b_quantized = qb != nullptr && qb->scale() != nullptr &&
+                           qb->scale()->size() > 0;
+  if (a_quantized != b_quantized) {
+    return false;
+  }
+  if (!a_quantized) {
+    return true;
+  }
+  if (qa->scale()->size() != 1 || qb->scale()->size() != 1 ||
+      qa->zero_point() == nullptr || qb->zero_point() == nullptr ||
+      qa->zero_point()->size() != 1 || qb->zero_point()->size() != 1) {
+    return false;
+  }
+  return qa->scale()->Get(0) == qb->scale()->Get(0) &&
+         qa->zero_point()->Get(0) == qb->zero_point()->Get(0);
+}
+
+// Reads the per-tensor scale and zero point of `tensor`.
+bool GetPerTensorQuantization(const Tensor* tensor, float* scale,
+                              int64_t* zero_point) {
+  const QuantizationParameters* q = tensor->quantization();
+  if (q == nullptr || q->scale() == nullptr || q->scale()->size() != 1 ||
+      q->zero_point() == nullptr || q->zero_point()->size() != 1) {
+    return false;
+  }
+  *scale = q->scale()->Get(0);
+  *zero_point = q->zero_point()->Get(0);
+  return true;
+}
+
+TfLiteStatus CopyIntArray(SimpleMemoryAllocator* allocator,
+                          ErrorReporter* error_reporter,
+                          const TfLiteIntArray* source,
+                          TfLiteIntArray** result) {
+  const size_t bytes = TfLiteIntArrayGetSizeInBytes(source->size);
+  TfLiteIntArray* array = reinterpret_cast<TfLiteIntArray*>(
+      allocator->AllocateFromTail(bytes, alignof(TfLiteIntArray)));
+  if (array == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to allocate %d bytes for a rewritten node.",
+                         bytes);
+    return kTfLiteError;
+  }
+  array->size = source->size;
+  for (int i = 0; i < source->size; ++i) {
+    array->data[i] = source->data[i];
+  }
+  *result = array;
+  return kTfLiteOk;
+}
+
+void ElideNode(NodeAndRegistration* node_and_registration) {
+  node_and_registration->registration = &kElidedNodeRegistration;
+  node_and_registration->node.inputs =
+      const_cast<TfLiteIntArray*>(&kEmptyIntArray);
+  node_and_registration->node.outputs =
+      const_cast<TfLiteIntArray*>(&kEmptyIntArray);
+}
+
+bool IsComparison(const NodeAndRegistration& node_and_registration) {
+  return IsBuiltin(node_and_registration, BuiltinOperator_EQUAL) ||
+         IsBuiltin(node_and_registration, BuiltinOperator_NOT_EQUAL) ||
+         IsBuiltin(node_and_registration, BuiltinOperator_GREATER) ||
+         IsBuiltin(node_and_registration, BuiltinOperator_GREATER_EQUAL) ||
+         IsBuiltin(node_and_registration, BuiltinOperator_LESS) ||
+         IsBuiltin(node_and_registration, BuiltinOperator_LESS_EQUAL);
+}
+
+bool HaveSameDims(const TfLiteEvalTensor& a, const TfLiteEvalTensor& b) {
+  if (a.dims->size != b.dims->size) {
+    return false;
+  }
+  for (int i = 0; i < a.dims->size; ++i) {
+    if (a.dims->data[i] != b.dims->data[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HasShapeOrIsScalar(const TfLiteEvalTensor& tensor,
+                        const TfLiteEvalTensor& output) {
+  return HaveSameDims(tensor, output) || ElementCount(*tensor.dims) == 1;
+}
+
+// Both TfLiteConvParams and TfLiteDepthwiseConvParams carry the fields used
+// here under the same names.
+template <typename ParamsT>
+bool IsPlainValidConv(const ParamsT* params) {
+  return params != nullptr && params->padding == kTfLitePaddingValid &&
+         params->stride_width == 1 && params->stride_height == 1 &&
+         params->dilation_width_factor == 1 &&
+         params->dilation_height_factor == 1;
+}
+
+template <typename ParamsT>
+void SetDilation(ParamsT* params, TfLitePadding padding, int block_height,
+                 int block_width) {
+  params->padding = padding;
+  params->dilation_height_factor = block_height;
+  params->dilation_width_factor = block_width;
+}
+
+}  // namespace
+
+bool IsElidedNode(const NodeAndRegistration& node_and_registration) {
+  return node_and_registration.registration == &kElidedNodeRegistration;
+}
+
+TfLiteStatus FuseSpaceToBatchConvolutions(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors) {
+  const int node_count = subgraph->operators()->size();
+  for (int s2b = 0; s2b < node_count; ++s2b) {
+    NodeAndRegistration* s2b_node = &node_and_registrations[s2b];
+    if (!IsBuiltin(*s2b_node, BuiltinOperator_SPACE_TO_BATCH_ND) ||
+        s2b_node->node.inputs->size != 3 || s2b_node->node.outputs->size != 1) {
+      continue;
+    }
+    const int input_index = s2b_node->node.inputs->data[kDataTensor];
+    const int s2b_block_index = s2b_node->node.inputs->data[kBlockShapeTensor];
+    const int paddings_index = s2b_node->node.inputs->data[kPaddingsTensor];
+    const int s2b_output_index = s2b_node->node.outputs->data[0];
+    if (IsSubgraphOutput(subgraph, s2b_output_index) ||
+        eval_tensors[input_index].dims->size != 4 ||
+        !IsConstantInt32(eval_tensors[s2b_block_index], 2) ||
+        !IsConstantInt32(eval_tensors[paddings_index], 4)) {
+      continue;
+    }
+
+    const int conv =
+        FindSoleConsumer(node_and_registrations, node_count, s2b_output_index);
+    if (conv <= s2b) {
+      continue;
+    }
+    NodeAndRegistration* conv_node = &node_and_registrations[conv];
+    const bool is_conv = IsBuiltin(*conv_node, BuiltinOperator_CONV_2D);
+    const bool is_depthwise =
+        IsBuiltin(*conv_node, BuiltinOperator_DEPTHWISE_CONV_2D);
+    if (!(is_conv || is_depthwise) || conv_node->node.inputs->size < 2 ||
+        conv_node->node.outputs->size != 1 ||
+        conv_node->node.inputs->data[kDataTensor] != s2b_output_index) {
+      continue;
+    }
+    if (is_conv && !IsPlainValidConv(static_cast<const TfLiteConvParams*>(
+                       conv_node->node.builtin_data))) {
+      continue;
+    }
+    if (is_depthwise &&
+        !IsPlainValidConv(static_cast<const TfLiteDepthwiseConvParams*>(
+            conv_node->node.builtin_data))) {
+      continue;
+    }
+    const int conv_output_index = conv_node->node.outputs->data[0];
+    if (IsSubgraphOutput(subgraph, conv_output_index)) {
+      continue;
+    }
+
+    const int b2s =
+        FindSoleConsumer(node_and_registrations, node_count, conv_output_index);
+    if (b2s <= conv) {
+      continue;
+    }
+    NodeAndRegistration* b2s_node = &node_and_registrations[b2s];
+    if (!IsBuiltin(*b2s_node, BuiltinOperator_BATCH_TO_SPACE_ND) ||
+        b2s_node->node.inputs->size != 3 || b2s_node->node.outputs->size != 1 ||
+        b2s_node->node.inputs->data[kDataTensor] != conv_output_index) {
+      continue;
+    }
+    const int b2s_block_index = b2s_node->node.inputs->data[kBlockShapeTensor];
+    const int crops_index = b2s_node->node.inputs->data[kPaddingsTensor];
+    const int output_index = b2s_node->node.outputs->data[0];
+    if (!IsConstantInt32(eval_tensors[b2s_block_index], 2) ||
+        !IsConstantInt32(eval_tensors[crops_index], 4) ||
+        eval_tensors[output_index].dims->size != 4) {
+      continue;
+    }
+
+    const TfLiteEvalTensor& s2b_block = eval_tensors[s2b_block_index];
+    const TfLiteEvalTensor& b2s_block = eval_tensors[b2s_block_index];
+    const int block_height = ReadInt32(s2b_block, 0);
+    const int block_width = ReadInt32(s2b_block, 1);
+    if (block_height < 1 || block_width < 1 ||
+        ReadInt32(b2s_block, 0) != block_height ||
+        ReadInt32(b2s_block, 1) != block_width) {
+      continue;
+    }
+
+    // The reshuffles must not requantize, or the fused graph would differ.
+    const auto* tensors = subgraph->tensors();
+    if (!HaveSameQuantization(tensors->Get(input_index),
+                              tensors->Get(s2b_output_index)) ||
+        !HaveSameQuantization(tensors->Get(conv_output_index),
+                              tensors->Get(output_index))) {
+      continue;
+    }
+
+    // Padding added in front by SPACE_TO_BATCH_ND minus the crop removed by
+    // BATCH_TO_SPACE_ND is the padding the dilated convolution sees.
+    const TfLiteEvalTensor& paddings = eval_tensors[paddings_index];
+    const TfLiteEvalTensor& crops = eval_tensors[crops_index];
+    const int pad_top = ReadInt32(paddings, 0) - ReadInt32(crops, 0);
+    const int pad_left = ReadInt32(paddings, 2) - ReadInt32(crops, 2);
+
+    const TfLiteIntArray* input_dims = eval_tensors[input_index].dims;
+    const TfLiteIntArray* output_dims = eval_tensors[output_index].dims;
+    const TfLiteIntArray* filter_dims =
+        eval_tensors[conv_node->node.inputs->data[1]].dims;
+    if (filter_dims->size != 4 || input_dims->data[0] != output_dims->data[0]) {
+      continue;
+    }
+
+    // Only fold when a standard padding mode reproduces both the padding and
+    // the output shape of the original pattern.
+    TfLitePadding padding = kTfLitePaddingUnknown;
+    const TfLitePadding candidates[] = {kTfLitePaddingValid,
+                                        kTfLitePaddingSame};
+    for (TfLitePadding candidate : candidates) {
+      int out_height, out_width;
+      TfLitePaddingValues values = ComputePaddingHeightWidth(
+          /*stride_height=*/1, /*stride_width=*/1, block_height, block_width,
+          input_dims->data[1], input_dims->data[2], filter_dims->data[1],
+          filter_dims->data[2], candidate, &out_height, &out_width);
+      if (out_height == output_dims->data[1] &&
+          out_width == output_dims->data[2] && values.height == pad_top &&
+          values.width == pad_left) {
+        padding = candidate;
+        break;
+      }
+    }
+    if (padding == kTfLitePaddingUnknown) {
+      continue;
+    }
+
+    TfLiteIntArray* conv_inputs;
+    TfLiteIntArray* conv_outputs;
+    TF_LITE_ENSURE_STATUS(CopyIntArray(allocator, error_reporter,
+                                       conv_node->node.inputs, &conv_inputs));
+    TF_LITE_ENSURE_STATUS(CopyIntArray(allocator, error_reporter,
+                                       conv_node->node.outputs, &conv_outputs));
+    conv_inputs->data[kDataTensor] = input_index;
+    conv_outputs->data[0] = output_index;
+    conv_node->node.inputs = conv_inputs;
+    conv_node->node.outputs = conv_outputs;
+    if (is_conv) {
+      SetDilation(static_cast<TfLiteConvParams*>(conv_node->node.builtin_data),
+                  padding, block_height, block_width);
+    } else {
+      SetDilation(
+          static_cast<TfLiteDepthwiseConvParams*>(conv_node->node.builtin_data),
+          padding, block_height, block_width);
+    }
+    ElideNode(s2b_node);
+    ElideNode(b2s_node);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus FuseComparisonIntoSelect(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors) {
+  const int node_count = subgraph->operators()->size();
+  for (int compare = 0; compare < node_count; ++compare) {
+    NodeAndRegistration* compare_node = &node_and_registrations[compare];
+    if (!IsComparison(*compare_node) || compare_node->node.inputs->size != 2 ||
+        compare_node->node.outputs->size != 1) {
+      continue;
+    }
+    const int lhs_index = compare_node->node.inputs->data[0];
+    const int rhs_index = compare_node->node.inputs->data[1];
+    const int mask_index = compare_node->node.outputs->data[0];
+    if (IsSubgraphOutput(subgraph, mask_index)) {
+      continue;
+    }
+
+    const int select =
+        FindSoleConsumer(node_and_registrations, node_count, mask_index);
+    if (select <= compare) {
+      continue;
+    }
+    NodeAndRegistration* select_node = &node_and_registrations[select];
+    if (!(IsBuiltin(*select_node, BuiltinOperator_SELECT) ||
+          IsBuiltin(*select_node, BuiltinOperator_SELECT_V2)) ||
+        select_node->node.inputs->size != 3 ||
+        select_node->node.outputs->size != 1 ||
+        select_node->node.builtin_data != nullptr) {
+      continue;
+    }
+    const int x_index = select_node->node.inputs->data[1];
+    const int y_index = select_node->node.inputs->data[2];
+    const int output_index = select_node->node.outputs->data[0];
+    // The mask must only feed the condition, not one of the values.
+    if (select_node->node.inputs->data[0] != mask_index ||
+        x_index == mask_index || y_index == mask_index) {
+      continue;
+    }
+
+    // Only the types the comparison kernels support, so that fusing never
+    // runs a model the unfused kernels would reject.
+    const TfLiteEvalTensor& output = eval_tensors[output_index];
+    const TfLiteType type = output.type;
+    if (type != kTfLiteFloat32 && type != kTfLiteInt8 &&
+        type != kTfLiteUInt8 && type != kTfLiteInt32) {
+      continue;
+    }
+    const int operands[] = {lhs_index, rhs_index, x_index, y_index};
+    bool operands_match = true;
+    for (int operand : operands) {
+      operands_match &= eval_tensors[operand].type == type &&
+                        HasShapeOrIsScalar(eval_tensors[operand], output);
+    }
+    // Quantized values are compared raw, which is exact only when both sides
+    // share the same scale and zero point. uint8/int8 operands must also be
+    // compared raw by the unfused kernel, see ComparesQuantizedRaw().
+    if (!operands_match ||
+        !HaveSameQuantization(subgraph->tensors()->Get(lhs_index),
+                              subgraph->tensors()->Get(rhs_index))) {
+      continue;
+    }
+    if (type == kTfLiteInt8 || type == kTfLiteUInt8) {
+      float scale;
+      int64_t zero_point;
+      if (!GetPerTensorQuantization(subgraph->tensors()->Get(lhs_index),
+                                    &scale, &zero_point) ||
+          !ops::micro::ComparesQuantizedRaw(scale)) {
+        continue;
+      }
+    }
+
+    ops::micro::FusedComparisonSelectParams* params =
+        reinterpret_cast<ops::micro::FusedComparisonSelectParams*>(
+            allocator->AllocateFromTail(
+                sizeof(ops::micro::FusedComparisonSelectParams),
+                alignof(ops::micro::FusedComparisonSelectParams)));
+    if (params == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to allocate fused select parameters.");
+      return kTfLiteError;
+    }
+    // SELECT inputs become {lhs, x, y, rhs}, see micro/kernels/select.h.
+    TfLiteIntArray* fused_inputs = reinterpret_cast<TfLiteIntArray*>(
+        allocator->AllocateFromTail(TfLiteIntArrayGetSizeInBytes(4),
+                                    alignof(TfLiteIntArray)));
+    if (fused_inputs == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to allocate fused select inputs.");
+      return kTfLiteError;
+    }
+    fused_inputs->size = 4;
+    fused_inputs->data[0] = lhs_index;
+    fused_inputs->data[1] = x_index;
+    fused_inputs->data[2] = y_index;
+    fused_inputs->data[3] = rhs_index;
+
+    params->comparison =
+        static_cast<BuiltinOperator>(compare_node->registration->builtin_code);
+    select_node->node.inputs = fused_inputs;
+    select_node->node.builtin_data = params;
+    ElideNode(compare_node);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus FoldInputQuantizeIntoConv(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors) {
+  const int node_count = subgraph->operators()->size();
+  for (int quantize = 0; quantize < node_count; ++quantize) {
+    NodeAndRegistration* quantize_node = &node_and_registrations[quantize];
+    if (!IsBuiltin(*quantize_node, BuiltinOperator_QUANTIZE) ||
+        quantize_node->node.inputs->size != 1 ||
+        quantize_node->node.outputs->size != 1) {
+      continue;
+    }
+    const int pixels_index = quantize_node->node.inputs->data[0];
+    const int quantized_index = quantize_node->node.outputs->data[0];
+    if (eval_tensors[pixels_index].type != kTfLiteUInt8 ||
+        eval_tensors[quantized_index].type != kTfLiteInt8 ||
+        IsSubgraphOutput(subgraph, quantized_index)) {
+      continue;
+    }
+    // The QUANTIZE must only shift the zero point by 128, which leaves the
+    // real values unchanged.
+    float pixels_scale, quantized_scale;
+    int64_t pixels_zero_point, quantized_zero_point;
+    if (!GetPerTensorQuantization(subgraph->tensors()->Get(pixels_index),
+                                  &pixels_scale, &pixels_zero_point) ||
+        !GetPerTensorQuantization(subgraph->tensors()->Get(quantized_index),
+                                  &quantized_scale, &quantized_zero_point) ||
+        pixels_scale != quantized_scale ||
+        quantized_zero_point != pixels_zero_point - 128) {
+      continue;
+    }
+
+    const int conv =
+        FindSoleConsumer(node_and_registrations, node_count, quantized_index);
+    if (conv <= quantize) {
+      continue;
+    }
+    NodeAndRegistration* conv_node = &node_and_registrations[conv];
+    // Packed or compressed weights only take int8 input.
+    if (!IsBuiltin(*conv_node, BuiltinOperator_CONV_2D) ||
+        conv_node->node.inputs->size < 2 ||
+        conv_node->node.custom_initial_data != nullptr) {
+      continue;
+    }
+    const TfLiteIntArray* conv_inputs = conv_node->node.inputs;
+    bool feeds_data_only = conv_inputs->data[kDataTensor] == quantized_index;
+    for (int i = 1; i < conv_inputs->size; ++i) {
+      feeds_data_only &= conv_inputs->data[i] != quantized_index;
+    }
+    if (!feeds_data_only) {
+      continue;
+    }
+    const TfLiteEvalTensor& filter = eval_tensors[conv_inputs->data[1]];
+    if (filter.type != kTfLiteInt8 || filter.data.data == nullptr ||
+        filter.dims->size != 4 ||
+        !ops::micro::IsShallowConvShape(filter.dims->data[3],
+                                        filter.dims->data[1],
+                                        filter.dims->data[2])) {
+      continue;
+    }
+
+    TfLiteIntArray* conv_inputs_copy;
+    TF_LITE_ENSURE_STATUS(CopyIntArray(allocator, error_reporter, conv_inputs,
+                                       &conv_inputs_copy));
+    conv_inputs_copy->data[kDataTensor] = pixels_index;
+    conv_node->node.inputs = conv_inputs_copy;
+    ElideNode(quantize_node);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus FuseSeparableConvolutions(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors) {
+  const int node_count = subgraph->operators()->size();
+  for (int depthwise = 0; depthwise < node_count; ++depthwise) {
+    NodeAndRegistration* depthwise_node = &node_and_registrations[depthwise];
+    if (!IsBuiltin(*depthwise_node, BuiltinOperator_DEPTHWISE_CONV_2D) ||
+        depthwise_node->node.inputs->size < 2 ||
+        depthwise_node->node.inputs->size > 3 ||
+        depthwise_node->node.outputs->size != 1 ||
+        depthwise_node->node.custom_initial_data != nullptr) {
+      continue;
+    }
+    const auto* depthwise_params =
+        static_cast<const TfLiteDepthwiseConvParams*>(
+            depthwise_node->node.builtin_data);
+    const TfLiteIntArray* depthwise_inputs = depthwise_node->node.inputs;
+    const int input_index = depthwise_inputs->data[kDataTensor];
+    const int intermediate_index = depthwise_node->node.outputs->data[0];
+    const TfLiteEvalTensor& input = eval_tensors[input_index];
+    const TfLiteEvalTensor& depthwise_filter =
+        eval_tensors[depthwise_inputs->data[1]];
+    if (depthwise_params == nullptr ||
+        depthwise_params->dilation_width_factor != 1 ||
+        depthwise_params->dilation_height_factor != 1 ||
+        input.type != kTfLiteInt8 || input.dims->size != 4 ||
+        depthwise_filter.type != kTfLiteInt8 ||
+        depthwise_filter.data.data == nullptr ||
+        depthwise_filter.dims->size != 4 ||
+        depthwise_filter.dims->data[3] != input.dims->data[3] ||
+        eval_tensors[intermediate_index].type != kTfLiteInt8 ||
+        IsSubgraphOutput(subgraph, intermediate_index)) {
+      continue;
+    }
+    float intermediate_scale;
+    int64_t intermediate_zero_point;
+    if (!GetPerTensorQuantization(subgraph->tensors()->Get(intermediate_index),
+                                  &intermediate_scale,
+                                  &intermediate_zero_point)) {
+      continue;
+    }
+
+    const int conv = FindSoleConsumer(node_and_registrations, node_count,
+                                      intermediate_index);
+    if (conv <= depthwise) {
+      continue;
+    }
+    NodeAndRegistration* conv_node = &node_and_registrations[conv];
+    if (!IsBuiltin(*conv_node, BuiltinOperator_CONV_2D) ||
+        conv_node->node.inputs->size < 2 || conv_node->node.inputs->size > 3 ||
+        conv_node->node.outputs->size != 1 ||
+        conv_node->node.custom_initial_data != nullptr) {
+      continue;
+    }
+    const auto* conv_params =
+        static_cast<const TfLiteConvParams*>(conv_node->node.builtin_data);
+    const TfLiteIntArray* conv_inputs = conv_node->node.inputs;
+    const TfLiteEvalTensor& pointwise_filter =
+        eval_tensors[conv_inputs->data[1]];
+    const bool has_pointwise_bias = conv_inputs->size == 3;
+    if (conv_params == nullptr || conv_params->stride_width != 1 ||
+        conv_params->stride_height != 1 ||
+        conv_inputs->data[kDataTensor] != intermediate_index ||
+        conv_inputs->data[1] == intermediate_index ||
+        (has_pointwise_bias && conv_inputs->data[2] == intermediate_index) ||
+        pointwise_filter.type != kTfLiteInt8 ||
+        pointwise_filter.data.data == nullptr ||
+        pointwise_filter.dims->size != 4 ||
+        pointwise_filter.dims->data[1] != 1 ||
+        pointwise_filter.dims->data[2] != 1 ||
+        eval_tensors[conv_node->node.outputs->data[0]].type != kTfLiteInt8) {
+      continue;
+    }
+
+    auto* params = reinterpret_cast<ops::micro::FusedSeparableConvParams*>(
+        allocator->AllocateFromTail(
+            sizeof(ops::micro::FusedSeparableConvParams),
+            alignof(ops::micro::FusedSeparableConvParams)));
+    TfLiteIntArray* fused_inputs = reinterpret_cast<TfLiteIntArray*>(
+        allocator->AllocateFromTail(
+            TfLiteIntArrayGetSizeInBytes(ops::micro::kSeparableConvNumInputs),
+            alignof(TfLiteIntArray)));
+    TfLiteRegistration* registration = reinterpret_cast<TfLiteRegistration*>(
+        allocator->AllocateFromTail(sizeof(TfLiteRegistration),
+                                    alignof(TfLiteRegistration)));
+    if (params == nullptr || fused_inputs == nullptr ||
+        registration == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to allocate a fused separable conv.");
+      return kTfLiteError;
+    }
+    params->depthwise = *depthwise_params;
+    params->pointwise = *conv_params;
+    params->intermediate_scale = intermediate_scale;
+    params->intermediate_zero_point =
+        static_cast<int32_t>(intermediate_zero_point);
+    fused_inputs->size = ops::micro::kSeparableConvNumInputs;
+    fused_inputs->data[ops::micro::kSeparableConvInputTensor] = input_index;
+    fused_inputs->data[ops::micro::kSeparableConvDepthwiseFilterTensor] =
+        depthwise_inputs->data[1];
+    fused_inputs->data[ops::micro::kSeparableConvDepthwiseBiasTensor] =
+        depthwise_inputs->size == 3 ? depthwise_inputs->data[2]
+                                    : kTfLiteOptionalTensor;
+    fused_inputs->data[ops::micro::kSeparableConvPointwiseFilterTensor] =
+        conv_inputs->data[1];
+    fused_inputs->data[ops::micro::kSeparableConvPointwiseBiasTensor] =
+        has_pointwise_bias ? conv_inputs->data[2] : kTfLiteOptionalTensor;
+    *registration = ops::micro::Register_FUSED_SEPARABLE_CONV_2D();
+    registration->builtin_code = BuiltinOperator_CUSTOM;
+    registration->custom_name = ops::micro::kFusedSeparableConvName;
+
+    conv_node->registration = registration;
+    conv_node->node.inputs = fused_inputs;
+    conv_node->node.builtin_data = params;
+    ElideNode(depthwise_node);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus FoldFloat16Dequantize(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors) {
+  const int node_count = subgraph->operators()->size();
+  for (int dequantize = 0; dequantize < node_count; ++dequantize) {
+    NodeAndRegistration* dequantize_node = &node_and_registrations[dequantize];
+    if (!IsBuiltin(*dequantize_node, BuiltinOperator_DEQUANTIZE) ||
+        dequantize_node->node.inputs->size != 1 ||
+        dequantize_node->node.outputs->size != 1) {
+      continue;
+    }
+    const int weights_index = dequantize_node->node.inputs->data[0];
+    const int float_index = dequantize_node->node.outputs->data[0];
+    if (eval_tensors[weights_index].type != kTfLiteFloat16 ||
+        eval_tensors[weights_index].data.data == nullptr ||
+        eval_tensors[float_index].type != kTfLiteFloat32 ||
+        IsSubgraphOutput(subgraph, float_index)) {
+      continue;
+    }
+
+    // Every consumer must read the tensor as filter or bias of a float
+    // convolution or fully connected layer.
+    bool only_weights = true;
+    int consumer_count = 0;
+    for (int i = 0; i < node_count && only_weights; ++i) {
+      const NodeAndRegistration& node = node_and_registrations[i];
+      const TfLiteIntArray* inputs = node.node.inputs;
+      bool reads = false;
+      for (int n = 0; n < inputs->size; ++n) {
+        if (inputs->data[n] != float_index) {
+          continue;
+        }
+        reads = true;
+        only_weights &= n != kDataTensor;
+      }
+      if (!reads) {
+        continue;
+      }
+      ++consumer_count;
+      only_weights &= (IsBuiltin(node, BuiltinOperator_CONV_2D) ||
+                       IsBuiltin(node, BuiltinOperator_DEPTHWISE_CONV_2D) ||
+                       IsBuiltin(node, BuiltinOperator_FULLY_CONNECTED)) &&
+                      i > dequantize && inputs->size >= 2 &&
+                      inputs->size <= 3 &&
+                      eval_tensors[inputs->data[kDataTensor]].type ==
+                          kTfLiteFloat32;
+    }
+    if (!only_weights || consumer_count == 0) {
+      continue;
+    }
+
+    for (int i = dequantize + 1; i < node_count; ++i) {
+      NodeAndRegistration* consumer = &node_and_registrations[i];
+      const TfLiteIntArray* inputs = consumer->node.inputs;
+      bool reads = false;
+      for (int n = 0; n < inputs->size; ++n) {
+        reads |= inputs->data[n] == float_index;
+      }
+      if (!reads) {
+        continue;
+      }
+      TfLiteIntArray* inputs_copy;
+      TF_LITE_ENSURE_STATUS(
+          CopyIntArray(allocator, error_reporter, inputs, &inputs_copy));
+      for (int n = 0; n < inputs_copy->size; ++n) {
+        if (inputs_copy->data[n] == float_index) {
+          inputs_copy->data[n] = weights_index;
+        }
+      }
+      consumer->node.inputs = inputs_copy;
+    }
+    ElideNode(dequantize_node);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus RewriteGraph(SimpleMemoryAllocator* allocator,
+                          ErrorReporter* error_reporter,
+                          const SubGraph* subgraph,
+                          NodeAndRegistration* node_and_registrations,
+                          TfLiteEvalTensor* eval_tensors) {
+  TFLITE_DCHECK(subgraph != nullptr);
+  TFLITE_DCHECK(node_and_registrations != nullptr);
+  TFLITE_DCHECK(eval_tensors != nullptr);
+  TF_LITE_ENSURE_STATUS(FuseSpaceToBatchConvolutions(
+      allocator, error_reporter, subgraph, node_and_registrations,
+      eval_tensors));
+  TF_LITE_ENSURE_STATUS(FuseComparisonIntoSelect(
+      allocator, error_reporter, subgraph, node_and_registrations,
+      eval_tensors));
+  TF_LITE_ENSURE_STATUS(FuseSeparableConvolutions(
+      allocator, error_reporter, subgraph, node_and_registrations,
+      eval_tensors));
+  TF_LITE_ENSURE_STATUS(FoldInputQuantizeIntoConv(
+      allocator, error_reporter, subgraph, node_and_registrations,
+      eval_tensors));
+  TF_LITE_ENSURE_STATUS(FoldFloat16Dequantize(allocator, error_reporter,
+                                              subgraph, node_and_registrations,
+                                              eval_tensors));
+  return kTfLiteOk;
+}
+
+}  // namespace internal
+}  // namespace tflite
@@ -0,0 +1,99 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_GRAPH_REWRITER_H_
+#define TENSORFLOW_LITE_MICRO_GRAPH_REWRITER_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/simple_memory_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace internal {
+
+// Graph rewrites applied to the node list of a model between parsing the
+// flatbuffer and preparing the kernels. Rewrites never touch the flatbuffer
+// itself: they only retarget node inputs/outputs (new arrays are allocated
+// from the arena tail), update builtin data and replace nodes by a no-op
+// registration that the interpreter skips. Tensors left without a producer or
+// consumer are not planned by the MicroAllocator.
+//
+// Every rewrite is optional - a pattern that does not match exactly is left
+// untouched. Only allocation failures are reported as errors.
+TfLiteStatus RewriteGraph(SimpleMemoryAllocator* allocator,
+                          ErrorReporter* error_reporter,
+                          const SubGraph* subgraph,
+                          NodeAndRegistration* node_and_registrations,
+                          TfLiteEvalTensor* eval_tensors);
+
+// Folds SPACE_TO_BATCH_ND -> CONV_2D/DEPTHWISE_CONV_2D -> BATCH_TO_SPACE_ND,
+// the pattern the converter emits for dilated convolutions, back into a
+// single dilated convolution. The surrounding reshuffles become no-ops and
+// their intermediate tensors are never allocated.
+TfLiteStatus FuseSpaceToBatchConvolutions(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors);
+
+// Folds a comparison (EQUAL, NOT_EQUAL, GREATER, ...) whose only consumer is
+// the condition input of a SELECT/SELECT_V2 into that node, so the mask is
+// computed on the fly instead of being written to a bool tensor first. Only
+// applies when all operands have the select type, one of the float32, int8,
+// uint8 and int32 types the comparison kernels support, and either the output
+// shape or a single element.
+TfLiteStatus FuseComparisonIntoSelect(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors);
+
+// Folds a QUANTIZE of uint8 input, typically camera pixels, to int8 with the
+// same scale and a zero point lowered by 128 into the CONV_2D that is its only
+// consumer, when that convolution has a shallow input, see
+// micro/kernels/conv.h. The convolution reads the uint8 tensor directly and
+// the int8 copy is never allocated.
+TfLiteStatus FoldInputQuantizeIntoConv(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors);
+
+// Fuses an int8 DEPTHWISE_CONV_2D and the 1x1 CONV_2D that is the only
+// consumer of its output into one node that keeps the depthwise output in a
+// one-row tile, see micro/kernels/separable_conv.h. The depthwise output
+// tensor is never allocated, which lowers the arena peak of MobileNet style
+// models.
+TfLiteStatus FuseSeparableConvolutions(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors);
+
+// Folds a DEQUANTIZE of a constant float16 tensor, which the float16
+// post-training quantization of the converter puts in front of every weight,
+// into its consumers when all of them are float CONV_2D, DEPTHWISE_CONV_2D or
+// FULLY_CONNECTED nodes reading it as filter or bias. These kernels convert
+// float16 weights while they run, see micro/kernels/float16_weights.h, so the
+// float32 copy is never allocated.
+TfLiteStatus FoldFloat16Dequantize(
+    SimpleMemoryAllocator* allocator, ErrorReporter* error_reporter,
+    const SubGraph* subgraph, NodeAndRegistration* node_and_registrations,
+    TfLiteEvalTensor* eval_tensors);
+
+// Returns true if the node has been removed by a graph rewrite.
+bool IsElidedNode(const NodeAndRegistration& node_and_registration);
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_GRAPH_REWRITER_H_
@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernel_tuner.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_variants.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+
+KernelTuner::KernelTuner(KernelTuningDecision* decisions, int max_decisions,
+                         int num_runs)
+    : decisions_(decisions),
+      max_decisions_(max_decisions),
+      num_runs_(num_runs < 1 ? 1 : num_runs) {
+  type = kTfLiteMicroKernelTunerContext;
+  Refresh = nullptr;
+}
+
+void KernelTuner::UseDecisions(int num_decisions) {
+  num_loaded_ = num_decisions < max_decisions_ ? num_decisions : max_decisions_;
+}
+
+int KernelTuner::LoadedDecision(int32_t builtin_code) const {
+  if (num_registered_ < num_loaded_ &&
+      decisions_[num_registered_].builtin_code == builtin_code) {
+    return decisions_[num_registered_].variant;
+  }
+  return -1;
+}
+
+void KernelTuner::Register(micro::KernelVariantSelection* selection) {
+  ++num_registered_;
+  if (last_ == nullptr) {
+    first_ = selection;
+  } else {
+    last_->next = selection;
+  }
+  last_ = selection;
+}
+
+void KernelTuner::Reset() {
+  first_ = nullptr;
+  last_ = nullptr;
+  num_registered_ = 0;
+}
+
+int32_t KernelTuner::TimeVariant(TfLiteContext* context,
+                                 const micro::KernelVariantSelection& selection,
+                                 int variant, TfLiteStatus* status) {
+  const micro::KernelVariant& kernel = selection.variants[variant];
+  // The first run warms up caches and is not timed.
+  *status = kernel.eval(context, selection.node);
+  const int32_t start = GetCurrentTimeTicks();
+  for (int run = 0; run < num_runs_ && *status == kTfLiteOk; ++run) {
+    *status = kernel.eval(context, selection.node);
+  }
+  // Unsigned so that a wrapping tick counter still gives the duration.
+  return static_cast<int32_t>(static_cast<uint32_t>(GetCurrentTimeTicks()) -
+                              static_cast<uint32_t>(start));
+}
+
+TfLiteStatus KernelTuner::Tune(TfLiteContext* context,
+                               TunedNodeBinder* binder) {
+  const bool has_timer = ticks_per_second() != 0;
+  int index = 0;
+  TfLiteStatus status = kTfLiteOk;
+  for (micro::KernelVariantSelection* selection = first_;
+       selection != nullptr && status == kTfLiteOk;
+       selection = selection->next, ++index) {
+    const bool has_decision = index < num_loaded_;
+    const KernelTuningDecision decision =
+        has_decision ? decisions_[index] : KernelTuningDecision{-1, -1};
+    if (decision.builtin_code == selection->builtin_code &&
+        decision.variant >= 0 &&
+        decision.variant < selection->num_variants &&
+        (selection->candidates & (1u << decision.variant)) != 0) {
+      selection->selected = decision.variant;
+    } else if (has_timer &&
+               (selection->candidates & (selection->candidates - 1)) != 0) {
+      if (binder != nullptr) {
+        binder->Bind(context, selection->node);
+      }
+      int32_t best_ticks = INT32_MAX;
+      for (int i = 0; i < selection->num_variants && status == kTfLiteOk;
+           ++i) {
+        if ((selection->candidates & (1u << i)) == 0) {
+          continue;
+        }
+        const int32_t ticks = TimeVariant(context, *selection, i, &status);
+        if (ticks < best_ticks) {
+          best_ticks = ticks;
+          selection->selected = i;
+        }
+      }
+      if (binder != nullptr) {
+        binder->Unbind(selection->node);
+      }
+    }
+    if (index < max_decisions_) {
+      decisions_[index].builtin_code = selection->builtin_code;
+      decisions_[index].variant = selection->selected;
+    }
+  }
+  num_decisions_ = index < max_decisions_ ? index : max_decisions_;
+  Reset();
+  return status;
+}
+
+}  // namespace tflite
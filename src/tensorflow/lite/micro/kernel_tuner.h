@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNEL_TUNER_H_
+#define TENSORFLOW_LITE_MICRO_KERNEL_TUNER_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_variants.h"
+
+namespace tflite {
+
+// The variant picked for one node, in the order the nodes were prepared.
+struct KernelTuningDecision {
+  int32_t builtin_code;
+  int32_t variant;
+};
+
+// Gives a node the tensors it runs on in Invoke() while it is timed, for nodes
+// that Invoke() runs on temporary views, see micro/patch_execution.h.
+class TunedNodeBinder {
+ public:
+  virtual ~TunedNodeBinder() {}
+  virtual void Bind(TfLiteContext* context, TfLiteNode* node) = 0;
+  // Restores what Bind() changed.
+  virtual void Unbind(TfLiteNode* node) = 0;
+};
+
+// Picks the fastest kernel variant of every node that has several, see
+// micro/kernels/kernel_variants.h. Installed with
+// MicroInterpreter::SetExternalContext(kTfLiteMicroKernelTunerContext, tuner)
+// before AllocateTensors(); at the end of AllocateTensors() every applicable
+// variant of every registered node is run `num_runs` times on the node's own
+// tensors, with whatever data the arena holds, and timed with
+// GetCurrentTimeTicks(). Without a timer (ticks_per_second() is 0) the
+// preferred variants are kept.
+//
+// The decisions are written to the array given to the constructor and can be
+// stored, for example in flash, and loaded into that array on the next boot
+// followed by UseDecisions(). Nodes whose loaded decision still matches the
+// model are then not timed:
+//
+//   KernelTuningDecision decisions[kMaxTunedNodes];
+//   KernelTuner tuner(decisions, kMaxTunedNodes);
+//   if (LoadFromFlash(decisions, &num_decisions)) {
+//     tuner.UseDecisions(num_decisions);
+//   }
+//   interpreter.SetExternalContext(kTfLiteMicroKernelTunerContext, &tuner);
+//   interpreter.AllocateTensors();
+//   StoreToFlash(decisions, tuner.num_decisions());
+//
+// Timing needs every applicable variant prepared, so the buffers of the
+// variants that lose, for example the transformed filter of the Winograd
+// convolution, stay in the arena of the interpreter that tuned. Nodes with a
+// loaded decision only prepare the selected variant; to get that memory back
+// once tuned, create the interpreter again on the same arena after
+// UseDecisions(tuner.num_decisions()).
+//
+// A tuner serves one interpreter at a time.
+class KernelTuner : public TfLiteExternalContext {
+ public:
+  KernelTuner(KernelTuningDecision* decisions, int max_decisions,
+              int num_runs = 3);
+
+  // Uses the first `num_decisions` entries of the decision array, from an
+  // earlier tuning of the same model, instead of timing those nodes.
+  void UseDecisions(int num_decisions);
+
+  // Number of decisions recorded by the last tuning.
+  int num_decisions() const { return num_decisions_; }
+
+  // Variant that the loaded decisions select for the next node to register
+  // if it is a `builtin_code` node, or -1. Called from
+  // PrepareKernelVariants(), which then prepares only that variant.
+  int LoadedDecision(int32_t builtin_code) const;
+
+  // Called from PrepareKernelVariants().
+  void Register(micro::KernelVariantSelection* selection);
+
+  // Drops the registered nodes. Called by the MicroInterpreter when it
+  // starts allocating a model.
+  void Reset();
+
+  // Selects the variant of every registered node. Called by the
+  // MicroInterpreter once the tensors are allocated, with a `binder` if some
+  // nodes only run on views of their tensors.
+  TfLiteStatus Tune(TfLiteContext* context, TunedNodeBinder* binder = nullptr);
+
+ private:
+  int32_t TimeVariant(TfLiteContext* context,
+                      const micro::KernelVariantSelection& selection,
+                      int variant, TfLiteStatus* status);
+
+  KernelTuningDecision* decisions_;
+  int max_decisions_;
+  int num_runs_;
+  int num_loaded_ = 0;
+  int num_decisions_ = 0;
+  int num_registered_ = 0;
+  micro::KernelVariantSelection* first_ = nullptr;
+  micro::KernelVariantSelection* last_ = nullptr;
+};
+
+// Returns the tuner installed on `context`, or nullptr if there is none.
+inline KernelTuner* GetKernelTuner(TfLiteContext* context) {
+  if (context->GetExternalContext == nullptr) {
+    return nullptr;
+  }
+  return static_cast<KernelTuner*>(
+      context->GetExternalContext(context, kTfLiteMicroKernelTunerContext));
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNEL_TUNER_H_
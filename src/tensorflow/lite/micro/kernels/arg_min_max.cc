@@ -31,17 +31,92 @@ constexpr int kInputTensor = 0;
 constexpr int kAxis = 1;
 constexpr int kOutputTensor = 0;
 
+// Number of independent running extremes kept by ArgMinMaxRow.
+constexpr int kAccumulators = 4;
+
+// Index of the extreme value of one contiguous row. The extreme is found with
+// independent accumulators first, which keeps the hot loop free of the
+// index bookkeeping, and its first occurrence is then located in a second and
+// usually short pass. Ties resolve to the lowest index as in the reference
+// kernel; all accumulators start from element 0 so that a NaN anywhere but at
+// index 0 is skipped and a NaN at index 0 yields 0, also matching it.
+template <typename T, typename Cmp>
+int ArgMinMaxRow(const T* data, int size, const Cmp& cmp) {
+  T extremes[kAccumulators];
+  for (int l = 0; l < kAccumulators; ++l) {
+    extremes[l] = data[0];
+  }
+  int i = 0;
+  for (; i <= size - kAccumulators; i += kAccumulators) {
+    for (int l = 0; l < kAccumulators; ++l) {
+      if (cmp(data[i + l], extremes[l])) {
+        extremes[l] = data[i + l];
+      }
+    }
+  }
+  for (; i < size; ++i) {
+    if (cmp(data[i], extremes[0])) {
+      extremes[0] = data[i];
+    }
+  }
+  T extreme = extremes[0];
+  for (int l = 1; l < kAccumulators; ++l) {
+    if (cmp(extremes[l], extreme)) {
+      extreme = extremes[l];
+    }
+  }
+  for (i = 0; i < size; ++i) {
+    if (data[i] == extreme) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+template <typename T1, typename T2, typename Cmp>
+inline void ArgMinMaxLastAxis(const RuntimeShape& input1_shape,
+                              const T1* input1_data, T2* output_data,
+                              const Cmp& cmp) {
+  const int dims_count = input1_shape.DimensionsCount();
+  const int axis_size = input1_shape.Dims(dims_count - 1);
+  const int outer_size = FlatSizeSkipDim(input1_shape, dims_count - 1);
+  for (int outer = 0; outer < outer_size; ++outer) {
+    output_data[outer] = static_cast<T2>(
+        ArgMinMaxRow(input1_data + outer * axis_size, axis_size, cmp));
+  }
+}
+
+template <typename T1, typename T2, typename T3, typename Cmp>
+inline void ArgMinMaxDispatch(const RuntimeShape& input1_shape,
+                              const T1* input1_data, const T3* input2_data,
+                              const RuntimeShape& output_shape,
+                              T2* output_data, const Cmp& cmp) {
+  const int dims_count = input1_shape.DimensionsCount();
+  int axis = input2_data[0];
+  if (axis < 0) {
+    axis += dims_count;
+  }
+  // Class scores are almost always reduced over the innermost axis, where
+  // each output reads one contiguous row.
+  if (axis == dims_count - 1 && input1_shape.Dims(axis) > 0) {
+    ArgMinMaxLastAxis(input1_shape, input1_data, output_data, cmp);
+  } else {
+    reference_ops::ArgMinMax(input1_shape, input1_data, input2_data,
+                             output_shape, output_data, cmp);
+  }
+}
+
 template <typename T1, typename T2, typename T3>
 inline void ArgMinMaxHelper(const RuntimeShape& input1_shape,
                             const T1* input1_data, const T3* input2_data,
                             const RuntimeShape& output_shape, T2* output_data,
                             bool is_arg_max) {
   if (is_arg_max) {
-    reference_ops::ArgMinMax(input1_shape, input1_data, input2_data,
-                             output_shape, output_data, micro::Greater());
+    ArgMinMaxDispatch(input1_shape, input1_data, input2_data, output_shape,
+                      output_data, micro::Greater());
   } else {
-    reference_ops::ArgMinMax(input1_shape, input1_data, input2_data,
-                             output_shape, output_data, micro::Less());
+    ArgMinMaxDispatch(input1_shape, input1_data, input2_data, output_shape,
+                      output_data, micro::Less());
   }
 }
 
@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/kernels/internal/reference/comparisons.h"
 
+#include <cstring>
+
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/select.h"
+#include "tensorflow/lite/micro/micro_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -28,495 +32,176 @@ namespace {
 
 struct OpData {
   ComparisonParams params;
+  // True when the raw input values order exactly like the real values they
+  // represent: always for unquantized types, and for quantized inputs that
+  // share scale and zero point. Rescaling is then skipped entirely.
+  bool compare_raw;
 };
 
 constexpr int kInputTensor1 = 0;
 constexpr int kInputTensor2 = 1;
 constexpr int kOutputTensor = 0;
 
-TfLiteStatus EqualEval(TfLiteContext* context, TfLiteNode* node) {
-  TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData* data = static_cast<const OpData*>(node->user_data);
+// Number of results produced per iteration of the contiguous loops. Storing
+// the lanes with one memcpy lets the compiler emit a single word store.
+constexpr int kLanes = 4;
 
-  const TfLiteEvalTensor* input1 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor1);
-  const TfLiteEvalTensor* input2 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor2);
-  TfLiteEvalTensor* output =
-      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+struct EqualOp {
+  static constexpr bool kSupportsBool = true;
+  template <typename T>
+  static bool Compare(T lhs, T rhs) {
+    return reference_ops::EqualFn(lhs, rhs);
+  }
+};
 
-  RuntimeShape input1_shape = tflite::micro::GetTensorShape(input1);
-  RuntimeShape input2_shape = tflite::micro::GetTensorShape(input2);
-  RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
-  bool* output_data = tflite::micro::GetTensorData<bool>(output);
+struct NotEqualOp {
+  static constexpr bool kSupportsBool = true;
+  template <typename T>
+  static bool Compare(T lhs, T rhs) {
+    return reference_ops::NotEqualFn(lhs, rhs);
+  }
+};
 
-  bool requires_broadcast = !tflite::micro::HaveSameShapes(input1, input2);
-  switch (input1->type) {
-    case kTfLiteBool:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<bool>(input1), input2_shape,
-                tflite::micro::GetTensorData<bool>(input2), output_shape,
-                output_data)
-          : reference_ops::EqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<bool>(input1), input2_shape,
-                tflite::micro::GetTensorData<bool>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteFloat32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data)
-          : reference_ops::EqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data)
-          : reference_ops::EqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt64:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data)
-          : reference_ops::EqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteUInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::EqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::EqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data);
-      break;
-    default:
-      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
-                         TfLiteTypeGetName(input1->type), input1->type);
-      return kTfLiteError;
+struct GreaterOp {
+  static constexpr bool kSupportsBool = false;
+  template <typename T>
+  static bool Compare(T lhs, T rhs) {
+    return reference_ops::GreaterFn(lhs, rhs);
   }
-  return kTfLiteOk;
-}
+};
 
-// TODO(renjieliu): Refactor the logic to avoid duplications.
-TfLiteStatus NotEqualEval(TfLiteContext* context, TfLiteNode* node) {
-  TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData* data = static_cast<const OpData*>(node->user_data);
+struct GreaterEqualOp {
+  static constexpr bool kSupportsBool = false;
+  template <typename T>
+  static bool Compare(T lhs, T rhs) {
+    return reference_ops::GreaterEqualFn(lhs, rhs);
+  }
+};
 
-  const TfLiteEvalTensor* input1 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor1);
-  const TfLiteEvalTensor* input2 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor2);
-  TfLiteEvalTensor* output =
-      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+struct LessOp {
+  static constexpr bool kSupportsBool = false;
+  template <typename T>
+  static bool Compare(T lhs, T rhs) {
+    return reference_ops::LessFn(lhs, rhs);
+  }
+};
 
-  RuntimeShape input1_shape = tflite::micro::GetTensorShape(input1);
-  RuntimeShape input2_shape = tflite::micro::GetTensorShape(input2);
-  RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
-  bool* output_data = tflite::micro::GetTensorData<bool>(output);
+struct LessEqualOp {
+  static constexpr bool kSupportsBool = false;
+  template <typename T>
+  static bool Compare(T lhs, T rhs) {
+    return reference_ops::LessEqualFn(lhs, rhs);
+  }
+};
 
-  bool requires_broadcast = !tflite::micro::HaveSameShapes(input1, input2);
-  switch (input1->type) {
-    case kTfLiteBool:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowNotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<bool>(input1), input2_shape,
-                tflite::micro::GetTensorData<bool>(input2), output_shape,
-                output_data)
-          : reference_ops::NotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<bool>(input1), input2_shape,
-                tflite::micro::GetTensorData<bool>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteFloat32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowNotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data)
-          : reference_ops::NotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowNotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data)
-          : reference_ops::NotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt64:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowNotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data)
-          : reference_ops::NotEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteUInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowNotEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::NotEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowNotEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::NotEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data);
-      break;
-    default:
-      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
-                         TfLiteTypeGetName(input1->type), input1->type);
-      return kTfLiteError;
+// Elementwise comparison of two contiguous arrays. Either input may be a
+// single value that is broadcast against the other one (stride 0).
+template <typename Op, typename T>
+void CompareContiguous(const T* input1_data, int input1_stride,
+                       const T* input2_data, int input2_stride,
+                       bool* output_data, int size) {
+  int i = 0;
+  for (; i <= size - kLanes; i += kLanes) {
+    bool lanes[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+      lanes[l] = Op::Compare(input1_data[(i + l) * input1_stride],
+                             input2_data[(i + l) * input2_stride]);
+    }
+    std::memcpy(output_data + i, lanes, sizeof(lanes));
+  }
+  for (; i < size; ++i) {
+    output_data[i] = Op::Compare(input1_data[i * input1_stride],
+                                 input2_data[i * input2_stride]);
   }
-  return kTfLiteOk;
 }
 
-TfLiteStatus GreaterEval(TfLiteContext* context, TfLiteNode* node) {
-  TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData* data = static_cast<const OpData*>(node->user_data);
-
-  const TfLiteEvalTensor* input1 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor1);
-  const TfLiteEvalTensor* input2 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor2);
-  TfLiteEvalTensor* output =
-      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
-
-  RuntimeShape input1_shape = tflite::micro::GetTensorShape(input1);
-  RuntimeShape input2_shape = tflite::micro::GetTensorShape(input2);
-  RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
-  bool* output_data = tflite::micro::GetTensorData<bool>(output);
+inline int32_t ScaleForComparison(int32_t value, int32_t offset,
+                                  int32_t multiplier, int shift,
+                                  int left_shift) {
+  const int32_t shifted_value = (offset + value) * (1 << left_shift);
+  return MultiplyByQuantizedMultiplierSmallerThanOneExp(shifted_value,
+                                                        multiplier, shift);
+}
 
-  bool requires_broadcast = !tflite::micro::HaveSameShapes(input1, input2);
-  switch (input1->type) {
-    case kTfLiteFloat32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt64:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteUInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data);
-      break;
-    default:
-      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
-                         TfLiteTypeGetName(input1->type), input1->type);
-      return kTfLiteError;
+// Quantized comparison where one side is a single value: that value is
+// rescaled once instead of once per element.
+template <typename Op, typename T>
+void CompareWithScaledScalar(const ComparisonParams& params,
+                             const T* input1_data, int input1_stride,
+                             const T* input2_data, int input2_stride,
+                             bool* output_data, int size) {
+  const int32_t scalar1 =
+      ScaleForComparison(input1_data[0], params.input1_offset,
+                         params.input1_multiplier, params.input1_shift,
+                         params.left_shift);
+  const int32_t scalar2 =
+      ScaleForComparison(input2_data[0], params.input2_offset,
+                         params.input2_multiplier, params.input2_shift,
+                         params.left_shift);
+  for (int i = 0; i < size; ++i) {
+    const int32_t value1 =
+        input1_stride == 0
+            ? scalar1
+            : ScaleForComparison(input1_data[i], params.input1_offset,
+                                 params.input1_multiplier, params.input1_shift,
+                                 params.left_shift);
+    const int32_t value2 =
+        input2_stride == 0
+            ? scalar2
+            : ScaleForComparison(input2_data[i], params.input2_offset,
+                                 params.input2_multiplier, params.input2_shift,
+                                 params.left_shift);
+    output_data[i] = Op::Compare(value1, value2);
   }
-  return kTfLiteOk;
 }
 
-TfLiteStatus GreaterEqualEval(TfLiteContext* context, TfLiteNode* node) {
-  TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData* data = static_cast<const OpData*>(node->user_data);
-
-  const TfLiteEvalTensor* input1 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor1);
-  const TfLiteEvalTensor* input2 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor2);
-  TfLiteEvalTensor* output =
-      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
-
-  RuntimeShape input1_shape = tflite::micro::GetTensorShape(input1);
-  RuntimeShape input2_shape = tflite::micro::GetTensorShape(input2);
-  RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+template <typename Op, typename T>
+void EvalComparison(const OpData& data, const TfLiteEvalTensor* input1,
+                    const TfLiteEvalTensor* input2, TfLiteEvalTensor* output) {
+  const T* input1_data = tflite::micro::GetTensorData<T>(input1);
+  const T* input2_data = tflite::micro::GetTensorData<T>(input2);
   bool* output_data = tflite::micro::GetTensorData<bool>(output);
 
-  bool requires_broadcast = !tflite::micro::HaveSameShapes(input1, input2);
-  switch (input1->type) {
-    case kTfLiteFloat32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt64:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteUInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowGreaterEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::GreaterEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data);
-      break;
-    default:
-      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
-                         TfLiteTypeGetName(input1->type), input1->type);
-      return kTfLiteError;
+  const int output_size = ElementCount(*output->dims);
+  const bool same_shapes = tflite::micro::HaveSameShapes(input1, input2);
+  const bool input1_is_scalar = ElementCount(*input1->dims) == 1;
+  const bool input2_is_scalar = ElementCount(*input2->dims) == 1;
+
+  if (same_shapes || input1_is_scalar || input2_is_scalar) {
+    const int input1_stride = (input1_is_scalar && !same_shapes) ? 0 : 1;
+    const int input2_stride = (input2_is_scalar && !same_shapes) ? 0 : 1;
+    if (data.compare_raw) {
+      CompareContiguous<Op>(input1_data, input1_stride, input2_data,
+                            input2_stride, output_data, output_size);
+    } else if (same_shapes) {
+      reference_ops::ComparisonWithScaling<T, Op::template Compare<int32_t>>(
+          data.params, tflite::micro::GetTensorShape(input1), input1_data,
+          tflite::micro::GetTensorShape(input2), input2_data,
+          tflite::micro::GetTensorShape(output), output_data);
+    } else {
+      CompareWithScaledScalar<Op>(data.params, input1_data, input1_stride,
+                                  input2_data, input2_stride, output_data,
+                                  output_size);
+    }
+    return;
   }
-  return kTfLiteOk;
-}
 
-TfLiteStatus LessEval(TfLiteContext* context, TfLiteNode* node) {
-  TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData* data = static_cast<const OpData*>(node->user_data);
-
-  const TfLiteEvalTensor* input1 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor1);
-  const TfLiteEvalTensor* input2 =
-      tflite::micro::GetEvalInput(context, node, kInputTensor2);
-  TfLiteEvalTensor* output =
-      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
-
-  RuntimeShape input1_shape = tflite::micro::GetTensorShape(input1);
-  RuntimeShape input2_shape = tflite::micro::GetTensorShape(input2);
-  RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
-  bool* output_data = tflite::micro::GetTensorData<bool>(output);
-
-  bool requires_broadcast = !tflite::micro::HaveSameShapes(input1, input2);
-  switch (input1->type) {
-    case kTfLiteFloat32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data)
-          : reference_ops::LessNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt64:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteUInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data);
-      break;
-    case kTfLiteInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data);
-      break;
-    default:
-      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
-                         TfLiteTypeGetName(input1->type), input1->type);
-      return kTfLiteError;
+  if (data.compare_raw) {
+    reference_ops::BroadcastComparison4DSlowImpl<T, Op::template Compare<T>>(
+        data.params, tflite::micro::GetTensorShape(input1), input1_data,
+        tflite::micro::GetTensorShape(input2), input2_data,
+        tflite::micro::GetTensorShape(output), output_data);
+  } else {
+    reference_ops::BroadcastComparison4DSlowWithScaling<
+        T, Op::template Compare<int32_t>>(
+        data.params, tflite::micro::GetTensorShape(input1), input1_data,
+        tflite::micro::GetTensorShape(input2), input2_data,
+        tflite::micro::GetTensorShape(output), output_data);
   }
-  return kTfLiteOk;
 }
 
-TfLiteStatus LessEqualEval(TfLiteContext* context, TfLiteNode* node) {
+template <typename Op>
+TfLiteStatus ComparisonEval(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK(node->user_data != nullptr);
   const OpData* data = static_cast<const OpData*>(node->user_data);
 
@@ -527,84 +212,34 @@ TfLiteStatus LessEqualEval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteEvalTensor* output =
       tflite::micro::GetEvalOutput(context, node, kOutputTensor);
 
-  RuntimeShape input1_shape = tflite::micro::GetTensorShape(input1);
-  RuntimeShape input2_shape = tflite::micro::GetTensorShape(input2);
-  RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
-  bool* output_data = tflite::micro::GetTensorData<bool>(output);
-
-  bool requires_broadcast = !tflite::micro::HaveSameShapes(input1, input2);
   switch (input1->type) {
+    case kTfLiteBool:
+      if (!Op::kSupportsBool) {
+        break;
+      }
+      EvalComparison<Op, bool>(*data, input1, input2, output);
+      return kTfLiteOk;
     case kTfLiteFloat32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data)
-          : reference_ops::LessEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<float>(input1), input2_shape,
-                tflite::micro::GetTensorData<float>(input2), output_shape,
-                output_data);
-      break;
+      EvalComparison<Op, float>(*data, input1, input2, output);
+      return kTfLiteOk;
     case kTfLiteInt32:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int32_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int32_t>(input2), output_shape,
-                output_data);
-      break;
+      EvalComparison<Op, int32_t>(*data, input1, input2, output);
+      return kTfLiteOk;
     case kTfLiteInt64:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessEqualNoScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int64_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int64_t>(input2), output_shape,
-                output_data);
-      break;
+      EvalComparison<Op, int64_t>(*data, input1, input2, output);
+      return kTfLiteOk;
     case kTfLiteUInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<uint8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<uint8_t>(input2), output_shape,
-                output_data);
-      break;
+      EvalComparison<Op, uint8_t>(*data, input1, input2, output);
+      return kTfLiteOk;
     case kTfLiteInt8:
-      requires_broadcast
-          ? reference_ops::Broadcast4DSlowLessEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data)
-          : reference_ops::LessEqualWithScaling(
-                data->params, input1_shape,
-                tflite::micro::GetTensorData<int8_t>(input1), input2_shape,
-                tflite::micro::GetTensorData<int8_t>(input2), output_shape,
-                output_data);
-      break;
+      EvalComparison<Op, int8_t>(*data, input1, input2, output);
+      return kTfLiteOk;
     default:
-      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
-                         TfLiteTypeGetName(input1->type), input1->type);
-      return kTfLiteError;
+      break;
   }
-  return kTfLiteOk;
+  TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                     TfLiteTypeGetName(input1->type), input1->type);
+  return kTfLiteError;
 }
 
 }  // namespace
@@ -623,10 +258,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input2 = GetInput(context, node, kInputTensor2);
   TF_LITE_ENSURE(context, input2 != nullptr);
 
+  data->compare_raw = true;
   if (input1->type == kTfLiteUInt8 || input1->type == kTfLiteInt8) {
     auto input1_offset = -input1->params.zero_point;
     auto input2_offset = -input2->params.zero_point;
-    const int kLeftShift = 8;
+    const int kLeftShift = kComparisonLeftShift;
 
     int32_t input1_multiplier;
     int input1_shift;
@@ -646,6 +282,15 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     data->params.input2_offset = input2_offset;
     data->params.input2_multiplier = input2_multiplier;
     data->params.input2_shift = input2_shift;
+
+    // With identical quantization the rescaled values are a strictly
+    // increasing function of the raw values as long as one quantization step
+    // stays at least one unit after the left shift, so comparing the raw
+    // values gives the same result.
+    data->compare_raw =
+        input1->params.scale == input2->params.scale &&
+        input1->params.zero_point == input2->params.zero_point &&
+        ComparesQuantizedRaw(input1->params.scale);
   }
 
   return kTfLiteOk;
@@ -657,7 +302,7 @@ TfLiteRegistration Register_EQUAL() {
   return {/*init=*/comparisons::Init,
           /*free=*/nullptr,
           /*prepare=*/comparisons::Prepare,
-          /*invoke=*/comparisons::EqualEval,
+          /*invoke=*/comparisons::ComparisonEval<comparisons::EqualOp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -668,7 +313,7 @@ TfLiteRegistration Register_NOT_EQUAL() {
   return {/*init=*/comparisons::Init,
           /*free=*/nullptr,
           /*prepare=*/comparisons::Prepare,
-          /*invoke=*/comparisons::NotEqualEval,
+          /*invoke=*/comparisons::ComparisonEval<comparisons::NotEqualOp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -679,7 +324,7 @@ TfLiteRegistration Register_GREATER() {
   return {/*init=*/comparisons::Init,
           /*free=*/nullptr,
           /*prepare=*/comparisons::Prepare,
-          /*invoke=*/comparisons::GreaterEval,
+          /*invoke=*/comparisons::ComparisonEval<comparisons::GreaterOp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -690,7 +335,7 @@ TfLiteRegistration Register_GREATER_EQUAL() {
   return {/*init=*/comparisons::Init,
           /*free=*/nullptr,
           /*prepare=*/comparisons::Prepare,
-          /*invoke=*/comparisons::GreaterEqualEval,
+          /*invoke=*/comparisons::ComparisonEval<comparisons::GreaterEqualOp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -701,7 +346,7 @@ TfLiteRegistration Register_LESS() {
   return {/*init=*/comparisons::Init,
           /*free=*/nullptr,
           /*prepare=*/comparisons::Prepare,
-          /*invoke=*/comparisons::LessEval,
+          /*invoke=*/comparisons::ComparisonEval<comparisons::LessOp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -712,7 +357,7 @@ TfLiteRegistration Register_LESS_EQUAL() {
   return {/*init=*/comparisons::Init,
           /*free=*/nullptr,
           /*prepare=*/comparisons::Prepare,
-          /*invoke=*/comparisons::LessEqualEval,
+          /*invoke=*/comparisons::ComparisonEval<comparisons::LessEqualOp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -0,0 +1,49 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/compressed_tiles.h"
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/parallel_executor.h"
+
+namespace tflite {
+namespace micro {
+
+TfLiteStatus PrepareCompressedTiles(TfLiteContext* context,
+                                    const CompressedWeights& compressed,
+                                    int num_channels, int channel_size,
+                                    CompressedTileData* data) {
+  data->tile_buffer_index[0] = -1;
+  data->tile_buffer_index[1] = -1;
+  data->channel_size = channel_size;
+  data->num_channels = num_channels;
+  const int tile_size = compressed.tile_channels * channel_size;
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, tile_size, &data->tile_buffer_index[0]));
+
+  // Decoding only overlaps the computation on another worker.
+  const ParallelExecutor* executor = GetParallelExecutor(context);
+  if (executor == nullptr || executor->num_workers() < 2 ||
+      context->recommended_num_threads < 2 ||
+      CompressedTileCount(compressed.tile_channels, num_channels) < 2) {
+    return kTfLiteOk;
+  }
+  return context->RequestScratchBufferInArena(context, tile_size,
+                                              &data->tile_buffer_index[1]);
+}
+
+}  // namespace micro
+}  // namespace tflite
@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_COMPRESSED_TILES_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_COMPRESSED_TILES_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/parallel_executor.h"
+
+namespace tflite {
+namespace micro {
+
+// Decoding of a compressed filter, see micro/compressed_weights.h, one tile of
+// output channels at a time into scratch buffers of the node. A kernel
+// reserves the buffers in Prepare with PrepareCompressedTiles() and walks the
+// tiles in Eval with ForEachCompressedTile():
+//
+//   TF_LITE_ENSURE_STATUS(ForEachCompressedTile(
+//       context, *data->compressed_weights, data->compressed_tiles,
+//       macs_per_channel,
+//       [&](const int8_t* channels, int first_channel, int num_channels) {
+//         ... compute output channels [first_channel, +num_channels) ...
+//       }));
+//
+// The channels of a tile are split into chunks as in ParallelFor(). If the
+// node is prepared with a ParallelExecutor of several workers and more than
+// one thread, see MicroInterpreter::SetNumThreads(), a second buffer is
+// reserved and one task decodes the next tile into it while the others
+// compute the current one.
+struct CompressedTileData {
+  // Scratch buffers the tiles alternate between, the second one -1 when
+  // every tile is decoded before it is computed.
+  int tile_buffer_index[2];
+  // Weights of one output channel.
+  int channel_size;
+  int num_channels;
+};
+
+TfLiteStatus PrepareCompressedTiles(TfLiteContext* context,
+                                    const CompressedWeights& compressed,
+                                    int num_channels, int channel_size,
+                                    CompressedTileData* data);
+
+// Calls fn(channels, first_channel, num_channels) on chunks that together
+// cover all output channels, `channels` holding the decoded weights of
+// channels [first_channel, first_channel + num_channels). Chunks of one tile
+// may run at the same time and must write only the outputs of their channels.
+template <typename Fn>
+TfLiteStatus ForEachCompressedTile(TfLiteContext* context,
+                                   const CompressedWeights& compressed,
+                                   const CompressedTileData& data,
+                                   int64_t macs_per_channel, const Fn& fn) {
+  const int num_tiles =
+      CompressedTileCount(compressed.tile_channels, data.num_channels);
+  int8_t* buffers[2];
+  for (int i = 0; i < 2; ++i) {
+    buffers[i] = data.tile_buffer_index[i] >= 0
+                     ? static_cast<int8_t*>(context->GetScratchBuffer(
+                           context, data.tile_buffer_index[i]))
+                     : nullptr;
+  }
+  ParallelExecutor* executor = GetParallelExecutor(context);
+  if (buffers[1] == nullptr || executor == nullptr) {
+    for (int tile = 0; tile < num_tiles; ++tile) {
+      const int first_channel = tile * compressed.tile_channels;
+      const int tile_channels =
+          DecompressTile(compressed, tile, data.num_channels,
+                         data.channel_size, buffers[0]);
+      TF_LITE_ENSURE_STATUS(ParallelFor(
+          context, tile_channels, macs_per_channel, [&](int begin, int end) {
+            fn(buffers[0] + begin * data.channel_size, first_channel + begin,
+               end - begin);
+          }));
+    }
+    return kTfLiteOk;
+  }
+
+  // Task 0 decodes the next tile, the others compute the current one.
+  struct Step {
+    const Fn* fn;
+    const CompressedWeights* compressed;
+    const CompressedTileData* data;
+    const int8_t* tile;
+    int first_channel;
+    int tile_channels;
+    int num_chunks;
+    // Tile decoded by task 0 into `next_buffer`, or -1.
+    int next_tile;
+    int8_t* next_buffer;
+    int next_channels;
+  } step = {&fn, &compressed, &data, nullptr, 0, 0, 0, -1, nullptr, 0};
+  step.next_channels = DecompressTile(compressed, 0, data.num_channels,
+                                      data.channel_size, buffers[0]);
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    step.tile = buffers[tile % 2];
+    step.first_channel = tile * compressed.tile_channels;
+    step.tile_channels = step.next_channels;
+    // One worker is busy decoding.
+    const int num_chunks =
+        NumParallelChunks(context, step.tile_channels, macs_per_channel);
+    step.num_chunks = num_chunks > 1 ? num_chunks - 1 : 1;
+    step.next_tile = tile + 1 < num_tiles ? tile + 1 : -1;
+    step.next_buffer = buffers[(tile + 1) % 2];
+    const int decode_tasks = step.next_tile >= 0 ? 1 : 0;
+    TF_LITE_ENSURE_STATUS(executor->Run(
+        decode_tasks + step.num_chunks,
+        [](void* user_data, int index) {
+          Step& current = *static_cast<Step*>(user_data);
+          if (current.next_tile >= 0) {
+            if (index == 0) {
+              current.next_channels =
+                  DecompressTile(*current.compressed, current.next_tile,
+                                 current.data->num_channels,
+                                 current.data->channel_size,
+                                 current.next_buffer);
+              return;
+            }
+            --index;
+          }
+          int begin, end;
+          ParallelChunkBounds(current.tile_channels, current.num_chunks,
+                              /*grain=*/1, index, &begin, &end);
+          (*current.fn)(current.tile + begin * current.data->channel_size,
+                        current.first_channel + begin, end - begin);
+        },
+        &step));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_COMPRESSED_TILES_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 
+#include <limits>
+
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -23,7 +25,14 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/compressed_tiles.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/dilated_conv.h"
+#include "tensorflow/lite/micro/kernels/float16_weights.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_variants.h"
+#include "tensorflow/lite/micro/kernels/weight_prefetch.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
 namespace ops {
@@ -62,6 +71,27 @@ struct OpData {
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+
+  // Offline pre-packed int8 weights, or nullptr.
+  const PackedWeights* packed_weights;
+  // Compressed int8 filter, or nullptr, and the scratch buffers its tiles
+  // are decompressed into.
+  const CompressedWeights* compressed_weights;
+  tflite::micro::CompressedTileData compressed_tiles;
+  // Streaming of a plain int8 filter that lives in slow memory.
+  tflite::micro::WeightPrefetchData prefetch;
+  // Implementation of a plain int8 convolution, see kernel_variants.h.
+  tflite::micro::KernelVariantSelection variants;
+  // Bias with the input zero point folded in, for the variants that multiply
+  // raw input values, or nullptr.
+  int32_t* effective_bias;
+  // Winograd domain filter of the "winograd" variant, and the index of the
+  // scratch buffer holding one transformed input tile.
+  int16_t* winograd_filter;
+  int winograd_tile_index;
+  // Conversion of a float16 filter and bias of a float convolution.
+  tflite::micro::Float16WeightData float16_filter;
+  const float* float16_bias;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -106,6 +136,15 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
     TF_LITE_ENSURE(context, output != nullptr);
     int output_channels = filter->dims->data[kConvQuantizedDimension];
 
+    // A uint8 input with an int8 filter is requantized like an int8 input of
+    // the same scale, see conv.h.
+    TfLiteTensor int8_input;
+    if (input->type == kTfLiteUInt8 && filter->type == kTfLiteInt8) {
+      int8_input = *input;
+      int8_input.type = kTfLiteInt8;
+      input = &int8_input;
+    }
+
     TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
         context, input, filter, bias, output, params->activation,
         &data->output_multiplier, &data->output_shift,
@@ -117,6 +156,41 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus ValidatePackedWeights(TfLiteContext* context,
+                                   const TfLiteTensor* input,
+                                   const TfLiteTensor* filter,
+                                   const PackedWeights* packed) {
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, packed->layout, kPackedWeightsO4I16);
+  const auto* affine_quantization =
+      static_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  for (int i = 0; i < affine_quantization->zero_point->size; ++i) {
+    TF_LITE_ENSURE_EQ(context, affine_quantization->zero_point->data[i], 0);
+  }
+  const int output_depth = filter->dims->data[0];
+  const int num_taps = filter->dims->data[1] * filter->dims->data[2];
+  TF_LITE_ENSURE_EQ(
+      context, packed->filter_size,
+      PackedO4I16Size(output_depth, num_taps, filter->dims->data[3]));
+  TF_LITE_ENSURE_EQ(context, packed->effective_bias_size, output_depth);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PrepareCompressedWeights(TfLiteContext* context,
+                                      const TfLiteTensor* input,
+                                      const TfLiteTensor* filter,
+                                      OpData* data) {
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  const int channel_size =
+      filter->dims->data[1] * filter->dims->data[2] * filter->dims->data[3];
+  return tflite::micro::PrepareCompressedTiles(
+      context, *data->compressed_weights, filter->dims->data[0], channel_size,
+      &data->compressed_tiles);
+}
+
+TfLiteStatus PrepareInt8Variants(TfLiteContext* context, TfLiteNode* node,
+                                 OpData* data);
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   return context->AllocatePersistentBuffer(context, sizeof(OpData));
@@ -153,7 +227,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
           context, num_channels * sizeof(int32_t)));
 
   // All per-channel quantized tensors need valid zero point and scale arrays.
-  if (input->type == kTfLiteInt8) {
+  // An int8 filter also comes with uint8 input, see conv.h.
+  if (filter->type == kTfLiteInt8) {
     TF_LITE_ENSURE_EQ(context, filter->quantization.type,
                       kTfLiteAffineQuantization);
 
@@ -179,6 +254,51 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->filter_zero_point = filter->params.zero_point;
   data->output_zero_point = output->params.zero_point;
 
+  data->packed_weights = tflite::micro::GetPackedWeights(node);
+  if (data->packed_weights != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        ValidatePackedWeights(context, input, filter, data->packed_weights));
+  }
+  // Packed weights do not read the original filter, so a compressed filter
+  // only needs decoding without them.
+  data->compressed_weights = data->packed_weights == nullptr
+                                 ? tflite::micro::GetCompressedWeights(node)
+                                 : nullptr;
+  if (data->compressed_weights != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        PrepareCompressedWeights(context, input, filter, data));
+  }
+  data->prefetch.tile_buffer_index[0] = -1;
+  if (input->type == kTfLiteInt8 && data->packed_weights == nullptr &&
+      data->compressed_weights == nullptr) {
+    TF_LITE_ENSURE_STATUS(tflite::micro::PrepareWeightPrefetch(
+        context, filter, num_channels,
+        filter_height * filter_width * filter->dims->data[3],
+        &data->prefetch));
+  }
+  data->float16_filter.tile_buffer_index = -1;
+  data->float16_bias = nullptr;
+  if (input->type == kTfLiteFloat32) {
+    TF_LITE_ENSURE_STATUS(tflite::micro::PrepareFloat16Weights(
+        context, filter, num_channels,
+        filter_height * filter_width * filter->dims->data[3],
+        &data->float16_filter));
+    TF_LITE_ENSURE_STATUS(tflite::micro::PrepareFloat16Bias(
+        context, GetOptionalInputTensor(context, node, kBiasTensor),
+        &data->float16_bias));
+  }
+  data->effective_bias = nullptr;
+  data->winograd_filter = nullptr;
+  if (filter->type == kTfLiteInt8 && data->packed_weights == nullptr &&
+      data->compressed_weights == nullptr &&
+      !tflite::micro::IsWeightPrefetchEnabled(data->prefetch)) {
+    TF_LITE_ENSURE_STATUS(PrepareInt8Variants(context, node, data));
+  } else if (input->type == kTfLiteUInt8 && filter->type == kTfLiteInt8) {
+    TF_LITE_KERNEL_LOG(context,
+                       "uint8 input with an int8 filter needs a plain filter.");
+    return kTfLiteError;
+  }
+
   return kTfLiteOk;
 }  // namespace conv
 
@@ -252,6 +372,993 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
       tflite::micro::GetTensorData<int8_t>(output));
 }
 
+// Number of multiply-accumulates of one output channel, to partition the
+// output channels with ParallelFor().
+int64_t MacsPerOutputChannel(const TfLiteEvalTensor* filter,
+                             const TfLiteEvalTensor* output) {
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  return static_cast<int64_t>(output_shape.FlatSize() / output_shape.Dims(3)) *
+         filter->dims->data[1] * filter->dims->data[2] * filter->dims->data[3];
+}
+
+// Per-channel int8 convolution over kPackedWeightsO4I16 weights. Output
+// channels are produced four at a time, each input value loaded feeding all
+// four from one contiguous filter block. The input zero point is part of the
+// effective bias, so taps in the padding area read the zero point instead of
+// being skipped. Computes output channels [first_channel, end_channel),
+// first_channel being a multiple of kPackedOutputBlock.
+void PackedConvChannels(const TfLiteConvParams* params, const OpData& data,
+                        const TfLiteEvalTensor* input,
+                        const TfLiteEvalTensor* filter, int first_channel,
+                        int end_channel, TfLiteEvalTensor* output) {
+  const PackedWeights& packed = *data.packed_weights;
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int num_taps = filter_height * filter_width;
+  const int depth_blocks = PackedBlockCount(input_depth, kPackedDepthBlock);
+  const int block_size = kPackedOutputBlock * kPackedDepthBlock;
+  const int32_t input_zero_point = data.input_zero_point;
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params->stride_height - data.padding.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params->stride_width - data.padding.width;
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        for (int out_c = first_channel; out_c < end_channel;
+             out_c += kPackedOutputBlock) {
+          int32_t acc[kPackedOutputBlock] = {};
+          const int8_t* block = packed.filter + (out_c / kPackedOutputBlock) *
+                                                    num_taps * depth_blocks *
+                                                    block_size;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params->dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params->dilation_width_factor * filter_x;
+              const bool is_point_inside_image =
+                  (in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                  (in_y < input_height);
+              const int8_t* in =
+                  is_point_inside_image
+                      ? input_data + Offset(input_shape, batch, in_y, in_x, 0)
+                      : nullptr;
+              for (int d0 = 0; d0 < input_depth; d0 += kPackedDepthBlock) {
+                const int depth = std::min(kPackedDepthBlock, input_depth - d0);
+                for (int d = 0; d < depth; ++d) {
+                  const int32_t input_val =
+                      in != nullptr ? in[d0 + d] : input_zero_point;
+                  for (int i = 0; i < kPackedOutputBlock; ++i) {
+                    acc[i] += block[i * kPackedDepthBlock + d] * input_val;
+                  }
+                }
+                block += block_size;
+              }
+            }
+          }
+          const int block_outputs =
+              std::min(kPackedOutputBlock, end_channel - out_c);
+          for (int i = 0; i < block_outputs; ++i) {
+            const int channel = out_c + i;
+            int32_t value = acc[i] + packed.effective_bias[channel];
+            value = MultiplyByQuantizedMultiplier(
+                value, data.per_channel_output_multiplier[channel],
+                data.per_channel_output_shift[channel]);
+            value += data.output_zero_point;
+            value = std::max(value, data.output_activation_min);
+            value = std::min(value, data.output_activation_max);
+            out[channel] = static_cast<int8_t>(value);
+          }
+        }
+      }
+    }
+  }
+}
+
+TfLiteStatus EvalPackedPerChannel(TfLiteContext* context,
+                                  const TfLiteConvParams* params,
+                                  const OpData& data,
+                                  const TfLiteEvalTensor* input,
+                                  const TfLiteEvalTensor* filter,
+                                  TfLiteEvalTensor* output) {
+  return tflite::micro::ParallelFor(
+      context, filter->dims->data[0], MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        PackedConvChannels(params, data, input, filter, begin, end, output);
+      },
+      /*grain=*/kPackedOutputBlock);
+}
+
+// Computes output channels [first_channel, first_channel + tile_channels) of
+// a per-channel int8 convolution from the filter channels in `tile_data`,
+// matching reference_integer_ops::ConvPerChannel for the channels it covers.
+void ConvPerChannelTile(const TfLiteConvParams& params, const OpData& data,
+                        const TfLiteEvalTensor* input,
+                        const TfLiteEvalTensor* filter,
+                        const TfLiteEvalTensor* bias, const int8_t* tile_data,
+                        int first_channel, int tile_channels,
+                        TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int channel_size = filter_height * filter_width * input_depth;
+  const int32_t input_offset = -data.input_zero_point;
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int32_t* bias_data =
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr;
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params.stride_height - data.padding.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params.stride_width - data.padding.width;
+        int8_t* out = output_data +
+                      Offset(output_shape, batch, out_y, out_x, 0) +
+                      first_channel;
+        for (int c = 0; c < tile_channels; ++c) {
+          const int8_t* filter_data = tile_data + c * channel_size;
+          int32_t acc = 0;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params.dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params.dilation_width_factor * filter_x;
+              // Zero padding by omitting the areas outside the image.
+              if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                  in_y >= input_height) {
+                continue;
+              }
+              const int8_t* in =
+                  input_data + Offset(input_shape, batch, in_y, in_x, 0);
+              const int8_t* taps =
+                  filter_data +
+                  (filter_y * filter_width + filter_x) * input_depth;
+              for (int d = 0; d < input_depth; ++d) {
+                acc += taps[d] * (in[d] + input_offset);
+              }
+            }
+          }
+          const int channel = first_channel + c;
+          if (bias_data) {
+            acc += bias_data[channel];
+          }
+          acc = MultiplyByQuantizedMultiplier(
+              acc, data.per_channel_output_multiplier[channel],
+              data.per_channel_output_shift[channel]);
+          acc += data.output_zero_point;
+          acc = std::max(acc, data.output_activation_min);
+          acc = std::min(acc, data.output_activation_max);
+          out[c] = static_cast<int8_t>(acc);
+        }
+      }
+    }
+  }
+}
+
+// ConvPerChannelTile() over chunks of the channels of the tile when they run
+// in parallel.
+TfLiteStatus ParallelConvPerChannelTile(TfLiteContext* context,
+                                        const TfLiteConvParams& params,
+                                        const OpData& data,
+                                        const TfLiteEvalTensor* input,
+                                        const TfLiteEvalTensor* filter,
+                                        const TfLiteEvalTensor* bias,
+                                        const int8_t* tile_data,
+                                        int first_channel, int tile_channels,
+                                        TfLiteEvalTensor* output) {
+  const int channel_size =
+      filter->dims->data[1] * filter->dims->data[2] * filter->dims->data[3];
+  return tflite::micro::ParallelFor(
+      context, tile_channels, MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        ConvPerChannelTile(params, data, input, filter, bias,
+                           tile_data + begin * channel_size,
+                           first_channel + begin, end - begin, output);
+      });
+}
+
+// Per-channel int8 convolution over a compressed filter. Output channels are
+// produced one tile at a time, each decompressed into a scratch buffer and
+// swept over the whole input; with threads the next tile is decompressed
+// while the current one is computed.
+TfLiteStatus EvalCompressedPerChannel(TfLiteContext* context,
+                                      TfLiteConvParams* params,
+                                      const OpData& data,
+                                      const TfLiteEvalTensor* input,
+                                      const TfLiteEvalTensor* filter,
+                                      const TfLiteEvalTensor* bias,
+                                      TfLiteEvalTensor* output) {
+  return tflite::micro::ForEachCompressedTile(
+      context, *data.compressed_weights, data.compressed_tiles,
+      MacsPerOutputChannel(filter, output),
+      [&](const int8_t* channels, int first_channel, int num_channels) {
+        ConvPerChannelTile(*params, data, input, filter, bias, channels,
+                           first_channel, num_channels, output);
+      });
+}
+
+// Per-channel int8 convolution over a filter in slow memory. Each tile of
+// output channels is computed from fast memory while the copy engine fetches
+// the next one.
+TfLiteStatus EvalPrefetchedPerChannel(TfLiteContext* context,
+                                      TfLiteConvParams* params,
+                                      const OpData& data,
+                                      const TfLiteEvalTensor* input,
+                                      const TfLiteEvalTensor* filter,
+                                      const TfLiteEvalTensor* bias,
+                                      TfLiteEvalTensor* output) {
+  tflite::micro::WeightTileStream stream(
+      context, data.prefetch, tflite::micro::GetTensorData<int8_t>(filter));
+  int first_channel;
+  int tile_channels;
+  while (const void* tile = stream.Next(&first_channel, &tile_channels)) {
+    TF_LITE_ENSURE_STATUS(ParallelConvPerChannelTile(
+        context, *params, data, input, filter, bias,
+        static_cast<const int8_t*>(tile), first_channel, tile_channels,
+        output));
+  }
+  return stream.status();
+}
+
+// The reference kernel, or ConvPerChannelTile() over chunks of the output
+// channels when they run in parallel.
+TfLiteStatus EvalReferencePerChannel(TfLiteContext* context,
+                                     TfLiteNode* node) {
+  auto* params = static_cast<TfLiteConvParams*>(node->builtin_data);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kFilterTensor);
+  const TfLiteEvalTensor* bias =
+      (NumInputs(node) == 3)
+          ? tflite::micro::GetEvalInput(context, node, kBiasTensor)
+          : nullptr;
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  const int output_depth = filter->dims->data[0];
+  if (tflite::micro::NumParallelChunks(
+          context, output_depth, MacsPerOutputChannel(filter, output)) > 1) {
+    return ParallelConvPerChannelTile(
+        context, *params, data, input, filter, bias,
+        tflite::micro::GetTensorData<int8_t>(filter), 0, output_depth, output);
+  }
+  EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
+                          output, nullptr);
+  return kTfLiteOk;
+}
+
+// Adds to acc[i], for i in [0, rows) and rows at most 4, the dot product of
+// the `depth` filter values at `filter + i * row_stride` with the `depth` raw
+// input values at `in`. Each input value loaded feeds all four rows.
+inline void AccumulateFilterRows(const int8_t* in, const int8_t* filter,
+                                 int row_stride, int depth, int rows,
+                                 int32_t* acc) {
+  if (rows == 4) {
+    for (int d = 0; d < depth; ++d) {
+      const int32_t input_val = in[d];
+      acc[0] += filter[d] * input_val;
+      acc[1] += filter[row_stride + d] * input_val;
+      acc[2] += filter[2 * row_stride + d] * input_val;
+      acc[3] += filter[3 * row_stride + d] * input_val;
+    }
+  } else {
+    for (int i = 0; i < rows; ++i) {
+      for (int d = 0; d < depth; ++d) {
+        acc[i] += filter[i * row_stride + d] * in[d];
+      }
+    }
+  }
+}
+
+// Per-channel int8 convolution with a dilated filter, matching
+// reference_integer_ops::ConvPerChannel. Output pixels whose window lies
+// entirely inside the input run the pointwise kernel once per filter tap,
+// four output channels per pass over raw input values plus the effective
+// bias. The border pixels run the taps found valid once per output row and
+// per column, see dilated_conv.h, so no tap loop has bounds checks. Computes
+// output channels [first_channel, end_channel).
+void DilatedConvChannels(const TfLiteConvParams* params, const OpData& data,
+                         const TfLiteEvalTensor* input,
+                         const TfLiteEvalTensor* filter,
+                         const TfLiteEvalTensor* bias, int first_channel,
+                         int end_channel, TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int stride_height = params->stride_height;
+  const int stride_width = params->stride_width;
+  const int dilation_height = params->dilation_height_factor;
+  const int dilation_width = params->dilation_width_factor;
+  const int channel_size = filter_height * filter_width * input_depth;
+  // Distances in the input between vertically and horizontally adjacent taps.
+  const int tap_row_stride = dilation_height * input_width * input_depth;
+  const int tap_column_stride = dilation_width * input_depth;
+  const int32_t input_offset = -data.input_zero_point;
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data =
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr;
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  int interior_begin, interior_end;
+  InteriorOutputRange(stride_width, dilation_width, filter_width,
+                      data.padding.width, input_width, output_width,
+                      &interior_begin, &interior_end);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = out_y * stride_height - data.padding.height;
+      int filter_y_begin, filter_y_end;
+      ValidTapRange(in_y_origin, dilation_height, filter_height, input_height,
+                    &filter_y_begin, &filter_y_end);
+      const bool interior_row =
+          filter_y_begin == 0 && filter_y_end == filter_height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = out_x * stride_width - data.padding.width;
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        if (interior_row && out_x >= interior_begin && out_x < interior_end) {
+          const int8_t* window =
+              input_data +
+              Offset(input_shape, batch, in_y_origin, in_x_origin, 0);
+          for (int out_c = first_channel; out_c < end_channel; out_c += 4) {
+            const int rows = std::min(4, end_channel - out_c);
+            const int8_t* taps = filter_data + out_c * channel_size;
+            int32_t acc[4] = {};
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              const int8_t* in = window + filter_y * tap_row_stride;
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                AccumulateFilterRows(in, taps, channel_size, input_depth,
+                                     rows, acc);
+                in += tap_column_stride;
+                taps += input_depth;
+              }
+            }
+            for (int i = 0; i < rows; ++i) {
+              const int channel = out_c + i;
+              int32_t value = acc[i] + data.effective_bias[channel];
+              value = MultiplyByQuantizedMultiplier(
+                  value, data.per_channel_output_multiplier[channel],
+                  data.per_channel_output_shift[channel]);
+              value += data.output_zero_point;
+              value = std::max(value, data.output_activation_min);
+              value = std::min(value, data.output_activation_max);
+              out[channel] = static_cast<int8_t>(value);
+            }
+          }
+          continue;
+        }
+        int filter_x_begin, filter_x_end;
+        ValidTapRange(in_x_origin, dilation_width, filter_width, input_width,
+                      &filter_x_begin, &filter_x_end);
+        for (int out_c = first_channel; out_c < end_channel; ++out_c) {
+          int32_t acc = 0;
+          for (int filter_y = filter_y_begin; filter_y < filter_y_end;
+               ++filter_y) {
+            const int8_t* in_row =
+                input_data +
+                Offset(input_shape, batch,
+                       in_y_origin + dilation_height * filter_y, 0, 0);
+            const int8_t* taps =
+                filter_data + out_c * channel_size +
+                (filter_y * filter_width + filter_x_begin) * input_depth;
+            for (int filter_x = filter_x_begin; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int8_t* in =
+                  in_row +
+                  (in_x_origin + dilation_width * filter_x) * input_depth;
+              for (int d = 0; d < input_depth; ++d) {
+                acc += taps[d] * (in[d] + input_offset);
+              }
+              taps += input_depth;
+            }
+          }
+          if (bias_data) {
+            acc += bias_data[out_c];
+          }
+          acc = MultiplyByQuantizedMultiplier(
+              acc, data.per_channel_output_multiplier[out_c],
+              data.per_channel_output_shift[out_c]);
+          acc += data.output_zero_point;
+          acc = std::max(acc, data.output_activation_min);
+          acc = std::min(acc, data.output_activation_max);
+          out[out_c] = static_cast<int8_t>(acc);
+        }
+      }
+    }
+  }
+}
+
+TfLiteStatus EvalDilatedPerChannel(TfLiteContext* context, TfLiteNode* node) {
+  const auto* params = static_cast<const TfLiteConvParams*>(node->builtin_data);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kFilterTensor);
+  const TfLiteEvalTensor* bias =
+      (NumInputs(node) == 3)
+          ? tflite::micro::GetEvalInput(context, node, kBiasTensor)
+          : nullptr;
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  return tflite::micro::ParallelFor(
+      context, filter->dims->data[0], MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        DilatedConvChannels(params, data, input, filter, bias, begin, end,
+                            output);
+      },
+      /*grain=*/4);
+}
+
+// Per-channel int8 convolution with a 1x1 filter and no padding. Every output
+// pixel is the product of the filter matrix with one input pixel, computed
+// four output channels per pass over the input pixel from raw input values
+// and the effective bias. Computes output channels [first_channel,
+// end_channel).
+void PointwiseConvChannels(const TfLiteConvParams* params, const OpData& data,
+                           const TfLiteEvalTensor* input,
+                           const TfLiteEvalTensor* filter, int first_channel,
+                           int end_channel, TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = input_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int8_t* in =
+            input_data + Offset(input_shape, batch,
+                                out_y * params->stride_height,
+                                out_x * params->stride_width, 0);
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        for (int out_c = first_channel; out_c < end_channel; out_c += 4) {
+          const int rows = std::min(4, end_channel - out_c);
+          int32_t acc[4] = {};
+          AccumulateFilterRows(in, filter_data + out_c * input_depth,
+                               input_depth, input_depth, rows, acc);
+          for (int i = 0; i < rows; ++i) {
+            const int channel = out_c + i;
+            int32_t value = acc[i] + data.effective_bias[channel];
+            value = MultiplyByQuantizedMultiplier(
+                value, data.per_channel_output_multiplier[channel],
+                data.per_channel_output_shift[channel]);
+            value += data.output_zero_point;
+            value = std::max(value, data.output_activation_min);
+            value = std::min(value, data.output_activation_max);
+            out[channel] = static_cast<int8_t>(value);
+          }
+        }
+      }
+    }
+  }
+}
+
+TfLiteStatus EvalPointwisePerChannel(TfLiteContext* context,
+                                     TfLiteNode* node) {
+  const auto* params = static_cast<const TfLiteConvParams*>(node->builtin_data);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kFilterTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  return tflite::micro::ParallelFor(
+      context, filter->dims->data[0], MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        PointwiseConvChannels(params, data, input, filter, begin, end, output);
+      },
+      /*grain=*/4);
+}
+
+// Per-channel convolution of few input channels, int8 or uint8, with an int8
+// filter, see conv.h. The patch of every output pixel is gathered once, with
+// the input zero point in the padding area, and each output channel is a dot
+// product over the whole patch, computed four channels per pass.
+template <typename InputT>
+void EvalShallowInputPerChannel(const TfLiteConvParams& params,
+                                const OpData& data,
+                                const TfLiteEvalTensor* input,
+                                const TfLiteEvalTensor* filter,
+                                TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int patch_size = filter_height * filter_width * input_depth;
+  const int16_t pad_value = static_cast<int16_t>(data.input_zero_point);
+  const InputT* input_data = tflite::micro::GetTensorData<InputT>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  int16_t patch[kMaxShallowConvPatchSize];
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params.stride_height - data.padding.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params.stride_width - data.padding.width;
+        int16_t* tap = patch;
+        for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+          const int in_y =
+              in_y_origin + params.dilation_height_factor * filter_y;
+          for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+            const int in_x =
+                in_x_origin + params.dilation_width_factor * filter_x;
+            if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                in_y >= input_height) {
+              for (int d = 0; d < input_depth; ++d) {
+                *tap++ = pad_value;
+              }
+              continue;
+            }
+            const InputT* in =
+                input_data + Offset(input_shape, batch, in_y, in_x, 0);
+            for (int d = 0; d < input_depth; ++d) {
+              *tap++ = in[d];
+            }
+          }
+        }
+
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        for (int out_c = 0; out_c < output_depth; out_c += 4) {
+          const int rows = std::min(4, output_depth - out_c);
+          const int8_t* row = filter_data + out_c * patch_size;
+          int32_t acc[4] = {};
+          if (rows == 4) {
+            for (int k = 0; k < patch_size; ++k) {
+              const int32_t input_val = patch[k];
+              acc[0] += row[k] * input_val;
+              acc[1] += row[patch_size + k] * input_val;
+              acc[2] += row[2 * patch_size + k] * input_val;
+              acc[3] += row[3 * patch_size + k] * input_val;
+            }
+          } else {
+            for (int i = 0; i < rows; ++i) {
+              for (int k = 0; k < patch_size; ++k) {
+                acc[i] += row[i * patch_size + k] * patch[k];
+              }
+            }
+          }
+          for (int i = 0; i < rows; ++i) {
+            const int channel = out_c + i;
+            int32_t value = acc[i] + data.effective_bias[channel];
+            value = MultiplyByQuantizedMultiplier(
+                value, data.per_channel_output_multiplier[channel],
+                data.per_channel_output_shift[channel]);
+            value += data.output_zero_point;
+            value = std::max(value, data.output_activation_min);
+            value = std::min(value, data.output_activation_max);
+            out[channel] = static_cast<int8_t>(value);
+          }
+        }
+      }
+    }
+  }
+}
+
+TfLiteStatus EvalShallowInput(TfLiteContext* context, TfLiteNode* node) {
+  const auto& params =
+      *static_cast<const TfLiteConvParams*>(node->builtin_data);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kFilterTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  if (input->type == kTfLiteUInt8) {
+    EvalShallowInputPerChannel<uint8_t>(params, data, input, filter, output);
+  } else {
+    EvalShallowInputPerChannel<int8_t>(params, data, input, filter, output);
+  }
+  return kTfLiteOk;
+}
+
+bool IsInt8Input(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  return input != nullptr && input->type == kTfLiteInt8;
+}
+
+bool IsShallowInput(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  const TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  return input != nullptr && filter != nullptr && output != nullptr &&
+         (input->type == kTfLiteInt8 || input->type == kTfLiteUInt8) &&
+         output->type == kTfLiteInt8 && IsConstantTensor(filter) &&
+         IsShallowConvShape(input->dims->data[3], filter->dims->data[1],
+                            filter->dims->data[2]);
+}
+
+bool IsPointwise(TfLiteContext* context, TfLiteNode* node) {
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  return IsInt8Input(context, node) && filter != nullptr &&
+         IsConstantTensor(filter) &&
+         filter->dims->data[1] == 1 && filter->dims->data[2] == 1 &&
+         data->padding.height == 0 && data->padding.width == 0;
+}
+
+bool IsDilated(TfLiteContext* context, TfLiteNode* node) {
+  const auto* params = static_cast<const TfLiteConvParams*>(node->builtin_data);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  return IsInt8Input(context, node) && filter != nullptr &&
+         IsConstantTensor(filter) &&
+         (params->dilation_height_factor > 1 ||
+          params->dilation_width_factor > 1);
+}
+
+TfLiteStatus PrepareEffectiveBias(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = static_cast<OpData*>(node->user_data);
+  if (data->effective_bias != nullptr) {
+    // Already computed for another variant.
+    return kTfLiteOk;
+  }
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  const TfLiteTensor* bias = GetOptionalInputTensor(context, node, kBiasTensor);
+  const int output_depth = filter->dims->data[kConvQuantizedDimension];
+  data->effective_bias =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, output_depth * sizeof(int32_t)));
+  TF_LITE_ENSURE(context, data->effective_bias != nullptr);
+  tflite::micro::ComputeEffectiveBias(
+      GetTensorData<int8_t>(filter),
+      bias != nullptr ? GetTensorData<int32_t>(bias) : nullptr, output_depth,
+      filter->dims->data[1] * filter->dims->data[2] * filter->dims->data[3],
+      input->params.zero_point, data->effective_bias);
+  return kTfLiteOk;
+}
+
+// Winograd F(2x2, 3x3): every 2x2 output tile is computed from a 4x4 input
+// tile with 16 multiplications per input and output channel instead of 36.
+// The filter is transformed with 2 * G, so that G g G^T, scaled by 4, stays
+// integer and fits int16; the tile result is scaled down by 4 again after
+// the output transform, which keeps the result exactly that of the reference
+// kernel. The transformed filter takes 32 bytes per 3x3 filter slice, against
+// 9 for the original.
+constexpr int kWinogradTileSize = 16;
+// Largest magnitude of a transformed filter value, 9 * 127.
+constexpr int32_t kMaxWinogradFilterValue = 1143;
+// Largest magnitude of a transformed input value, 4 * 128.
+constexpr int32_t kMaxWinogradInputValue = 512;
+
+// Computes (2 * G) g (2 * G)^T for one 3x3 filter slice `g`.
+void TransformWinogradFilter(const int32_t g[9], int16_t u[16]) {
+  int32_t t[12];
+  for (int x = 0; x < 3; ++x) {
+    t[x] = 2 * g[x];
+    t[3 + x] = g[x] + g[3 + x] + g[6 + x];
+    t[6 + x] = g[x] - g[3 + x] + g[6 + x];
+    t[9 + x] = 2 * g[6 + x];
+  }
+  for (int y = 0; y < 4; ++y) {
+    const int32_t* row = t + 3 * y;
+    u[4 * y] = static_cast<int16_t>(2 * row[0]);
+    u[4 * y + 1] = static_cast<int16_t>(row[0] + row[1] + row[2]);
+    u[4 * y + 2] = static_cast<int16_t>(row[0] - row[1] + row[2]);
+    u[4 * y + 3] = static_cast<int16_t>(2 * row[2]);
+  }
+}
+
+// Replaces the 4x4 input tile `d` by B^T d B.
+void TransformWinogradInput(int32_t d[16]) {
+  int32_t t[16];
+  for (int x = 0; x < 4; ++x) {
+    t[x] = d[x] - d[8 + x];
+    t[4 + x] = d[4 + x] + d[8 + x];
+    t[8 + x] = d[8 + x] - d[4 + x];
+    t[12 + x] = d[4 + x] - d[12 + x];
+  }
+  for (int y = 0; y < 4; ++y) {
+    const int32_t* row = t + 4 * y;
+    d[4 * y] = row[0] - row[2];
+    d[4 * y + 1] = row[1] + row[2];
+    d[4 * y + 2] = row[2] - row[1];
+    d[4 * y + 3] = row[1] - row[3];
+  }
+}
+
+// Computes A^T m A for the 4x4 product tile `m`, scaled down by 4.
+void TransformWinogradOutput(const int32_t m[16], int32_t o[4]) {
+  int64_t t[8];
+  for (int x = 0; x < 4; ++x) {
+    t[x] = static_cast<int64_t>(m[x]) + m[4 + x] + m[8 + x];
+    t[4 + x] = static_cast<int64_t>(m[4 + x]) - m[8 + x] - m[12 + x];
+  }
+  for (int y = 0; y < 2; ++y) {
+    const int64_t* row = t + 4 * y;
+    o[2 * y] = static_cast<int32_t>((row[0] + row[1] + row[2]) / 4);
+    o[2 * y + 1] = static_cast<int32_t>((row[1] - row[2] - row[3]) / 4);
+  }
+}
+
+bool IsWinograd(TfLiteContext* context, TfLiteNode* node) {
+  const auto* params = static_cast<const TfLiteConvParams*>(node->builtin_data);
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  if (input == nullptr || filter == nullptr || input->type != kTfLiteInt8 ||
+      !IsConstantTensor(filter) || filter->dims->data[1] != 3 ||
+      filter->dims->data[2] != 3 || params->stride_width != 1 ||
+      params->stride_height != 1 || params->dilation_width_factor != 1 ||
+      params->dilation_height_factor != 1) {
+    return false;
+  }
+  // The products of a tile are accumulated over the input channels in int32.
+  const int64_t max_product =
+      static_cast<int64_t>(kMaxWinogradFilterValue) * kMaxWinogradInputValue;
+  return max_product * filter->dims->data[3] <=
+         std::numeric_limits<int32_t>::max();
+}
+
+TfLiteStatus PrepareWinograd(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  TF_LITE_ENSURE_STATUS(PrepareEffectiveBias(context, node));
+  const int output_depth = filter->dims->data[0];
+  const int input_depth = filter->dims->data[3];
+  data->winograd_filter =
+      static_cast<int16_t*>(context->AllocatePersistentBuffer(
+          context, output_depth * kWinogradTileSize * input_depth *
+                       sizeof(int16_t)));
+  TF_LITE_ENSURE(context, data->winograd_filter != nullptr);
+  // Laid out as [output channel][tile position][input channel], so that the
+  // products of one tile position are a dot product over the input channels.
+  const int8_t* filter_data = GetTensorData<int8_t>(filter);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    for (int in_c = 0; in_c < input_depth; ++in_c) {
+      int32_t g[9];
+      for (int i = 0; i < 9; ++i) {
+        g[i] = filter_data[(out_c * 9 + i) * input_depth + in_c];
+      }
+      int16_t u[kWinogradTileSize];
+      TransformWinogradFilter(g, u);
+      int16_t* out =
+          data->winograd_filter + out_c * kWinogradTileSize * input_depth;
+      for (int i = 0; i < kWinogradTileSize; ++i) {
+        out[i * input_depth + in_c] = u[i];
+      }
+    }
+  }
+  return context->RequestScratchBufferInArena(
+      context, kWinogradTileSize * input_depth * sizeof(int16_t),
+      &data->winograd_tile_index);
+}
+
+TfLiteStatus EvalWinograd(TfLiteContext* context, TfLiteNode* node) {
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  int16_t* tile = static_cast<int16_t*>(
+      context->GetScratchBuffer(context, data.winograd_tile_index));
+  TFLITE_DCHECK(tile != nullptr);
+  const int16_t pad_value = static_cast<int16_t>(data.input_zero_point);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; out_y += 2) {
+      for (int out_x = 0; out_x < output_width; out_x += 2) {
+        // Gathers the raw 4x4 input tile, with the input zero point in the
+        // padding area, as [tile position][input channel].
+        const int in_y_origin = out_y - data.padding.height;
+        const int in_x_origin = out_x - data.padding.width;
+        for (int i = 0; i < kWinogradTileSize; ++i) {
+          const int in_y = in_y_origin + i / 4;
+          const int in_x = in_x_origin + i % 4;
+          int16_t* dst = tile + i * input_depth;
+          if (in_y < 0 || in_y >= input_height || in_x < 0 ||
+              in_x >= input_width) {
+            for (int d = 0; d < input_depth; ++d) {
+              dst[d] = pad_value;
+            }
+            continue;
+          }
+          const int8_t* src =
+              input_data + Offset(input_shape, batch, in_y, in_x, 0);
+          for (int d = 0; d < input_depth; ++d) {
+            dst[d] = src[d];
+          }
+        }
+        for (int d = 0; d < input_depth; ++d) {
+          int32_t v[kWinogradTileSize];
+          for (int i = 0; i < kWinogradTileSize; ++i) {
+            v[i] = tile[i * input_depth + d];
+          }
+          TransformWinogradInput(v);
+          for (int i = 0; i < kWinogradTileSize; ++i) {
+            tile[i * input_depth + d] = static_cast<int16_t>(v[i]);
+          }
+        }
+
+        const int rows = std::min(2, output_height - out_y);
+        const int cols = std::min(2, output_width - out_x);
+        for (int out_c = 0; out_c < output_depth; ++out_c) {
+          const int16_t* u =
+              data.winograd_filter + out_c * kWinogradTileSize * input_depth;
+          int32_t m[kWinogradTileSize];
+          for (int i = 0; i < kWinogradTileSize; ++i) {
+            const int16_t* u_row = u + i * input_depth;
+            const int16_t* v_row = tile + i * input_depth;
+            int32_t acc = 0;
+            for (int d = 0; d < input_depth; ++d) {
+              acc += u_row[d] * v_row[d];
+            }
+            m[i] = acc;
+          }
+          int32_t o[4];
+          TransformWinogradOutput(m, o);
+          for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < cols; ++x) {
+              int32_t value = o[2 * y + x] + data.effective_bias[out_c];
+              value = MultiplyByQuantizedMultiplier(
+                  value, data.per_channel_output_multiplier[out_c],
+                  data.per_channel_output_shift[out_c]);
+              value += data.output_zero_point;
+              value = std::max(value, data.output_activation_min);
+              value = std::min(value, data.output_activation_max);
+              output_data[Offset(output_shape, batch, out_y + y, out_x + x,
+                                 out_c)] = static_cast<int8_t>(value);
+            }
+          }
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Implementations of convolutions with a plain int8 filter, in order of
+// preference. The Winograd filter takes more than three times the arena of
+// the original filter, so it comes after the reference kernel and only runs
+// when a KernelTuner times it faster.
+constexpr tflite::micro::KernelVariant kInt8Variants[] = {
+    {"pointwise", IsPointwise, PrepareEffectiveBias, EvalPointwisePerChannel},
+    {"shallow_input", IsShallowInput, PrepareEffectiveBias, EvalShallowInput},
+    {"dilated", IsDilated, PrepareEffectiveBias, EvalDilatedPerChannel},
+    {"reference", IsInt8Input, nullptr, EvalReferencePerChannel},
+    {"winograd", IsWinograd, PrepareWinograd, EvalWinograd},
+};
+
+TfLiteStatus PrepareInt8Variants(TfLiteContext* context, TfLiteNode* node,
+                                 OpData* data) {
+  return tflite::micro::PrepareKernelVariants(
+      context, node, BuiltinOperator_CONV_2D, kInt8Variants,
+      sizeof(kInt8Variants) / sizeof(kInt8Variants[0]), &data->variants);
+}
+
+// Computes output channels [first_channel, first_channel + tile_channels) of
+// a float convolution from the float32 filter channels in `tile_data`,
+// matching reference_ops::Conv for the channels it covers.
+void ConvFloatTile(const ConvParams& params, const TfLiteEvalTensor* input,
+                   const TfLiteEvalTensor* filter, const float* bias_data,
+                   const float* tile_data, int first_channel,
+                   int tile_channels, TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int channel_size = filter_height * filter_width * input_depth;
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params.stride_height - params.padding_values.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params.stride_width - params.padding_values.width;
+        float* out = output_data +
+                     Offset(output_shape, batch, out_y, out_x, 0) +
+                     first_channel;
+        for (int c = 0; c < tile_channels; ++c) {
+          const float* filter_data = tile_data + c * channel_size;
+          float total = 0.f;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params.dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params.dilation_width_factor * filter_x;
+              // Zero padding by omitting the areas outside the image.
+              if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                  in_y >= input_height) {
+                continue;
+              }
+              const float* in =
+                  input_data + Offset(input_shape, batch, in_y, in_x, 0);
+              const float* taps =
+                  filter_data +
+                  (filter_y * filter_width + filter_x) * input_depth;
+              for (int d = 0; d < input_depth; ++d) {
+                total += in[d] * taps[d];
+              }
+            }
+          }
+          const float bias_value =
+              bias_data != nullptr ? bias_data[first_channel + c] : 0.0f;
+          out[c] = ActivationFunctionWithMinMax(total + bias_value,
+                                                params.float_activation_min,
+                                                params.float_activation_max);
+        }
+      }
+    }
+  }
+}
+
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, const OpData& data,
                const TfLiteEvalTensor* input, const TfLiteEvalTensor* filter,
@@ -271,13 +1378,31 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = params->dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  const float* bias_data =
+      tflite::micro::GetFloatBias(data.float16_bias, bias);
+
+  // A float16 filter is converted one tile of output channels at a time.
+  if (tflite::micro::HasFloat16Weights(data.float16_filter)) {
+    const TfLiteFloat16* filter_data =
+        tflite::micro::GetTensorData<TfLiteFloat16>(filter);
+    int tile_channels;
+    for (int first_channel = 0;
+         first_channel < data.float16_filter.num_channels;
+         first_channel += tile_channels) {
+      const float* tile = tflite::micro::ConvertFloat16Tile(
+          context, data.float16_filter, filter_data, first_channel,
+          &tile_channels);
+      ConvFloatTile(op_params, input, filter, bias_data, tile, first_channel,
+                    tile_channels, output);
+    }
+    return;
+  }
 
   reference_ops::Conv(op_params, tflite::micro::GetTensorShape(input),
                       tflite::micro::GetTensorData<float>(input),
                       tflite::micro::GetTensorShape(filter),
                       tflite::micro::GetTensorData<float>(filter),
-                      tflite::micro::GetTensorShape(bias),
-                      tflite::micro::GetTensorData<float>(bias),
+                      tflite::micro::GetTensorShape(bias), bias_data,
                       tflite::micro::GetTensorShape(output),
                       tflite::micro::GetTensorData<float>(output),
                       tflite::micro::GetTensorShape(im2col),
@@ -307,10 +1432,23 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                 nullptr, output);
       break;
     case kTfLiteInt8:
-      EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
-                              output, nullptr);
-      break;
+      if (data.packed_weights != nullptr) {
+        return EvalPackedPerChannel(context, params, data, input, filter,
+                                    output);
+      }
+      if (data.compressed_weights != nullptr) {
+        return EvalCompressedPerChannel(context, params, data, input, filter,
+                                        bias, output);
+      }
+      if (tflite::micro::IsWeightPrefetchEnabled(data.prefetch)) {
+        return EvalPrefetchedPerChannel(context, params, data, input, filter,
+                                        bias, output);
+      }
+      return tflite::micro::EvalKernelVariant(context, node, data.variants);
     case kTfLiteUInt8:
+      if (filter->type == kTfLiteInt8) {
+        return tflite::micro::EvalKernelVariant(context, node, data.variants);
+      }
       EvalQuantized(context, node, params, data, input, filter, bias, nullptr,
                     nullptr, output);
       break;
@@ -0,0 +1,42 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_CONV_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_CONV_H_
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+// The int8 CONV_2D has a kernel for layers with few input channels, typically
+// the stem of an image model reading RGB or mono pixels. It gathers the whole
+// filter_height x filter_width x input_depth patch of an output pixel once and
+// runs each output channel over it as one dot product. It also reads uint8
+// input, with an int8 filter and output: the graph rewriter folds a QUANTIZE
+// of uint8 camera pixels into the convolution that follows it.
+constexpr int kMaxShallowConvInputDepth = 4;
+constexpr int kMaxShallowConvPatchSize = 256;
+
+inline bool IsShallowConvShape(int input_depth, int filter_height,
+                               int filter_width) {
+  return input_depth <= kMaxShallowConvInputDepth &&
+         filter_height * filter_width * input_depth <=
+             kMaxShallowConvPatchSize;
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_CONV_H_
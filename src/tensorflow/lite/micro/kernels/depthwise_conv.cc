@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
@@ -24,7 +27,10 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/dilated_conv.h"
+#include "tensorflow/lite/micro/kernels/float16_weights.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -61,6 +67,11 @@ struct OpData {
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+
+  // Offline pre-packed int8 weights, or nullptr.
+  const PackedWeights* packed_weights;
+  // Float32 copy of the float16 bias of a float convolution, or nullptr.
+  const float* float16_bias;
 };
 
 TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
@@ -74,9 +85,10 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
 
   int unused_output_height, unused_output_width;
   data->padding = ComputePaddingHeightWidth(
-      params->stride_height, params->stride_width, 1, 1, height, width,
-      filter_height, filter_width, params->padding, &unused_output_height,
-      &unused_output_width);
+      params->stride_height, params->stride_width,
+      params->dilation_height_factor, params->dilation_width_factor, height,
+      width, filter_height, filter_width, params->padding,
+      &unused_output_height, &unused_output_width);
 
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
@@ -101,6 +113,27 @@ TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus ValidatePackedWeights(TfLiteContext* context,
+                                   const TfLiteDepthwiseConvParams* params,
+                                   const TfLiteTensor* input,
+                                   const TfLiteTensor* filter,
+                                   const PackedWeights* packed) {
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, packed->layout, kPackedWeightsC16);
+  TF_LITE_ENSURE_EQ(context, params->depth_multiplier, 1);
+  const auto* affine_quantization =
+      static_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  for (int i = 0; i < affine_quantization->zero_point->size; ++i) {
+    TF_LITE_ENSURE_EQ(context, affine_quantization->zero_point->data[i], 0);
+  }
+  const int channels = filter->dims->data[kDepthwiseConvQuantizedDimension];
+  const int num_taps = filter->dims->data[1] * filter->dims->data[2];
+  TF_LITE_ENSURE_EQ(context, packed->filter_size,
+                    PackedC16Size(channels, num_taps));
+  TF_LITE_ENSURE_EQ(context, packed->effective_bias_size, channels);
+  return kTfLiteOk;
+}
+
 }  // namespace
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -167,9 +200,97 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->filter_zero_point = filter->params.zero_point;
   data->output_zero_point = output->params.zero_point;
 
+  data->packed_weights = tflite::micro::GetPackedWeights(node);
+  if (data->packed_weights != nullptr) {
+    TF_LITE_ENSURE_STATUS(ValidatePackedWeights(context, params, input, filter,
+                                                data->packed_weights));
+  }
+  // A float16 filter is converted tap by tap in EvalFloat(), only the bias is
+  // converted here.
+  data->float16_bias = nullptr;
+  if (input->type == kTfLiteFloat32) {
+    TF_LITE_ENSURE_MSG(context,
+                       filter->type == kTfLiteFloat32 ||
+                           (filter->type == kTfLiteFloat16 &&
+                            IsConstantTensor(filter)),
+                       "The filter must be float32 or constant float16.");
+    TF_LITE_ENSURE_STATUS(tflite::micro::PrepareFloat16Bias(
+        context, GetOptionalInputTensor(context, node, kBiasTensor),
+        &data->float16_bias));
+  }
+
   return kTfLiteOk;
 }
 
+// Float depthwise convolution with a float16 filter, matching
+// reference_ops::DepthwiseConv over the filter converted to float32. Each tap
+// is converted when it is loaded, so no float32 copy of the filter is kept.
+void DepthwiseConvFloat16Filter(const DepthwiseParams& params,
+                                const TfLiteEvalTensor* input,
+                                const TfLiteEvalTensor* filter,
+                                const float* bias_data,
+                                TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int depth_multiplier = params.depth_multiplier;
+  TFLITE_DCHECK_EQ(output_depth, input_depth * depth_multiplier);
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  const TfLiteFloat16* filter_data =
+      tflite::micro::GetTensorData<TfLiteFloat16>(filter);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+
+  for (int b = 0; b < batches; ++b) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params.stride_height - params.padding_values.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params.stride_width - params.padding_values.width;
+        for (int ic = 0; ic < input_depth; ++ic) {
+          for (int m = 0; m < depth_multiplier; ++m) {
+            const int oc = m + ic * depth_multiplier;
+            float total = 0.f;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              const int in_y =
+                  in_y_origin + params.dilation_height_factor * filter_y;
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                const int in_x =
+                    in_x_origin + params.dilation_width_factor * filter_x;
+                // Zero padding by omitting the areas outside the image.
+                if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                    in_y >= input_height) {
+                  continue;
+                }
+                const float input_value =
+                    input_data[Offset(input_shape, b, in_y, in_x, ic)];
+                const float filter_value = Float16ToFloat(filter_data[Offset(
+                    filter_shape, 0, filter_y, filter_x, oc)]);
+                total += input_value * filter_value;
+              }
+            }
+            const float bias_value =
+                bias_data != nullptr ? bias_data[oc] : 0.0f;
+            output_data[Offset(output_shape, b, out_y, out_x, oc)] =
+                ActivationFunctionWithMinMax(total + bias_value,
+                                             params.float_activation_min,
+                                             params.float_activation_max);
+          }
+        }
+      }
+    }
+  }
+}
+
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteDepthwiseConvParams* params, const OpData& data,
                const TfLiteEvalTensor* input, const TfLiteEvalTensor* filter,
@@ -191,13 +312,19 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
 
+  const float* bias_data =
+      tflite::micro::GetFloatBias(data.float16_bias, bias);
+  if (filter->type == kTfLiteFloat16) {
+    DepthwiseConvFloat16Filter(op_params, input, filter, bias_data, output);
+    return;
+  }
+
   tflite::reference_ops::DepthwiseConv(
       op_params, tflite::micro::GetTensorShape(input),
       tflite::micro::GetTensorData<float>(input),
       tflite::micro::GetTensorShape(filter),
       tflite::micro::GetTensorData<float>(filter),
-      tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<float>(bias),
+      tflite::micro::GetTensorShape(bias), bias_data,
       tflite::micro::GetTensorShape(output),
       tflite::micro::GetTensorData<float>(output));
 }
@@ -231,11 +358,340 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
       tflite::micro::GetTensorShape(filter),
       tflite::micro::GetTensorData<int8_t>(filter),
       tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<int32_t>(bias),
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr,
       tflite::micro::GetTensorShape(output),
       tflite::micro::GetTensorData<int8_t>(output));
 }
 
+// Adds to acc[c], for c in [0, num_channels), the filter tap taps[c] times
+// the input value in[c] plus `input_offset`.
+inline void AccumulateChannels(const int8_t* taps, const int8_t* in,
+                               int32_t input_offset, int num_channels,
+                               int32_t* acc) {
+  for (int c = 0; c < num_channels; ++c) {
+    acc[c] += taps[c] * (static_cast<int32_t>(in[c]) + input_offset);
+  }
+}
+
+// Per-channel int8 depthwise convolution with a dilated filter, matching
+// EvalQuantizedPerChannel. With a depth multiplier of 1, output pixels whose
+// window lies entirely inside the input run the loop of
+// EvalPackedPerChannel(), kPackedChannelBlock channels at a time over the
+// taps of the unpacked filter, which are contiguous across channels too. The
+// other pixels run the taps found valid once per output row and per column,
+// see dilated_conv.h, so no tap loop has bounds checks. Computes output rows
+// [first_row, end_row) of every batch.
+void EvalDilatedPerChannel(const TfLiteDepthwiseConvParams* params,
+                           const OpData& data, const TfLiteEvalTensor* input,
+                           const TfLiteEvalTensor* filter,
+                           const TfLiteEvalTensor* bias, int first_row,
+                           int end_row, TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int depth_multiplier = params->depth_multiplier;
+  const int stride_height = params->stride_height;
+  const int stride_width = params->stride_width;
+  const int dilation_height = params->dilation_height_factor;
+  const int dilation_width = params->dilation_width_factor;
+  // Distances in the input between vertically and horizontally adjacent taps.
+  const int tap_row_stride = dilation_height * input_width * input_depth;
+  const int tap_column_stride = dilation_width * input_depth;
+  const int32_t input_offset = -data.input_zero_point;
+  const int32_t activation_min = std::numeric_limits<int8_t>::min();
+  const int32_t activation_max = std::numeric_limits<int8_t>::max();
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data =
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr;
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  int interior_begin, interior_end;
+  InteriorOutputRange(stride_width, dilation_width, filter_width,
+                      data.padding.width, input_width, output_width,
+                      &interior_begin, &interior_end);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = first_row; out_y < end_row; ++out_y) {
+      const int in_y_origin = out_y * stride_height - data.padding.height;
+      int filter_y_begin, filter_y_end;
+      ValidTapRange(in_y_origin, dilation_height, filter_height, input_height,
+                    &filter_y_begin, &filter_y_end);
+      const bool interior_row = depth_multiplier == 1 &&
+                                filter_y_begin == 0 &&
+                                filter_y_end == filter_height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = out_x * stride_width - data.padding.width;
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        if (interior_row && out_x >= interior_begin && out_x < interior_end) {
+          const int8_t* window =
+              input_data +
+              Offset(input_shape, batch, in_y_origin, in_x_origin, 0);
+          for (int c0 = 0; c0 < output_depth; c0 += kPackedChannelBlock) {
+            const int block_channels =
+                std::min(kPackedChannelBlock, output_depth - c0);
+            int32_t acc[kPackedChannelBlock] = {};
+            const int8_t* taps = filter_data + c0;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              const int8_t* in = window + filter_y * tap_row_stride + c0;
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                AccumulateChannels(taps, in, input_offset, block_channels,
+                                   acc);
+                in += tap_column_stride;
+                taps += output_depth;
+              }
+            }
+            for (int c = 0; c < block_channels; ++c) {
+              const int channel = c0 + c;
+              int32_t value = acc[c];
+              if (bias_data) {
+                value += bias_data[channel];
+              }
+              value = MultiplyByQuantizedMultiplier(
+                  value, data.per_channel_output_multiplier[channel],
+                  data.per_channel_output_shift[channel]);
+              value += data.output_zero_point;
+              // Clamps like EvalQuantizedPerChannel so both paths agree.
+              value = std::max(value, activation_min);
+              value = std::min(value, activation_max);
+              out[channel] = static_cast<int8_t>(value);
+            }
+          }
+          continue;
+        }
+        int filter_x_begin, filter_x_end;
+        ValidTapRange(in_x_origin, dilation_width, filter_width, input_width,
+                      &filter_x_begin, &filter_x_end);
+        for (int in_c = 0; in_c < input_depth; ++in_c) {
+          for (int m = 0; m < depth_multiplier; ++m) {
+            const int out_c = in_c * depth_multiplier + m;
+            int32_t acc = 0;
+            for (int filter_y = filter_y_begin; filter_y < filter_y_end;
+                 ++filter_y) {
+              const int8_t* in_row =
+                  input_data +
+                  Offset(input_shape, batch,
+                         in_y_origin + dilation_height * filter_y, 0, in_c);
+              const int8_t* taps =
+                  filter_data + Offset(filter_shape, 0, filter_y, 0, out_c);
+              for (int filter_x = filter_x_begin; filter_x < filter_x_end;
+                   ++filter_x) {
+                acc += taps[filter_x * output_depth] *
+                       (in_row[(in_x_origin + dilation_width * filter_x) *
+                               input_depth] +
+                        input_offset);
+              }
+            }
+            if (bias_data) {
+              acc += bias_data[out_c];
+            }
+            acc = MultiplyByQuantizedMultiplier(
+                acc, data.per_channel_output_multiplier[out_c],
+                data.per_channel_output_shift[out_c]);
+            acc += data.output_zero_point;
+            // Clamps like EvalQuantizedPerChannel so both paths agree.
+            acc = std::max(acc, activation_min);
+            acc = std::min(acc, activation_max);
+            out[out_c] = static_cast<int8_t>(acc);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Per-channel int8 depthwise convolution with a depth multiplier of
+// kDepthMultiplier, matching EvalQuantizedPerChannel. Each input value is
+// loaded once per filter tap and feeds the kDepthMultiplier consecutive
+// output channels of its input channel, whose filter taps are contiguous.
+// Those outputs are then requantized together. The valid taps come from
+// dilated_conv.h, so the tap loops run without bounds checks. Computes output
+// rows [first_row, end_row) of every batch.
+template <int kDepthMultiplier>
+void EvalDepthMultiplierPerChannel(const TfLiteDepthwiseConvParams* params,
+                                   const OpData& data,
+                                   const TfLiteEvalTensor* input,
+                                   const TfLiteEvalTensor* filter,
+                                   const TfLiteEvalTensor* bias, int first_row,
+                                   int end_row, TfLiteEvalTensor* output) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int stride_height = params->stride_height;
+  const int stride_width = params->stride_width;
+  const int dilation_height = params->dilation_height_factor;
+  const int dilation_width = params->dilation_width_factor;
+  const int32_t input_offset = -data.input_zero_point;
+  const int32_t activation_min = std::numeric_limits<int8_t>::min();
+  const int32_t activation_max = std::numeric_limits<int8_t>::max();
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  const int32_t* bias_data =
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr;
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  int interior_begin, interior_end;
+  InteriorOutputRange(stride_width, dilation_width, filter_width,
+                      data.padding.width, input_width, output_width,
+                      &interior_begin, &interior_end);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = first_row; out_y < end_row; ++out_y) {
+      const int in_y_origin = out_y * stride_height - data.padding.height;
+      int filter_y_begin, filter_y_end;
+      ValidTapRange(in_y_origin, dilation_height, filter_height, input_height,
+                    &filter_y_begin, &filter_y_end);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = out_x * stride_width - data.padding.width;
+        int filter_x_begin = 0;
+        int filter_x_end = filter_width;
+        if (out_x < interior_begin || out_x >= interior_end) {
+          ValidTapRange(in_x_origin, dilation_width, filter_width,
+                        input_width, &filter_x_begin, &filter_x_end);
+        }
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        for (int in_c = 0; in_c < input_depth; ++in_c) {
+          const int first_channel = in_c * kDepthMultiplier;
+          int32_t acc[kDepthMultiplier] = {};
+          for (int filter_y = filter_y_begin; filter_y < filter_y_end;
+               ++filter_y) {
+            const int8_t* in_row =
+                input_data +
+                Offset(input_shape, batch,
+                       in_y_origin + dilation_height * filter_y, 0, in_c);
+            const int8_t* taps =
+                filter_data +
+                Offset(filter_shape, 0, filter_y, 0, first_channel);
+            for (int filter_x = filter_x_begin; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int32_t input_val =
+                  in_row[(in_x_origin + dilation_width * filter_x) *
+                         input_depth] +
+                  input_offset;
+              const int8_t* tap = taps + filter_x * output_depth;
+              for (int m = 0; m < kDepthMultiplier; ++m) {
+                acc[m] += tap[m] * input_val;
+              }
+            }
+          }
+          for (int m = 0; m < kDepthMultiplier; ++m) {
+            const int channel = first_channel + m;
+            int32_t value = acc[m];
+            if (bias_data) {
+              value += bias_data[channel];
+            }
+            value = MultiplyByQuantizedMultiplier(
+                value, data.per_channel_output_multiplier[channel],
+                data.per_channel_output_shift[channel]);
+            value += data.output_zero_point;
+            // Clamps like EvalQuantizedPerChannel so both paths agree.
+            value = std::max(value, activation_min);
+            value = std::min(value, activation_max);
+            out[channel] = static_cast<int8_t>(value);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Per-channel int8 depthwise convolution over kPackedWeightsC16 weights,
+// 16 channels at a time with all the filter taps of a block contiguous. The
+// input zero point is part of the effective bias, so taps in the padding area
+// read the zero point instead of being skipped.
+void EvalPackedPerChannel(TfLiteDepthwiseConvParams* params,
+                          const OpData& data, const TfLiteEvalTensor* input,
+                          const TfLiteEvalTensor* filter,
+                          TfLiteEvalTensor* output) {
+  const PackedWeights& packed = *data.packed_weights;
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int channels = output_shape.Dims(3);
+  const int num_taps = filter_height * filter_width;
+  const int32_t input_zero_point = data.input_zero_point;
+  const int32_t activation_min = std::numeric_limits<int8_t>::min();
+  const int32_t activation_max = std::numeric_limits<int8_t>::max();
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params->stride_height - data.padding.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params->stride_width - data.padding.width;
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        for (int c0 = 0; c0 < channels; c0 += kPackedChannelBlock) {
+          const int block_channels =
+              std::min(kPackedChannelBlock, channels - c0);
+          int32_t acc[kPackedChannelBlock] = {};
+          const int8_t* block = packed.filter + c0 * num_taps;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params->dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params->dilation_width_factor * filter_x;
+              const bool is_point_inside_image =
+                  (in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                  (in_y < input_height);
+              if (is_point_inside_image) {
+                AccumulateChannels(
+                    block,
+                    input_data + Offset(input_shape, batch, in_y, in_x, c0),
+                    /*input_offset=*/0, block_channels, acc);
+              } else {
+                for (int c = 0; c < block_channels; ++c) {
+                  acc[c] += block[c] * input_zero_point;
+                }
+              }
+              block += kPackedChannelBlock;
+            }
+          }
+          for (int c = 0; c < block_channels; ++c) {
+            const int channel = c0 + c;
+            int32_t value = acc[c] + packed.effective_bias[channel];
+            value = MultiplyByQuantizedMultiplier(
+                value, data.per_channel_output_multiplier[channel],
+                data.per_channel_output_shift[channel]);
+            value += data.output_zero_point;
+            // Clamps like EvalQuantizedPerChannel so both paths agree.
+            value = std::max(value, activation_min);
+            value = std::min(value, activation_max);
+            out[channel] = static_cast<int8_t>(value);
+          }
+        }
+      }
+    }
+  }
+}
+
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    TfLiteDepthwiseConvParams* params, const OpData& data,
                    const TfLiteEvalTensor* input,
@@ -270,11 +726,60 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
       tflite::micro::GetTensorShape(filter),
       tflite::micro::GetTensorData<uint8_t>(filter),
       tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<int32_t>(bias),
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr,
       tflite::micro::GetTensorShape(output),
       tflite::micro::GetTensorData<uint8_t>(output));
 }
 
+// Kernel over output rows [first_row, end_row) of every batch.
+typedef void (*EvalRowsFn)(const TfLiteDepthwiseConvParams* params,
+                           const OpData& data, const TfLiteEvalTensor* input,
+                           const TfLiteEvalTensor* filter,
+                           const TfLiteEvalTensor* bias, int first_row,
+                           int end_row, TfLiteEvalTensor* output);
+
+// Per-channel int8 depthwise convolution without packed weights. The output
+// rows are split into chunks for ParallelFor(), so the reference kernel only
+// runs when the layer stays on one thread; otherwise EvalDilatedPerChannel()
+// stands in for it, it matches the reference for a dilation of 1 too. The
+// reference kernel needs a bias, so a layer without one always takes
+// EvalDilatedPerChannel().
+TfLiteStatus EvalInt8Rows(TfLiteContext* context, TfLiteNode* node,
+                          TfLiteDepthwiseConvParams* params,
+                          const OpData& data, const TfLiteEvalTensor* input,
+                          const TfLiteEvalTensor* filter,
+                          const TfLiteEvalTensor* bias,
+                          TfLiteEvalTensor* output) {
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_height = output_shape.Dims(1);
+  const int64_t macs_per_row = static_cast<int64_t>(output_shape.Dims(0)) *
+                               output_shape.Dims(2) * output_shape.Dims(3) *
+                               filter_shape.Dims(1) * filter_shape.Dims(2);
+  EvalRowsFn eval_rows = nullptr;
+  if (params->depth_multiplier == 2) {
+    eval_rows = EvalDepthMultiplierPerChannel<2>;
+  } else if (params->depth_multiplier == 4) {
+    eval_rows = EvalDepthMultiplierPerChannel<4>;
+  } else if (params->depth_multiplier == 8) {
+    eval_rows = EvalDepthMultiplierPerChannel<8>;
+  } else if (bias == nullptr || params->dilation_height_factor > 1 ||
+             params->dilation_width_factor > 1 ||
+             tflite::micro::NumParallelChunks(context, output_height,
+                                              macs_per_row) > 1) {
+    eval_rows = EvalDilatedPerChannel;
+  }
+  if (eval_rows == nullptr) {
+    EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
+                            output);
+    return kTfLiteOk;
+  }
+  return tflite::micro::ParallelFor(
+      context, output_height, macs_per_row, [&](int begin, int end) {
+        eval_rows(params, data, input, filter, bias, begin, end, output);
+      });
+}
+
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK(node->user_data != nullptr);
   TFLITE_DCHECK(node->builtin_data != nullptr);
@@ -301,9 +806,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       EvalFloat(context, node, params, data, input, filter, bias, output);
       break;
     case kTfLiteInt8:
-      EvalQuantizedPerChannel(context, node, params, data, input, filter, bias,
-                              output);
-      break;
+      if (data.packed_weights != nullptr) {
+        EvalPackedPerChannel(params, data, input, filter, output);
+        break;
+      }
+      return EvalInt8Rows(context, node, params, data, input, filter, bias,
+                          output);
     case kTfLiteUInt8:
       EvalQuantized(context, node, params, data, input, filter, bias, output);
       break;
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -56,11 +57,16 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, 0);
   TF_LITE_ENSURE(context, output != nullptr);
 
+  // A float16 input is normally a constant folded into its consumers by the
+  // graph rewriter, see micro/graph_rewriter.h.
   TF_LITE_ENSURE(context, input->type == kTfLiteUInt8 ||
                               input->type == kTfLiteInt8 ||
-                              input->type == kTfLiteInt16);
+                              input->type == kTfLiteInt16 ||
+                              input->type == kTfLiteFloat16);
   TF_LITE_ENSURE(
       context, output->type == kTfLiteFloat32 || output->type == kTfLiteInt32);
+  TF_LITE_ENSURE(context, input->type != kTfLiteFloat16 ||
+                              output->type == kTfLiteFloat32);
 
   if (output->type == kTfLiteInt32) {
     const double effective_output_scale =
@@ -106,6 +112,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                                   tflite::micro::GetTensorShape(output),
                                   tflite::micro::GetTensorData<float>(output));
         break;
+      case kTfLiteFloat16:
+        Float16ToFloat(tflite::micro::GetTensorData<TfLiteFloat16>(input),
+                       MatchingFlatSize(tflite::micro::GetTensorShape(input),
+                                        tflite::micro::GetTensorShape(output)),
+                       tflite::micro::GetTensorData<float>(output));
+        break;
       default:
         TF_LITE_KERNEL_LOG(context, "Input %s, output %s not supported.",
                            TfLiteTypeGetName(input->type),
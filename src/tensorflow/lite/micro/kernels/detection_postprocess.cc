@@ -0,0 +1,803 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+
+// Micro implementation of the TFLite_Detection_PostProcess custom op emitted
+// for SSD heads. It decodes center-size box encodings against the anchors and
+// runs non max suppression, either over the best class of every box ("fast"
+// NMS) or class by class (`use_regular_nms`).
+//
+// Unlike the float kernel in TFLite, the class predictions are kept in their
+// quantized form: the score threshold is converted once to the integer
+// domain, boxes below it are dropped before anything is decoded, and the
+// survivors are ordered with a counting sort over the 256 possible scores.
+// Only boxes that reach the greedy NMS loop are decoded, and only the final
+// detections are dequantized.
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace detection_postprocess {
+
+constexpr int kInputTensorBoxEncodings = 0;
+constexpr int kInputTensorClassPredictions = 1;
+constexpr int kInputTensorAnchors = 2;
+
+constexpr int kOutputTensorDetectionBoxes = 0;
+constexpr int kOutputTensorDetectionClasses = 1;
+constexpr int kOutputTensorDetectionScores = 2;
+constexpr int kOutputTensorNumDetections = 3;
+
+constexpr int kNumCoordBox = 4;
+constexpr int kBatchSize = 1;
+
+// Number of distinct 8-bit scores, i.e. the number of counting sort buckets.
+constexpr int kNumScoreRanks = 256;
+
+struct CenterSizeEncoding {
+  float y;
+  float x;
+  float h;
+  float w;
+};
+
+struct BoxCornerEncoding {
+  float ymin;
+  float xmin;
+  float ymax;
+  float xmax;
+};
+
+// A box that survived NMS. `rank` is the quantized score mapped to [0, 255]
+// so that uint8 and int8 predictions order the same way.
+struct Detection {
+  BoxCornerEncoding box;
+  int32_t box_index;
+  int32_t class_index;
+  int32_t rank;
+};
+
+struct OpData {
+  int max_detections;
+  int max_classes_per_detection;
+  int detections_per_class;
+  bool use_regular_nms;
+  float non_max_suppression_score_threshold;
+  float intersection_over_union_threshold;
+  int num_classes;
+  CenterSizeEncoding scale_values;
+
+  // Derived in Prepare.
+  int num_boxes;
+  int num_classes_with_background;
+  int label_offset;
+  int box_stride;
+  // Smallest rank whose score passes the threshold; kNumScoreRanks when no
+  // score can pass.
+  int32_t rank_threshold;
+  // Added to a raw int8/uint8 score to obtain its rank.
+  int32_t rank_offset;
+  float scores_scale;
+  int32_t scores_zero_point;
+  float boxes_scale;
+  int32_t boxes_zero_point;
+  float anchors_scale;
+  int32_t anchors_zero_point;
+
+  int ranks_index;
+  int histogram_index;
+  int candidates_index;
+  int kept_index;
+  int merged_index;
+};
+
+// Minimal reader for the FlexBuffer map the converter stores as the custom
+// options of this op. Only scalar values (int, uint, float and bool, stored
+// inline or indirectly) are supported, which is all the op needs.
+class OptionsMap {
+ public:
+  OptionsMap(const uint8_t* buffer, size_t length)
+      : buffer_(buffer), end_(buffer + length) {}
+
+  // Locates the root map. Returns false if the buffer is not a FlexBuffer
+  // map.
+  bool Init() {
+    if (buffer_ == nullptr || end_ - buffer_ < 3) {
+      return false;
+    }
+    const int root_width = end_[-1];
+    const int root_packed_type = end_[-2];
+    const uint8_t* root = end_ - 2 - root_width;
+    if (!IsValidWidth(root_width) || !InBounds(root, root_width) ||
+        (root_packed_type >> 2) != kTypeMap) {
+      return false;
+    }
+    width_ = 1 << (root_packed_type & 3);
+    values_ = Indirect(root, root_width);
+    if (values_ == nullptr || !InBounds(values_ - 3 * width_, 3 * width_)) {
+      return false;
+    }
+    size_ = static_cast<int>(ReadUInt(values_ - width_, width_));
+    const uint8_t* keys_field = values_ - 3 * width_;
+    keys_ = Indirect(keys_field, width_);
+    keys_width_ = static_cast<int>(ReadUInt(values_ - 2 * width_, width_));
+    types_ = values_ + size_ * width_;
+    return keys_ != nullptr && IsValidWidth(keys_width_) &&
+           InBounds(keys_, size_ * keys_width_) &&
+           InBounds(values_, size_ * width_) && InBounds(types_, size_);
+  }
+
+  bool GetFloat(const char* key, float* value) const {
+    int type;
+    int width;
+    const uint8_t* data = Find(key, &type, &width);
+    if (data == nullptr) {
+      return false;
+    }
+    switch (type) {
+      case kTypeFloat:
+        if (width == 4) {
+          const uint32_t bits = static_cast<uint32_t>(ReadUInt(data, 4));
+          std::memcpy(value, &bits, sizeof(*value));
+        } else if (width == 8) {
+          const uint64_t bits = ReadUInt(data, 8);
+          double double_value;
+          std::memcpy(&double_value, &bits, sizeof(double_value));
+          *value = static_cast<float>(double_value);
+        } else {
+          return false;
+        }
+        return true;
+      case kTypeInt:
+        *value = static_cast<float>(ReadInt(data, width));
+        return true;
+      case kTypeUInt:
+        *value = static_cast<float>(ReadUInt(data, width));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  bool GetInt(const char* key, int* value) const {
+    int type;
+    int width;
+    const uint8_t* data = Find(key, &type, &width);
+    if (data == nullptr) {
+      return false;
+    }
+    switch (type) {
+      case kTypeInt:
+        *value = static_cast<int>(ReadInt(data, width));
+        return true;
+      case kTypeUInt:
+      case kTypeBool:
+        *value = static_cast<int>(ReadUInt(data, width));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  bool GetBool(const char* key, bool* value) const {
+    int int_value;
+    if (!GetInt(key, &int_value)) {
+      return false;
+    }
+    *value = int_value != 0;
+    return true;
+  }
+
+ private:
+  enum {
+    kTypeInt = 1,
+    kTypeUInt = 2,
+    kTypeFloat = 3,
+    kTypeIndirectInt = 6,
+    kTypeIndirectUInt = 7,
+    kTypeIndirectFloat = 8,
+    kTypeMap = 9,
+    kTypeBool = 26,
+  };
+
+  static bool IsValidWidth(int width) {
+    return width == 1 || width == 2 || width == 4 || width == 8;
+  }
+
+  // FlexBuffers are always little endian.
+  static uint64_t ReadUInt(const uint8_t* data, int width) {
+    uint64_t value = 0;
+    for (int i = width - 1; i >= 0; --i) {
+      value = (value << 8) | data[i];
+    }
+    return value;
+  }
+
+  static int64_t ReadInt(const uint8_t* data, int width) {
+    const uint64_t value = ReadUInt(data, width);
+    const int shift = 64 - 8 * width;
+    return static_cast<int64_t>(value << shift) >> shift;
+  }
+
+  bool InBounds(const uint8_t* data, int size) const {
+    return data >= buffer_ && size >= 0 && data + size <= end_;
+  }
+
+  // Follows the backwards offset stored at `field`.
+  const uint8_t* Indirect(const uint8_t* field, int width) const {
+    const uint64_t offset = ReadUInt(field, width);
+    if (offset > static_cast<uint64_t>(field - buffer_)) {
+      return nullptr;
+    }
+    return field - offset;
+  }
+
+  const uint8_t* Find(const char* key, int* type, int* width) const {
+    for (int i = 0; i < size_; ++i) {
+      const uint8_t* key_data =
+          Indirect(keys_ + i * keys_width_, keys_width_);
+      if (key_data == nullptr) {
+        return nullptr;
+      }
+      const size_t key_length = std::strlen(key) + 1;
+      if (!InBounds(key_data, key_length) ||
+          std::memcmp(key_data, key, key_length) != 0) {
+        continue;
+      }
+      const uint8_t* value = values_ + i * width_;
+      *type = types_[i] >> 2;
+      *width = width_;
+      if (*type >= kTypeIndirectInt && *type <= kTypeIndirectFloat) {
+        *type -= kTypeIndirectInt - kTypeInt;
+        *width = 1 << (types_[i] & 3);
+        value = Indirect(value, width_);
+        if (value == nullptr || !InBounds(value, *width)) {
+          return nullptr;
+        }
+      }
+      return value;
+    }
+    return nullptr;
+  }
+
+  const uint8_t* buffer_;
+  const uint8_t* end_;
+  const uint8_t* values_ = nullptr;
+  const uint8_t* keys_ = nullptr;
+  const uint8_t* types_ = nullptr;
+  int width_ = 0;
+  int keys_width_ = 0;
+  int size_ = 0;
+};
+
+template <typename T>
+inline float Dequantize(const T* data, int index, float scale,
+                        int32_t zero_point) {
+  return scale * (static_cast<int32_t>(data[index]) - zero_point);
+}
+
+template <>
+inline float Dequantize<float>(const float* data, int index, float scale,
+                               int32_t zero_point) {
+  return data[index];
+}
+
+// Reads four consecutive values of a float32, uint8 or int8 tensor as
+// floats.
+struct CenterSizeReader {
+  const TfLiteEvalTensor* tensor;
+  float scale;
+  int32_t zero_point;
+
+  template <typename T>
+  void ReadTyped(int offset, CenterSizeEncoding* out) const {
+    const T* data = tflite::micro::GetTensorData<T>(tensor);
+    out->y = Dequantize(data, offset + 0, scale, zero_point);
+    out->x = Dequantize(data, offset + 1, scale, zero_point);
+    out->h = Dequantize(data, offset + 2, scale, zero_point);
+    out->w = Dequantize(data, offset + 3, scale, zero_point);
+  }
+
+  void Read(int offset, CenterSizeEncoding* out) const {
+    switch (tensor->type) {
+      case kTfLiteUInt8:
+        ReadTyped<uint8_t>(offset, out);
+        break;
+      case kTfLiteInt8:
+        ReadTyped<int8_t>(offset, out);
+        break;
+      default:
+        ReadTyped<float>(offset, out);
+        break;
+    }
+  }
+};
+
+// Everything Eval needs to decode boxes and rank scores.
+struct EvalContext {
+  const OpData* data;
+  CenterSizeReader boxes;
+  CenterSizeReader anchors;
+  const uint8_t* scores;
+};
+
+void DecodeBox(const EvalContext& ctx, int box_index,
+               BoxCornerEncoding* decoded) {
+  const OpData* data = ctx.data;
+  CenterSizeEncoding box;
+  CenterSizeEncoding anchor;
+  ctx.boxes.Read(box_index * data->box_stride, &box);
+  ctx.anchors.Read(box_index * kNumCoordBox, &anchor);
+
+  const float y_center =
+      box.y / data->scale_values.y * anchor.h + anchor.y;
+  const float x_center =
+      box.x / data->scale_values.x * anchor.w + anchor.x;
+  const float half_h =
+      0.5f * std::exp(box.h / data->scale_values.h) * anchor.h;
+  const float half_w =
+      0.5f * std::exp(box.w / data->scale_values.w) * anchor.w;
+  decoded->ymin = y_center - half_h;
+  decoded->xmin = x_center - half_w;
+  decoded->ymax = y_center + half_h;
+  decoded->xmax = x_center + half_w;
+}
+
+float ComputeIntersectionOverUnion(const BoxCornerEncoding& box_i,
+                                   const BoxCornerEncoding& box_j) {
+  const float area_i = (box_i.ymax - box_i.ymin) * (box_i.xmax - box_i.xmin);
+  const float area_j = (box_j.ymax - box_j.ymin) * (box_j.xmax - box_j.xmin);
+  if (area_i <= 0 || area_j <= 0) {
+    return 0.0f;
+  }
+  const float intersection_ymin = std::fmax(box_i.ymin, box_j.ymin);
+  const float intersection_xmin = std::fmax(box_i.xmin, box_j.xmin);
+  const float intersection_ymax = std::fmin(box_i.ymax, box_j.ymax);
+  const float intersection_xmax = std::fmin(box_i.xmax, box_j.xmax);
+  const float intersection_area =
+      std::fmax(intersection_ymax - intersection_ymin, 0.0f) *
+      std::fmax(intersection_xmax - intersection_xmin, 0.0f);
+  return intersection_area / (area_i + area_j - intersection_area);
+}
+
+inline int32_t ScoreRank(const EvalContext& ctx, int box_index,
+                         int class_index) {
+  const OpData* data = ctx.data;
+  return static_cast<uint8_t>(
+      ctx.scores[box_index * data->num_classes_with_background +
+                 data->label_offset + class_index] +
+      data->rank_offset);
+}
+
+// Orders the boxes whose rank passes the threshold by decreasing rank, and by
+// increasing box index within a rank, with a counting sort. `ranks` holds the
+// rank of every box. Returns the number of candidates.
+int SortCandidates(const OpData* data, const uint8_t* ranks,
+                   int32_t* histogram, int32_t* candidates) {
+  const int rank_threshold = data->rank_threshold;
+  std::memset(histogram, 0, kNumScoreRanks * sizeof(int32_t));
+  for (int i = 0; i < data->num_boxes; ++i) {
+    ++histogram[ranks[i]];
+  }
+  // Turn the counts into the start offsets of every bucket, best rank first.
+  int num_candidates = 0;
+  for (int rank = kNumScoreRanks - 1; rank >= rank_threshold; --rank) {
+    const int count = histogram[rank];
+    histogram[rank] = num_candidates;
+    num_candidates += count;
+  }
+  for (int i = 0; i < data->num_boxes; ++i) {
+    const int rank = ranks[i];
+    if (rank >= rank_threshold) {
+      candidates[histogram[rank]++] = i;
+    }
+  }
+  return num_candidates;
+}
+
+// Greedy non max suppression over sorted candidates: a candidate is kept
+// unless it overlaps an already kept box by more than the IoU threshold.
+// Boxes are decoded only when they are reached, so at most `max_kept` boxes
+// plus the suppressed ones in between are ever decoded.
+int NonMaxSuppression(const EvalContext& ctx, const uint8_t* ranks,
+                      const int32_t* candidates, int num_candidates,
+                      int max_kept, Detection* kept) {
+  const float iou_threshold = ctx.data->intersection_over_union_threshold;
+  int num_kept = 0;
+  for (int i = 0; i < num_candidates && num_kept < max_kept; ++i) {
+    const int box_index = candidates[i];
+    Detection* detection = &kept[num_kept];
+    DecodeBox(ctx, box_index, &detection->box);
+    bool suppressed = false;
+    for (int j = 0; j < num_kept; ++j) {
+      if (ComputeIntersectionOverUnion(kept[j].box, detection->box) >
+          iou_threshold) {
+        suppressed = true;
+        break;
+      }
+    }
+    if (!suppressed) {
+      detection->box_index = box_index;
+      detection->rank = ranks[box_index];
+      ++num_kept;
+    }
+  }
+  return num_kept;
+}
+
+float DequantizeRank(const OpData* data, int32_t rank) {
+  return data->scores_scale *
+         (rank - data->rank_offset - data->scores_zero_point);
+}
+
+void WriteDetection(const OpData* data, const BoxCornerEncoding& box,
+                    int class_index, int32_t rank, int output_index,
+                    float* boxes, float* classes, float* scores) {
+  float* output_box = boxes + output_index * kNumCoordBox;
+  output_box[0] = box.ymin;
+  output_box[1] = box.xmin;
+  output_box[2] = box.ymax;
+  output_box[3] = box.xmax;
+  classes[output_index] = static_cast<float>(class_index);
+  scores[output_index] = DequantizeRank(data, rank);
+}
+
+// NMS over the best class of every box. Each kept box then reports its
+// `max_classes_per_detection` best classes.
+int FastNonMaxSuppression(TfLiteContext* context, const EvalContext& ctx,
+                          float* boxes, float* classes, float* scores) {
+  const OpData* data = ctx.data;
+  uint8_t* ranks =
+      static_cast<uint8_t*>(context->GetScratchBuffer(context,
+                                                      data->ranks_index));
+  int32_t* histogram = static_cast<int32_t*>(
+      context->GetScratchBuffer(context, data->histogram_index));
+  int32_t* candidates = static_cast<int32_t*>(
+      context->GetScratchBuffer(context, data->candidates_index));
+  Detection* kept = static_cast<Detection*>(
+      context->GetScratchBuffer(context, data->kept_index));
+
+  for (int i = 0; i < data->num_boxes; ++i) {
+    int32_t best = 0;
+    for (int c = 0; c < data->num_classes; ++c) {
+      const int32_t rank = ScoreRank(ctx, i, c);
+      best = rank > best ? rank : best;
+    }
+    ranks[i] = static_cast<uint8_t>(best);
+  }
+  const int num_candidates =
+      SortCandidates(data, ranks, histogram, candidates);
+  const int num_kept = NonMaxSuppression(ctx, ranks, candidates,
+                                         num_candidates, data->max_detections,
+                                         kept);
+
+  const int classes_per_box = data->max_classes_per_detection;
+  for (int k = 0; k < num_kept; ++k) {
+    const int box_index = kept[k].box_index;
+    // Selection of the best classes: each round takes the best class that
+    // ranks strictly after the previous pick (higher rank, then lower index).
+    int32_t previous_rank = kNumScoreRanks;
+    int previous_class = -1;
+    for (int n = 0; n < classes_per_box; ++n) {
+      int best_class = -1;
+      int32_t best_rank = -1;
+      for (int c = 0; c < data->num_classes; ++c) {
+        const int32_t rank = ScoreRank(ctx, box_index, c);
+        const bool after_previous =
+            rank < previous_rank ||
+            (rank == previous_rank && c > previous_class);
+        if (after_previous && rank > best_rank) {
+          best_rank = rank;
+          best_class = c;
+        }
+      }
+      WriteDetection(data, kept[k].box, best_class, best_rank,
+                     k * classes_per_box + n, boxes, classes, scores);
+      previous_rank = best_rank;
+      previous_class = best_class;
+    }
+  }
+  return num_kept * classes_per_box;
+}
+
+// NMS run separately for every class, keeping up to `detections_per_class`
+// boxes each, followed by a merge that keeps the `max_detections` best.
+int RegularNonMaxSuppression(TfLiteContext* context, const EvalContext& ctx,
+                             float* boxes, float* classes, float* scores) {
+  const OpData* data = ctx.data;
+  uint8_t* ranks =
+      static_cast<uint8_t*>(context->GetScratchBuffer(context,
+                                                      data->ranks_index));
+  int32_t* histogram = static_cast<int32_t*>(
+      context->GetScratchBuffer(context, data->histogram_index));
+  int32_t* candidates = static_cast<int32_t*>(
+      context->GetScratchBuffer(context, data->candidates_index));
+  Detection* kept = static_cast<Detection*>(
+      context->GetScratchBuffer(context, data->kept_index));
+  Detection* merged = static_cast<Detection*>(
+      context->GetScratchBuffer(context, data->merged_index));
+
+  int num_merged = 0;
+  for (int c = 0; c < data->num_classes; ++c) {
+    for (int i = 0; i < data->num_boxes; ++i) {
+      ranks[i] = static_cast<uint8_t>(ScoreRank(ctx, i, c));
+    }
+    const int num_candidates =
+        SortCandidates(data, ranks, histogram, candidates);
+    const int num_kept =
+        NonMaxSuppression(ctx, ranks, candidates, num_candidates,
+                          data->detections_per_class, kept);
+
+    // Kept boxes come best first, so the first one that does not make it
+    // into the merged list ends the class.
+    for (int k = 0; k < num_kept; ++k) {
+      int position = num_merged;
+      while (position > 0 && merged[position - 1].rank < kept[k].rank) {
+        --position;
+      }
+      if (position >= data->max_detections) {
+        break;
+      }
+      const int last = num_merged < data->max_detections
+                           ? num_merged
+                           : data->max_detections - 1;
+      for (int m = last; m > position; --m) {
+        merged[m] = merged[m - 1];
+      }
+      merged[position] = kept[k];
+      merged[position].class_index = c;
+      if (num_merged < data->max_detections) {
+        ++num_merged;
+      }
+    }
+  }
+
+  for (int m = 0; m < num_merged; ++m) {
+    WriteDetection(data, merged[m].box, merged[m].class_index, merged[m].rank,
+                   m, boxes, classes, scores);
+  }
+  return num_merged;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  OpData* data = static_cast<OpData*>(
+      context->AllocatePersistentBuffer(context, sizeof(OpData)));
+  if (data == nullptr) {
+    return nullptr;
+  }
+
+  OptionsMap options(reinterpret_cast<const uint8_t*>(buffer), length);
+  // Defaults match the converter's; every option is normally present.
+  data->max_detections = 0;
+  data->max_classes_per_detection = 1;
+  data->detections_per_class = 100;
+  data->use_regular_nms = false;
+  data->non_max_suppression_score_threshold = 0.0f;
+  data->intersection_over_union_threshold = 0.0f;
+  data->num_classes = 0;
+  data->scale_values.y = 10.0f;
+  data->scale_values.x = 10.0f;
+  data->scale_values.h = 5.0f;
+  data->scale_values.w = 5.0f;
+  if (options.Init()) {
+    options.GetInt("max_detections", &data->max_detections);
+    options.GetInt("max_classes_per_detection",
+                   &data->max_classes_per_detection);
+    options.GetInt("detections_per_class", &data->detections_per_class);
+    options.GetBool("use_regular_nms", &data->use_regular_nms);
+    options.GetFloat("nms_score_threshold",
+                     &data->non_max_suppression_score_threshold);
+    options.GetFloat("nms_iou_threshold",
+                     &data->intersection_over_union_threshold);
+    options.GetInt("num_classes", &data->num_classes);
+    options.GetFloat("y_scale", &data->scale_values.y);
+    options.GetFloat("x_scale", &data->scale_values.x);
+    options.GetFloat("h_scale", &data->scale_values.h);
+    options.GetFloat("w_scale", &data->scale_values.w);
+  }
+  return data;
+}
+
+TfLiteStatus EnsureBoxInputType(TfLiteContext* context,
+                                const TfLiteTensor* input) {
+  if (input->type != kTfLiteFloat32 && input->type != kTfLiteUInt8 &&
+      input->type != kTfLiteInt8) {
+    TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                       TfLiteTypeGetName(input->type), input->type);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE(context, node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 4);
+
+  const TfLiteTensor* box_encodings =
+      GetInput(context, node, kInputTensorBoxEncodings);
+  TF_LITE_ENSURE(context, box_encodings != nullptr);
+  const TfLiteTensor* class_predictions =
+      GetInput(context, node, kInputTensorClassPredictions);
+  TF_LITE_ENSURE(context, class_predictions != nullptr);
+  const TfLiteTensor* anchors = GetInput(context, node, kInputTensorAnchors);
+  TF_LITE_ENSURE(context, anchors != nullptr);
+
+  TF_LITE_ENSURE(context, data->max_detections > 0);
+  TF_LITE_ENSURE(context, data->max_classes_per_detection > 0);
+  TF_LITE_ENSURE(context, data->num_classes > 0);
+  TF_LITE_ENSURE(context, data->max_classes_per_detection <=
+                              data->num_classes);
+  if (data->use_regular_nms) {
+    TF_LITE_ENSURE(context, data->detections_per_class > 0);
+  }
+
+  TF_LITE_ENSURE_EQ(context, NumDimensions(box_encodings), 3);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(class_predictions), 3);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(anchors), 2);
+  TF_LITE_ENSURE_EQ(context, box_encodings->dims->data[0], kBatchSize);
+  TF_LITE_ENSURE_EQ(context, class_predictions->dims->data[0], kBatchSize);
+  const int num_boxes = box_encodings->dims->data[1];
+  TF_LITE_ENSURE_EQ(context, class_predictions->dims->data[1], num_boxes);
+  TF_LITE_ENSURE_EQ(context, anchors->dims->data[0], num_boxes);
+  TF_LITE_ENSURE_EQ(context, anchors->dims->data[1], kNumCoordBox);
+  TF_LITE_ENSURE(context, box_encodings->dims->data[2] >= kNumCoordBox);
+
+  data->num_boxes = num_boxes;
+  data->box_stride = box_encodings->dims->data[2];
+  data->num_classes_with_background = class_predictions->dims->data[2];
+  data->label_offset =
+      data->num_classes_with_background - data->num_classes;
+  TF_LITE_ENSURE(context, data->label_offset == 0 || data->label_offset == 1);
+
+  TF_LITE_ENSURE_STATUS(EnsureBoxInputType(context, box_encodings));
+  TF_LITE_ENSURE_STATUS(EnsureBoxInputType(context, anchors));
+  data->boxes_scale = box_encodings->params.scale;
+  data->boxes_zero_point = box_encodings->params.zero_point;
+  data->anchors_scale = anchors->params.scale;
+  data->anchors_zero_point = anchors->params.zero_point;
+
+  // NMS works on the raw scores, which requires 8-bit predictions.
+  if (class_predictions->type == kTfLiteUInt8) {
+    data->rank_offset = 0;
+  } else if (class_predictions->type == kTfLiteInt8) {
+    data->rank_offset = 128;
+  } else {
+    TF_LITE_KERNEL_LOG(context,
+                       "Class predictions of type %s (%d) not supported, "
+                       "TFLite_Detection_PostProcess requires uint8 or int8.",
+                       TfLiteTypeGetName(class_predictions->type),
+                       class_predictions->type);
+    return kTfLiteError;
+  }
+  data->scores_scale = class_predictions->params.scale;
+  data->scores_zero_point = class_predictions->params.zero_point;
+  TF_LITE_ENSURE(context, data->scores_scale > 0.0f);
+
+  // A raw score q passes when scale * (q - zero_point) >= threshold, that is
+  // when q >= ceil(threshold / scale + zero_point).
+  const float raw_threshold =
+      std::ceil(data->non_max_suppression_score_threshold /
+                    data->scores_scale +
+                data->scores_zero_point);
+  float rank_threshold = raw_threshold + data->rank_offset;
+  rank_threshold = std::fmax(rank_threshold, 0.0f);
+  rank_threshold =
+      std::fmin(rank_threshold, static_cast<float>(kNumScoreRanks));
+  data->rank_threshold = static_cast<int32_t>(rank_threshold);
+
+  const int num_detected_boxes =
+      data->max_detections * data->max_classes_per_detection;
+  const int num_expected_elements[] = {num_detected_boxes * kNumCoordBox,
+                                       num_detected_boxes, num_detected_boxes,
+                                       1};
+  for (int i = 0; i < 4; ++i) {
+    TfLiteTensor* output = GetOutput(context, node, i);
+    TF_LITE_ENSURE(context, output != nullptr);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, NumElements(output), num_expected_elements[i]);
+  }
+
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, num_boxes * sizeof(uint8_t), &data->ranks_index));
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, kNumScoreRanks * sizeof(int32_t), &data->histogram_index));
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, num_boxes * sizeof(int32_t), &data->candidates_index));
+  const int max_kept = data->use_regular_nms ? data->detections_per_class
+                                             : data->max_detections;
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, max_kept * sizeof(Detection), &data->kept_index));
+  data->merged_index = -1;
+  if (data->use_regular_nms) {
+    TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+        context, data->max_detections * sizeof(Detection),
+        &data->merged_index));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+
+  const TfLiteEvalTensor* box_encodings =
+      tflite::micro::GetEvalInput(context, node, kInputTensorBoxEncodings);
+  const TfLiteEvalTensor* class_predictions =
+      tflite::micro::GetEvalInput(context, node, kInputTensorClassPredictions);
+  const TfLiteEvalTensor* anchors =
+      tflite::micro::GetEvalInput(context, node, kInputTensorAnchors);
+  TfLiteEvalTensor* detection_boxes =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensorDetectionBoxes);
+  TfLiteEvalTensor* detection_classes = tflite::micro::GetEvalOutput(
+      context, node, kOutputTensorDetectionClasses);
+  TfLiteEvalTensor* detection_scores = tflite::micro::GetEvalOutput(
+      context, node, kOutputTensorDetectionScores);
+  TfLiteEvalTensor* num_detections =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensorNumDetections);
+
+  EvalContext ctx;
+  ctx.data = data;
+  ctx.boxes = {box_encodings, data->boxes_scale, data->boxes_zero_point};
+  ctx.anchors = {anchors, data->anchors_scale, data->anchors_zero_point};
+  ctx.scores = tflite::micro::GetTensorData<uint8_t>(class_predictions);
+
+  float* boxes = tflite::micro::GetTensorData<float>(detection_boxes);
+  float* classes = tflite::micro::GetTensorData<float>(detection_classes);
+  float* scores = tflite::micro::GetTensorData<float>(detection_scores);
+  const int num_detected_boxes =
+      data->max_detections * data->max_classes_per_detection;
+  std::memset(boxes, 0, num_detected_boxes * kNumCoordBox * sizeof(float));
+  std::memset(classes, 0, num_detected_boxes * sizeof(float));
+  std::memset(scores, 0, num_detected_boxes * sizeof(float));
+
+  const int num_valid =
+      data->use_regular_nms
+          ? RegularNonMaxSuppression(context, ctx, boxes, classes, scores)
+          : FastNonMaxSuppression(context, ctx, boxes, classes, scores);
+  tflite::micro::GetTensorData<float>(num_detections)[0] =
+      static_cast<float>(num_valid);
+  return kTfLiteOk;
+}
+
+}  // namespace detection_postprocess
+
+TfLiteRegistration* Register_DETECTION_POSTPROCESS() {
+  static TfLiteRegistration r = {/*init=*/detection_postprocess::Init,
+                                 /*free=*/nullptr,
+                                 /*prepare=*/detection_postprocess::Prepare,
+                                 /*invoke=*/detection_postprocess::Eval,
+                                 /*profiling_string=*/nullptr,
+                                 /*builtin_code=*/0,
+                                 /*custom_name=*/nullptr,
+                                 /*version=*/0};
+  return &r;
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
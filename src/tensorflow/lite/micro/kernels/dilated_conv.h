@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_DILATED_CONV_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_DILATED_CONV_H_
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+// The int8 CONV_2D and DEPTHWISE_CONV_2D kernels for dilated filters skip the
+// filter taps that fall in the padding without testing each of them. The taps
+// of a window that land inside the input form one range, computed once per
+// output row and per border column. The interior pixels, whose windows lie
+// entirely inside the input, run all taps through the inner loops of the
+// undilated kernels.
+
+// Sets [begin, end) to the taps of a window of `filter_size` taps, `dilation`
+// apart and starting at input position `origin`, that land inside an input of
+// `input_size` positions.
+inline void ValidTapRange(int origin, int dilation, int filter_size,
+                          int input_size, int* begin, int* end) {
+  *begin = origin < 0 ? (dilation - 1 - origin) / dilation : 0;
+  *end = input_size > origin
+             ? (input_size - origin + dilation - 1) / dilation
+             : 0;
+  if (*end > filter_size) {
+    *end = filter_size;
+  }
+  if (*end < *begin) {
+    *end = *begin;
+  }
+}
+
+// Sets [begin, end) to the outputs whose windows lie entirely inside the
+// input.
+inline void InteriorOutputRange(int stride, int dilation, int filter_size,
+                                int padding, int input_size, int output_size,
+                                int* begin, int* end) {
+  const int last_origin = input_size - 1 - (filter_size - 1) * dilation;
+  *begin = (padding + stride - 1) / stride;
+  *end = last_origin + padding >= 0 ? (last_origin + padding) / stride + 1 : 0;
+  if (*begin > output_size) {
+    *begin = output_size;
+  }
+  if (*end > output_size) {
+    *end = output_size;
+  }
+  if (*end < *begin) {
+    *end = *begin;
+  }
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_DILATED_CONV_H_
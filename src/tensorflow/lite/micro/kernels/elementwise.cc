@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cmath>
+#include <cstring>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -27,8 +28,153 @@ namespace micro {
 namespace elementwise {
 namespace {
 
+// Number of entries of the interpolated int16 lookup table: one every 128
+// input steps plus the end point.
+constexpr int kInt16TableSize = 513;
+constexpr int kInt16NumSegments = kInt16TableSize - 1;
+// Largest interpolation error, in output steps, accepted for a segment of the
+// int16 table before its inputs are evaluated in float instead.
+constexpr float kInt16MaxTableError = 2.0f;
+// Allowance, in output steps, for the float rounding of the functions in the
+// bound of the interpolation error.
+constexpr float kInt16FloatMargin = 0.1f;
+
+struct OpData {
+  // Lookup tables for quantized inputs, built in Prepare from the input and
+  // output quantization parameters. The int8 table has one entry per input
+  // value, indexed by `input + 128`. The int16 table is linearly
+  // interpolated, see LookupInt16.
+  int8_t* int8_table;
+  int16_t* int16_table;
+  // One bit per int16 table segment that interpolates poorly, typically next
+  // to a singularity such as LOG or RSQRT at 0. Inputs in those segments are
+  // computed in float.
+  uint32_t* int16_exact_segments;
+  float input_scale;
+  float output_scale;
+};
+
+typedef float (*FloatFunc)(float);
+
+float Abs(float x) { return std::abs(x); }
+float Sin(float x) { return std::sin(x); }
+float Cos(float x) { return std::cos(x); }
+float Exp(float x) { return std::exp(x); }
+float Log(float x) { return std::log(x); }
+float Sqrt(float x) { return std::sqrt(x); }
+float Rsqrt(float x) { return 1.f / std::sqrt(x); }
+float Square(float x) { return x * x; }
+
+// Ranges of the second derivatives of the functions over [lo, hi], which bound
+// the interpolation error of the int16 table. Return false where the function
+// is not twice differentiable. Inputs outside the domain give NaN, a constant
+// output, so ranges below the domain have a second derivative of 0.
+typedef bool (*SecondDerivativeRange)(float lo, float hi, float* min_value,
+                                      float* max_value);
+
+// Range of sin over [lo, hi].
+void SinRange(float lo, float hi, float* min_value, float* max_value) {
+  constexpr float kHalfPi = 1.57079632679f;
+  constexpr float kTwoPi = 6.28318530718f;
+  *min_value = std::fmin(std::sin(lo), std::sin(hi));
+  *max_value = std::fmax(std::sin(lo), std::sin(hi));
+  // Peaks at pi / 2 + 2 pi k, troughs at -pi / 2 + 2 pi k.
+  if (std::floor((hi - kHalfPi) / kTwoPi) >
+      std::floor((lo - kHalfPi) / kTwoPi)) {
+    *max_value = 1.0f;
+  }
+  if (std::floor((hi + kHalfPi) / kTwoPi) >
+      std::floor((lo + kHalfPi) / kTwoPi)) {
+    *min_value = -1.0f;
+  }
+}
+
+bool AbsSecondDerivative(float lo, float hi, float* min_value,
+                         float* max_value) {
+  *min_value = 0.0f;
+  *max_value = 0.0f;
+  return lo >= 0.0f || hi <= 0.0f;
+}
+
+bool SinSecondDerivative(float lo, float hi, float* min_value,
+                         float* max_value) {
+  float min_sin;
+  float max_sin;
+  SinRange(lo, hi, &min_sin, &max_sin);
+  *min_value = -max_sin;
+  *max_value = -min_sin;
+  return true;
+}
+
+// cos(x) = sin(x + pi / 2).
+bool CosSecondDerivative(float lo, float hi, float* min_value,
+                         float* max_value) {
+  constexpr float kHalfPi = 1.57079632679f;
+  return SinSecondDerivative(lo + kHalfPi, hi + kHalfPi, min_value, max_value);
+}
+
+bool ExpSecondDerivative(float lo, float hi, float* min_value,
+                         float* max_value) {
+  *min_value = std::exp(lo);
+  *max_value = std::exp(hi);
+  return true;
+}
+
+bool LogSecondDerivative(float lo, float hi, float* min_value,
+                         float* max_value) {
+  *min_value = 0.0f;
+  *max_value = 0.0f;
+  if (hi < 0.0f) {
+    return true;
+  }
+  if (lo <= 0.0f) {
+    return false;
+  }
+  *min_value = -1.0f / (lo * lo);
+  *max_value = -1.0f / (hi * hi);
+  return true;
+}
+
+bool SqrtSecondDerivative(float lo, float hi, float* min_value,
+                          float* max_value) {
+  *min_value = 0.0f;
+  *max_value = 0.0f;
+  if (hi < 0.0f) {
+    return true;
+  }
+  if (lo <= 0.0f) {
+    return false;
+  }
+  *min_value = -0.25f / (lo * std::sqrt(lo));
+  *max_value = -0.25f / (hi * std::sqrt(hi));
+  return true;
+}
+
+bool RsqrtSecondDerivative(float lo, float hi, float* min_value,
+                           float* max_value) {
+  *min_value = 0.0f;
+  *max_value = 0.0f;
+  if (hi < 0.0f) {
+    return true;
+  }
+  if (lo <= 0.0f) {
+    return false;
+  }
+  *min_value = 0.75f / (hi * hi * std::sqrt(hi));
+  *max_value = 0.75f / (lo * lo * std::sqrt(lo));
+  return true;
+}
+
+bool SquareSecondDerivative(float lo, float hi, float* min_value,
+                            float* max_value) {
+  *min_value = 2.0f;
+  *max_value = 2.0f;
+  return true;
+}
+
 bool IsNumericSupportedType(const TfLiteType type) {
-  return type == kTfLiteFloat32;
+  return type == kTfLiteFloat32 || type == kTfLiteInt8 ||
+         type == kTfLiteInt16;
 }
 
 bool IsLogicalSupportedType(const TfLiteType type) {
@@ -36,7 +182,7 @@ bool IsLogicalSupportedType(const TfLiteType type) {
 }
 
 typedef bool (*IsSupportedType)(TfLiteType);
-template <IsSupportedType>
+template <IsSupportedType is_supported_type>
 TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -45,7 +191,7 @@ TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, 0);
   TF_LITE_ENSURE(context, output != nullptr);
   TF_LITE_ENSURE_TYPES_EQ(context, input->type, output->type);
-  if (!IsSupportedType(input->type)) {
+  if (!is_supported_type(input->type)) {
     TF_LITE_KERNEL_LOG(context, "Input data type %s (%d) is not supported.",
                        TfLiteTypeGetName(input->type), input->type);
     return kTfLiteError;
@@ -53,6 +199,193 @@ TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+// Rounds `value / scale` to the nearest integer in [min_value, max_value].
+// Results outside the function domain (NaN) map to the real value 0.
+float QuantizeAndClamp(float value, float scale, int32_t zero_point,
+                       float min_value, float max_value) {
+  if (std::isnan(value)) {
+    return static_cast<float>(zero_point);
+  }
+  const float quantized = std::round(value / scale) + zero_point;
+  return std::fmin(std::fmax(quantized, min_value), max_value);
+}
+
+void PopulateInt8Table(FloatFunc func, const TfLiteTensor* input,
+                       const TfLiteTensor* output, int8_t* table) {
+  const float input_scale = input->params.scale;
+  const int32_t input_zero_point = input->params.zero_point;
+  for (int i = 0; i < 256; ++i) {
+    const float value = input_scale * (i - 128 - input_zero_point);
+    table[i] = static_cast<int8_t>(
+        QuantizeAndClamp(func(value), output->params.scale,
+                         output->params.zero_point, -128.0f, 127.0f));
+  }
+}
+
+// Samples `func` every 128 input steps. Each entry is biased by half of the
+// interpolation error at the middle of its segment, which halves the
+// worst-case error of the lookup for curved functions.
+void PopulateInt16Table(FloatFunc func, const TfLiteTensor* input,
+                        const TfLiteTensor* output, int16_t* table) {
+  const float input_scale = input->params.scale;
+  const float output_scale = output->params.scale;
+  auto sample = [&](int32_t input_value) {
+    return QuantizeAndClamp(func(input_scale * input_value), output_scale, 0,
+                            -32768.0f, 32767.0f);
+  };
+  for (int i = 0; i < kInt16TableSize - 1; ++i) {
+    const int32_t input_value = i * 128 - 32768;
+    const float value = sample(input_value);
+    const float next_value = sample(input_value + 128);
+    const float midpoint_value = sample(input_value + 64);
+    const float midpoint_interpolated = std::round((value + next_value) / 2);
+    const float bias = std::round((midpoint_interpolated - midpoint_value) / 2);
+    table[i] = static_cast<int16_t>(
+        std::fmin(std::fmax(value - bias, -32768.0f), 32767.0f));
+  }
+  table[kInt16TableSize - 1] = static_cast<int16_t>(sample(32768));
+}
+
+inline int16_t LookupInt16(const int16_t* table, int16_t value) {
+  const int32_t shifted = static_cast<int32_t>(value) + 32768;
+  const int32_t index = shifted >> 7;
+  const int32_t offset = shifted & 0x7f;
+  const int32_t base = table[index];
+  const int32_t slope = table[index + 1] - base;
+  return static_cast<int16_t>(base + ((slope * offset + 64) >> 7));
+}
+
+inline int16_t EvalInt16(FloatFunc func, float input_scale,
+                         float output_scale, int16_t value) {
+  return static_cast<int16_t>(QuantizeAndClamp(
+      func(input_scale * value), output_scale, 0, -32768.0f, 32767.0f));
+}
+
+// Largest value over u in [0, 1] of 4 u (1 - u) error - ((1 - u) offset +
+// u next_offset), for an error of at least 0.
+float MaxDeviation(float error, float offset, float next_offset) {
+  float max_deviation = std::fmax(-offset, -next_offset);
+  if (error > 0.0f) {
+    const float u = (4 * error - (next_offset - offset)) / (8 * error);
+    if (u > 0.0f && u < 1.0f) {
+      max_deviation =
+          std::fmax(max_deviation, 4 * u * (1 - u) * error -
+                                       ((1 - u) * offset + u * next_offset));
+    }
+  }
+  return max_deviation;
+}
+
+// Flags the table segments whose interpolation may be more than
+// kInt16MaxTableError steps off, from the knots of each segment alone.
+//
+// At u = (x - lo) / h between two knots h apart, the lookup rounds the
+// interpolated entries, which are off from the exact output by the offsets of
+// the entries at the knots, interpolated, and by the interpolation error
+// h^2 u (1 - u) f''(x') / 2 for some x' in the segment. The extremes of f''
+// bound the latter. The exact output is rounded too, and two rounded values
+// whose difference D is in [-2, 2) are at most 2 apart.
+void FindInt16ExactSegments(FloatFunc func,
+                            SecondDerivativeRange second_derivative,
+                            const TfLiteTensor* input,
+                            const TfLiteTensor* output, const int16_t* table,
+                            uint32_t* exact_segments) {
+  const float input_scale = input->params.scale;
+  const float output_scale = output->params.scale;
+  const float step = 128 * input_scale;
+  const float interpolation_scale = step * step / (8 * output_scale);
+  // Unrounded output at a knot, with NaN mapping to 0 as in QuantizeAndClamp.
+  auto knot_value = [&](int knot) {
+    const float value =
+        func(input_scale * (knot * 128 - 32768)) / output_scale;
+    return std::isnan(value) ? 0.0f : value;
+  };
+  // Unrounded and clamped output at a knot minus its table entry.
+  auto knot_offset = [&](int knot, float value) {
+    return std::fmin(std::fmax(value, -32768.0f), 32767.0f) - table[knot];
+  };
+  float value = knot_value(0);
+  float offset = knot_offset(0, value);
+  for (int i = 0; i < kInt16NumSegments; ++i) {
+    const float next_value = knot_value(i + 1);
+    const float next_offset = knot_offset(i + 1, next_value);
+    const float lo = input_scale * (i * 128 - 32768);
+    float min_second_derivative;
+    float max_second_derivative;
+    bool exact = !second_derivative(lo, lo + step, &min_second_derivative,
+                                    &max_second_derivative);
+    // Extremes of the interpolated minus the exact output at u = 1 / 2, in
+    // output steps.
+    float min_error =
+        interpolation_scale * std::fmin(min_second_derivative, 0.0f);
+    float max_error =
+        interpolation_scale * std::fmax(max_second_derivative, 0.0f);
+    const float min_output = std::fmin(value, next_value) - max_error;
+    const float max_output = std::fmax(value, next_value) - min_error;
+    if (min_output >= 32767.0f || max_output <= -32768.0f) {
+      // Clamped throughout, like both knots.
+      min_error = 0.0f;
+      max_error = 0.0f;
+    } else if (!(min_output >= -32768.0f && max_output <= 32767.0f)) {
+      // Clamped in part of the segment only, or not finite.
+      exact = true;
+    }
+    // D is at most MaxDeviation(max_error, ...) and at least
+    // -MaxDeviation(-min_error, ...).
+    const float max_deviation =
+        std::fmax(MaxDeviation(max_error, offset, next_offset),
+                  MaxDeviation(-min_error, -offset, -next_offset));
+    if (exact ||
+        !(max_deviation + kInt16FloatMargin < kInt16MaxTableError)) {
+      exact_segments[i >> 5] |= 1u << (i & 31);
+    }
+    value = next_value;
+    offset = next_offset;
+  }
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+template <FloatFunc func, SecondDerivativeRange second_derivative>
+TfLiteStatus NumericPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(
+      GenericPrepare<IsNumericSupportedType>(context, node));
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  data->int8_table = nullptr;
+  data->int16_table = nullptr;
+  data->int16_exact_segments = nullptr;
+
+  const TfLiteTensor* input = GetInput(context, node, 0);
+  const TfLiteTensor* output = GetOutput(context, node, 0);
+  if (input->type == kTfLiteInt8) {
+    data->int8_table = static_cast<int8_t*>(
+        context->AllocatePersistentBuffer(context, 256 * sizeof(int8_t)));
+    TF_LITE_ENSURE(context, data->int8_table != nullptr);
+    PopulateInt8Table(func, input, output, data->int8_table);
+  } else if (input->type == kTfLiteInt16) {
+    TF_LITE_ENSURE_EQ(context, input->params.zero_point, 0);
+    TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
+    data->int16_table = static_cast<int16_t*>(context->AllocatePersistentBuffer(
+        context, kInt16TableSize * sizeof(int16_t)));
+    TF_LITE_ENSURE(context, data->int16_table != nullptr);
+    PopulateInt16Table(func, input, output, data->int16_table);
+    const size_t exact_segments_bytes = kInt16NumSegments / 8;
+    data->int16_exact_segments = static_cast<uint32_t*>(
+        context->AllocatePersistentBuffer(context, exact_segments_bytes));
+    TF_LITE_ENSURE(context, data->int16_exact_segments != nullptr);
+    std::memset(data->int16_exact_segments, 0, exact_segments_bytes);
+    FindInt16ExactSegments(func, second_derivative, input, output,
+                           data->int16_table, data->int16_exact_segments);
+    data->input_scale = input->params.scale;
+    data->output_scale = output->params.scale;
+  }
+  return kTfLiteOk;
+}
+
 template <typename T>
 inline TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node,
                              T func(T), TfLiteType expected_type) {
@@ -68,9 +401,47 @@ inline TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
-inline TfLiteStatus EvalNumeric(TfLiteContext* context, TfLiteNode* node,
-                                float float_func(float)) {
-  return EvalImpl<float>(context, node, float_func, kTfLiteFloat32);
+template <FloatFunc func>
+TfLiteStatus NumericEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, 0);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
+  const size_t num_elements = ElementCount(*input->dims);
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+      return EvalImpl<float>(context, node, func, kTfLiteFloat32);
+    case kTfLiteInt8: {
+      const int8_t* in_data = tflite::micro::GetTensorData<int8_t>(input);
+      int8_t* out_data = tflite::micro::GetTensorData<int8_t>(output);
+      const int8_t* table = data->int8_table;
+      for (size_t i = 0; i < num_elements; ++i) {
+        out_data[i] = table[static_cast<uint8_t>(in_data[i] + 128)];
+      }
+      return kTfLiteOk;
+    }
+    case kTfLiteInt16: {
+      const int16_t* in_data = tflite::micro::GetTensorData<int16_t>(input);
+      int16_t* out_data = tflite::micro::GetTensorData<int16_t>(output);
+      const uint32_t* exact_segments = data->int16_exact_segments;
+      for (size_t i = 0; i < num_elements; ++i) {
+        const int16_t value = in_data[i];
+        const int32_t segment = (static_cast<int32_t>(value) + 32768) >> 7;
+        if (exact_segments[segment >> 5] & (1u << (segment & 31))) {
+          out_data[i] =
+              EvalInt16(func, data->input_scale, data->output_scale, value);
+        } else {
+          out_data[i] = LookupInt16(data->int16_table, value);
+        }
+      }
+      return kTfLiteOk;
+    }
+    default:
+      TF_LITE_KERNEL_LOG(context, "Input data type %s (%d) is not supported.",
+                         TfLiteTypeGetName(input->type), input->type);
+      return kTfLiteError;
+  }
 }
 
 inline TfLiteStatus EvalLogical(TfLiteContext* context, TfLiteNode* node,
@@ -78,34 +449,6 @@ inline TfLiteStatus EvalLogical(TfLiteContext* context, TfLiteNode* node,
   return EvalImpl<bool>(context, node, bool_func, kTfLiteBool);
 }
 
-TfLiteStatus AbsEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, std::abs);
-}
-
-TfLiteStatus SinEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, std::sin);
-}
-
-TfLiteStatus CosEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, std::cos);
-}
-
-TfLiteStatus LogEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, std::log);
-}
-
-TfLiteStatus SqrtEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, std::sqrt);
-}
-
-TfLiteStatus RsqrtEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, [](float f) { return 1.f / std::sqrt(f); });
-}
-
-TfLiteStatus SquareEval(TfLiteContext* context, TfLiteNode* node) {
-  return EvalNumeric(context, node, [](float f) { return f * f; });
-}
-
 TfLiteStatus LogicalNotEval(TfLiteContext* context, TfLiteNode* node) {
   return EvalLogical(context, node, [](bool v) { return !v; });
 }
@@ -114,11 +457,12 @@ TfLiteStatus LogicalNotEval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace elementwise
 
 TfLiteRegistration Register_ABS() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::AbsEval,
+              elementwise::NumericPrepare<elementwise::Abs,
+                                          elementwise::AbsSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Abs>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -126,11 +470,12 @@ TfLiteRegistration Register_ABS() {
 }
 
 TfLiteRegistration Register_SIN() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::SinEval,
+              elementwise::NumericPrepare<elementwise::Sin,
+                                          elementwise::SinSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Sin>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -138,11 +483,25 @@ TfLiteRegistration Register_SIN() {
 }
 
 TfLiteRegistration Register_COS() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::CosEval,
+              elementwise::NumericPrepare<elementwise::Cos,
+                                          elementwise::CosSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Cos>,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+TfLiteRegistration Register_EXP() {
+  return {/*init=*/elementwise::Init,
+          /*free=*/nullptr,
+          /*prepare=*/
+              elementwise::NumericPrepare<elementwise::Exp,
+                                          elementwise::ExpSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Exp>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -150,11 +509,12 @@ TfLiteRegistration Register_COS() {
 }
 
 TfLiteRegistration Register_LOG() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::LogEval,
+              elementwise::NumericPrepare<elementwise::Log,
+                                          elementwise::LogSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Log>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -162,11 +522,12 @@ TfLiteRegistration Register_LOG() {
 }
 
 TfLiteRegistration Register_SQRT() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::SqrtEval,
+              elementwise::NumericPrepare<elementwise::Sqrt,
+                                          elementwise::SqrtSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Sqrt>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -174,11 +535,12 @@ TfLiteRegistration Register_SQRT() {
 }
 
 TfLiteRegistration Register_RSQRT() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::RsqrtEval,
+              elementwise::NumericPrepare<elementwise::Rsqrt,
+                                          elementwise::RsqrtSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Rsqrt>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
@@ -186,11 +548,12 @@ TfLiteRegistration Register_RSQRT() {
 }
 
 TfLiteRegistration Register_SQUARE() {
-  return {/*init=*/nullptr,
+  return {/*init=*/elementwise::Init,
           /*free=*/nullptr,
           /*prepare=*/
-          elementwise::GenericPrepare<elementwise::IsNumericSupportedType>,
-          /*invoke=*/elementwise::SquareEval,
+              elementwise::NumericPrepare<elementwise::Square,
+                                          elementwise::SquareSecondDerivative>,
+          /*invoke=*/elementwise::NumericEval<elementwise::Square>,
           /*profiling_string=*/nullptr,
           /*builtin_code=*/0,
           /*custom_name=*/nullptr,
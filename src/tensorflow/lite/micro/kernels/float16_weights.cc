@@ -0,0 +1,83 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/float16_weights.h"
+
+#include <algorithm>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace micro {
+
+TfLiteStatus PrepareFloat16Weights(TfLiteContext* context,
+                                   const TfLiteTensor* filter,
+                                   int num_channels, int channel_size,
+                                   Float16WeightData* data) {
+  data->tile_buffer_index = -1;
+  data->channel_size = channel_size;
+  data->num_channels = num_channels;
+  data->tile_channels = 0;
+  if (filter->type != kTfLiteFloat16) {
+    return kTfLiteOk;
+  }
+  TF_LITE_ENSURE_MSG(context, IsConstantTensor(filter),
+                     "A float16 filter must be constant.");
+  TF_LITE_ENSURE(context, num_channels > 0 && channel_size > 0);
+  const int max_tile_channels =
+      kFloat16TileBytes / static_cast<int>(channel_size * sizeof(float));
+  data->tile_channels = std::min(std::max(max_tile_channels, 1), num_channels);
+  return context->RequestScratchBufferInArena(
+      context, data->tile_channels * channel_size * sizeof(float),
+      &data->tile_buffer_index);
+}
+
+TfLiteStatus PrepareFloat16Bias(TfLiteContext* context,
+                                const TfLiteTensor* bias,
+                                const float** bias_data) {
+  *bias_data = nullptr;
+  if (bias == nullptr || bias->type != kTfLiteFloat16) {
+    return kTfLiteOk;
+  }
+  TF_LITE_ENSURE_MSG(context, IsConstantTensor(bias),
+                     "A float16 bias must be constant.");
+  const int bias_size = NumElements(bias);
+  float* converted = static_cast<float*>(
+      context->AllocatePersistentBuffer(context, bias_size * sizeof(float)));
+  TF_LITE_ENSURE(context, converted != nullptr);
+  Float16ToFloat(bias->data.f16, bias_size, converted);
+  *bias_data = converted;
+  return kTfLiteOk;
+}
+
+const float* ConvertFloat16Tile(TfLiteContext* context,
+                                const Float16WeightData& data,
+                                const TfLiteFloat16* filter, int first_channel,
+                                int* tile_channels) {
+  TFLITE_DCHECK(HasFloat16Weights(data));
+  float* tile = static_cast<float*>(
+      context->GetScratchBuffer(context, data.tile_buffer_index));
+  *tile_channels =
+      std::min(data.tile_channels, data.num_channels - first_channel);
+  Float16ToFloat(filter + first_channel * data.channel_size,
+                 *tile_channels * data.channel_size, tile);
+  return tile;
+}
+
+}  // namespace micro
+}  // namespace tflite
@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_FLOAT16_WEIGHTS_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_FLOAT16_WEIGHTS_H_
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace micro {
+
+// Float kernels reading a constant float16 filter, as written by the float16
+// post-training quantization of the converter. The filter is converted to
+// float32 in tiles of whole output channels (dimension 0) while the kernel
+// runs, so the model keeps half the weight bytes and the arena only holds one
+// tile. A float16 bias is small and converted once in Prepare.
+//
+//   Prepare:
+//     TF_LITE_ENSURE_STATUS(PrepareFloat16Weights(
+//         context, filter, num_channels, channel_size, &data->f16));
+//     TF_LITE_ENSURE_STATUS(PrepareFloat16Bias(context, bias, &data->bias));
+//   Eval:
+//     for (int first = 0; first < num_channels; first += tile_channels) {
+//       const float* tile =
+//           ConvertFloat16Tile(context, data->f16, filter_data, first,
+//                              &tile_channels);
+//       ... compute output channels [first, first + tile_channels) ...
+//     }
+struct Float16WeightData {
+  // Scratch buffer holding one float32 tile, -1 for a float32 filter.
+  int tile_buffer_index;
+  // Elements of one output channel.
+  int channel_size;
+  int num_channels;
+  int tile_channels;
+};
+
+// Bytes of float32 weights a tile holds at most, unless a single channel is
+// larger.
+constexpr int kFloat16TileBytes = 4096;
+
+// Sets up the conversion of `filter`, `num_channels` channels of
+// `channel_size` elements, if it is a constant float16 tensor. Does nothing
+// for a float32 filter.
+TfLiteStatus PrepareFloat16Weights(TfLiteContext* context,
+                                   const TfLiteTensor* filter,
+                                   int num_channels, int channel_size,
+                                   Float16WeightData* data);
+
+// Sets `bias_data` to a float32 copy of `bias` in persistent memory if it is
+// a constant float16 tensor, to nullptr otherwise. `bias` may be nullptr.
+TfLiteStatus PrepareFloat16Bias(TfLiteContext* context,
+                                const TfLiteTensor* bias,
+                                const float** bias_data);
+
+inline bool HasFloat16Weights(const Float16WeightData& data) {
+  return data.tile_buffer_index >= 0;
+}
+
+// Converts the tile of channels starting at `first_channel` into the scratch
+// buffer and returns it.
+const float* ConvertFloat16Tile(TfLiteContext* context,
+                                const Float16WeightData& data,
+                                const TfLiteFloat16* filter, int first_channel,
+                                int* tile_channels);
+
+// The float32 bias of a kernel, given the result of PrepareFloat16Bias(), or
+// nullptr without bias.
+inline const float* GetFloatBias(const float* float16_bias,
+                                 const TfLiteEvalTensor* bias) {
+  if (float16_bias != nullptr) {
+    return float16_bias;
+  }
+  return bias != nullptr ? bias->data.f : nullptr;
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_FLOAT16_WEIGHTS_H_
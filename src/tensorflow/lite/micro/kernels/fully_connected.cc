@@ -22,7 +22,12 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/compressed_tiles.h"
+#include "tensorflow/lite/micro/kernels/float16_weights.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_variants.h"
+#include "tensorflow/lite/micro/kernels/weight_prefetch.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
 namespace ops {
@@ -35,6 +40,10 @@ struct OpData {
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // Per output channel multiplier and left shift of a filter quantized per
+  // channel, or nullptr for a per-tensor filter.
+  int32_t* per_channel_output_multiplier;
+  int32_t* per_channel_output_shift;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
@@ -45,6 +54,22 @@ struct OpData {
   int32_t input_zero_point;
   int32_t filter_zero_point;
   int32_t output_zero_point;
+  // Offline pre-packed int8 weights, or nullptr.
+  const PackedWeights* packed_weights;
+  // Compressed int8 filter, or nullptr, and the scratch buffers its tiles
+  // are decompressed into.
+  const CompressedWeights* compressed_weights;
+  tflite::micro::CompressedTileData compressed_tiles;
+  // Streaming of a plain int8 filter that lives in slow memory.
+  tflite::micro::WeightPrefetchData prefetch;
+  // Implementation of a plain int8 layer, see kernel_variants.h.
+  tflite::micro::KernelVariantSelection variants;
+  // Bias with the input zero point folded in, for the variants that multiply
+  // raw input values, or nullptr.
+  int32_t* effective_bias;
+  // Conversion of a float16 filter and bias of a float layer.
+  tflite::micro::Float16WeightData float16_filter;
+  const float* float16_bias;
 };
 
 constexpr int kInputTensor = 0;
@@ -77,8 +102,102 @@ TfLiteStatus CalculateOpData(TfLiteContext* context,
   return status;
 }
 
+// Sets up the per output channel requantization of an int8 filter quantized
+// along dimension 0, as CONV_2D does. Leaves the arrays nullptr for a filter
+// with a single scale.
+TfLiteStatus CalculatePerChannelOpData(TfLiteContext* context,
+                                       TfLiteFusedActivation activation,
+                                       const TfLiteTensor* input,
+                                       const TfLiteTensor* filter,
+                                       const TfLiteTensor* bias,
+                                       TfLiteTensor* output, OpData* data) {
+  data->per_channel_output_multiplier = nullptr;
+  data->per_channel_output_shift = nullptr;
+  if (filter->type != kTfLiteInt8 ||
+      filter->quantization.type != kTfLiteAffineQuantization) {
+    return kTfLiteOk;
+  }
+  const auto* affine_quantization =
+      static_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  TF_LITE_ENSURE(context, affine_quantization);
+  TF_LITE_ENSURE(context, affine_quantization->scale);
+  const int num_channels = affine_quantization->scale->size;
+  if (num_channels == 1) {
+    return kTfLiteOk;
+  }
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(filter), 2);
+  TF_LITE_ENSURE_EQ(context, affine_quantization->quantized_dimension, 0);
+  TF_LITE_ENSURE(context, affine_quantization->zero_point);
+  for (int i = 0; i < affine_quantization->zero_point->size; ++i) {
+    TF_LITE_ENSURE_EQ(context, affine_quantization->zero_point->data[i], 0);
+  }
+
+  data->per_channel_output_multiplier =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  data->per_channel_output_shift =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  TF_LITE_ENSURE(context, data->per_channel_output_multiplier != nullptr &&
+                              data->per_channel_output_shift != nullptr);
+  return PopulateConvolutionQuantizationParams(
+      context, input, filter, bias, output, activation,
+      &data->output_multiplier, &data->output_shift,
+      &data->output_activation_min, &data->output_activation_max,
+      data->per_channel_output_multiplier,
+      reinterpret_cast<int*>(data->per_channel_output_shift), num_channels);
+}
+
+// Requantizes the accumulator of output channel `channel`, bias included, to
+// the int8 output. Shared by the epilogues of all int8 implementations.
+inline int8_t RequantizeInt8(const OpData& data, int channel, int32_t acc) {
+  if (data.per_channel_output_multiplier != nullptr) {
+    acc = MultiplyByQuantizedMultiplier(
+        acc, data.per_channel_output_multiplier[channel],
+        data.per_channel_output_shift[channel]);
+  } else {
+    acc = MultiplyByQuantizedMultiplier(acc, data.output_multiplier,
+                                        -data.output_shift);
+  }
+  acc += data.output_zero_point;
+  acc = std::max(acc, data.output_activation_min);
+  acc = std::min(acc, data.output_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+TfLiteStatus ValidatePackedWeights(TfLiteContext* context,
+                                   const TfLiteTensor* input,
+                                   const TfLiteTensor* filter,
+                                   const PackedWeights* packed) {
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, packed->layout, kPackedWeightsO4I16);
+  TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+  const int filter_dim_count = NumDimensions(filter);
+  const int output_depth = filter->dims->data[filter_dim_count - 2];
+  const int accum_depth = filter->dims->data[filter_dim_count - 1];
+  TF_LITE_ENSURE_EQ(context, packed->filter_size,
+                    PackedO4I16Size(output_depth, 1, accum_depth));
+  TF_LITE_ENSURE_EQ(context, packed->effective_bias_size, output_depth);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PrepareCompressedWeights(TfLiteContext* context,
+                                      const TfLiteTensor* input,
+                                      const TfLiteTensor* filter,
+                                      OpData* data) {
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(filter), 2);
+  return tflite::micro::PrepareCompressedTiles(
+      context, *data->compressed_weights, filter->dims->data[0],
+      filter->dims->data[1], &data->compressed_tiles);
+}
+
 }  // namespace
 
+TfLiteStatus PrepareInt8Variants(TfLiteContext* context, TfLiteNode* node,
+                                 OpData* data);
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
   return context->AllocatePersistentBuffer(context, sizeof(OpData));
@@ -101,11 +220,220 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, output != nullptr);
 
   TF_LITE_ENSURE_TYPES_EQ(context, input->type, output->type);
-  TF_LITE_ENSURE_MSG(context, input->type == filter->type,
+  // A float layer may keep its weights as float16, see float16_weights.h.
+  TF_LITE_ENSURE_MSG(context,
+                     input->type == filter->type ||
+                         (input->type == kTfLiteFloat32 &&
+                          filter->type == kTfLiteFloat16),
                      "Hybrid models are not supported on TFLite Micro.");
 
-  return CalculateOpData(context, params->activation, input->type, input,
-                         filter, bias, output, data);
+  data->packed_weights = tflite::micro::GetPackedWeights(node);
+  if (data->packed_weights != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        ValidatePackedWeights(context, input, filter, data->packed_weights));
+  }
+  // Packed weights do not read the original filter, so a compressed filter
+  // only needs decoding without them.
+  data->compressed_weights = data->packed_weights == nullptr
+                                 ? tflite::micro::GetCompressedWeights(node)
+                                 : nullptr;
+  if (data->compressed_weights != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        PrepareCompressedWeights(context, input, filter, data));
+  }
+  data->prefetch.tile_buffer_index[0] = -1;
+  if (input->type == kTfLiteInt8 && data->packed_weights == nullptr &&
+      data->compressed_weights == nullptr && NumDimensions(filter) == 2) {
+    TF_LITE_ENSURE_STATUS(tflite::micro::PrepareWeightPrefetch(
+        context, filter, filter->dims->data[0], filter->dims->data[1],
+        &data->prefetch));
+  }
+
+  TF_LITE_ENSURE_STATUS(CalculateOpData(context, params->activation,
+                                        input->type, input, filter, bias,
+                                        output, data));
+  TF_LITE_ENSURE_STATUS(CalculatePerChannelOpData(
+      context, params->activation, input, filter, bias, output, data));
+  data->float16_filter.tile_buffer_index = -1;
+  data->float16_bias = nullptr;
+  if (input->type == kTfLiteFloat32) {
+    const int filter_dim_count = NumDimensions(filter);
+    TF_LITE_ENSURE_STATUS(tflite::micro::PrepareFloat16Weights(
+        context, filter, filter->dims->data[filter_dim_count - 2],
+        filter->dims->data[filter_dim_count - 1], &data->float16_filter));
+    TF_LITE_ENSURE_STATUS(
+        tflite::micro::PrepareFloat16Bias(context, bias, &data->float16_bias));
+  }
+  data->effective_bias = nullptr;
+  if (input->type == kTfLiteInt8 && data->packed_weights == nullptr &&
+      data->compressed_weights == nullptr &&
+      !tflite::micro::IsWeightPrefetchEnabled(data->prefetch)) {
+    TF_LITE_ENSURE_STATUS(PrepareInt8Variants(context, node, data));
+  }
+  return kTfLiteOk;
+}
+
+// Number of multiply-accumulates of one output channel, to partition the
+// output channels with ParallelFor().
+int64_t MacsPerOutputChannel(const TfLiteEvalTensor* filter,
+                             const TfLiteEvalTensor* output) {
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dim_count = output_shape.DimensionsCount();
+  return static_cast<int64_t>(
+             FlatSizeSkipDim(output_shape, output_dim_count - 1)) *
+         filter->dims->data[1];
+}
+
+// Int8 fully connected layer over kPackedWeightsO4I16 weights. Each input
+// value that is loaded feeds four output channels from one contiguous filter
+// block, and the input zero point is already part of the effective bias.
+// Computes output channels [first_channel, end_channel), first_channel being
+// a multiple of kPackedOutputBlock.
+void PackedChannelsInt8(const OpData& data, const TfLiteEvalTensor* input,
+                        const TfLiteEvalTensor* filter, int first_channel,
+                        int end_channel, TfLiteEvalTensor* output) {
+  const PackedWeights& packed = *data.packed_weights;
+  const RuntimeShape filter_shape = tflite::micro::GetTensorShape(filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = output_shape.Dims(0);
+  const int output_depth = output_shape.Dims(1);
+  const int accum_depth =
+      filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* batch_input = input_data + b * accum_depth;
+    const int8_t* block =
+        packed.filter +
+        PackedO4I16Offset(first_channel, 0, 0, /*num_taps=*/1, accum_depth);
+    for (int out_c = first_channel; out_c < end_channel;
+         out_c += kPackedOutputBlock) {
+      int32_t acc[kPackedOutputBlock] = {};
+      for (int d0 = 0; d0 < accum_depth; d0 += kPackedDepthBlock) {
+        const int depth = std::min(kPackedDepthBlock, accum_depth - d0);
+        for (int d = 0; d < depth; ++d) {
+          const int32_t input_val = batch_input[d0 + d];
+          for (int i = 0; i < kPackedOutputBlock; ++i) {
+            acc[i] += block[i * kPackedDepthBlock + d] * input_val;
+          }
+        }
+        block += kPackedOutputBlock * kPackedDepthBlock;
+      }
+      const int block_outputs =
+          std::min(kPackedOutputBlock, end_channel - out_c);
+      for (int i = 0; i < block_outputs; ++i) {
+        output_data[b * output_depth + out_c + i] = RequantizeInt8(
+            data, out_c + i, acc[i] + packed.effective_bias[out_c + i]);
+      }
+    }
+  }
+}
+
+TfLiteStatus EvalPackedInt8(TfLiteContext* context, const OpData& data,
+                            const TfLiteEvalTensor* input,
+                            const TfLiteEvalTensor* filter,
+                            TfLiteEvalTensor* output) {
+  const int output_depth = filter->dims->data[filter->dims->size - 2];
+  return tflite::micro::ParallelFor(
+      context, output_depth, MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        PackedChannelsInt8(data, input, filter, begin, end, output);
+      },
+      /*grain=*/kPackedOutputBlock);
+}
+
+// Computes output channels [first_channel, first_channel + tile_channels) of
+// an int8 fully connected layer for all batches, from the filter rows in
+// `tile_data`.
+void FullyConnectedTileInt8(const OpData& data, const TfLiteEvalTensor* input,
+                            const TfLiteEvalTensor* filter,
+                            const TfLiteEvalTensor* bias,
+                            const int8_t* tile_data, int first_channel,
+                            int tile_channels, TfLiteEvalTensor* output) {
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  const int accum_depth = filter->dims->data[1];
+  const int32_t input_offset = -data.input_zero_point;
+  const int32_t filter_offset = -data.filter_zero_point;
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int32_t* bias_data =
+      bias != nullptr ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr;
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* batch_input = input_data + b * accum_depth;
+    for (int c = 0; c < tile_channels; ++c) {
+      const int8_t* filter_row = tile_data + c * accum_depth;
+      int32_t acc = 0;
+      for (int d = 0; d < accum_depth; ++d) {
+        acc +=
+            (filter_row[d] + filter_offset) * (batch_input[d] + input_offset);
+      }
+      const int out_c = first_channel + c;
+      if (bias_data) {
+        acc += bias_data[out_c];
+      }
+      output_data[b * output_depth + out_c] = RequantizeInt8(data, out_c, acc);
+    }
+  }
+}
+
+// FullyConnectedTileInt8() over chunks of the channels of the tile when they
+// run in parallel.
+TfLiteStatus ParallelFullyConnectedTileInt8(
+    TfLiteContext* context, const OpData& data, const TfLiteEvalTensor* input,
+    const TfLiteEvalTensor* filter, const TfLiteEvalTensor* bias,
+    const int8_t* tile_data, int first_channel, int tile_channels,
+    TfLiteEvalTensor* output) {
+  const int accum_depth = filter->dims->data[1];
+  return tflite::micro::ParallelFor(
+      context, tile_channels, MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        FullyConnectedTileInt8(data, input, filter, bias,
+                               tile_data + begin * accum_depth,
+                               first_channel + begin, end - begin, output);
+      });
+}
+
+// Int8 fully connected layer over a compressed filter. One tile of output
+// channels at a time is decompressed into a scratch buffer and applied to all
+// batches before moving on to the next tile; with threads the next tile is
+// decompressed while the current one is computed.
+TfLiteStatus EvalCompressedInt8(TfLiteContext* context, const OpData& data,
+                                const TfLiteEvalTensor* input,
+                                const TfLiteEvalTensor* filter,
+                                const TfLiteEvalTensor* bias,
+                                TfLiteEvalTensor* output) {
+  return tflite::micro::ForEachCompressedTile(
+      context, *data.compressed_weights, data.compressed_tiles,
+      MacsPerOutputChannel(filter, output),
+      [&](const int8_t* channels, int first_channel, int num_channels) {
+        FullyConnectedTileInt8(data, input, filter, bias, channels,
+                               first_channel, num_channels, output);
+      });
+}
+
+// Int8 fully connected layer over a filter in slow memory. Each tile of output
+// channels is computed from fast memory while the copy engine fetches the
+// next one.
+TfLiteStatus EvalPrefetchedInt8(TfLiteContext* context, const OpData& data,
+                                const TfLiteEvalTensor* input,
+                                const TfLiteEvalTensor* filter,
+                                const TfLiteEvalTensor* bias,
+                                TfLiteEvalTensor* output) {
+  tflite::micro::WeightTileStream stream(
+      context, data.prefetch, tflite::micro::GetTensorData<int8_t>(filter));
+  int first_channel;
+  int tile_channels;
+  while (const void* tile = stream.Next(&first_channel, &tile_channels)) {
+    TF_LITE_ENSURE_STATUS(ParallelFullyConnectedTileInt8(
+        context, data, input, filter, bias, static_cast<const int8_t*>(tile),
+        first_channel, tile_channels, output));
+  }
+  return stream.status();
 }
 
 TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
@@ -136,6 +464,129 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Int8 fully connected layer that computes four output channels per pass
+// over the input, multiplying raw input values into the effective bias.
+// Computes output channels [first_channel, end_channel).
+void Rows4ChannelsInt8(const OpData& data, const TfLiteEvalTensor* input,
+                       const TfLiteEvalTensor* filter, int first_channel,
+                       int end_channel, TfLiteEvalTensor* output) {
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  const int accum_depth = filter->dims->data[1];
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* batch_input = input_data + b * accum_depth;
+    for (int out_c = first_channel; out_c < end_channel; out_c += 4) {
+      const int rows = std::min(4, end_channel - out_c);
+      const int8_t* row = filter_data + out_c * accum_depth;
+      int32_t acc[4] = {};
+      if (rows == 4) {
+        for (int d = 0; d < accum_depth; ++d) {
+          const int32_t input_val = batch_input[d];
+          acc[0] += row[d] * input_val;
+          acc[1] += row[accum_depth + d] * input_val;
+          acc[2] += row[2 * accum_depth + d] * input_val;
+          acc[3] += row[3 * accum_depth + d] * input_val;
+        }
+      } else {
+        for (int i = 0; i < rows; ++i) {
+          for (int d = 0; d < accum_depth; ++d) {
+            acc[i] += row[i * accum_depth + d] * batch_input[d];
+          }
+        }
+      }
+      for (int i = 0; i < rows; ++i) {
+        output_data[b * output_depth + out_c + i] = RequantizeInt8(
+            data, out_c + i, acc[i] + data.effective_bias[out_c + i]);
+      }
+    }
+  }
+}
+
+TfLiteStatus EvalRows4Int8(TfLiteContext* context, TfLiteNode* node) {
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kWeightsTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  return tflite::micro::ParallelFor(
+      context, filter->dims->data[0], MacsPerOutputChannel(filter, output),
+      [&](int begin, int end) {
+        Rows4ChannelsInt8(data, input, filter, begin, end, output);
+      },
+      /*grain=*/4);
+}
+
+// The reference kernel, or FullyConnectedTileInt8() over chunks of the output
+// channels when they run in parallel or the filter is quantized per channel,
+// which the reference kernel does not support.
+TfLiteStatus EvalReferenceInt8(TfLiteContext* context, TfLiteNode* node) {
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* filter =
+      tflite::micro::GetEvalInput(context, node, kWeightsTensor);
+  const TfLiteEvalTensor* bias =
+      tflite::micro::GetEvalInput(context, node, kBiasTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  const int output_depth = filter->dims->data[0];
+  const int64_t macs_per_channel = MacsPerOutputChannel(filter, output);
+  if (data.per_channel_output_multiplier != nullptr ||
+      tflite::micro::NumParallelChunks(context, output_depth,
+                                       macs_per_channel) > 1) {
+    return ParallelFullyConnectedTileInt8(
+        context, data, input, filter, bias,
+        tflite::micro::GetTensorData<int8_t>(filter), 0, output_depth, output);
+  }
+  return EvalQuantizedInt8(context, node, data, input, filter, bias, output);
+}
+
+bool HasConstantSymmetricFilter(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* filter = GetInput(context, node, kWeightsTensor);
+  return filter != nullptr && IsConstantTensor(filter) &&
+         NumDimensions(filter) == 2 && filter->params.zero_point == 0;
+}
+
+TfLiteStatus PrepareEffectiveBias(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kWeightsTensor);
+  const TfLiteTensor* bias = GetOptionalInputTensor(context, node, kBiasTensor);
+  const int output_depth = filter->dims->data[0];
+  data->effective_bias =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, output_depth * sizeof(int32_t)));
+  TF_LITE_ENSURE(context, data->effective_bias != nullptr);
+  tflite::micro::ComputeEffectiveBias(
+      GetTensorData<int8_t>(filter),
+      bias != nullptr ? GetTensorData<int32_t>(bias) : nullptr, output_depth,
+      filter->dims->data[1], input->params.zero_point, data->effective_bias);
+  return kTfLiteOk;
+}
+
+// Implementations of int8 layers with a plain filter, in order of preference.
+constexpr tflite::micro::KernelVariant kInt8Variants[] = {
+    {"reference", tflite::micro::IsAlwaysApplicable, nullptr,
+     EvalReferenceInt8},
+    {"rows4", HasConstantSymmetricFilter, PrepareEffectiveBias,
+     EvalRows4Int8},
+};
+
+TfLiteStatus PrepareInt8Variants(TfLiteContext* context, TfLiteNode* node,
+                                 OpData* data) {
+  return tflite::micro::PrepareKernelVariants(
+      context, node, BuiltinOperator_FULLY_CONNECTED, kInt8Variants,
+      sizeof(kInt8Variants) / sizeof(kInt8Variants[0]), &data->variants);
+}
+
 TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                            const OpData& data, const TfLiteEvalTensor* input,
                            const TfLiteEvalTensor* filter,
@@ -181,7 +632,41 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
-TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
+// Computes output channels [first_channel, first_channel + tile_channels) of
+// a float layer from the float32 filter rows in `tile_data`, matching
+// reference_ops::FullyConnected for the channels it covers.
+void FullyConnectedFloatTile(const FullyConnectedParams& params,
+                             const TfLiteEvalTensor* input,
+                             const TfLiteEvalTensor* filter,
+                             const float* bias_data, const float* tile_data,
+                             int first_channel, int tile_channels,
+                             TfLiteEvalTensor* output) {
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = filter->dims->data[filter->dims->size - 1];
+  const float* input_data = tflite::micro::GetTensorData<float>(input);
+  float* output_data = tflite::micro::GetTensorData<float>(output);
+  for (int b = 0; b < batches; ++b) {
+    const float* in = input_data + b * accum_depth;
+    float* out = output_data + b * output_depth + first_channel;
+    for (int c = 0; c < tile_channels; ++c) {
+      const float* weights = tile_data + c * accum_depth;
+      float total = 0.f;
+      for (int d = 0; d < accum_depth; ++d) {
+        total += in[d] * weights[d];
+      }
+      const float bias_value =
+          bias_data != nullptr ? bias_data[first_channel + c] : 0.0f;
+      out[c] = ActivationFunctionWithMinMax(total + bias_value,
+                                            params.float_activation_min,
+                                            params.float_activation_max);
+    }
+  }
+}
+
+TfLiteStatus EvalFloat(TfLiteContext* context, const OpData& data,
                        TfLiteFusedActivation activation,
                        const TfLiteEvalTensor* input,
                        const TfLiteEvalTensor* filter,
@@ -192,13 +677,32 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
   tflite::FullyConnectedParams op_params;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  const float* bias_data =
+      tflite::micro::GetFloatBias(data.float16_bias, bias);
+
+  // A float16 filter is converted one tile of output channels at a time.
+  if (tflite::micro::HasFloat16Weights(data.float16_filter)) {
+    const TfLiteFloat16* filter_data =
+        tflite::micro::GetTensorData<TfLiteFloat16>(filter);
+    int tile_channels;
+    for (int first_channel = 0;
+         first_channel < data.float16_filter.num_channels;
+         first_channel += tile_channels) {
+      const float* tile = tflite::micro::ConvertFloat16Tile(
+          context, data.float16_filter, filter_data, first_channel,
+          &tile_channels);
+      FullyConnectedFloatTile(op_params, input, filter, bias_data, tile,
+                              first_channel, tile_channels, output);
+    }
+    return kTfLiteOk;
+  }
+
   tflite::reference_ops::FullyConnected(
       op_params, tflite::micro::GetTensorShape(input),
       tflite::micro::GetTensorData<float>(input),
       tflite::micro::GetTensorShape(filter),
       tflite::micro::GetTensorData<float>(filter),
-      tflite::micro::GetTensorShape(bias),
-      tflite::micro::GetTensorData<float>(bias),
+      tflite::micro::GetTensorShape(bias), bias_data,
       tflite::micro::GetTensorShape(output),
       tflite::micro::GetTensorData<float>(output));
   return kTfLiteOk;
@@ -221,14 +725,23 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK(node->user_data != nullptr);
   const OpData& data = *(static_cast<const OpData*>(node->user_data));
 
-  // Checks in Prepare ensure input, output and filter types are all the same.
+  // Checks in Prepare ensure input, output and filter types are all the same,
+  // but for a float16 filter of a float layer.
   switch (input->type) {
     case kTfLiteFloat32:
-      return EvalFloat(context, node, params->activation, input, filter, bias,
+      return EvalFloat(context, data, params->activation, input, filter, bias,
                        output);
     case kTfLiteInt8:
-      return EvalQuantizedInt8(context, node, data, input, filter, bias,
-                               output);
+      if (data.packed_weights != nullptr) {
+        return EvalPackedInt8(context, data, input, filter, output);
+      }
+      if (data.compressed_weights != nullptr) {
+        return EvalCompressedInt8(context, data, input, filter, bias, output);
+      }
+      if (tflite::micro::IsWeightPrefetchEnabled(data.prefetch)) {
+        return EvalPrefetchedInt8(context, data, input, filter, bias, output);
+      }
+      return tflite::micro::EvalKernelVariant(context, node, data.variants);
 
     case kTfLiteUInt8:
       return EvalQuantized(context, node, data, input, filter, bias, output);
@@ -45,6 +45,7 @@ KernelRunner::KernelRunner(const TfLiteRegistration& registration,
   context_.AllocatePersistentBuffer = AllocatePersistentBuffer;
   context_.RequestScratchBufferInArena = RequestScratchBufferInArena;
   context_.GetScratchBuffer = GetScratchBuffer;
+  context_.GetExternalContext = GetExternalContext;
 
   // Prepare TfLiteNode:
   node_.inputs = inputs;
@@ -52,9 +53,10 @@ KernelRunner::KernelRunner(const TfLiteRegistration& registration,
   node_.builtin_data = builtin_data;
 }
 
-TfLiteStatus KernelRunner::InitAndPrepare(const char* init_data) {
+TfLiteStatus KernelRunner::InitAndPrepare(const char* init_data,
+                                          size_t length) {
   if (registration_.init) {
-    node_.user_data = registration_.init(&context_, init_data, /*length=*/0);
+    node_.user_data = registration_.init(&context_, init_data, length);
   }
   if (registration_.prepare) {
     TF_LITE_ENSURE_STATUS(registration_.prepare(&context_, &node_));
@@ -71,6 +73,21 @@ TfLiteStatus KernelRunner::Invoke() {
   return registration_.invoke(&context_, &node_);
 }
 
+void KernelRunner::SetExternalContext(TfLiteExternalContextType type,
+                                      TfLiteExternalContext* external_context) {
+  TFLITE_DCHECK(type >= 0 && type < kTfLiteMaxExternalContexts);
+  external_contexts_[type] = external_context;
+}
+
+void KernelRunner::SetNumThreads(int num_threads) {
+  context_.recommended_num_threads = num_threads > 1 ? num_threads : 1;
+}
+
+void KernelRunner::SetNodeWeights(const NodeWeights* weights) {
+  node_.custom_initial_data = weights;
+  node_.custom_initial_data_size = weights != nullptr ? sizeof(NodeWeights) : 0;
+}
+
 TfLiteTensor* KernelRunner::GetTensor(const struct TfLiteContext* context,
                                       int tensor_index) {
   TFLITE_DCHECK(context != nullptr);
@@ -149,6 +166,18 @@ void* KernelRunner::GetScratchBuffer(TfLiteContext* context, int buffer_index) {
   return runner->scratch_buffers_[buffer_index];
 }
 
+TfLiteExternalContext* KernelRunner::GetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  TFLITE_DCHECK(context != nullptr);
+  KernelRunner* runner = reinterpret_cast<KernelRunner*>(context->impl_);
+  TFLITE_DCHECK(runner != nullptr);
+
+  if (type < 0 || type >= kTfLiteMaxExternalContexts) {
+    return nullptr;
+  }
+  return runner->external_contexts_[type];
+}
+
 void KernelRunner::ReportOpError(struct TfLiteContext* context,
                                  const char* format, ...) {
   TFLITE_DCHECK(context != nullptr);
@@ -157,7 +186,7 @@ void KernelRunner::ReportOpError(struct TfLiteContext* context,
 
   va_list args;
   va_start(args, format);
-  TF_LITE_REPORT_ERROR(runner->error_reporter_, format, args);
+  runner->error_reporter_->ReportFromContext(format, args);
   va_end(args);
 }
 
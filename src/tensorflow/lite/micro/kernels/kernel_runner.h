@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/node_weights.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
 
 namespace tflite {
@@ -39,13 +40,29 @@ class KernelRunner {
   // Calls init and prepare on the kernel (i.e. TfLiteRegistration) struct. Any
   // exceptions will be reported through the error_reporter and returned as a
   // status code here.
-  TfLiteStatus InitAndPrepare(const char* init_data = nullptr);
+  TfLiteStatus InitAndPrepare(const char* init_data = nullptr,
+                              size_t length = 0);
 
   // Calls init, prepare, and invoke on a given TfLiteRegistration pointer.
   // After successful invoke, results will be available in the output tensor as
   // passed into the constructor of this class.
   TfLiteStatus Invoke();
 
+  // Installs `external_context` for the kernel, for example a KernelTuner or a
+  // ParallelExecutor, like MicroInterpreter::SetExternalContext(). Call
+  // before InitAndPrepare().
+  void SetExternalContext(TfLiteExternalContextType type,
+                          TfLiteExternalContext* external_context);
+
+  // Number of threads the kernel may use, like
+  // MicroInterpreter::SetNumThreads(). Defaults to 1.
+  void SetNumThreads(int num_threads);
+
+  // Attaches offline prepared `weights` to the node, like the MicroAllocator
+  // does for the PackedWeights and CompressedWeights metadata. Call before
+  // InitAndPrepare().
+  void SetNodeWeights(const NodeWeights* weights);
+
  protected:
   static TfLiteTensor* GetTensor(const struct TfLiteContext* context,
                                  int tensor_index);
@@ -58,6 +75,8 @@ class KernelRunner {
   static void* GetScratchBuffer(TfLiteContext* context, int buffer_index);
   static void ReportOpError(struct TfLiteContext* context, const char* format,
                             ...);
+  static TfLiteExternalContext* GetExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
 
  private:
   static constexpr int kNumScratchBuffers_ = 5;
@@ -75,6 +94,7 @@ class KernelRunner {
 
   int scratch_buffer_count_ = 0;
   uint8_t* scratch_buffers_[kNumScratchBuffers_];
+  TfLiteExternalContext* external_contexts_[kTfLiteMaxExternalContexts] = {};
 };
 
 }  // namespace micro
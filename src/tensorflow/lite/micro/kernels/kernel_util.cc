@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 
+#include <algorithm>
+
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/parallel_executor.h"
 
 namespace tflite {
 namespace micro {
@@ -37,5 +40,60 @@ const RuntimeShape GetTensorShape(const TfLiteEvalTensor* tensor) {
   return RuntimeShape(dims_size, dims_data);
 }
 
+bool IsLayoutPreservingReorder(const int* extents, const int* input_order,
+                               const int* output_order, int num_digits) {
+  int in = 0;
+  int out = 0;
+  while (true) {
+    while (in < num_digits && extents[input_order[in]] == 1) ++in;
+    while (out < num_digits && extents[output_order[out]] == 1) ++out;
+    if (in == num_digits || out == num_digits) {
+      return in == num_digits && out == num_digits;
+    }
+    if (input_order[in] != output_order[out]) {
+      return false;
+    }
+    ++in;
+    ++out;
+  }
+}
+
+void ComputeEffectiveBias(const int8_t* filter, const int32_t* bias,
+                          int num_channels, int row_size,
+                          int32_t input_zero_point, int32_t* effective_bias) {
+  for (int c = 0; c < num_channels; ++c) {
+    int32_t sum = 0;
+    for (int i = 0; i < row_size; ++i) {
+      sum += filter[c * row_size + i];
+    }
+    effective_bias[c] =
+        (bias != nullptr ? bias[c] : 0) - input_zero_point * sum;
+  }
+}
+
+int NumParallelChunks(TfLiteContext* context, int num_items,
+                      int64_t macs_per_item) {
+  const ParallelExecutor* executor = GetParallelExecutor(context);
+  if (executor == nullptr) {
+    return 1;
+  }
+  int num_chunks =
+      std::min(context->recommended_num_threads, executor->num_workers());
+  const int64_t total_macs = num_items * macs_per_item;
+  if (total_macs / kMinParallelChunkMacs < num_chunks) {
+    num_chunks = static_cast<int>(total_macs / kMinParallelChunkMacs);
+  }
+  return std::max(1, std::min(num_chunks, num_items));
+}
+
+void ParallelChunkBounds(int num_items, int num_chunks, int grain, int index,
+                         int* begin, int* end) {
+  const int64_t num_blocks = (num_items + grain - 1) / grain;
+  const int first_block = static_cast<int>(num_blocks * index / num_chunks);
+  const int end_block = static_cast<int>(num_blocks * (index + 1) / num_chunks);
+  *begin = first_block * grain;
+  *end = std::min(num_items, end_block * grain);
+}
+
 }  // namespace micro
 }  // namespace tflite
@@ -21,6 +21,8 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/node_weights.h"
+#include "tensorflow/lite/micro/parallel_executor.h"
 
 namespace tflite {
 namespace micro {
@@ -69,6 +71,99 @@ const RuntimeShape GetTensorShape(const TfLiteEvalTensor* tensor);
 bool HaveSameShapes(const TfLiteEvalTensor* input1,
                     const TfLiteEvalTensor* input2);
 
+// Block rearrangement ops (SPACE_TO_DEPTH, SPACE_TO_BATCH_ND, ...) visit the
+// same set of index "digits" (batch, block offset, spatial position, ...) in a
+// different major-to-minor order for the input and the output. `extents` holds
+// the size of each digit, `input_order` and `output_order` list the digit
+// indices from major to minor. Returns true if both orders agree once digits
+// of extent 1 are dropped, i.e. when the op leaves the buffer bytes untouched
+// and can run as a plain copy (or not at all when input and output alias).
+bool IsLayoutPreservingReorder(const int* extents, const int* input_order,
+                               const int* output_order, int num_digits);
+
+// Folds the input zero point into the bias of an int8 layer with a symmetric
+// filter of `num_channels` rows of `row_size` values, so that the inner loop
+// multiplies raw input values: effective_bias[c] = bias[c] -
+// input_zero_point * sum(row c). `bias` may be nullptr.
+void ComputeEffectiveBias(const int8_t* filter, const int32_t* bias,
+                          int num_channels, int row_size,
+                          int32_t input_zero_point, int32_t* effective_bias);
+
+// Returns the offline prepared weights the MicroAllocator attached to a
+// builtin node, or nullptr if there are none. See micro/node_weights.h.
+inline const NodeWeights* GetNodeWeights(const TfLiteNode* node) {
+  if (node->custom_initial_data == nullptr ||
+      node->custom_initial_data_size != sizeof(NodeWeights)) {
+    return nullptr;
+  }
+  return static_cast<const NodeWeights*>(node->custom_initial_data);
+}
+
+// Returns the pre-packed weights of a node, or nullptr if there are none.
+// See micro/packed_weights.h.
+inline const PackedWeights* GetPackedWeights(const TfLiteNode* node) {
+  const NodeWeights* weights = GetNodeWeights(node);
+  return weights != nullptr ? weights->packed : nullptr;
+}
+
+// Returns the compressed filter of a node, or nullptr if it is not
+// compressed. See micro/compressed_weights.h.
+inline const CompressedWeights* GetCompressedWeights(const TfLiteNode* node) {
+  const NodeWeights* weights = GetNodeWeights(node);
+  return weights != nullptr ? weights->compressed : nullptr;
+}
+
+// Fewest multiply-accumulates worth a chunk of their own; smaller loops stay
+// on the calling thread.
+constexpr int64_t kMinParallelChunkMacs = 16 * 1024;
+
+// Number of chunks ParallelFor() splits a loop over `num_items` items of
+// `macs_per_item` multiply-accumulates each into: at most
+// context->recommended_num_threads and the workers of the ParallelExecutor,
+// with at least kMinParallelChunkMacs per chunk. 1 without an executor.
+int NumParallelChunks(TfLiteContext* context, int num_items,
+                      int64_t macs_per_item);
+
+// Bounds [begin, end) of chunk `index` of `num_chunks` over `num_items`
+// items. Chunks start on a multiple of `grain` and their sizes, hence their
+// costs, differ by at most `grain` items.
+void ParallelChunkBounds(int num_items, int num_chunks, int grain, int index,
+                         int* begin, int* end);
+
+// Calls fn(begin, end) on chunks that together cover [0, num_items), through
+// the ParallelExecutor of `context` (see micro/parallel_executor.h) when the
+// loop is worth splitting, else once on the calling thread. The items are
+// output channels or rows: every call must write only the outputs of its
+// items. `grain` keeps blocked kernels, for example four channels per pass,
+// on their block boundaries.
+template <typename Fn>
+TfLiteStatus ParallelFor(TfLiteContext* context, int num_items,
+                         int64_t macs_per_item, const Fn& fn, int grain = 1) {
+  const int num_chunks =
+      NumParallelChunks(context, (num_items + grain - 1) / grain,
+                        macs_per_item * grain);
+  if (num_chunks <= 1) {
+    fn(0, num_items);
+    return kTfLiteOk;
+  }
+  struct Loop {
+    const Fn* fn;
+    int num_items;
+    int num_chunks;
+    int grain;
+  } loop = {&fn, num_items, num_chunks, grain};
+  return GetParallelExecutor(context)->Run(
+      num_chunks,
+      [](void* user_data, int index) {
+        const Loop& chunks = *static_cast<const Loop*>(user_data);
+        int begin, end;
+        ParallelChunkBounds(chunks.num_items, chunks.num_chunks, chunks.grain,
+                            index, &begin, &end);
+        (*chunks.fn)(begin, end);
+      },
+      &loop);
+}
+
 }  // namespace micro
 }  // namespace tflite
 
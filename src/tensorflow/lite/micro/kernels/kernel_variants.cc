@@ -0,0 +1,81 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/kernel_variants.h"
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernel_tuner.h"
+
+namespace tflite {
+namespace micro {
+
+bool IsAlwaysApplicable(TfLiteContext* context, TfLiteNode* node) {
+  return true;
+}
+
+TfLiteStatus PrepareKernelVariants(TfLiteContext* context, TfLiteNode* node,
+                                   int32_t builtin_code,
+                                   const KernelVariant* variants,
+                                   int num_variants,
+                                   KernelVariantSelection* selection) {
+  TF_LITE_ENSURE(context, num_variants <= kMaxKernelVariants);
+  selection->variants = variants;
+  selection->num_variants = num_variants;
+  selection->candidates = 0;
+  selection->selected = -1;
+  selection->builtin_code = builtin_code;
+  selection->node = node;
+  selection->next = nullptr;
+  uint32_t applicable = 0;
+  for (int i = 0; i < num_variants; ++i) {
+    if (variants[i].is_applicable(context, node)) {
+      applicable |= 1u << i;
+    }
+  }
+  TF_LITE_ENSURE_MSG(context, applicable != 0,
+                     "No kernel variant applies to the node.");
+  // Only variants that may run are prepared: the preferred one without a
+  // tuner, the decided one if an earlier tuning is loaded, and otherwise
+  // every applicable one for the tuner to time.
+  KernelTuner* tuner = GetKernelTuner(context);
+  const int decided =
+      tuner != nullptr ? tuner->LoadedDecision(builtin_code) : -1;
+  if (decided >= 0 && decided < num_variants &&
+      (applicable & (1u << decided)) != 0) {
+    selection->candidates = 1u << decided;
+  } else if (tuner == nullptr) {
+    selection->candidates = applicable & (~applicable + 1);
+  } else {
+    selection->candidates = applicable;
+  }
+  for (int i = 0; i < num_variants; ++i) {
+    if ((selection->candidates & (1u << i)) == 0) {
+      continue;
+    }
+    if (variants[i].prepare != nullptr) {
+      TF_LITE_ENSURE_STATUS(variants[i].prepare(context, node));
+    }
+    if (selection->selected < 0) {
+      selection->selected = i;
+    }
+  }
+  if (tuner != nullptr) {
+    tuner->Register(selection);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace micro
+}  // namespace tflite
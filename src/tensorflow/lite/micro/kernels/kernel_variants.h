@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_VARIANTS_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_VARIANTS_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace micro {
+
+// Largest number of implementations one operator can register.
+constexpr int kMaxKernelVariants = 16;
+
+// One implementation of an operator. A kernel lists its variants in order of
+// preference and picks one per node in Prepare:
+//
+//   constexpr KernelVariant kVariants[] = {
+//       {"reference", IsAlwaysApplicable, nullptr, EvalReference},
+//       {"pointwise", IsPointwise, PreparePointwise, EvalPointwise},
+//   };
+//   ...
+//   TF_LITE_ENSURE_STATUS(PrepareKernelVariants(
+//       context, node, BuiltinOperator_CONV_2D, kVariants, 2,
+//       &data->variants));
+//   ...
+//   return EvalKernelVariant(context, node, data.variants);
+//
+// Without a KernelTuner the first applicable variant runs and is the only one
+// prepared, so variants whose buffers cost more arena than they are worth by
+// default go after one that always applies. With a tuner, see
+// micro/kernel_tuner.h, the variant is the one recorded by an earlier tuning,
+// which is then the only one prepared, or else the one timed fastest on the
+// node at the end of AllocateTensors() among all applicable variants.
+struct KernelVariant {
+  const char* name;
+  // Whether the variant supports the node, called from Prepare.
+  bool (*is_applicable)(TfLiteContext* context, TfLiteNode* node);
+  // Optional, called from Prepare for every variant that may run, for
+  // example to allocate buffers the variant needs.
+  TfLiteStatus (*prepare)(TfLiteContext* context, TfLiteNode* node);
+  TfLiteStatus (*eval)(TfLiteContext* context, TfLiteNode* node);
+};
+
+// The variants of one node and the one selected, kept in the OpData of the
+// kernel.
+struct KernelVariantSelection {
+  const KernelVariant* variants;
+  int num_variants;
+  // Bit i is set if variants[i] is applicable and prepared, so that it may
+  // be selected.
+  uint32_t candidates;
+  int selected;
+  int32_t builtin_code;
+  TfLiteNode* node;
+  // Next node registered with the KernelTuner.
+  KernelVariantSelection* next;
+};
+
+bool IsAlwaysApplicable(TfLiteContext* context, TfLiteNode* node);
+
+// Checks which of `variants` apply to `node`, prepares the candidates and
+// selects one. Fails if none applies.
+TfLiteStatus PrepareKernelVariants(TfLiteContext* context, TfLiteNode* node,
+                                   int32_t builtin_code,
+                                   const KernelVariant* variants,
+                                   int num_variants,
+                                   KernelVariantSelection* selection);
+
+inline TfLiteStatus EvalKernelVariant(TfLiteContext* context, TfLiteNode* node,
+                                      const KernelVariantSelection& selection) {
+  return selection.variants[selection.selected].eval(context, node);
+}
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_VARIANTS_H_
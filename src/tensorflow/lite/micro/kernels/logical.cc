@@ -12,11 +12,15 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstdint>
+#include <cstring>
+
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/reference/binary_function.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/op_macros.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -29,8 +33,42 @@ constexpr int kInputTensor1 = 0;
 constexpr int kInputTensor2 = 1;
 constexpr int kOutputTensor = 0;
 
+// Word-at-a-time LOGICAL_AND/LOGICAL_OR over contiguous bool arrays. Bool
+// tensors hold one byte of value 0 or 1 per element, so a bitwise AND/OR of
+// the bytes gives the logical result for every lane of the word.
+template <typename WordOp>
+void LogicalContiguous(const bool* input1_data, const bool* input2_data,
+                       bool* output_data, int size, WordOp word_op,
+                       bool (*func)(bool, bool)) {
+  int i = 0;
+  for (; i <= size - static_cast<int>(sizeof(uint32_t));
+       i += sizeof(uint32_t)) {
+    uint32_t word1, word2;
+    std::memcpy(&word1, input1_data + i, sizeof(word1));
+    std::memcpy(&word2, input2_data + i, sizeof(word2));
+    const uint32_t result = word_op(word1, word2);
+    std::memcpy(output_data + i, &result, sizeof(result));
+  }
+  for (; i < size; ++i) {
+    output_data[i] = func(input1_data[i], input2_data[i]);
+  }
+}
+
+// Broadcasting a single bool either forwards the other input or produces a
+// constant: x && true == x, x && false == false, and conversely for OR.
+void LogicalWithScalar(const bool* input_data, bool scalar, bool* output_data,
+                       int size, bool absorbing_value) {
+  if (scalar == absorbing_value) {
+    std::memset(output_data, absorbing_value ? 1 : 0, size);
+  } else if (output_data != input_data) {
+    std::memcpy(output_data, input_data, size);
+  }
+}
+
+template <typename WordOp>
 TfLiteStatus LogicalImpl(TfLiteContext* context, TfLiteNode* node,
-                         bool (*func)(bool, bool)) {
+                         bool (*func)(bool, bool), WordOp word_op,
+                         bool absorbing_value) {
   const TfLiteEvalTensor* input1 =
       tflite::micro::GetEvalInput(context, node, kInputTensor1);
   const TfLiteEvalTensor* input2 =
@@ -38,22 +76,25 @@ TfLiteStatus LogicalImpl(TfLiteContext* context, TfLiteNode* node,
   TfLiteEvalTensor* output =
       tflite::micro::GetEvalOutput(context, node, kOutputTensor);
 
+  const bool* input1_data = tflite::micro::GetTensorData<bool>(input1);
+  const bool* input2_data = tflite::micro::GetTensorData<bool>(input2);
+  bool* output_data = tflite::micro::GetTensorData<bool>(output);
+  const int output_size = ElementCount(*output->dims);
+
   if (tflite::micro::HaveSameShapes(input1, input2)) {
-    reference_ops::BinaryFunction<bool, bool, bool>(
-        tflite::micro::GetTensorShape(input1),
-        tflite::micro::GetTensorData<bool>(input1),
-        tflite::micro::GetTensorShape(input2),
-        tflite::micro::GetTensorData<bool>(input2),
-        tflite::micro::GetTensorShape(output),
-        tflite::micro::GetTensorData<bool>(output), func);
+    LogicalContiguous(input1_data, input2_data, output_data, output_size,
+                      word_op, func);
+  } else if (ElementCount(*input2->dims) == 1) {
+    LogicalWithScalar(input1_data, input2_data[0], output_data, output_size,
+                      absorbing_value);
+  } else if (ElementCount(*input1->dims) == 1) {
+    LogicalWithScalar(input2_data, input1_data[0], output_data, output_size,
+                      absorbing_value);
   } else {
     reference_ops::BroadcastBinaryFunction4DSlow<bool, bool, bool>(
-        tflite::micro::GetTensorShape(input1),
-        tflite::micro::GetTensorData<bool>(input1),
-        tflite::micro::GetTensorShape(input2),
-        tflite::micro::GetTensorData<bool>(input2),
-        tflite::micro::GetTensorShape(output),
-        tflite::micro::GetTensorData<bool>(output), func);
+        tflite::micro::GetTensorShape(input1), input1_data,
+        tflite::micro::GetTensorShape(input2), input2_data,
+        tflite::micro::GetTensorShape(output), output_data, func);
   }
 
   return kTfLiteOk;
@@ -61,14 +102,20 @@ TfLiteStatus LogicalImpl(TfLiteContext* context, TfLiteNode* node,
 
 bool LogicalOr(bool x, bool y) { return x || y; }
 
+uint32_t LogicalOrWord(uint32_t x, uint32_t y) { return x | y; }
+
 TfLiteStatus LogicalOrEval(TfLiteContext* context, TfLiteNode* node) {
-  return LogicalImpl(context, node, LogicalOr);
+  return LogicalImpl(context, node, LogicalOr, LogicalOrWord,
+                     /*absorbing_value=*/true);
 }
 
 bool LogicalAnd(bool x, bool y) { return x && y; }
 
+uint32_t LogicalAndWord(uint32_t x, uint32_t y) { return x & y; }
+
 TfLiteStatus LogicalAndEval(TfLiteContext* context, TfLiteNode* node) {
-  return LogicalImpl(context, node, LogicalAnd);
+  return LogicalImpl(context, node, LogicalAnd, LogicalAndWord,
+                     /*absorbing_value=*/false);
 }
 
 }  // namespace
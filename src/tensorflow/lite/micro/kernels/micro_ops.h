@@ -34,15 +34,19 @@ TfLiteRegistration Register_ADD();
 TfLiteRegistration Register_ARG_MAX();
 TfLiteRegistration Register_ARG_MIN();
 TfLiteRegistration Register_AVERAGE_POOL_2D();
+TfLiteRegistration Register_BATCH_TO_SPACE_ND();
 TfLiteRegistration Register_CEIL();
 // TODO(b/160234179): Change custom OPs to also return by value.
 TfLiteRegistration* Register_CIRCULAR_BUFFER();
 TfLiteRegistration Register_CONV_2D();
 TfLiteRegistration Register_CONCATENATION();
 TfLiteRegistration Register_COS();
+TfLiteRegistration Register_DEPTH_TO_SPACE();
 TfLiteRegistration Register_DEPTHWISE_CONV_2D();
 TfLiteRegistration Register_DEQUANTIZE();
+TfLiteRegistration* Register_DETECTION_POSTPROCESS();
 TfLiteRegistration Register_EQUAL();
+TfLiteRegistration Register_EXP();
 TfLiteRegistration Register_FLOOR();
 TfLiteRegistration Register_FULLY_CONNECTED();
 TfLiteRegistration Register_GREATER();
@@ -74,8 +78,12 @@ TfLiteRegistration Register_RESHAPE();
 TfLiteRegistration Register_RESIZE_NEAREST_NEIGHBOR();
 TfLiteRegistration Register_ROUND();
 TfLiteRegistration Register_RSQRT();
+TfLiteRegistration Register_SELECT();
+TfLiteRegistration Register_SELECT_V2();
 TfLiteRegistration Register_SIN();
 TfLiteRegistration Register_SOFTMAX();
+TfLiteRegistration Register_SPACE_TO_BATCH_ND();
+TfLiteRegistration Register_SPACE_TO_DEPTH();
 TfLiteRegistration Register_SPLIT();
 TfLiteRegistration Register_SPLIT_V();
 TfLiteRegistration Register_SQRT();
@@ -83,6 +91,7 @@ TfLiteRegistration Register_SQUARE();
 TfLiteRegistration Register_STRIDED_SLICE();
 TfLiteRegistration Register_SUB();
 TfLiteRegistration Register_SVDF();
+TfLiteRegistration Register_TOPK_V2();
 TfLiteRegistration Register_UNPACK();
 TfLiteRegistration Register_L2_NORMALIZATION();
 TfLiteRegistration Register_TANH();
@@ -58,9 +58,65 @@ TfLiteStatus CalculateOpData(const TfLiteContext* context,
   return kTfLiteOk;
 }
 
-void AverageEvalFloat(const TfLiteContext* context, const TfLiteNode* node,
-                      const TfLitePoolParams* params, const OpData* data,
-                      const TfLiteEvalTensor* input, TfLiteEvalTensor* output) {
+// A reference pooling kernel for elements of type T.
+template <typename T>
+using PoolFn = void (*)(const PoolParams& params,
+                        const RuntimeShape& input_shape, const T* input_data,
+                        const RuntimeShape& output_shape, T* output_data);
+
+// Runs `pool` on output rows [first_row, end_row) of every batch. The kernel
+// is given the band of input rows from the first one these outputs read, with
+// the top padding shifted so that every window keeps its position and valid
+// area.
+template <typename T>
+void PoolRows(PoolFn<T> pool, const PoolParams& params,
+              const TfLiteEvalTensor* input, TfLiteEvalTensor* output,
+              int first_row, int end_row) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int in_y_origin =
+      first_row * params.stride_height - params.padding_values.height;
+  const int first_input_row = std::max(0, in_y_origin);
+  PoolParams band_params = params;
+  band_params.padding_values.height = first_input_row - in_y_origin;
+  const RuntimeShape band_input_shape(
+      {1, input_shape.Dims(1) - first_input_row, input_shape.Dims(2),
+       input_shape.Dims(3)});
+  const RuntimeShape band_output_shape(
+      {1, end_row - first_row, output_shape.Dims(2), output_shape.Dims(3)});
+  const T* input_data = tflite::micro::GetTensorData<T>(input);
+  T* output_data = tflite::micro::GetTensorData<T>(output);
+  for (int batch = 0; batch < batches; ++batch) {
+    pool(band_params, band_input_shape,
+         input_data + Offset(input_shape, batch, first_input_row, 0, 0),
+         band_output_shape,
+         output_data + Offset(output_shape, batch, first_row, 0, 0));
+  }
+}
+
+// Runs `pool` over the whole output, split into chunks of output rows with
+// ParallelFor().
+template <typename T>
+TfLiteStatus Pool(TfLiteContext* context, PoolFn<T> pool,
+                  const PoolParams& params, const TfLiteEvalTensor* input,
+                  TfLiteEvalTensor* output) {
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int64_t window_reads_per_row =
+      static_cast<int64_t>(output_shape.Dims(0)) * output_shape.Dims(2) *
+      output_shape.Dims(3) * params.filter_height * params.filter_width;
+  return tflite::micro::ParallelFor(
+      context, output_shape.Dims(1), window_reads_per_row,
+      [&](int begin, int end) {
+        PoolRows(pool, params, input, output, begin, end);
+      });
+}
+
+TfLiteStatus AverageEvalFloat(TfLiteContext* context, const TfLiteNode* node,
+                              const TfLitePoolParams* params,
+                              const OpData* data,
+                              const TfLiteEvalTensor* input,
+                              TfLiteEvalTensor* output) {
   PoolParams op_params;
   op_params.stride_height = params->stride_height;
   op_params.stride_width = params->stride_width;
@@ -70,16 +126,16 @@ void AverageEvalFloat(const TfLiteContext* context, const TfLiteNode* node,
   op_params.padding_values.width = data->padding.width;
   op_params.float_activation_min = data->activation_min_f32;
   op_params.float_activation_max = data->activation_max_f32;
-  reference_ops::AveragePool(op_params, tflite::micro::GetTensorShape(input),
-                             tflite::micro::GetTensorData<float>(input),
-                             tflite::micro::GetTensorShape(output),
-                             tflite::micro::GetTensorData<float>(output));
+  return Pool<float>(context, reference_ops::AveragePool, op_params, input,
+                     output);
 }
 
-void AverageEvalQuantized(TfLiteContext* context, const TfLiteNode* node,
-                          const TfLitePoolParams* params, const OpData* data,
-                          const TfLiteEvalTensor* input,
-                          TfLiteEvalTensor* output) {
+TfLiteStatus AverageEvalQuantized(TfLiteContext* context,
+                                  const TfLiteNode* node,
+                                  const TfLitePoolParams* params,
+                                  const OpData* data,
+                                  const TfLiteEvalTensor* input,
+                                  TfLiteEvalTensor* output) {
   TFLITE_DCHECK(input->type == kTfLiteUInt8 || input->type == kTfLiteInt8);
 
   PoolParams op_params;
@@ -93,22 +149,17 @@ void AverageEvalQuantized(TfLiteContext* context, const TfLiteNode* node,
   op_params.quantized_activation_max = data->activation_max;
 
   if (input->type == kTfLiteUInt8) {
-    reference_ops::AveragePool(op_params, tflite::micro::GetTensorShape(input),
-                               tflite::micro::GetTensorData<uint8_t>(input),
-                               tflite::micro::GetTensorShape(output),
-                               tflite::micro::GetTensorData<uint8_t>(output));
-  } else {
-    reference_integer_ops::AveragePool(
-        op_params, tflite::micro::GetTensorShape(input),
-        tflite::micro::GetTensorData<int8_t>(input),
-        tflite::micro::GetTensorShape(output),
-        tflite::micro::GetTensorData<int8_t>(output));
+    return Pool<uint8_t>(context, reference_ops::AveragePool, op_params, input,
+                         output);
   }
+  return Pool<int8_t>(context, reference_integer_ops::AveragePool, op_params,
+                      input, output);
 }
 
-void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
-                  TfLitePoolParams* params, const OpData* data,
-                  const TfLiteEvalTensor* input, TfLiteEvalTensor* output) {
+TfLiteStatus MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
+                          TfLitePoolParams* params, const OpData* data,
+                          const TfLiteEvalTensor* input,
+                          TfLiteEvalTensor* output) {
   tflite::PoolParams op_params;
   op_params.stride_height = params->stride_height;
   op_params.stride_width = params->stride_width;
@@ -118,15 +169,13 @@ void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.padding_values.width = data->padding.width;
   op_params.float_activation_min = data->activation_min_f32;
   op_params.float_activation_max = data->activation_max_f32;
-  reference_ops::MaxPool(op_params, tflite::micro::GetTensorShape(input),
-                         tflite::micro::GetTensorData<float>(input),
-                         tflite::micro::GetTensorShape(output),
-                         tflite::micro::GetTensorData<float>(output));
+  return Pool<float>(context, reference_ops::MaxPool, op_params, input, output);
 }
 
-void MaxEvalQuantized(TfLiteContext* context, TfLiteNode* node,
-                      TfLitePoolParams* params, const OpData* data,
-                      const TfLiteEvalTensor* input, TfLiteEvalTensor* output) {
+TfLiteStatus MaxEvalQuantized(TfLiteContext* context, TfLiteNode* node,
+                              TfLitePoolParams* params, const OpData* data,
+                              const TfLiteEvalTensor* input,
+                              TfLiteEvalTensor* output) {
   tflite::PoolParams op_params;
   op_params.stride_height = params->stride_height;
   op_params.stride_width = params->stride_width;
@@ -138,17 +187,11 @@ void MaxEvalQuantized(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_max = data->activation_max;
 
   if (input->type == kTfLiteUInt8) {
-    reference_ops::MaxPool(op_params, tflite::micro::GetTensorShape(input),
-                           tflite::micro::GetTensorData<uint8_t>(input),
-                           tflite::micro::GetTensorShape(output),
-                           tflite::micro::GetTensorData<uint8_t>(output));
-  } else {
-    reference_integer_ops::MaxPool(
-        op_params, tflite::micro::GetTensorShape(input),
-        tflite::micro::GetTensorData<int8_t>(input),
-        tflite::micro::GetTensorShape(output),
-        tflite::micro::GetTensorData<int8_t>(output));
+    return Pool<uint8_t>(context, reference_ops::MaxPool, op_params, input,
+                         output);
   }
+  return Pool<int8_t>(context, reference_integer_ops::MaxPool, op_params,
+                      input, output);
 }
 }  // namespace
 
@@ -167,18 +210,15 @@ TfLiteStatus AverageEval(TfLiteContext* context, TfLiteNode* node) {
   // Inputs and outputs share the same type, guaranteed by the converter.
   switch (input->type) {
     case kTfLiteFloat32:
-      AverageEvalFloat(context, node, params, data, input, output);
-      break;
+      return AverageEvalFloat(context, node, params, data, input, output);
     case kTfLiteUInt8:
     case kTfLiteInt8:
-      AverageEvalQuantized(context, node, params, data, input, output);
-      break;
+      return AverageEvalQuantized(context, node, params, data, input, output);
     default:
       TF_LITE_KERNEL_LOG(context, "Input type %s is not currently supported",
                          TfLiteTypeGetName(input->type));
       return kTfLiteError;
   }
-  return kTfLiteOk;
 }
 
 TfLiteStatus MaxEval(TfLiteContext* context, TfLiteNode* node) {
@@ -195,18 +235,15 @@ TfLiteStatus MaxEval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (input->type) {
     case kTfLiteFloat32:
-      MaxEvalFloat(context, node, params, data, input, output);
-      break;
+      return MaxEvalFloat(context, node, params, data, input, output);
     case kTfLiteUInt8:
     case kTfLiteInt8:
-      MaxEvalQuantized(context, node, params, data, input, output);
-      break;
+      return MaxEvalQuantized(context, node, params, data, input, output);
     default:
       TF_LITE_KERNEL_LOG(context, "Type %s not currently supported.",
                          TfLiteTypeGetName(input->type));
       return kTfLiteError;
   }
-  return kTfLiteOk;
 }
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
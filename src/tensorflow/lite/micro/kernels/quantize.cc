@@ -66,12 +66,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TF_LITE_ENSURE(context, input->type == kTfLiteFloat32 ||
                               input->type == kTfLiteInt16 ||
-                              input->type == kTfLiteInt8);
+                              input->type == kTfLiteInt8 ||
+                              input->type == kTfLiteUInt8);
   TF_LITE_ENSURE(context, output->type == kTfLiteUInt8 ||
                               output->type == kTfLiteInt8 ||
                               output->type == kTfLiteInt16);
 
-  if (((input->type == kTfLiteInt16 || input->type == kTfLiteInt8) &&
+  if (((input->type == kTfLiteInt16 || input->type == kTfLiteInt8 ||
+        input->type == kTfLiteUInt8) &&
        output->type == kTfLiteInt8) ||
       (input->type == kTfLiteInt16 && output->type == kTfLiteInt16)) {
     double effective_scale = static_cast<double>(input->params.scale) /
@@ -165,6 +167,24 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                            TfLiteTypeGetName(output->type));
         return kTfLiteError;
     }
+  } else if (input->type == kTfLiteUInt8) {
+    // Uint8 to Int8 requantization of image input, left in place when the
+    // graph rewriter cannot fold it into a shallow convolution.
+    size_t size = ElementCount(*input->dims);
+    switch (output->type) {
+      case kTfLiteInt8:
+        reference_ops::Requantize(
+            tflite::micro::GetTensorData<uint8_t>(input), size,
+            data->output_multiplier, data->output_shift, data->input_zero_point,
+            data->quantization_params.zero_point,
+            tflite::micro::GetTensorData<int8_t>(output));
+        break;
+      default:
+        TF_LITE_KERNEL_LOG(context, "Input %s, output %s not supported.",
+                           TfLiteTypeGetName(input->type),
+                           TfLiteTypeGetName(output->type));
+        return kTfLiteError;
+    }
   } else {
     TF_LITE_KERNEL_LOG(context, "Input %s, output %s not supported.",
                        TfLiteTypeGetName(input->type),
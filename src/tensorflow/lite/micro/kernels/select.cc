@@ -0,0 +1,359 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/reference/select.h"
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/reference/comparisons.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/select.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace select {
+
+constexpr int kInputTensorCondition = 0;
+constexpr int kInputTensorX = 1;
+constexpr int kInputTensorY = 2;
+// Only present when a comparison has been folded into the node, in which case
+// kInputTensorCondition holds the left hand side of the comparison.
+constexpr int kInputTensorRhs = 3;
+constexpr int kOutputTensor = 0;
+
+enum class KernelType {
+  // Every input has the output shape or is a single element.
+  kStrided,
+  // SELECT with a rank one condition choosing whole rows of x or y.
+  kRankOne,
+  // SELECT_V2 with general broadcasting.
+  kBroadcast,
+};
+
+struct OpData {
+  KernelType kernel_type;
+  // Element stride of each input in the kStrided kernel: 1, or 0 for inputs
+  // holding a single element.
+  int condition_stride;
+  int x_stride;
+  int y_stride;
+  int rhs_stride;
+  // Comparison folded into this node, only valid if `is_fused` is set.
+  BuiltinOperator comparison;
+  bool is_fused;
+};
+
+bool IsComparison(BuiltinOperator op) {
+  return op == BuiltinOperator_EQUAL || op == BuiltinOperator_NOT_EQUAL ||
+         op == BuiltinOperator_GREATER ||
+         op == BuiltinOperator_GREATER_EQUAL || op == BuiltinOperator_LESS ||
+         op == BuiltinOperator_LESS_EQUAL;
+}
+
+// Returns the stride for `input` in the kStrided kernel, or -1 if the input
+// needs to be broadcast in a way the strided kernel does not handle.
+int StridedInputStride(const TfLiteTensor* input, const TfLiteTensor* output) {
+  if (HaveSameShapes(input, output)) {
+    return 1;
+  }
+  if (NumElements(input) == 1) {
+    return 0;
+  }
+  return -1;
+}
+
+template <typename T>
+void SelectStrided(const OpData& data, const bool* condition_data,
+                   const T* x_data, const T* y_data, T* output_data,
+                   int size) {
+  for (int i = 0; i < size; ++i) {
+    output_data[i] = condition_data[i * data.condition_stride]
+                         ? x_data[i * data.x_stride]
+                         : y_data[i * data.y_stride];
+  }
+}
+
+template <typename T, reference_ops::ComparisonFn<T> F>
+void ComparisonSelectStrided(const OpData& data, const T* lhs_data,
+                             const T* rhs_data, const T* x_data,
+                             const T* y_data, T* output_data, int size) {
+  for (int i = 0; i < size; ++i) {
+    output_data[i] = F(lhs_data[i * data.condition_stride],
+                       rhs_data[i * data.rhs_stride])
+                         ? x_data[i * data.x_stride]
+                         : y_data[i * data.y_stride];
+  }
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
+                         bool is_v2) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+
+  data->is_fused = node->builtin_data != nullptr;
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), data->is_fused ? 4 : 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* input_condition =
+      GetInput(context, node, kInputTensorCondition);
+  TF_LITE_ENSURE(context, input_condition != nullptr);
+  const TfLiteTensor* input_x = GetInput(context, node, kInputTensorX);
+  TF_LITE_ENSURE(context, input_x != nullptr);
+  const TfLiteTensor* input_y = GetInput(context, node, kInputTensorY);
+  TF_LITE_ENSURE(context, input_y != nullptr);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input_x->type, input_y->type);
+  TF_LITE_ENSURE_TYPES_EQ(context, input_x->type, output->type);
+
+  data->condition_stride = StridedInputStride(input_condition, output);
+  data->x_stride = StridedInputStride(input_x, output);
+  data->y_stride = StridedInputStride(input_y, output);
+  const bool is_strided = data->condition_stride >= 0 &&
+                          data->x_stride >= 0 && data->y_stride >= 0;
+
+  if (data->is_fused) {
+    const auto* params =
+        static_cast<const FusedComparisonSelectParams*>(node->builtin_data);
+    TF_LITE_ENSURE(context, IsComparison(params->comparison));
+    data->comparison = params->comparison;
+
+    const TfLiteTensor* input_rhs = GetInput(context, node, kInputTensorRhs);
+    TF_LITE_ENSURE(context, input_rhs != nullptr);
+    TF_LITE_ENSURE_TYPES_EQ(context, input_condition->type, input_x->type);
+    TF_LITE_ENSURE_TYPES_EQ(context, input_rhs->type, input_x->type);
+    data->rhs_stride = StridedInputStride(input_rhs, output);
+    TF_LITE_ENSURE(context, is_strided && data->rhs_stride >= 0);
+    data->kernel_type = KernelType::kStrided;
+    return kTfLiteOk;
+  }
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input_condition->type, kTfLiteBool);
+  if (is_strided) {
+    data->kernel_type = KernelType::kStrided;
+  } else if (!is_v2) {
+    // SELECT only allows a condition of the input shape or of rank one.
+    TF_LITE_ENSURE(context, HaveSameShapes(input_x, input_y));
+    TF_LITE_ENSURE(context, HaveSameShapes(input_x, output));
+    TF_LITE_ENSURE_EQ(context, NumDimensions(input_condition), 1);
+    data->kernel_type = KernelType::kRankOne;
+  } else {
+    TF_LITE_ENSURE(context, NumDimensions(input_condition) <= 4);
+    TF_LITE_ENSURE(context, NumDimensions(input_x) <= 4);
+    TF_LITE_ENSURE(context, NumDimensions(input_y) <= 4);
+    TF_LITE_ENSURE(context, NumDimensions(output) <= 4);
+    data->kernel_type = KernelType::kBroadcast;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus SelectPrepare(TfLiteContext* context, TfLiteNode* node) {
+  return PrepareImpl(context, node, /*is_v2=*/false);
+}
+
+TfLiteStatus SelectV2Prepare(TfLiteContext* context, TfLiteNode* node) {
+  return PrepareImpl(context, node, /*is_v2=*/true);
+}
+
+template <typename T>
+void EvalSelect(const OpData& data, const TfLiteEvalTensor* input_condition,
+                const TfLiteEvalTensor* input_x,
+                const TfLiteEvalTensor* input_y, TfLiteEvalTensor* output) {
+  const bool* condition_data =
+      tflite::micro::GetTensorData<bool>(input_condition);
+  const T* x_data = tflite::micro::GetTensorData<T>(input_x);
+  const T* y_data = tflite::micro::GetTensorData<T>(input_y);
+  T* output_data = tflite::micro::GetTensorData<T>(output);
+
+  switch (data.kernel_type) {
+    case KernelType::kStrided:
+      SelectStrided(data, condition_data, x_data, y_data, output_data,
+                    ElementCount(*output->dims));
+      break;
+    case KernelType::kRankOne:
+      reference_ops::RankOneSelect(
+          tflite::micro::GetTensorShape(input_condition), condition_data,
+          tflite::micro::GetTensorShape(input_x), x_data,
+          tflite::micro::GetTensorShape(input_y), y_data,
+          tflite::micro::GetTensorShape(output), output_data);
+      break;
+    case KernelType::kBroadcast:
+      reference_ops::BroadcastSelect4DSlow(
+          tflite::micro::GetTensorShape(input_condition), condition_data,
+          tflite::micro::GetTensorShape(input_x), x_data,
+          tflite::micro::GetTensorShape(input_y), y_data,
+          tflite::micro::GetTensorShape(output), output_data);
+      break;
+  }
+}
+
+template <typename T>
+void EvalComparisonSelect(const OpData& data, const TfLiteEvalTensor* lhs,
+                          const TfLiteEvalTensor* rhs,
+                          const TfLiteEvalTensor* input_x,
+                          const TfLiteEvalTensor* input_y,
+                          TfLiteEvalTensor* output) {
+  const T* lhs_data = tflite::micro::GetTensorData<T>(lhs);
+  const T* rhs_data = tflite::micro::GetTensorData<T>(rhs);
+  const T* x_data = tflite::micro::GetTensorData<T>(input_x);
+  const T* y_data = tflite::micro::GetTensorData<T>(input_y);
+  T* output_data = tflite::micro::GetTensorData<T>(output);
+  const int size = ElementCount(*output->dims);
+
+  switch (data.comparison) {
+    case BuiltinOperator_EQUAL:
+      ComparisonSelectStrided<T, reference_ops::EqualFn<T>>(
+          data, lhs_data, rhs_data, x_data, y_data, output_data, size);
+      break;
+    case BuiltinOperator_NOT_EQUAL:
+      ComparisonSelectStrided<T, reference_ops::NotEqualFn<T>>(
+          data, lhs_data, rhs_data, x_data, y_data, output_data, size);
+      break;
+    case BuiltinOperator_GREATER:
+      ComparisonSelectStrided<T, reference_ops::GreaterFn<T>>(
+          data, lhs_data, rhs_data, x_data, y_data, output_data, size);
+      break;
+    case BuiltinOperator_GREATER_EQUAL:
+      ComparisonSelectStrided<T, reference_ops::GreaterEqualFn<T>>(
+          data, lhs_data, rhs_data, x_data, y_data, output_data, size);
+      break;
+    case BuiltinOperator_LESS:
+      ComparisonSelectStrided<T, reference_ops::LessFn<T>>(
+          data, lhs_data, rhs_data, x_data, y_data, output_data, size);
+      break;
+    case BuiltinOperator_LESS_EQUAL:
+      ComparisonSelectStrided<T, reference_ops::LessEqualFn<T>>(
+          data, lhs_data, rhs_data, x_data, y_data, output_data, size);
+      break;
+    default:
+      // Rejected in Prepare.
+      break;
+  }
+}
+
+TfLiteStatus EvalFused(TfLiteContext* context, TfLiteNode* node,
+                       const OpData& data) {
+  const TfLiteEvalTensor* lhs =
+      tflite::micro::GetEvalInput(context, node, kInputTensorCondition);
+  const TfLiteEvalTensor* rhs =
+      tflite::micro::GetEvalInput(context, node, kInputTensorRhs);
+  const TfLiteEvalTensor* input_x =
+      tflite::micro::GetEvalInput(context, node, kInputTensorX);
+  const TfLiteEvalTensor* input_y =
+      tflite::micro::GetEvalInput(context, node, kInputTensorY);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  switch (input_x->type) {
+    case kTfLiteFloat32:
+      EvalComparisonSelect<float>(data, lhs, rhs, input_x, input_y, output);
+      break;
+    case kTfLiteInt8:
+      EvalComparisonSelect<int8_t>(data, lhs, rhs, input_x, input_y, output);
+      break;
+    case kTfLiteUInt8:
+      EvalComparisonSelect<uint8_t>(data, lhs, rhs, input_x, input_y, output);
+      break;
+    case kTfLiteInt32:
+      EvalComparisonSelect<int32_t>(data, lhs, rhs, input_x, input_y, output);
+      break;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                         TfLiteTypeGetName(input_x->type), input_x->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  if (data.is_fused) {
+    return EvalFused(context, node, data);
+  }
+
+  const TfLiteEvalTensor* input_condition =
+      tflite::micro::GetEvalInput(context, node, kInputTensorCondition);
+  const TfLiteEvalTensor* input_x =
+      tflite::micro::GetEvalInput(context, node, kInputTensorX);
+  const TfLiteEvalTensor* input_y =
+      tflite::micro::GetEvalInput(context, node, kInputTensorY);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  switch (input_x->type) {
+    case kTfLiteFloat32:
+      EvalSelect<float>(data, input_condition, input_x, input_y, output);
+      break;
+    case kTfLiteInt8:
+      EvalSelect<int8_t>(data, input_condition, input_x, input_y, output);
+      break;
+    case kTfLiteUInt8:
+      EvalSelect<uint8_t>(data, input_condition, input_x, input_y, output);
+      break;
+    case kTfLiteInt16:
+      EvalSelect<int16_t>(data, input_condition, input_x, input_y, output);
+      break;
+    case kTfLiteInt32:
+      EvalSelect<int32_t>(data, input_condition, input_x, input_y, output);
+      break;
+    case kTfLiteBool:
+      EvalSelect<bool>(data, input_condition, input_x, input_y, output);
+      break;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                         TfLiteTypeGetName(input_x->type), input_x->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace select
+
+TfLiteRegistration Register_SELECT() {
+  return {/*init=*/select::Init,
+          /*free=*/nullptr,
+          /*prepare=*/select::SelectPrepare,
+          /*invoke=*/select::Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+TfLiteRegistration Register_SELECT_V2() {
+  return {/*init=*/select::Init,
+          /*free=*/nullptr,
+          /*prepare=*/select::SelectV2Prepare,
+          /*invoke=*/select::Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,51 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_SELECT_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_SELECT_H_
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+// Builtin data attached to a SELECT/SELECT_V2 node by the graph rewriter when
+// the comparison producing its condition has been folded into it. The node
+// inputs are then {lhs, x, y, rhs} and the kernel evaluates
+// `(lhs <comparison> rhs) ? x : y` in one pass, without the intermediate bool
+// tensor. All four inputs have the type of the output, and each one either
+// has the output shape or holds a single element.
+struct FusedComparisonSelectParams {
+  BuiltinOperator comparison;
+};
+
+// Left shift the comparison kernels apply to quantized values before
+// rescaling them.
+constexpr int kComparisonLeftShift = 8;
+
+// Whether the comparison kernels compare uint8/int8 operands that share
+// `scale` and zero point raw. One quantization step must stay at least one
+// unit after the left shift, otherwise rescaling can merge neighbouring raw
+// values and the result differs. The fused SELECT always compares raw, so the
+// graph rewriter only fuses comparisons for which this holds.
+inline bool ComparesQuantizedRaw(float scale) {
+  return scale * (1 << kComparisonLeftShift) >= 1.0f;
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_SELECT_H_
@@ -0,0 +1,307 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/separable_conv.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace separable_conv {
+namespace {
+
+constexpr int kOutputTensor = 0;
+
+struct OpData {
+  TfLitePaddingValues padding;
+  int32_t input_zero_point;
+  int32_t intermediate_zero_point;
+  int32_t output_zero_point;
+
+  // Requantization of the depthwise and pointwise stages, per channel.
+  int32_t* depthwise_multiplier;
+  int32_t* depthwise_shift;
+  int32_t* pointwise_multiplier;
+  int32_t* pointwise_shift;
+  int32_t depthwise_activation_min;
+  int32_t depthwise_activation_max;
+  int32_t pointwise_activation_min;
+  int32_t pointwise_activation_max;
+
+  // Pointwise bias with the intermediate zero point folded in.
+  int32_t* pointwise_bias;
+  // Index of the scratch buffer holding one row of the depthwise output.
+  int row_buffer_index;
+};
+
+const TfLiteEvalTensor* GetOptionalEvalInput(const TfLiteContext* context,
+                                             const TfLiteNode* node,
+                                             int index) {
+  return node->inputs->data[index] == kTfLiteOptionalTensor
+             ? nullptr
+             : tflite::micro::GetEvalInput(context, node, index);
+}
+
+// Computes row `out_y` of the depthwise output, requantized to the
+// intermediate tensor, into `row`.
+void EvalDepthwiseRow(const FusedSeparableConvParams& params,
+                      const OpData& data, int batch, int out_y,
+                      const RuntimeShape& input_shape, const int8_t* input,
+                      const RuntimeShape& filter_shape, const int8_t* filter,
+                      const int32_t* bias, int output_width, int8_t* row) {
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int in_y_origin =
+      out_y * params.depthwise.stride_height - data.padding.height;
+  for (int out_x = 0; out_x < output_width; ++out_x) {
+    const int in_x_origin =
+        out_x * params.depthwise.stride_width - data.padding.width;
+    for (int c = 0; c < depth; ++c) {
+      int32_t acc = 0;
+      for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+        const int in_y = in_y_origin + filter_y;
+        if (in_y < 0 || in_y >= input_height) {
+          continue;
+        }
+        for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+          const int in_x = in_x_origin + filter_x;
+          if (in_x < 0 || in_x >= input_width) {
+            continue;
+          }
+          const int32_t input_val =
+              input[Offset(input_shape, batch, in_y, in_x, c)];
+          const int32_t filter_val =
+              filter[Offset(filter_shape, 0, filter_y, filter_x, c)];
+          acc += filter_val * (input_val - data.input_zero_point);
+        }
+      }
+      if (bias != nullptr) {
+        acc += bias[c];
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, data.depthwise_multiplier[c],
+                                          data.depthwise_shift[c]);
+      acc += data.intermediate_zero_point;
+      acc = std::max(acc, data.depthwise_activation_min);
+      acc = std::min(acc, data.depthwise_activation_max);
+      row[out_x * depth + c] = static_cast<int8_t>(acc);
+    }
+  }
+}
+
+}  // namespace
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const auto* params =
+      static_cast<const FusedSeparableConvParams*>(node->builtin_data);
+
+  TF_LITE_ENSURE_EQ(context, node->inputs->size, kSeparableConvNumInputs);
+  TF_LITE_ENSURE_EQ(context, node->outputs->size, 1);
+  const TfLiteTensor* input =
+      GetInput(context, node, kSeparableConvInputTensor);
+  const TfLiteTensor* depthwise_filter =
+      GetInput(context, node, kSeparableConvDepthwiseFilterTensor);
+  const TfLiteTensor* depthwise_bias =
+      GetOptionalInputTensor(context, node, kSeparableConvDepthwiseBiasTensor);
+  const TfLiteTensor* pointwise_filter =
+      GetInput(context, node, kSeparableConvPointwiseFilterTensor);
+  const TfLiteTensor* pointwise_bias =
+      GetOptionalInputTensor(context, node, kSeparableConvPointwiseBiasTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE(context, input != nullptr && depthwise_filter != nullptr &&
+                              pointwise_filter != nullptr && output != nullptr);
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+
+  const int depth = SizeOfDimension(input, 3);
+  const int output_depth = SizeOfDimension(output, 3);
+  const int output_width = SizeOfDimension(output, 2);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(depthwise_filter, 3), depth);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(pointwise_filter, 3), depth);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(pointwise_filter, 0),
+                    output_depth);
+
+  int output_height_unused, output_width_unused;
+  data->padding = ComputePaddingHeightWidth(
+      params->depthwise.stride_height, params->depthwise.stride_width, 1, 1,
+      SizeOfDimension(input, 1), SizeOfDimension(input, 2),
+      SizeOfDimension(depthwise_filter, 1),
+      SizeOfDimension(depthwise_filter, 2), params->depthwise.padding,
+      &output_height_unused, &output_width_unused);
+
+  data->depthwise_multiplier = static_cast<int32_t*>(
+      context->AllocatePersistentBuffer(context, depth * sizeof(int32_t)));
+  data->depthwise_shift = static_cast<int32_t*>(
+      context->AllocatePersistentBuffer(context, depth * sizeof(int32_t)));
+  data->pointwise_multiplier =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, output_depth * sizeof(int32_t)));
+  data->pointwise_shift =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, output_depth * sizeof(int32_t)));
+  data->pointwise_bias =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, output_depth * sizeof(int32_t)));
+  TF_LITE_ENSURE(context, data->depthwise_multiplier != nullptr &&
+                              data->depthwise_shift != nullptr &&
+                              data->pointwise_multiplier != nullptr &&
+                              data->pointwise_shift != nullptr &&
+                              data->pointwise_bias != nullptr);
+
+  // Stands in for the depthwise output, which has no tensor data.
+  TfLiteTensor intermediate = {};
+  intermediate.type = kTfLiteInt8;
+  intermediate.params.scale = params->intermediate_scale;
+  intermediate.params.zero_point = params->intermediate_zero_point;
+  intermediate.quantization.type = kTfLiteAffineQuantization;
+
+  int32_t unused_multiplier;
+  int unused_shift;
+  TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+      context, input, depthwise_filter, depthwise_bias, &intermediate,
+      params->depthwise.activation, &unused_multiplier, &unused_shift,
+      &data->depthwise_activation_min, &data->depthwise_activation_max,
+      data->depthwise_multiplier,
+      reinterpret_cast<int*>(data->depthwise_shift), depth));
+  // Like the int8 DEPTHWISE_CONV_2D kernel, the depthwise stage only clamps to
+  // the int8 range, its activation is part of the intermediate quantization.
+  data->depthwise_activation_min = std::numeric_limits<int8_t>::min();
+  data->depthwise_activation_max = std::numeric_limits<int8_t>::max();
+  TF_LITE_ENSURE_STATUS(tflite::PopulateConvolutionQuantizationParams(
+      context, &intermediate, pointwise_filter, pointwise_bias, output,
+      params->pointwise.activation, &unused_multiplier, &unused_shift,
+      &data->pointwise_activation_min, &data->pointwise_activation_max,
+      data->pointwise_multiplier,
+      reinterpret_cast<int*>(data->pointwise_shift), output_depth));
+
+  data->input_zero_point = input->params.zero_point;
+  data->intermediate_zero_point = params->intermediate_zero_point;
+  data->output_zero_point = output->params.zero_point;
+  tflite::micro::ComputeEffectiveBias(
+      GetTensorData<int8_t>(pointwise_filter),
+      pointwise_bias != nullptr ? GetTensorData<int32_t>(pointwise_bias)
+                                : nullptr,
+      output_depth, depth, params->intermediate_zero_point,
+      data->pointwise_bias);
+
+  return context->RequestScratchBufferInArena(
+      context, output_width * depth, &data->row_buffer_index);
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const auto& params =
+      *static_cast<const FusedSeparableConvParams*>(node->builtin_data);
+  const OpData& data = *static_cast<const OpData*>(node->user_data);
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kSeparableConvInputTensor);
+  const TfLiteEvalTensor* depthwise_filter = tflite::micro::GetEvalInput(
+      context, node, kSeparableConvDepthwiseFilterTensor);
+  const TfLiteEvalTensor* depthwise_bias =
+      GetOptionalEvalInput(context, node, kSeparableConvDepthwiseBiasTensor);
+  const TfLiteEvalTensor* pointwise_filter = tflite::micro::GetEvalInput(
+      context, node, kSeparableConvPointwiseFilterTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape filter_shape =
+      tflite::micro::GetTensorShape(depthwise_filter);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = input_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* depthwise_filter_data =
+      tflite::micro::GetTensorData<int8_t>(depthwise_filter);
+  const int32_t* depthwise_bias_data =
+      depthwise_bias != nullptr
+          ? tflite::micro::GetTensorData<int32_t>(depthwise_bias)
+          : nullptr;
+  const int8_t* pointwise_filter_data =
+      tflite::micro::GetTensorData<int8_t>(pointwise_filter);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  int8_t* row = static_cast<int8_t*>(
+      context->GetScratchBuffer(context, data.row_buffer_index));
+  TFLITE_DCHECK(row != nullptr);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      EvalDepthwiseRow(params, data, batch, out_y, input_shape, input_data,
+                       filter_shape, depthwise_filter_data,
+                       depthwise_bias_data, output_width, row);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int8_t* in = row + out_x * depth;
+        int8_t* out =
+            output_data + Offset(output_shape, batch, out_y, out_x, 0);
+        for (int out_c = 0; out_c < output_depth; ++out_c) {
+          const int8_t* weights = pointwise_filter_data + out_c * depth;
+          int32_t acc = 0;
+          for (int d = 0; d < depth; ++d) {
+            acc += weights[d] * in[d];
+          }
+          acc += data.pointwise_bias[out_c];
+          acc = MultiplyByQuantizedMultiplier(
+              acc, data.pointwise_multiplier[out_c],
+              data.pointwise_shift[out_c]);
+          acc += data.output_zero_point;
+          acc = std::max(acc, data.pointwise_activation_min);
+          acc = std::min(acc, data.pointwise_activation_max);
+          out[out_c] = static_cast<int8_t>(acc);
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace separable_conv
+
+TfLiteRegistration Register_FUSED_SEPARABLE_CONV_2D() {
+  return {/*init=*/separable_conv::Init,
+          /*free=*/nullptr,
+          /*prepare=*/separable_conv::Prepare,
+          /*invoke=*/separable_conv::Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
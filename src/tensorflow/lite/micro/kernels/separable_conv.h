@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_SEPARABLE_CONV_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_SEPARABLE_CONV_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+// Builtin data of the node the graph rewriter makes out of an int8
+// DEPTHWISE_CONV_2D (depth multiplier and dilation 1) whose only consumer is
+// a 1x1 CONV_2D with stride 1, the separable block of MobileNet. The kernel
+// computes one row of the depthwise output at a time into a scratch tile and
+// runs the pointwise convolution over it right away, so the depthwise output
+// tensor is never allocated. Results are those of the two separate kernels.
+struct FusedSeparableConvParams {
+  TfLiteDepthwiseConvParams depthwise;
+  TfLiteConvParams pointwise;
+  // Quantization of the depthwise output.
+  float intermediate_scale;
+  int32_t intermediate_zero_point;
+};
+
+// Inputs of the fused node, the bias slots hold kTfLiteOptionalTensor when
+// the original node had no bias. The output is that of the CONV_2D.
+constexpr int kSeparableConvInputTensor = 0;
+constexpr int kSeparableConvDepthwiseFilterTensor = 1;
+constexpr int kSeparableConvDepthwiseBiasTensor = 2;
+constexpr int kSeparableConvPointwiseFilterTensor = 3;
+constexpr int kSeparableConvPointwiseBiasTensor = 4;
+constexpr int kSeparableConvNumInputs = 5;
+
+// Kernel of the fused node. It is not a builtin operator and is only set by
+// the graph rewriter, as a custom operator named kFusedSeparableConvName.
+TfLiteRegistration Register_FUSED_SEPARABLE_CONV_2D();
+constexpr char kFusedSeparableConvName[] = "FUSED_SEPARABLE_CONV_2D";
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_SEPARABLE_CONV_H_
@@ -0,0 +1,193 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/reference/space_to_batch_nd.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace space_to_batch_nd {
+
+constexpr int kInputTensor = 0;
+constexpr int kBlockShapeTensor = 1;
+constexpr int kPaddingsTensor = 2;
+constexpr int kOutputTensor = 0;
+
+// Currently, only 3D NHC and 4D NHWC input/output op_context are supported.
+// In case of 3D input, it will be extended to 3D NHWC by adding W=1.
+// The 4D array need to have exactly 2 spatial dimensions.
+// TODO(b/149952582): Support arbitrary dimension in SpaceToBatchND.
+const int kInputOutputMinDimensionNum = 3;
+const int kInputOutputMaxDimensionNum = 4;
+
+struct OpData {
+  SpaceToBatchParams params;
+  // True when block_shape and paddings are constant and describe a reorder
+  // that leaves the buffer bytes untouched (e.g. no padding and a block that
+  // covers the whole image of a single batch).
+  bool layout_preserving;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  const TfLiteTensor* block_shape =
+      GetInput(context, node, kBlockShapeTensor);
+  TF_LITE_ENSURE(context, block_shape != nullptr);
+  const TfLiteTensor* paddings = GetInput(context, node, kPaddingsTensor);
+  TF_LITE_ENSURE(context, paddings != nullptr);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE(context, NumDimensions(input) >= kInputOutputMinDimensionNum);
+  TF_LITE_ENSURE(context, NumDimensions(input) <= kInputOutputMaxDimensionNum);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(output), NumDimensions(input));
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, output->type);
+  TF_LITE_ENSURE_TYPES_EQ(context, block_shape->type, kTfLiteInt32);
+  TF_LITE_ENSURE_TYPES_EQ(context, paddings->type, kTfLiteInt32);
+
+  data->params.output_offset = output->params.zero_point;
+  data->layout_preserving = false;
+
+  // TFLM can not resize the output, so the reorder can only be analyzed ahead
+  // of time when the block shape and paddings are baked into the model.
+  if (IsConstantTensor(block_shape) && IsConstantTensor(paddings)) {
+    const int spatial_dims = NumDimensions(input) - 2;
+    TF_LITE_ENSURE_EQ(context, NumElements(block_shape), spatial_dims);
+    const int32_t* block_shape_data = GetTensorData<int32_t>(block_shape);
+    const int32_t* paddings_data = GetTensorData<int32_t>(paddings);
+    bool has_padding = false;
+    for (int i = 0; i < spatial_dims * 2; ++i) {
+      has_padding |= paddings_data[i] != 0;
+    }
+
+    // Digits: input batch, output row, row offset in block, output column,
+    // column offset in block. The block offsets are moved in front of the
+    // batch on the output side.
+    const int extents[] = {
+        input->dims->data[0], output->dims->data[1], block_shape_data[0],
+        spatial_dims == 2 ? output->dims->data[2] : 1,
+        spatial_dims == 2 ? block_shape_data[1] : 1};
+    const int input_order[] = {0, 1, 2, 3, 4};
+    const int output_order[] = {2, 4, 0, 1, 3};
+    data->layout_preserving =
+        !has_padding && tflite::micro::IsLayoutPreservingReorder(
+                            extents, input_order, output_order, 5);
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* block_shape =
+      tflite::micro::GetEvalInput(context, node, kBlockShapeTensor);
+  const TfLiteEvalTensor* paddings =
+      tflite::micro::GetEvalInput(context, node, kPaddingsTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  if (data.layout_preserving) {
+    if (input->data.raw != output->data.raw) {
+      size_t bytes;
+      TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(input, &bytes));
+      memcpy(output->data.raw, input->data.raw, bytes);
+    }
+    return kTfLiteOk;
+  }
+
+  switch (input->type) {  // Already know in/out types are same.
+    case kTfLiteFloat32:
+      reference_ops::SpaceToBatchND(
+          data.params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<float>(input),
+          tflite::micro::GetTensorShape(block_shape),
+          tflite::micro::GetTensorData<int32_t>(block_shape),
+          tflite::micro::GetTensorShape(paddings),
+          tflite::micro::GetTensorData<int32_t>(paddings),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<float>(output));
+      break;
+    case kTfLiteInt8:
+      reference_ops::SpaceToBatchND(
+          data.params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<int8_t>(input),
+          tflite::micro::GetTensorShape(block_shape),
+          tflite::micro::GetTensorData<int32_t>(block_shape),
+          tflite::micro::GetTensorShape(paddings),
+          tflite::micro::GetTensorData<int32_t>(paddings),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<int8_t>(output));
+      break;
+    case kTfLiteUInt8:
+      reference_ops::SpaceToBatchND(
+          data.params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<uint8_t>(input),
+          tflite::micro::GetTensorShape(block_shape),
+          tflite::micro::GetTensorData<int32_t>(block_shape),
+          tflite::micro::GetTensorShape(paddings),
+          tflite::micro::GetTensorData<int32_t>(paddings),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<uint8_t>(output));
+      break;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                         TfLiteTypeGetName(input->type), input->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace space_to_batch_nd
+
+TfLiteRegistration Register_SPACE_TO_BATCH_ND() {
+  return {/*init=*/space_to_batch_nd::Init,
+          /*free=*/nullptr,
+          /*prepare=*/space_to_batch_nd::Prepare,
+          /*invoke=*/space_to_batch_nd::Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
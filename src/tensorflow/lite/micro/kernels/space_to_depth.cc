@@ -0,0 +1,157 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/reference/space_to_depth.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace space_to_depth {
+
+constexpr int kInputTensor = 0;
+constexpr int kOutputTensor = 0;
+
+struct OpData {
+  // True when the output bytes are identical to the input bytes, e.g. for
+  // block_size 1 or when the input is exactly one block wide.
+  bool layout_preserving;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  auto* params =
+      reinterpret_cast<TfLiteSpaceToDepthParams*>(node->builtin_data);
+
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_EQ(context, NumDimensions(input), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(output), 4);
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, output->type);
+
+  const int block_size = params->block_size;
+  TF_LITE_ENSURE(context, block_size > 0);
+  const int input_height = input->dims->data[1];
+  const int input_width = input->dims->data[2];
+  TF_LITE_ENSURE_EQ(context, input_height % block_size, 0);
+  TF_LITE_ENSURE_EQ(context, input_width % block_size, 0);
+  TF_LITE_ENSURE_EQ(context, output->dims->data[0], input->dims->data[0]);
+  TF_LITE_ENSURE_EQ(context, output->dims->data[1], input_height / block_size);
+  TF_LITE_ENSURE_EQ(context, output->dims->data[2], input_width / block_size);
+  TF_LITE_ENSURE_EQ(context, output->dims->data[3],
+                    input->dims->data[3] * block_size * block_size);
+
+  // Digits: batch, output row, row within block, output column, column within
+  // block. The depth axis is innermost on both sides and is left out.
+  const int extents[] = {input->dims->data[0], input_height / block_size,
+                         block_size, input_width / block_size, block_size};
+  const int input_order[] = {0, 1, 2, 3, 4};
+  const int output_order[] = {0, 1, 3, 2, 4};
+  data->layout_preserving = tflite::micro::IsLayoutPreservingReorder(
+      extents, input_order, output_order, 5);
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  auto* params =
+      reinterpret_cast<TfLiteSpaceToDepthParams*>(node->builtin_data);
+
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  if (data.layout_preserving) {
+    if (input->data.raw != output->data.raw) {
+      size_t bytes;
+      TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(input, &bytes));
+      memcpy(output->data.raw, input->data.raw, bytes);
+    }
+    return kTfLiteOk;
+  }
+
+  SpaceToDepthParams op_params;
+  op_params.block_size = params->block_size;
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+      reference_ops::SpaceToDepth(op_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<float>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<float>(output));
+      break;
+    case kTfLiteInt8:
+      reference_ops::SpaceToDepth(op_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<int8_t>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<int8_t>(output));
+      break;
+    case kTfLiteUInt8:
+      reference_ops::SpaceToDepth(
+          op_params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<uint8_t>(input),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<uint8_t>(output));
+      break;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                         TfLiteTypeGetName(input->type), input->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace space_to_depth
+
+TfLiteRegistration Register_SPACE_TO_DEPTH() {
+  return {/*init=*/space_to_depth::Init,
+          /*free=*/nullptr,
+          /*prepare=*/space_to_depth::Prepare,
+          /*invoke=*/space_to_depth::Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
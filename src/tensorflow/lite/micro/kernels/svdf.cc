@@ -191,58 +191,33 @@ inline void EvalFloatSVDF(
       bias_ptr, params->activation, state_ptr, scratch_ptr, output_ptr);
 }
 
-void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
-                     const TfLiteEvalTensor* input_tensor,
-                     const TfLiteEvalTensor* weights_feature_tensor,
-                     const TfLiteEvalTensor* weights_time_tensor,
-                     const TfLiteEvalTensor* bias_tensor,
-                     const TfLiteSVDFParams* params,
-                     TfLiteEvalTensor* activation_state_tensor,
-                     TfLiteEvalTensor* output_tensor, const OpData& data) {
-  const int n_rank = params->rank;
+// Feature matmul and time of filters [first_filter, end_filter) for every
+// batch, after the activation state has been shifted.
+void EvalIntegerSvdfFilters(const TfLiteEvalTensor* input_tensor,
+                            const TfLiteEvalTensor* weights_feature_tensor,
+                            const TfLiteEvalTensor* weights_time_tensor,
+                            TfLiteEvalTensor* activation_state_tensor,
+                            const OpData& data, int first_filter,
+                            int end_filter, int32_t* scratch_tensor) {
   const int n_batch = input_tensor->dims->data[0];
   const int n_input = input_tensor->dims->data[1];
   const int n_filter = weights_feature_tensor->dims->data[0];
-  const int n_unit = n_filter / n_rank;
   const int n_memory = weights_time_tensor->dims->data[1];
-
-  TFLITE_DCHECK(context != nullptr);
-  TFLITE_DCHECK(context->GetScratchBuffer != nullptr);
-
-  int32_t* scratch_tensor = static_cast<int32_t*>(
-      context->GetScratchBuffer(context, data.scratch_tensor_index));
-  int32_t* scratch_output_tensor = static_cast<int32_t*>(
-      context->GetScratchBuffer(context, data.scratch_output_tensor_index));
-
-  // Shift states.
-  int16_t* const state_ptr =
+  int16_t* state =
       tflite::micro::GetTensorData<int16_t>(activation_state_tensor);
 
-  // Left shift the activation_state.
-  {
-    int16_t* new_state_start = state_ptr;
-    const int16_t* old_state_start = state_ptr + 1;
-    const int16_t* old_state_end = state_ptr + n_batch * n_filter * n_memory;
-    while (old_state_start != old_state_end) {
-      *new_state_start++ = *old_state_start++;
-    }
-  }
-
-  // Note: no need to clear the latest activation, matmul is not accumulative.
-
   // Feature matmul.
   {
-    int16_t* state =
-        tflite::micro::GetTensorData<int16_t>(activation_state_tensor);
     const int8_t* input = tflite::micro::GetTensorData<int8_t>(input_tensor);
     const int8_t* weight_feature =
         tflite::micro::GetTensorData<int8_t>(weights_feature_tensor);
     const int32_t output_max = std::numeric_limits<int16_t>::max();
     const int32_t output_min = std::numeric_limits<int16_t>::min();
-    int16_t* result_in_batch = state + (n_memory - 1);
     for (int b = 0; b < n_batch; b++) {
-      const int8_t* matrix_ptr = weight_feature;
-      for (int r = 0; r < n_filter; r++) {
+      const int8_t* matrix_ptr = weight_feature + first_filter * n_input;
+      int16_t* result_in_batch =
+          state + (b * n_filter + first_filter) * n_memory + (n_memory - 1);
+      for (int r = first_filter; r < end_filter; r++) {
         int32_t dot_prod = 0;
         const int8_t* vector_in_batch = input + b * n_input;
         for (int c = 0; c < n_input; c++) {
@@ -267,16 +242,17 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
   // Time.
   {
     for (int b = 0; b < n_batch; ++b) {
-      int32_t* scratch_ptr_batch = scratch_tensor + b * n_filter;
+      int32_t* scratch_ptr_batch =
+          scratch_tensor + b * n_filter + first_filter;
 
       // Perform batched vector dot product:
       const int16_t* vector1_ptr =
-          tflite::micro::GetTensorData<int16_t>(weights_time_tensor);
+          tflite::micro::GetTensorData<int16_t>(weights_time_tensor) +
+          first_filter * n_memory;
       const int16_t* vector2_ptr =
-          tflite::micro::GetTensorData<int16_t>(activation_state_tensor) +
-          b * n_memory * n_filter;
+          state + (b * n_filter + first_filter) * n_memory;
 
-      for (int i = 0; i < n_filter; i++) {
+      for (int i = first_filter; i < end_filter; i++) {
         *scratch_ptr_batch = 0;
         for (int j = 0; j < n_memory; j++) {
           *scratch_ptr_batch += *vector1_ptr++ * *vector2_ptr++;
@@ -285,6 +261,57 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
       }
     }
   }
+}
+
+TfLiteStatus EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
+                             const TfLiteEvalTensor* input_tensor,
+                             const TfLiteEvalTensor* weights_feature_tensor,
+                             const TfLiteEvalTensor* weights_time_tensor,
+                             const TfLiteEvalTensor* bias_tensor,
+                             const TfLiteSVDFParams* params,
+                             TfLiteEvalTensor* activation_state_tensor,
+                             TfLiteEvalTensor* output_tensor,
+                             const OpData& data) {
+  const int n_rank = params->rank;
+  const int n_batch = input_tensor->dims->data[0];
+  const int n_input = input_tensor->dims->data[1];
+  const int n_filter = weights_feature_tensor->dims->data[0];
+  const int n_unit = n_filter / n_rank;
+  const int n_memory = weights_time_tensor->dims->data[1];
+
+  TFLITE_DCHECK(context != nullptr);
+  TFLITE_DCHECK(context->GetScratchBuffer != nullptr);
+
+  int32_t* scratch_tensor = static_cast<int32_t*>(
+      context->GetScratchBuffer(context, data.scratch_tensor_index));
+  int32_t* scratch_output_tensor = static_cast<int32_t*>(
+      context->GetScratchBuffer(context, data.scratch_output_tensor_index));
+
+  // Shift states.
+  int16_t* const state_ptr =
+      tflite::micro::GetTensorData<int16_t>(activation_state_tensor);
+
+  // Left shift the activation_state.
+  {
+    int16_t* new_state_start = state_ptr;
+    const int16_t* old_state_start = state_ptr + 1;
+    const int16_t* old_state_end = state_ptr + n_batch * n_filter * n_memory;
+    while (old_state_start != old_state_end) {
+      *new_state_start++ = *old_state_start++;
+    }
+  }
+
+  // Note: no need to clear the latest activation, matmul is not accumulative.
+
+  // Feature matmul and time, split by filter: a filter only reads and writes
+  // its own rows of the state and its own scratch values.
+  TF_LITE_ENSURE_STATUS(tflite::micro::ParallelFor(
+      context, n_filter, static_cast<int64_t>(n_batch) * (n_input + n_memory),
+      [&](int first_filter, int end_filter) {
+        EvalIntegerSvdfFilters(input_tensor, weights_feature_tensor,
+                               weights_time_tensor, activation_state_tensor,
+                               data, first_filter, end_filter, scratch_tensor);
+      }));
 
   // Reduce, add bias, rescale, activation.
   {
@@ -333,6 +360,7 @@ void EvalIntegerSVDF(TfLiteContext* context, TfLiteNode* node,
           static_cast<int8_t>(x4);
     }
   }
+  return kTfLiteOk;
 }
 
 }  // namespace
@@ -521,10 +549,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     }
 
     case kTfLiteInt8: {
-      EvalIntegerSVDF(context, node, input, weights_feature, weights_time, bias,
-                      params, activation_state, output, data);
-      return kTfLiteOk;
-      break;
+      return EvalIntegerSVDF(context, node, input, weights_feature,
+                             weights_time, bias, params, activation_state,
+                             output, data);
     }
 
     default:
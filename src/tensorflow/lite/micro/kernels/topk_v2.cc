@@ -0,0 +1,232 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace topk_v2 {
+
+constexpr int kInputTensor = 0;
+constexpr int kInputTopK = 1;
+constexpr int kOutputValues = 0;
+constexpr int kOutputIndices = 1;
+
+struct OpData {
+  int k;
+};
+
+// Ranking used by TOPK_V2: larger values first, and for equal values the
+// lower index first.
+template <typename T>
+inline bool IsWorse(T value_a, int32_t index_a, T value_b, int32_t index_b) {
+  return value_a < value_b || (value_a == value_b && index_a > index_b);
+}
+
+// Restores the heap property below `position` of a heap that keeps the worst
+// ranked entry at the root.
+template <typename T>
+void SiftDown(T* values, int32_t* indices, int size, int position) {
+  while (true) {
+    const int left = 2 * position + 1;
+    const int right = left + 1;
+    int worst = position;
+    if (left < size &&
+        IsWorse(values[left], indices[left], values[worst], indices[worst])) {
+      worst = left;
+    }
+    if (right < size &&
+        IsWorse(values[right], indices[right], values[worst], indices[worst])) {
+      worst = right;
+    }
+    if (worst == position) {
+      return;
+    }
+    const T value = values[position];
+    values[position] = values[worst];
+    values[worst] = value;
+    const int32_t index = indices[position];
+    indices[position] = indices[worst];
+    indices[worst] = index;
+    position = worst;
+  }
+}
+
+// Selects the k best entries of one row in O(n log k) using the outputs
+// themselves as heap storage, so no scratch memory is needed. Once the heap
+// is full a single comparison against its root rejects most candidates.
+template <typename T>
+void TopKRow(const T* input, int size, int k, T* values, int32_t* indices) {
+  if (k == 0) {
+    return;
+  }
+  for (int i = 0; i < k; ++i) {
+    values[i] = input[i];
+    indices[i] = i;
+  }
+  for (int i = k / 2 - 1; i >= 0; --i) {
+    SiftDown(values, indices, k, i);
+  }
+  for (int i = k; i < size; ++i) {
+    // Later entries have higher indices, so only a strictly larger value can
+    // outrank the current root.
+    if (input[i] > values[0]) {
+      values[0] = input[i];
+      indices[0] = i;
+      SiftDown(values, indices, k, 0);
+    }
+  }
+  // Heap sort: moving the worst entry to the back each round leaves the
+  // output ordered best first.
+  for (int end = k - 1; end > 0; --end) {
+    const T value = values[0];
+    values[0] = values[end];
+    values[end] = value;
+    const int32_t index = indices[0];
+    indices[0] = indices[end];
+    indices[end] = index;
+    SiftDown(values, indices, end, 0);
+  }
+}
+
+template <typename T>
+void TopK(const TfLiteEvalTensor* input, int k, TfLiteEvalTensor* values,
+          TfLiteEvalTensor* indices) {
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const int last_dim = input_shape.DimensionsCount() - 1;
+  const int row_size = input_shape.Dims(last_dim);
+  const int num_rows = FlatSizeSkipDim(input_shape, last_dim);
+
+  const T* input_data = tflite::micro::GetTensorData<T>(input);
+  T* values_data = tflite::micro::GetTensorData<T>(values);
+  int32_t* indices_data = tflite::micro::GetTensorData<int32_t>(indices);
+  for (int row = 0; row < num_rows; ++row) {
+    TopKRow(input_data + row * row_size, row_size, k, values_data + row * k,
+            indices_data + row * k);
+  }
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
+
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  const TfLiteTensor* top_k = GetInput(context, node, kInputTopK);
+  TF_LITE_ENSURE(context, top_k != nullptr);
+  TfLiteTensor* values = GetOutput(context, node, kOutputValues);
+  TF_LITE_ENSURE(context, values != nullptr);
+  TfLiteTensor* indices = GetOutput(context, node, kOutputIndices);
+  TF_LITE_ENSURE(context, indices != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, top_k->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, NumElements(top_k), 1);
+  // Output shapes are fixed when the model is converted, which requires k to
+  // be known up front.
+  if (!IsConstantTensor(top_k)) {
+    TF_LITE_KERNEL_LOG(context, "TOPK_V2 requires a constant k.");
+    return kTfLiteError;
+  }
+  const int k = top_k->data.i32[0];
+
+  const int num_dimensions = NumDimensions(input);
+  TF_LITE_ENSURE(context, num_dimensions >= 1);
+  TF_LITE_ENSURE(context, k >= 0);
+  TF_LITE_ENSURE(context, k <= input->dims->data[num_dimensions - 1]);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, values->type, input->type);
+  TF_LITE_ENSURE_TYPES_EQ(context, indices->type, kTfLiteInt32);
+  // Values are copied from the input unchanged, so quantized outputs must
+  // share the input's quantization.
+  if (input->type == kTfLiteInt8 || input->type == kTfLiteUInt8) {
+    TF_LITE_ENSURE(context, values->params.scale == input->params.scale);
+    TF_LITE_ENSURE_EQ(context, values->params.zero_point,
+                      input->params.zero_point);
+  }
+  TF_LITE_ENSURE_EQ(context, NumDimensions(values), num_dimensions);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(indices), num_dimensions);
+  for (int i = 0; i < num_dimensions - 1; ++i) {
+    TF_LITE_ENSURE_EQ(context, values->dims->data[i], input->dims->data[i]);
+    TF_LITE_ENSURE_EQ(context, indices->dims->data[i], input->dims->data[i]);
+  }
+  TF_LITE_ENSURE_EQ(context, values->dims->data[num_dimensions - 1], k);
+  TF_LITE_ENSURE_EQ(context, indices->dims->data[num_dimensions - 1], k);
+
+  data->k = k;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  TfLiteEvalTensor* values =
+      tflite::micro::GetEvalOutput(context, node, kOutputValues);
+  TfLiteEvalTensor* indices =
+      tflite::micro::GetEvalOutput(context, node, kOutputIndices);
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+      TopK<float>(input, data->k, values, indices);
+      break;
+    case kTfLiteInt8:
+      TopK<int8_t>(input, data->k, values, indices);
+      break;
+    case kTfLiteUInt8:
+      TopK<uint8_t>(input, data->k, values, indices);
+      break;
+    case kTfLiteInt32:
+      TopK<int32_t>(input, data->k, values, indices);
+      break;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type %s (%d) not supported.",
+                         TfLiteTypeGetName(input->type), input->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace topk_v2
+
+TfLiteRegistration Register_TOPK_V2() {
+  return {/*init=*/topk_v2::Init,
+          /*free=*/nullptr,
+          /*prepare=*/topk_v2::Prepare,
+          /*invoke=*/topk_v2::Eval,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
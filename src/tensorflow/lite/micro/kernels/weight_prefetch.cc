@@ -0,0 +1,107 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/weight_prefetch.h"
+
+#include <algorithm>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/weight_copy_engine.h"
+
+namespace tflite {
+namespace micro {
+
+TfLiteStatus PrepareWeightPrefetch(TfLiteContext* context,
+                                   const TfLiteTensor* weights,
+                                   int num_channels, int channel_size,
+                                   WeightPrefetchData* data) {
+  data->tile_buffer_index[0] = -1;
+  data->tile_buffer_index[1] = -1;
+  data->channel_size = channel_size;
+  data->num_channels = num_channels;
+  data->tile_channels = 0;
+
+  const WeightCopyEngine* engine = GetWeightCopyEngine(context);
+  if (engine == nullptr || weights->allocation_type != kTfLiteMmapRo ||
+      num_channels <= 0 || channel_size <= 0 ||
+      !engine->IsSlowMemory(weights->data.raw, weights->bytes)) {
+    return kTfLiteOk;
+  }
+
+  const int max_tile_channels =
+      static_cast<int>(engine->MaxTileSize()) / channel_size;
+  data->tile_channels = std::min(std::max(max_tile_channels, 1), num_channels);
+  const int tile_size = data->tile_channels * channel_size;
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, tile_size, &data->tile_buffer_index[0]));
+  return context->RequestScratchBufferInArena(context, tile_size,
+                                              &data->tile_buffer_index[1]);
+}
+
+WeightTileStream::WeightTileStream(TfLiteContext* context,
+                                   const WeightPrefetchData& data,
+                                   const void* weights)
+    : engine_(GetWeightCopyEngine(context)),
+      data_(data),
+      weights_(static_cast<const uint8_t*>(weights)) {
+  TFLITE_DCHECK(IsWeightPrefetchEnabled(data));
+  buffers_[0] = static_cast<uint8_t*>(
+      context->GetScratchBuffer(context, data.tile_buffer_index[0]));
+  buffers_[1] = static_cast<uint8_t*>(
+      context->GetScratchBuffer(context, data.tile_buffer_index[1]));
+  if (engine_ == nullptr) {
+    TF_LITE_KERNEL_LOG(context, "Weight copy engine removed after Prepare.");
+    status_ = kTfLiteError;
+    return;
+  }
+  status_ = StartCopy(0, 0);
+}
+
+int WeightTileStream::TileChannels(int first_channel) const {
+  return std::min(data_.tile_channels, data_.num_channels - first_channel);
+}
+
+TfLiteStatus WeightTileStream::StartCopy(int buffer, int first_channel) {
+  const int offset = first_channel * data_.channel_size;
+  return engine_->StartCopy(buffers_[buffer], weights_ + offset,
+                            TileChannels(first_channel) * data_.channel_size);
+}
+
+const void* WeightTileStream::Next(int* first_channel, int* tile_channels) {
+  if (status_ != kTfLiteOk || next_channel_ >= data_.num_channels) {
+    return nullptr;
+  }
+  status_ = engine_->Wait();
+  if (status_ != kTfLiteOk) {
+    return nullptr;
+  }
+  const uint8_t* tile = buffers_[current_];
+  *first_channel = next_channel_;
+  *tile_channels = TileChannels(next_channel_);
+  next_channel_ += *tile_channels;
+  if (next_channel_ < data_.num_channels) {
+    // Fills the other buffer, whose tile the caller has finished with.
+    status_ = StartCopy(current_ ^ 1, next_channel_);
+    if (status_ != kTfLiteOk) {
+      return nullptr;
+    }
+  }
+  current_ ^= 1;
+  return tile;
+}
+
+}  // namespace micro
+}  // namespace tflite
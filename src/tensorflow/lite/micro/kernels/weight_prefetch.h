@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_WEIGHT_PREFETCH_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_WEIGHT_PREFETCH_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/weight_copy_engine.h"
+
+namespace tflite {
+namespace micro {
+
+// Double-buffered streaming of a weight tensor from slow memory, in tiles of
+// whole output channels (dimension 0). A kernel declares its tiles in Prepare
+// with PrepareWeightPrefetch(), which reserves two tile buffers as scratch
+// buffers of the node, and walks them in Eval with a WeightTileStream:
+//
+//   WeightTileStream stream(context, data->prefetch, filter_data);
+//   int first_channel, tile_channels;
+//   while (const void* tile = stream.Next(&first_channel, &tile_channels)) {
+//     ... compute output channels [first_channel, +tile_channels) ...
+//   }
+//   TF_LITE_ENSURE_STATUS(stream.status());
+//
+// Next() waits for the tile it returns and starts copying the following one
+// into the other buffer, so the copy engine works while the caller computes.
+struct WeightPrefetchData {
+  // Scratch buffers the tiles alternate between, -1 when prefetch is off.
+  int tile_buffer_index[2];
+  // Bytes of one output channel.
+  int channel_size;
+  int num_channels;
+  int tile_channels;
+};
+
+// Sets up prefetching of `weights`, a constant tensor of `num_channels`
+// channels of `channel_size` bytes each. Prefetch stays off unless a
+// WeightCopyEngine is installed and reports the weights as slow memory.
+TfLiteStatus PrepareWeightPrefetch(TfLiteContext* context,
+                                   const TfLiteTensor* weights,
+                                   int num_channels, int channel_size,
+                                   WeightPrefetchData* data);
+
+inline bool IsWeightPrefetchEnabled(const WeightPrefetchData& data) {
+  return data.tile_buffer_index[0] >= 0;
+}
+
+class WeightTileStream {
+ public:
+  // Starts copying the first tile of `weights`.
+  WeightTileStream(TfLiteContext* context, const WeightPrefetchData& data,
+                   const void* weights);
+
+  // Returns the next tile in fast memory, or nullptr once all tiles have been
+  // returned or a copy failed.
+  const void* Next(int* first_channel, int* tile_channels);
+
+  TfLiteStatus status() const { return status_; }
+
+ private:
+  TfLiteStatus StartCopy(int buffer, int first_channel);
+  int TileChannels(int first_channel) const;
+
+  WeightCopyEngine* engine_;
+  const WeightPrefetchData& data_;
+  const uint8_t* weights_;
+  uint8_t* buffers_[2];
+  int current_ = 0;
+  int next_channel_ = 0;
+  TfLiteStatus status_ = kTfLiteOk;
+};
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_WEIGHT_PREFETCH_H_
@@ -51,6 +51,9 @@ TfLiteStatus TfLiteTypeSizeOf(TfLiteType type, size_t* size) {
     case kTfLiteFloat32:
       *size = sizeof(float);
       break;
+    case kTfLiteFloat16:
+      *size = sizeof(TfLiteFloat16);
+      break;
     case kTfLiteInt16:
       *size = sizeof(int16_t);
       break;
@@ -315,7 +315,7 @@ void GreedyMemoryPlanner::PrintMemoryPlan(ErrorReporter* error_reporter) {
   CalculateOffsetsIfNeeded();
 
   for (int i = 0; i < buffer_count_; ++i) {
-    TF_LITE_REPORT_ERROR(
+    TF_LITE_REPORT_INFO(
         error_reporter,
         "Planner buffer ID: %d, calculated offset: %d, size required: %d, "
         "first_time_created: %d, "
@@ -377,7 +377,7 @@ void GreedyMemoryPlanner::PrintMemoryPlan(ErrorReporter* error_reporter) {
       }
     }
     line[kLineWidth] = 0;
-    TF_LITE_REPORT_ERROR(error_reporter, "%s", (const char*)line);
+    TF_LITE_REPORT_INFO(error_reporter, "%s", (const char*)line);
   }
 }
 
@@ -26,10 +26,13 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/graph_rewriter.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
 #include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
 #include "tensorflow/lite/micro/memory_planner/memory_planner.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/micro/model_byte_order.h"
+#include "tensorflow/lite/micro/node_weights.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -97,17 +100,17 @@ TfLiteStatus CheckOfflinePlannedOffsets(const Model* model,
         int version = metadata_buffer[0];
         int subgraph_idx = metadata_buffer[1];
         const int nbr_offline_offsets = metadata_buffer[2];
-#ifndef TF_LITE_STRIP_ERROR_STRINGS
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_INFO
         int* offline_planner_offsets = (int*)&metadata_buffer[3];
 #endif
 
-        TF_LITE_REPORT_ERROR(error_reporter, "==== Model metadata info: =====");
-        TF_LITE_REPORT_ERROR(error_reporter,
-                             "Offline planner metadata found, version %d, "
-                             "subgraph %d, nbr offline offsets %d",
-                             version, subgraph_idx, nbr_offline_offsets);
+        TF_LITE_REPORT_INFO(error_reporter, "==== Model metadata info: =====");
+        TF_LITE_REPORT_INFO(error_reporter,
+                            "Offline planner metadata found, version %d, "
+                            "subgraph %d, nbr offline offsets %d",
+                            version, subgraph_idx, nbr_offline_offsets);
         for (int j = 0; j < nbr_offline_offsets; ++j) {
-          TF_LITE_REPORT_ERROR(
+          TF_LITE_REPORT_INFO(
               error_reporter,
               "Offline planner tensor index %d, offline offset: %d", j,
               offline_planner_offsets[j]);
@@ -162,10 +165,14 @@ class AllocationInfoBuilder {
   TfLiteStatus GetOfflinePlannedOffsets(
       const Model* model, const int32_t** offline_planner_offsets);
 
-  // Add allocaiton information for the tensors.
+  // Add allocaiton information for the tensors. Tensor lifetimes are taken
+  // from the node inputs/outputs rather than the flatbuffer operators so that
+  // graph rewrites done in StartModelAllocation() are reflected in the plan.
   TfLiteStatus AddTensors(const SubGraph* subgraph,
+                          const NodeAndRegistration* node_and_registrations,
                           const int32_t* offline_offsets,
-                          TfLiteEvalTensor* eval_tensors);
+                          TfLiteEvalTensor* eval_tensors,
+                          int num_interleaved_operators);
 
   // Add allocation information for the scratch buffers.
   TfLiteStatus AddScratchBuffers(internal::ScratchBufferHandle* buffer_handles);
@@ -199,9 +206,11 @@ TfLiteStatus AllocationInfoBuilder::Allocate() {
   return kTfLiteOk;
 }
 
-TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
-                                               const int32_t* offline_offsets,
-                                               TfLiteEvalTensor* eval_tensors) {
+TfLiteStatus AllocationInfoBuilder::AddTensors(
+    const SubGraph* subgraph, const NodeAndRegistration* node_and_registrations,
+    const int32_t* offline_offsets, TfLiteEvalTensor* eval_tensors,
+    int num_interleaved_operators) {
+  TFLITE_DCHECK(node_and_registrations != nullptr);
   TFLITE_DCHECK(eval_tensors != nullptr);
 
   // Set up allocation info for all tensors.
@@ -238,9 +247,13 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
 
   // Figure out when the first and last use of each tensor is.
   for (int i = (subgraph->operators()->size() - 1); i >= 0; --i) {
-    const auto* op = subgraph->operators()->Get(i);
-    for (size_t n = 0; n < op->inputs()->size(); ++n) {
-      const int tensor_index = op->inputs()->Get(n);
+    const TfLiteNode& node = node_and_registrations[i].node;
+    for (int n = 0; n < node.inputs->size; ++n) {
+      const int tensor_index = node.inputs->data[n];
+      // Optional inputs are marked with a negative index.
+      if (tensor_index < 0) {
+        continue;
+      }
       AllocationInfo* current = &info_[tensor_index];
 
       // TODO(b/166484865): Figure out a more general solution.
@@ -248,8 +261,11 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
       // operator input.
       // In case operator input(s) are not in subgraph inputs initialize them.
       if (current->first_created == 0) {
-        for (size_t op_input = 0; op_input < op->inputs()->size(); ++op_input) {
-          const int op_tensor_index = op->inputs()->Get(op_input);
+        for (int op_input = 0; op_input < node.inputs->size; ++op_input) {
+          const int op_tensor_index = node.inputs->data[op_input];
+          if (op_tensor_index < 0) {
+            continue;
+          }
           AllocationInfo* op_current = &info_[op_tensor_index];
           if (op_current->needs_allocating && op_current->first_created == -1) {
             op_current->first_created = i;
@@ -261,8 +277,8 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
         current->last_used = i;
       }
     }
-    for (size_t n = 0; n < op->outputs()->size(); ++n) {
-      const int tensor_index = op->outputs()->Get(n);
+    for (int n = 0; n < node.outputs->size; ++n) {
+      const int tensor_index = node.outputs->data[n];
       AllocationInfo* current = &info_[tensor_index];
       if ((current->first_created == -1) || (current->first_created > i)) {
         current->first_created = i;
@@ -270,6 +286,28 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     }
   }
 
+  // Interleaved operators all run before any of them has finished, so their
+  // tensors live from the first to the last of them.
+  for (int i = 0; i < num_interleaved_operators; ++i) {
+    const TfLiteNode& node = node_and_registrations[i].node;
+    const int num_inputs = node.inputs->size;
+    for (int n = 0; n < num_inputs + node.outputs->size; ++n) {
+      const int tensor_index = n < num_inputs
+                                   ? node.inputs->data[n]
+                                   : node.outputs->data[n - num_inputs];
+      if (tensor_index < 0) {
+        continue;
+      }
+      AllocationInfo* current = &info_[tensor_index];
+      if (current->first_created > 0) {
+        current->first_created = 0;
+      }
+      if (current->last_used < num_interleaved_operators - 1) {
+        current->last_used = num_interleaved_operators - 1;
+      }
+    }
+  }
+
   // Work out which tensors need to be allocated.
   for (size_t i = 0; i < tensor_count_; ++i) {
     AllocationInfo* current = &info_[i];
@@ -278,6 +316,14 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     if (is_read_only) {
       current->needs_allocating = false;
     }
+    // Tensors that are neither produced nor consumed by any node (e.g. the
+    // intermediates of a pattern removed by the graph rewriter) need no
+    // buffer.
+    const bool is_unused =
+        (current->first_created == -1) && (current->last_used == -1);
+    if (is_unused) {
+      current->needs_allocating = false;
+    }
     const bool has_partial_lifetime =
         !is_read_only &&
         ((current->first_created == -1) || (current->last_used == -1));
@@ -400,6 +446,246 @@ TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
   }
   return kTfLiteOk;
 }
+
+// Returns the table of 32-bit integers stored in the metadata entry `name`,
+// or nullptr if the model has no such entry. Tools that write one table per
+// subgraph add several entries of the same name, `occurrence` selects one.
+const int32_t* GetMetadataTable(const Model* model, const char* name,
+                                size_t* table_size, int occurrence = 0) {
+  *table_size = 0;
+  if (model->metadata() == nullptr) {
+    return nullptr;
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers =
+      model->buffers();
+  for (size_t i = 0; i < model->metadata()->size(); ++i) {
+    auto metadata = model->metadata()->Get(i);
+    if (strncmp(metadata->name()->c_str(), name, strlen(name)) != 0 ||
+        occurrence-- > 0) {
+      continue;
+    }
+    const flatbuffers::Vector<uint8_t>* array =
+        metadata->buffer() < buffers->size()
+            ? (*buffers)[metadata->buffer()]->data()
+            : nullptr;
+    if (array == nullptr) {
+      return nullptr;
+    }
+    *table_size = array->size() / sizeof(int32_t);
+    return reinterpret_cast<const int32_t*>(array->data());
+  }
+  return nullptr;
+}
+
+// Returns the NodeWeights attached to a builtin node, attaching an empty one
+// first if needed.
+NodeWeights* GetOrAttachNodeWeights(SimpleMemoryAllocator* memory_allocator,
+                                    ErrorReporter* error_reporter,
+                                    TfLiteNode* node) {
+  if (node->custom_initial_data != nullptr) {
+    TFLITE_DCHECK(node->custom_initial_data_size == sizeof(NodeWeights));
+    return const_cast<NodeWeights*>(
+        static_cast<const NodeWeights*>(node->custom_initial_data));
+  }
+  NodeWeights* weights =
+      reinterpret_cast<NodeWeights*>(memory_allocator->AllocateFromTail(
+          sizeof(NodeWeights), alignof(NodeWeights)));
+  if (weights == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to allocate memory for NodeWeights.");
+    return nullptr;
+  }
+  *weights = {};
+  node->custom_initial_data = weights;
+  node->custom_initial_data_size = sizeof(NodeWeights);
+  return weights;
+}
+
+// Attaches the offline pre-packed weights listed in the PackedWeights
+// metadata, if any, to their nodes. See packed_weights.h for the format.
+// There is one table per subgraph with packed weights, only the one of the
+// subgraph that runs is used.
+TfLiteStatus AttachPackedWeights(const Model* model,
+                                 SimpleMemoryAllocator* memory_allocator,
+                                 ErrorReporter* error_reporter,
+                                 NodeAndRegistration* node_and_registrations) {
+  const int32_t* table = nullptr;
+  for (int occurrence = 0;; ++occurrence) {
+    size_t entry_size;
+    const int32_t* entry = GetMetadataTable(model, kPackedWeightsMetadata,
+                                            &entry_size, occurrence);
+    if (entry == nullptr) {
+      break;
+    }
+    if (entry_size < 3 || entry[0] != kPackedWeightsVersion || entry[1] < 0 ||
+        static_cast<size_t>(entry[1]) >= model->subgraphs()->size() ||
+        entry[2] < 0 || (entry_size - 3) / 4 < static_cast<size_t>(entry[2]) ||
+        (entry[1] == 0 && table != nullptr)) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Invalid or unsupported PackedWeights metadata.");
+      return kTfLiteError;
+    }
+    if (entry[1] == 0) {
+      table = entry;
+    }
+  }
+  if (table == nullptr) {
+    return kTfLiteOk;
+  }
+
+  const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers =
+      model->buffers();
+  const size_t operators_size = (*model->subgraphs())[0]->operators()->size();
+  for (int entry = 0; entry < table[2]; ++entry) {
+    const int32_t* fields = &table[3 + 4 * entry];
+    const uint32_t operator_index = fields[0];
+    const uint32_t filter_buffer = fields[2];
+    const uint32_t bias_buffer = fields[3];
+    if (operator_index >= operators_size || filter_buffer >= buffers->size() ||
+        bias_buffer >= buffers->size()) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "PackedWeights entry %d is out of range.", entry);
+      return kTfLiteError;
+    }
+    const flatbuffers::Vector<uint8_t>* filter =
+        (*buffers)[filter_buffer]->data();
+    const flatbuffers::Vector<uint8_t>* bias = (*buffers)[bias_buffer]->data();
+    NodeAndRegistration* node_and_registration =
+        &node_and_registrations[operator_index];
+    if (filter == nullptr || bias == nullptr ||
+        reinterpret_cast<uintptr_t>(bias->data()) % sizeof(int32_t) != 0 ||
+        node_and_registration->registration->builtin_code ==
+            BuiltinOperator_CUSTOM) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "PackedWeights entry %d is invalid.", entry);
+      return kTfLiteError;
+    }
+
+    PackedWeights* packed =
+        reinterpret_cast<PackedWeights*>(memory_allocator->AllocateFromTail(
+            sizeof(PackedWeights), alignof(PackedWeights)));
+    NodeWeights* weights = GetOrAttachNodeWeights(
+        memory_allocator, error_reporter, &node_and_registration->node);
+    if (packed == nullptr || weights == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to allocate memory for PackedWeights.");
+      return kTfLiteError;
+    }
+    packed->layout = static_cast<PackedWeightsLayout>(fields[1]);
+    packed->filter = reinterpret_cast<const int8_t*>(filter->data());
+    packed->filter_size = filter->size();
+    packed->effective_bias = reinterpret_cast<const int32_t*>(bias->data());
+    packed->effective_bias_size = bias->size() / sizeof(int32_t);
+    weights->packed = packed;
+  }
+  return kTfLiteOk;
+}
+
+// Attaches the compressed filters listed in the CompressedWeights metadata,
+// if any, to the nodes consuming them. See compressed_weights.h for the
+// format.
+TfLiteStatus AttachCompressedWeights(
+    const Model* model, SimpleMemoryAllocator* memory_allocator,
+    ErrorReporter* error_reporter,
+    NodeAndRegistration* node_and_registrations) {
+  size_t table_size;
+  const int32_t* table =
+      GetMetadataTable(model, kCompressedWeightsMetadata, &table_size);
+  if (table == nullptr) {
+    return kTfLiteOk;
+  }
+  if (table_size < 3 || table[0] != kCompressedWeightsVersion ||
+      table[1] != 0 || table[2] < 0 ||
+      (table_size - 3) / 4 < static_cast<size_t>(table[2])) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Invalid or unsupported CompressedWeights metadata.");
+    return kTfLiteError;
+  }
+
+  const SubGraph* subgraph = (*model->subgraphs())[0];
+  const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers =
+      model->buffers();
+  for (int entry = 0; entry < table[2]; ++entry) {
+    const int32_t* fields = &table[3 + 4 * entry];
+    const uint32_t tensor_index = fields[0];
+    const int index_bits = fields[2];
+    const int tile_channels = fields[3];
+    if (tensor_index >= subgraph->tensors()->size()) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "CompressedWeights entry %d is out of range.",
+                           entry);
+      return kTfLiteError;
+    }
+    const Tensor* tensor = subgraph->tensors()->Get(tensor_index);
+    const flatbuffers::Vector<uint8_t>* data =
+        tensor->buffer() < buffers->size()
+            ? (*buffers)[tensor->buffer()]->data()
+            : nullptr;
+    int num_channels = 0;
+    int channel_size = 1;
+    if (tensor->shape() != nullptr && tensor->shape()->size() > 0) {
+      num_channels = tensor->shape()->Get(0);
+      for (size_t i = 1; i < tensor->shape()->size(); ++i) {
+        channel_size *= tensor->shape()->Get(i);
+      }
+    }
+    if (fields[1] != kCompressedWeightsPalette ||
+        (index_bits != 1 && index_bits != 2 && index_bits != 4) ||
+        tile_channels <= 0 || tensor->type() != TensorType_INT8 ||
+        data == nullptr || num_channels <= 0 ||
+        static_cast<int>(data->size()) !=
+            CompressedWeightsSize(index_bits, tile_channels, num_channels,
+                                  channel_size)) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "CompressedWeights entry %d is invalid.", entry);
+      return kTfLiteError;
+    }
+
+    CompressedWeights* compressed = reinterpret_cast<CompressedWeights*>(
+        memory_allocator->AllocateFromTail(sizeof(CompressedWeights),
+                                           alignof(CompressedWeights)));
+    if (compressed == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to allocate memory for CompressedWeights.");
+      return kTfLiteError;
+    }
+    compressed->codec = kCompressedWeightsPalette;
+    compressed->index_bits = index_bits;
+    compressed->tile_channels = tile_channels;
+    compressed->data = data->data();
+    compressed->data_size = data->size();
+
+    // Every consumer must be able to decode the tensor, which only the
+    // filter input of CONV_2D and FULLY_CONNECTED does.
+    for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+      const flatbuffers::Vector<int32_t>* inputs =
+          subgraph->operators()->Get(i)->inputs();
+      NodeAndRegistration* node_and_registration = &node_and_registrations[i];
+      const int32_t builtin_code =
+          node_and_registration->registration->builtin_code;
+      for (size_t j = 0; j < inputs->size(); ++j) {
+        if (inputs->Get(j) != static_cast<int32_t>(tensor_index)) {
+          continue;
+        }
+        if (j != 1 || (builtin_code != BuiltinOperator_CONV_2D &&
+                       builtin_code != BuiltinOperator_FULLY_CONNECTED)) {
+          TF_LITE_REPORT_ERROR(
+              error_reporter,
+              "Compressed tensor %d used by unsupported operator %d.",
+              static_cast<int>(tensor_index), static_cast<int>(i));
+          return kTfLiteError;
+        }
+        NodeWeights* weights = GetOrAttachNodeWeights(
+            memory_allocator, error_reporter, &node_and_registration->node);
+        if (weights == nullptr) {
+          return kTfLiteError;
+        }
+        weights->compressed = compressed;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
 }  // namespace
 
 namespace internal {
@@ -484,7 +770,8 @@ TfLiteStatus InitializeTfLiteTensorFromFlatbuffer(
     SimpleMemoryAllocator* allocator, bool allocate_temp,
     const tflite::Tensor& flatbuffer_tensor,
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-    ErrorReporter* error_reporter, TfLiteTensor* result) {
+    ErrorReporter* error_reporter, TfLiteTensor* result,
+    const TfLiteIntArray* host_order_dims) {
   TFLITE_DCHECK(result != nullptr);
 
   *result = {};
@@ -514,7 +801,9 @@ TfLiteStatus InitializeTfLiteTensorFromFlatbuffer(
   TF_LITE_ENSURE_STATUS(BytesRequiredForTensor(
       flatbuffer_tensor, &result->bytes, &type_size, error_reporter));
 
-  if (flatbuffer_tensor.shape() == nullptr) {
+  if (host_order_dims != nullptr) {
+    result->dims = const_cast<TfLiteIntArray*>(host_order_dims);
+  } else if (flatbuffer_tensor.shape() == nullptr) {
     // flatbuffer_tensor.shape() can return a nullptr in the case of a scalar
     // tensor.
     result->dims = const_cast<TfLiteIntArray*>(&kZeroLengthIntArray);
@@ -597,7 +886,8 @@ TfLiteStatus InitializeTfLiteTensorFromFlatbuffer(
 TfLiteStatus InitializeTfLiteEvalTensorFromFlatbuffer(
     SimpleMemoryAllocator* allocator, const tflite::Tensor& flatbuffer_tensor,
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-    ErrorReporter* error_reporter, TfLiteEvalTensor* result) {
+    ErrorReporter* error_reporter, TfLiteEvalTensor* result,
+    const TfLiteIntArray* host_order_dims) {
   *result = {};
   // Make sure the serialized type is one we know how to deal with, and convert
   // it from a flatbuffer enum into a constant used by the kernel C API.
@@ -606,7 +896,9 @@ TfLiteStatus InitializeTfLiteEvalTensorFromFlatbuffer(
 
   result->data.data = GetFlatbufferTensorBuffer(flatbuffer_tensor, buffers);
 
-  if (flatbuffer_tensor.shape() == nullptr) {
+  if (host_order_dims != nullptr) {
+    result->dims = const_cast<TfLiteIntArray*>(host_order_dims);
+  } else if (flatbuffer_tensor.shape() == nullptr) {
     // flatbuffer_tensor.shape() can return a nullptr in the case of a scalar
     // tensor.
     result->dims = const_cast<TfLiteIntArray*>(&kZeroLengthIntArray);
@@ -670,12 +962,21 @@ TfLiteStatus MicroAllocator::StartModelAllocation(
 
   model_is_allocating_ = true;
 
+  TF_LITE_ENSURE_STATUS(ReadModelByteOrder(model));
   TF_LITE_ENSURE_STATUS(InitScratchBufferHandles());
   TF_LITE_ENSURE_STATUS(AllocateTfLiteEvalTensors(model, eval_tensors));
   TF_LITE_ENSURE_STATUS(
       AllocateNodeAndRegistrations(model, node_and_registrations));
   TF_LITE_ENSURE_STATUS(PrepareNodeAndRegistrationDataFromFlatbuffer(
       model, op_resolver, *node_and_registrations));
+  TF_LITE_ENSURE_STATUS(AttachPackedWeights(
+      model, memory_allocator_, error_reporter_, *node_and_registrations));
+  TF_LITE_ENSURE_STATUS(AttachCompressedWeights(
+      model, memory_allocator_, error_reporter_, *node_and_registrations));
+  TF_LITE_ENSURE_STATUS(internal::RewriteGraph(
+      memory_allocator_, error_reporter_, GetSubGraphFromModel(model),
+      *node_and_registrations, *eval_tensors));
+  node_and_registrations_ = *node_and_registrations;
 
   return kTfLiteOk;
 }
@@ -843,13 +1144,20 @@ TfLiteStatus MicroAllocator::PrepareNodeAndRegistrationDataFromFlatbuffer(
                                    (void**)(&builtin_data)));
     }
 
-    TfLiteIntArray* inputs_array;
-    TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
-        memory_allocator_, error_reporter_, op->inputs(), &inputs_array));
+    const int num_tensors = subgraph->tensors()->size();
+    TfLiteIntArray* inputs_array = const_cast<TfLiteIntArray*>(
+        GetHostOrderArray(HostByteOrderInputsIndex(num_tensors, i)));
+    if (inputs_array == nullptr) {
+      TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
+          memory_allocator_, error_reporter_, op->inputs(), &inputs_array));
+    }
 
-    TfLiteIntArray* outputs_array;
-    TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
-        memory_allocator_, error_reporter_, op->outputs(), &outputs_array));
+    TfLiteIntArray* outputs_array = const_cast<TfLiteIntArray*>(
+        GetHostOrderArray(HostByteOrderOutputsIndex(num_tensors, i)));
+    if (outputs_array == nullptr) {
+      TF_LITE_ENSURE_STATUS(internal::FlatBufferVectorToTfLiteTypeArray(
+          memory_allocator_, error_reporter_, op->outputs(), &outputs_array));
+    }
 
     TfLiteNode* node = &(node_and_registrations[i].node);
     *node = {};
@@ -954,7 +1262,8 @@ TfLiteStatus MicroAllocator::AllocateTfLiteEvalTensors(
   for (size_t i = 0; i < alloc_count; ++i) {
     TfLiteStatus status = internal::InitializeTfLiteEvalTensorFromFlatbuffer(
         memory_allocator_, *subgraph->tensors()->Get(i), model->buffers(),
-        error_reporter_, &tensors[i]);
+        error_reporter_, &tensors[i],
+        GetHostOrderArray(HostByteOrderDimsIndex(i)));
     if (status != kTfLiteOk) {
       TF_LITE_REPORT_ERROR(error_reporter_, "Failed to initialize tensor %d",
                            i);
@@ -1002,7 +1311,87 @@ TfLiteStatus MicroAllocator::PopulateTfLiteTensorFromFlatbuffer(
   // to the new API this can be dropped.
   return internal::InitializeTfLiteTensorFromFlatbuffer(
       memory_allocator_, allocate_temp, *subgraph->tensors()->Get(tensor_index),
-      model->buffers(), error_reporter_, tensor);
+      model->buffers(), error_reporter_, tensor,
+      GetHostOrderArray(HostByteOrderDimsIndex(tensor_index)));
+}
+
+TfLiteStatus MicroAllocator::ReadModelByteOrder(const Model* model) {
+  model_in_host_byte_order_ = FLATBUFFERS_LITTLEENDIAN;
+  host_order_table_ = nullptr;
+  size_t table_size;
+  const int32_t* table =
+      GetMetadataTable(model, kHostByteOrderMetadata, &table_size);
+  if (table == nullptr) {
+    return kTfLiteOk;
+  }
+  if (table_size >= 1 && static_cast<uint32_t>(table[0]) ==
+                             flatbuffers::EndianSwap(kHostByteOrderMark)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Model was converted for the other byte order.");
+    return kTfLiteError;
+  }
+  const SubGraph* subgraph = GetSubGraphFromModel(model);
+  TFLITE_DCHECK(subgraph != nullptr);
+  const int num_tensors = subgraph->tensors()->size();
+  const int num_operators = subgraph->operators()->size();
+  const int num_offsets =
+      HostByteOrderInputsIndex(num_tensors, num_operators);
+  if (table_size < kHostByteOrderHeaderSize ||
+      static_cast<uint32_t>(table[0]) != kHostByteOrderMark ||
+      table[1] != kHostByteOrderVersion || table[2] != num_tensors ||
+      table[3] != num_operators ||
+      table_size < static_cast<size_t>(num_offsets)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Invalid or unsupported HostByteOrder metadata.");
+    return kTfLiteError;
+  }
+
+  // Every array must match the flatbuffer, which costs a pass over the dims
+  // and index lists but nothing proportional to the weights.
+  for (int i = kHostByteOrderHeaderSize; i < num_offsets; ++i) {
+    const flatbuffers::Vector<int32_t>* expected;
+    if (i < HostByteOrderInputsIndex(num_tensors, 0)) {
+      const int tensor = i - HostByteOrderDimsIndex(0);
+      expected = subgraph->tensors()->Get(tensor)->shape();
+    } else {
+      const int op = (i - HostByteOrderInputsIndex(num_tensors, 0)) / 2;
+      const Operator* op_data = subgraph->operators()->Get(op);
+      expected = i == HostByteOrderInputsIndex(num_tensors, op)
+                     ? op_data->inputs()
+                     : op_data->outputs();
+    }
+    const int32_t offset = table[i];
+    if (offset == -1 && expected == nullptr) {
+      continue;
+    }
+    bool valid = offset >= num_offsets &&
+                 static_cast<size_t>(offset) < table_size &&
+                 expected != nullptr &&
+                 static_cast<uint32_t>(table[offset]) == expected->size() &&
+                 table_size - offset > expected->size();
+    for (uint32_t j = 0; valid && j < expected->size(); ++j) {
+      valid = table[offset + 1 + j] == expected->Get(j);
+    }
+    if (!valid) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "HostByteOrder array %d does not match the model.",
+                           i);
+      return kTfLiteError;
+    }
+  }
+  model_in_host_byte_order_ = true;
+  host_order_table_ = table;
+  return kTfLiteOk;
+}
+
+const TfLiteIntArray* MicroAllocator::GetHostOrderArray(int index) const {
+  // Flatbuffer arrays are used in place on little-endian hosts anyway.
+  if (FLATBUFFERS_LITTLEENDIAN || host_order_table_ == nullptr ||
+      host_order_table_[index] < 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const TfLiteIntArray*>(
+      &host_order_table_[host_order_table_[index]]);
 }
 
 ErrorReporter* MicroAllocator::error_reporter() const {
@@ -1045,7 +1434,9 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
     TF_LITE_ENSURE_STATUS(
         builder.GetOfflinePlannedOffsets(model, &offline_planner_offsets));
     TF_LITE_ENSURE_STATUS(
-        builder.AddTensors(subgraph, offline_planner_offsets, eval_tensors));
+        builder.AddTensors(subgraph, node_and_registrations_,
+                           offline_planner_offsets, eval_tensors,
+                           num_interleaved_operators_));
     TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_handles_));
     const AllocationInfo* allocation_info = builder.Finish();
 
@@ -37,11 +37,14 @@ namespace internal {
 // TfLiteEvalTensor API - drop the allocate_temp flag. This enables internal
 // flatbuffer quantization or dimension allocations to take place in either the
 // temp or tail section of the arena.
+// `host_order_dims`, if given, is used as the dims of the tensor instead of a
+// host byte order copy of the flatbuffer shape (see model_byte_order.h).
 TfLiteStatus InitializeTfLiteTensorFromFlatbuffer(
     SimpleMemoryAllocator* allocator, bool allocate_temp,
     const tflite::Tensor& flatbuffer_tensor,
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-    ErrorReporter* error_reporter, TfLiteTensor* result);
+    ErrorReporter* error_reporter, TfLiteTensor* result,
+    const TfLiteIntArray* host_order_dims = nullptr);
 
 // A handle tracking scratch buffer allocation. This handle is created by
 // `RequestScratchBufferInArena`. `data` field is populated in
@@ -180,6 +183,20 @@ class MicroAllocator {
   // `FinishModelAllocation`. Otherwise, it will return 0.
   size_t used_bytes() const;
 
+  // Returns true if the constant buffers of the model being allocated are in
+  // host byte order, which is always the case on little-endian hosts and for
+  // models converted with convert_byte_order (see model_byte_order.h). Only
+  // valid after `StartModelAllocation`.
+  bool model_in_host_byte_order() const { return model_in_host_byte_order_; }
+
+  // Keeps every tensor read or written by the first `num_operators` operators
+  // allocated while any of them runs, for operators that run interleaved patch
+  // by patch (see micro/patch_execution.h). Applies to the next
+  // `FinishModelAllocation`, 0 plans every operator on its own.
+  void SetInterleavedOperators(int num_operators) {
+    num_interleaved_operators_ = num_operators;
+  }
+
  protected:
   MicroAllocator(SimpleMemoryAllocator* memory_allocator,
                  ErrorReporter* error_reporter);
@@ -252,6 +269,23 @@ class MicroAllocator {
   // How many scratch buffers have been allocated.
   size_t scratch_buffer_count_ = 0;
 
+  // Node list of the model currently being allocated. Used by the memory
+  // planner to derive tensor lifetimes.
+  NodeAndRegistration* node_and_registrations_ = nullptr;
+  int num_interleaved_operators_ = 0;
+
+  // Reads the HostByteOrder metadata of the model, if any.
+  TfLiteStatus ReadModelByteOrder(const Model* model);
+
+  // Returns the host byte order copy of an array of the model, or nullptr if
+  // the flatbuffer array has to be converted instead. `index` is an index into
+  // the offsets of the byte order table.
+  const TfLiteIntArray* GetHostOrderArray(int index) const;
+
+  bool model_in_host_byte_order_ = true;
+  // Byte order table of the model, see model_byte_order.h.
+  const int32_t* host_order_table_ = nullptr;
+
   virtual TfLiteStatus InitScratchBufferHandles();
   virtual TfLiteStatus MoveScratchBufferHandlesToTail();
 
@@ -16,12 +16,18 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 
 #include <cstdarg>
+#include <cstdint>
 
 #ifndef TF_LITE_STRIP_ERROR_STRINGS
 #include "tensorflow/lite/micro/debug_log.h"
 #include "tensorflow/lite/micro/micro_string.h"
 #endif
 
+#ifdef TF_LITE_LOG_INTERNING
+#include "tensorflow/lite/core/api/interned_log.h"
+#include "tensorflow/lite/micro/debug_log.h"
+#endif
+
 namespace tflite {
 
 int MicroErrorReporter::Report(const char* format, va_list args) {
@@ -38,4 +44,13 @@ int MicroErrorReporter::Report(const char* format, va_list args) {
   return 0;
 }
 
+#ifdef TF_LITE_LOG_INTERNING
+int MicroErrorReporter::ReportInterned(uint32_t id, const uint32_t* words,
+                                       int num_words) {
+  uint8_t frame[kMaxInternedLogFrameSize];
+  DebugLogBinary(frame, EncodeInternedLogFrame(id, words, num_words, frame));
+  return 0;
+}
+#endif
+
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_MICRO_MICRO_ERROR_REPORTER_H_
 
 #include <cstdarg>
+#include <cstdint>
 
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/micro/compatibility.h"
@@ -26,6 +27,11 @@ class MicroErrorReporter : public ErrorReporter {
  public:
   ~MicroErrorReporter() override {}
   int Report(const char* format, va_list args) override;
+#ifdef TF_LITE_LOG_INTERNING
+  // Writes the message to DebugLogBinary() as a binary frame.
+  int ReportInterned(uint32_t id, const uint32_t* words,
+                     int num_words) override;
+#endif
 
  private:
   TF_LITE_REMOVE_VIRTUAL_DELETE
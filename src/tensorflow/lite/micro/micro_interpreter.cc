@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
+#include "tensorflow/lite/micro/kernel_tuner.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
@@ -31,7 +32,8 @@ limitations under the License.
 namespace tflite {
 namespace {
 
-#ifndef TF_LITE_STRIP_ERROR_STRINGS
+// Used in error messages and, in debug builds, to name profiler events.
+#if !defined(TF_LITE_STRIP_ERROR_STRINGS) || !defined(NDEBUG)
 const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
   if (registration->builtin_code == BuiltinOperator_CUSTOM) {
     return registration->custom_name;
@@ -39,7 +41,7 @@ const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
     return EnumNameBuiltinOperator(BuiltinOperator(registration->builtin_code));
   }
 }
-#endif  // !defined(TF_LITE_STRIP_ERROR_STRINGS)
+#endif  // !defined(TF_LITE_STRIP_ERROR_STRINGS) || !defined(NDEBUG)
 
 }  // namespace
 
@@ -92,7 +94,9 @@ void ContextHelper::ReportOpError(struct TfLiteContext* context,
   ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
   va_list args;
   va_start(args, format);
-  TF_LITE_REPORT_ERROR(helper->error_reporter_, format, args);
+  // Messages interned by the kernel's TF_LITE_KERNEL_LOG reach the reporter's
+  // ReportInterned(), the others are forwarded as they are.
+  helper->error_reporter_->ReportFromContext(format, args);
   va_end(args);
 #endif
 }
@@ -110,6 +114,25 @@ TfLiteEvalTensor* ContextHelper::GetEvalTensor(
   return &helper->eval_tensors_[tensor_idx];
 }
 
+TfLiteExternalContext* ContextHelper::GetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
+  if (type < 0 || type >= kTfLiteMaxExternalContexts) {
+    return nullptr;
+  }
+  return helper->external_contexts_[type];
+}
+
+void ContextHelper::SetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type,
+    TfLiteExternalContext* external_context) {
+  ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
+  if (type < 0 || type >= kTfLiteMaxExternalContexts) {
+    return;
+  }
+  helper->external_contexts_[type] = external_context;
+}
+
 void ContextHelper::SetNodeIndex(int idx) {
   if (scratch_buffer_count_ != 0) {
     TF_LITE_REPORT_ERROR(error_reporter_,
@@ -213,6 +236,8 @@ void MicroInterpreter::Init(tflite::Profiler* profiler) {
   context_.ReportError = context_helper_.ReportOpError;
   context_.GetTensor = context_helper_.GetTensor;
   context_.GetEvalTensor = context_helper_.GetEvalTensor;
+  context_.GetExternalContext = context_helper_.GetExternalContext;
+  context_.SetExternalContext = context_helper_.SetExternalContext;
   context_.recommended_num_threads = 1;
   context_.profiler = profiler;
 
@@ -260,6 +285,52 @@ void MicroInterpreter::CorrectTensorDataEndianness(T* data, int32_t size) {
 }
 
 TfLiteStatus MicroInterpreter::AllocateTensors() {
+  bool done = false;
+  while (!done) {
+    TF_LITE_ENSURE_STATUS(AllocateTensorsStep(&done));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::AllocateTensorsStep(bool* done) {
+  *done = false;
+  if (tensors_allocated_) {
+    *done = true;
+    return kTfLiteOk;
+  }
+  // The allocator cannot give back what a failed step allocated, nor the
+  // kernels the state their Init or Prepare left behind, so running the step
+  // again would plan on top of it. A failure is final instead.
+  if (initialization_status_ != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Interpreter failed to initialize or allocate "
+                         "tensors, create a new one to retry.");
+    return kTfLiteError;
+  }
+  const size_t step = allocation_step_;
+  TfLiteStatus status = kTfLiteOk;
+  if (step == 0) {
+    status = StartAllocation();
+  } else {
+    const size_t num_ops = subgraph_->operators()->size();
+    if (step <= num_ops) {
+      InitOp(step - 1);
+    } else if (step <= 2 * num_ops) {
+      status = PrepareOp(step - num_ops - 1);
+    } else {
+      status = FinishAllocation();
+      *done = status == kTfLiteOk;
+    }
+  }
+  if (status != kTfLiteOk) {
+    initialization_status_ = kTfLiteError;
+    return kTfLiteError;
+  }
+  ++allocation_step_;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::StartAllocation() {
   if (allocator_.StartModelAllocation(model_, op_resolver_,
                                       &node_and_registrations_,
                                       &eval_tensors_) != kTfLiteOk) {
@@ -276,12 +347,25 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_helper_.SetTfLiteEvalTensors(eval_tensors_);
   context_.tensors_size = subgraph_->tensors()->size();
 
+  KernelTuner* tuner = GetKernelTuner(&context_);
+  if (tuner != nullptr) {
+    tuner->Reset();
+  }
+
   // If the system is big endian then convert weights from the flatbuffer from
   // little to big endian on startup so that it does not need to be done during
-  // inference.
+  // inference, unless the model has been converted offline (see
+  // model_byte_order.h).
   // NOTE: This requires that the flatbuffer is held in memory which can be
   // modified by this process.
-  if (!FLATBUFFERS_LITTLEENDIAN) {
+  if (!allocator_.model_in_host_byte_order()) {
+#if defined(TF_LITE_MICRO_REQUIRE_HOST_BYTE_ORDER)
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Model buffers are not in host byte order, convert "
+                         "the model with convert_byte_order.");
+    initialization_status_ = kTfLiteError;
+    return kTfLiteError;
+#else
     for (size_t t = 0; t < subgraph_->tensors()->size(); ++t) {
       if (auto* buffer =
               (*model_->buffers())[subgraph_->tensors()->Get(t)->buffer()]) {
@@ -296,57 +380,75 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
         }
       }
     }
+#endif  // defined(TF_LITE_MICRO_REQUIRE_HOST_BYTE_ORDER)
   }
 
+  if (num_patched_operators_ > 0 &&
+      patch_executor_.Plan(&allocator_, error_reporter_, subgraph_,
+                           node_and_registrations_, eval_tensors_,
+                           num_patched_operators_,
+                           num_patches_) != kTfLiteOk) {
+    initialization_status_ = kTfLiteError;
+    return kTfLiteError;
+  }
+  allocator_.SetInterleavedOperators(patch_executor_.num_operators());
+
   // Only allow AllocatePersistentBuffer in Init stage.
   context_.AllocatePersistentBuffer = context_helper_.AllocatePersistentBuffer;
   context_.RequestScratchBufferInArena = nullptr;
   context_.GetScratchBuffer = nullptr;
 
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    context_helper_.SetNodeIndex(i);
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
-    size_t init_data_size;
-    const char* init_data;
-    if (registration->builtin_code == BuiltinOperator_CUSTOM) {
-      init_data = reinterpret_cast<const char*>(node->custom_initial_data);
-      init_data_size = node->custom_initial_data_size;
-    } else {
-      init_data = reinterpret_cast<const char*>(node->builtin_data);
-      init_data_size = 0;
-    }
-    if (registration->init) {
-      node->user_data =
-          registration->init(&context_, init_data, init_data_size);
-    }
+  return kTfLiteOk;
+}
+
+void MicroInterpreter::InitOp(size_t index) {
+  context_helper_.SetNodeIndex(index);
+  auto* node = &(node_and_registrations_[index].node);
+  auto* registration = node_and_registrations_[index].registration;
+  size_t init_data_size;
+  const char* init_data;
+  if (registration->builtin_code == BuiltinOperator_CUSTOM) {
+    init_data = reinterpret_cast<const char*>(node->custom_initial_data);
+    init_data_size = node->custom_initial_data_size;
+  } else {
+    init_data = reinterpret_cast<const char*>(node->builtin_data);
+    init_data_size = 0;
+  }
+  if (registration->init) {
+    node->user_data = registration->init(&context_, init_data, init_data_size);
   }
   context_helper_.SetNodeIndex(-1);
+}
 
+TfLiteStatus MicroInterpreter::PrepareOp(size_t index) {
   // Both AllocatePersistentBuffer and RequestScratchBufferInArena is
   // available in Prepare stage.
   context_.RequestScratchBufferInArena =
       context_helper_.RequestScratchBufferInArena;
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    // Set node idx to annotate the lifetime for scratch buffers.
-    context_helper_.SetNodeIndex(i);
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
-    if (registration->prepare) {
-      TfLiteStatus prepare_status = registration->prepare(&context_, node);
-      if (prepare_status != kTfLiteOk) {
-        TF_LITE_REPORT_ERROR(
-            error_reporter_,
-            "Node %s (number %df) failed to prepare with status %d",
-            OpNameFromRegistration(registration), i, prepare_status);
-        return kTfLiteError;
-      }
+  // Set node idx to annotate the lifetime for scratch buffers.
+  context_helper_.SetNodeIndex(index);
+  auto* node = &(node_and_registrations_[index].node);
+  auto* registration = node_and_registrations_[index].registration;
+  if (registration->prepare) {
+    TfLiteStatus prepare_status = registration->prepare(&context_, node);
+    if (prepare_status != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter_,
+          "Node %s (number %df) failed to prepare with status %d",
+          OpNameFromRegistration(registration), index, prepare_status);
+      return kTfLiteError;
     }
-    allocator_.ResetTempAllocations();
-    context_helper_.CommitScratchBuffers();
   }
+  if (static_cast<int>(index) < patch_executor_.num_operators()) {
+    TF_LITE_ENSURE_STATUS(patch_executor_.RequestTile(&context_, index));
+  }
+  allocator_.ResetTempAllocations();
+  context_helper_.CommitScratchBuffers();
   context_helper_.SetNodeIndex(-1);
+  return kTfLiteOk;
+}
 
+TfLiteStatus MicroInterpreter::FinishAllocation() {
   // Prepare is done, we're ready for Invoke. Memory allocation is no longer
   // allowed. Kernels can only fetch scratch buffers via GetScratchBuffer.
   context_.AllocatePersistentBuffer = nullptr;
@@ -361,6 +463,15 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_helper_.SetScratchBufferHandles(scratch_buffer_handles);
   TF_LITE_ENSURE_STATUS(ResetVariableTensors());
 
+  // Times the kernel variants on the planned tensors.
+  KernelTuner* tuner = GetKernelTuner(&context_);
+  if (tuner != nullptr) {
+    TF_LITE_ENSURE_STATUS(tuner->Tune(
+        &context_,
+        patch_executor_.num_operators() > 0 ? &patch_executor_ : nullptr));
+    allocator_.ResetTempAllocations();
+  }
+
   tensors_allocated_ = true;
   return kTfLiteOk;
 }
@@ -378,42 +489,149 @@ TfLiteStatus MicroInterpreter::Invoke() {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   }
 
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
-    auto* node = &(node_and_registrations_[i].node);
-    auto* registration = node_and_registrations_[i].registration;
+  early_exit_taken_ = -1;
+  int next_exit = 0;
+  size_t first_op = 0;
+  if (patch_executor_.num_operators() > 0) {
+    const TfLiteStatus status = InvokePatches();
+    if (status != kTfLiteOk) {
+      return status;
+    }
+    for (; first_op < static_cast<size_t>(patch_executor_.num_operators());
+         ++first_op) {
+      if (TakeEarlyExit(first_op, &next_exit)) {
+        return kTfLiteOk;
+      }
+    }
+  }
+  for (size_t i = first_op; i < subgraph_->operators()->size(); ++i) {
+    const TfLiteStatus status = InvokeOp(i);
+    if (status != kTfLiteOk) {
+      return status;
+    }
+    if (TakeEarlyExit(i, &next_exit)) {
+      return kTfLiteOk;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::InvokeOp(size_t index) {
+  auto* node = &(node_and_registrations_[index].node);
+  auto* registration = node_and_registrations_[index].registration;
+  if (registration->invoke == nullptr) {
+    return kTfLiteOk;
+  }
 
-    if (registration->invoke) {
-      TfLiteStatus invoke_status;
+  TfLiteStatus invoke_status;
 #ifndef NDEBUG  // Omit profiler overhead from release builds.
-      // The case where profiler == nullptr is handled by
-      // ScopedOperatorProfile.
-      tflite::Profiler* profiler =
-          reinterpret_cast<tflite::Profiler*>(context_.profiler);
-      ScopedOperatorProfile scoped_profiler(
-          profiler, OpNameFromRegistration(registration), i);
+  // The case where profiler == nullptr is handled by ScopedOperatorProfile.
+  tflite::Profiler* profiler =
+      reinterpret_cast<tflite::Profiler*>(context_.profiler);
+  ScopedOperatorProfile scoped_profiler(
+      profiler, OpNameFromRegistration(registration), index);
 #endif
-      invoke_status = registration->invoke(&context_, node);
-
-      // All TfLiteTensor structs used in the kernel are allocated from temp
-      // memory in the allocator. This creates a chain of allocations in the
-      // temp section. The call below resets the chain of allocations to
-      // prepare for the next call.
-      allocator_.ResetTempAllocations();
-
-      if (invoke_status == kTfLiteError) {
-        TF_LITE_REPORT_ERROR(
-            error_reporter_,
-            "Node %s (number %d) failed to invoke with status %d",
-            OpNameFromRegistration(registration), i, invoke_status);
-        return kTfLiteError;
-      } else if (invoke_status != kTfLiteOk) {
-        return invoke_status;
+  invoke_status = registration->invoke(&context_, node);
+
+  // All TfLiteTensor structs used in the kernel are allocated from temp
+  // memory in the allocator. This creates a chain of allocations in the temp
+  // section. The call below resets the chain of allocations to prepare for
+  // the next call.
+  allocator_.ResetTempAllocations();
+
+  if (invoke_status == kTfLiteError) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Node %s (number %d) failed to invoke with status %d",
+                         OpNameFromRegistration(registration), index,
+                         invoke_status);
+  }
+  return invoke_status;
+}
+
+TfLiteStatus MicroInterpreter::InvokePatches() {
+  for (int patch = 0; patch < patch_executor_.num_patches(); ++patch) {
+    for (int i = 0; i < patch_executor_.num_operators(); ++i) {
+      patch_executor_.BindOperator(&context_, patch, i);
+      const TfLiteStatus status = InvokeOp(i);
+      patch_executor_.UnbindOperator(i);
+      if (status != kTfLiteOk) {
+        return status;
       }
     }
   }
   return kTfLiteOk;
 }
 
+bool MicroInterpreter::TakeEarlyExit(size_t index, int* next_exit) {
+  if (*next_exit == num_early_exits_ ||
+      static_cast<size_t>(early_exits_[*next_exit].op_index) != index) {
+    return false;
+  }
+  const EarlyExit& early_exit = early_exits_[*next_exit];
+  const TfLiteEvalTensor* head =
+      &eval_tensors_[outputs().Get(early_exit.output_index)];
+  if (early_exit.check(head, early_exit.user_data)) {
+    early_exit_taken_ = *next_exit;
+    return true;
+  }
+  ++*next_exit;
+  return false;
+}
+
+TfLiteStatus MicroInterpreter::SetPatchExecution(int num_operators,
+                                                 int num_patches) {
+  if (allocation_step_ != 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetPatchExecution() must be called before "
+                         "AllocateTensors().");
+    return kTfLiteError;
+  }
+  if (num_operators < 0 ||
+      static_cast<size_t>(num_operators) > operators_size() ||
+      (num_operators > 0 && num_patches < 1)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Invalid patch execution of %d operators in %d "
+                         "patches.",
+                         num_operators, num_patches);
+    return kTfLiteError;
+  }
+  num_patched_operators_ = num_operators;
+  num_patches_ = num_patches;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetEarlyExits(const EarlyExit* exits,
+                                             int num_exits) {
+  early_exits_ = nullptr;
+  num_early_exits_ = 0;
+  if (exits == nullptr) {
+    return kTfLiteOk;
+  }
+  const int num_operators = static_cast<int>(operators_size());
+  for (int i = 0; i < num_exits; ++i) {
+    const EarlyExit& early_exit = exits[i];
+    if (early_exit.op_index < 0 || early_exit.op_index >= num_operators ||
+        (i > 0 && early_exit.op_index <= exits[i - 1].op_index)) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Early exit %d has operator %d, operators must be "
+                           "in range and increasing.",
+                           i, early_exit.op_index);
+      return kTfLiteError;
+    }
+    if (early_exit.output_index < 0 ||
+        static_cast<size_t>(early_exit.output_index) >= outputs_size() ||
+        early_exit.check == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Early exit %d needs a model output and a check.",
+                           i);
+      return kTfLiteError;
+    }
+  }
+  early_exits_ = exits;
+  num_early_exits_ = num_exits;
+  return kTfLiteOk;
+}
+
 TfLiteTensor* MicroInterpreter::input(size_t index) {
   const size_t length = inputs_size();
   if (index >= length) {
@@ -495,4 +713,13 @@ TfLiteStatus MicroInterpreter::ResetVariableTensors() {
   return kTfLiteOk;
 }
 
+void MicroInterpreter::SetExternalContext(TfLiteExternalContextType type,
+                                          TfLiteExternalContext* ctx) {
+  context_.SetExternalContext(&context_, type, ctx);
+}
+
+void MicroInterpreter::SetNumThreads(int num_threads) {
+  context_.recommended_num_threads = num_threads > 1 ? num_threads : 1;
+}
+
 }  // namespace tflite
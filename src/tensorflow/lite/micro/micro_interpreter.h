@@ -23,8 +23,10 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/micro/early_exit.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/micro/patch_execution.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -55,6 +57,11 @@ class ContextHelper {
                                  int tensor_idx);
   static TfLiteEvalTensor* GetEvalTensor(const struct TfLiteContext* context,
                                          int tensor_idx);
+  static TfLiteExternalContext* GetExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+  static void SetExternalContext(struct TfLiteContext* context,
+                                 TfLiteExternalContextType type,
+                                 TfLiteExternalContext* external_context);
   // Commits all scratch buffer allocations to MicroAllocator.
   TfLiteStatus CommitScratchBuffers();
 
@@ -77,6 +84,8 @@ class ContextHelper {
 
   size_t scrach_buffer_sizes_[kMaxScratchBuffersPerOp];
   size_t scratch_buffer_count_ = 0;
+
+  TfLiteExternalContext* external_contexts_[kTfLiteMaxExternalContexts] = {};
 };
 
 }  // namespace internal
@@ -107,14 +116,48 @@ class MicroInterpreter {
   ~MicroInterpreter();
 
   // Runs through the model and allocates all necessary input, output and
-  // intermediate tensors.
+  // intermediate tensors. A failure is final: later calls and Invoke() return
+  // kTfLiteError, and a new interpreter has to be created on the arena.
   TfLiteStatus AllocateTensors();
 
+  // Runs one step of AllocateTensors(): starting the model allocation, the
+  // Init or the Prepare of one operator, or finishing the allocation with the
+  // memory plan. Sets `done` once the tensors are allocated. Lets a model be
+  // loaded in small time slices, see micro/model_hot_swap.h. A failed step is
+  // not retried, as for AllocateTensors().
+  TfLiteStatus AllocateTensorsStep(bool* done);
+
   // In order to support partial graph runs for strided models, this can return
   // values other than kTfLiteOk and kTfLiteError.
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
   TfLiteStatus Invoke();
 
+  // Installs the early exits of a cascaded model, ordered by operator index
+  // with at most one exit per operator. Invoke() runs the check of each exit
+  // after its operator and returns kTfLiteOk without running the remaining
+  // operators once a check passes. The head of the exit taken is then valid,
+  // the other outputs are not. Heads must be model outputs, so that the
+  // memory planner keeps them until the end of Invoke(). Pass nullptr to
+  // remove the exits. Does not take ownership of the array.
+  TfLiteStatus SetEarlyExits(const EarlyExit* exits, int num_exits);
+
+  // Index in the early exits of the exit taken by the last Invoke(), or -1 if
+  // it ran all operators.
+  int early_exit_taken() const { return early_exit_taken_; }
+
+  // Runs the first `num_operators` operators on `num_patches` horizontal
+  // bands of their output instead of whole tensors, see
+  // micro/patch_execution.h. Their intermediate tensors then only hold one
+  // band, which lowers the peak memory of models whose first layers work on
+  // large images, at the cost of computing the overlap of the bands again.
+  // The operators must be a chain of CONV_2D and DEPTHWISE_CONV_2D nodes, each
+  // feeding the next one only, which AllocateTensors() checks once the graph
+  // is rewritten: nodes removed by a rewrite are skipped and fused separable
+  // convolutions are accepted. `num_operators` counts the operators of the
+  // model. Call before AllocateTensors(), 0 operators runs the model as a
+  // whole.
+  TfLiteStatus SetPatchExecution(int num_operators, int num_patches);
+
   size_t tensors_size() const { return context_.tensors_size; }
   TfLiteTensor* tensor(size_t tensor_index);
   template <class T>
@@ -162,6 +205,21 @@ class MicroInterpreter {
   // Reset all variable tensors to the default value.
   TfLiteStatus ResetVariableTensors();
 
+  // Installs an external context that kernels look up by type, for example a
+  // WeightCopyEngine (see micro/weight_copy_engine.h). Kernels plan with the
+  // contexts present when they are prepared, so this should be called before
+  // AllocateTensors(). Does not take ownership of the pointer.
+  void SetExternalContext(TfLiteExternalContextType type,
+                          TfLiteExternalContext* ctx);
+
+  // Sets TfLiteContext::recommended_num_threads, 1 by default. Kernels split
+  // their work into at most this many chunks and run them through the
+  // ParallelExecutor installed as an external context, see
+  // micro/parallel_executor.h. Layers whose weights are packed, compressed or
+  // prefetched split the output channels of each weight tile, so small tiles
+  // run on the calling thread only.
+  void SetNumThreads(int num_threads);
+
   TfLiteStatus initialization_status() const { return initialization_status_; }
 
   size_t operators_size() const { return subgraph_->operators()->size(); }
@@ -193,6 +251,17 @@ class MicroInterpreter {
   template <class T>
   void CorrectTensorDataEndianness(T* data, int32_t size);
 
+  TfLiteStatus StartAllocation();
+  void InitOp(size_t index);
+  TfLiteStatus PrepareOp(size_t index);
+  TfLiteStatus FinishAllocation();
+
+  TfLiteStatus InvokeOp(size_t index);
+  // Runs the patched operators once per patch.
+  TfLiteStatus InvokePatches();
+  // Runs the check of the early exit of operator `index`, if it has one.
+  bool TakeEarlyExit(size_t index, int* next_exit);
+
   NodeAndRegistration* node_and_registrations_ = nullptr;
 
   const Model* model_;
@@ -201,6 +270,17 @@ class MicroInterpreter {
   TfLiteContext context_ = {};
   MicroAllocator& allocator_;
   bool tensors_allocated_;
+  // Next step of AllocateTensorsStep(): 0 starts the allocation, the next
+  // operators_size() steps run Init and the ones after those run Prepare.
+  size_t allocation_step_ = 0;
+
+  const EarlyExit* early_exits_ = nullptr;
+  int num_early_exits_ = 0;
+  int early_exit_taken_ = -1;
+
+  int num_patched_operators_ = 0;
+  int num_patches_ = 0;
+  internal::PatchExecutor patch_executor_;
 
   TfLiteStatus initialization_status_;
 
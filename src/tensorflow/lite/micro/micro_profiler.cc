@@ -33,10 +33,10 @@ uint32_t MicroProfiler::BeginEvent(const char* tag, EventType event_type,
 }
 
 void MicroProfiler::EndEvent(uint32_t event_handle) {
-#ifndef TF_LITE_STRIP_ERROR_STRINGS
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_INFO
   int32_t end_time = GetCurrentTimeTicks();
-  TF_LITE_REPORT_ERROR(reporter_, "%s took %d cycles\n", event_tag_,
-                       end_time - start_time_);
+  TF_LITE_REPORT_INFO(reporter_, "%s took %d cycles\n", event_tag_,
+                      end_time - start_time_);
 #endif
 }
 }  // namespace tflite
@@ -276,4 +276,10 @@ void SymmetricDequantize(const int8_t* values, const int size,
   }
 }
 
+void Float16ToFloat(const TfLiteFloat16* values, int size, float* result) {
+  for (int i = 0; i < size; ++i) {
+    result[i] = Float16ToFloat(values[i]);
+  }
+}
+
 }  // namespace tflite
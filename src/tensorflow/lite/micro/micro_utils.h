@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_MICRO_MICRO_UTILS_H_
 
 #include <stdint.h>
+#include <string.h>
 
 #include "tensorflow/lite/c/common.h"
 
@@ -105,6 +106,30 @@ void AsymmetricDequantize(const T* values, const int size,
   }
 }
 
+// Converts an IEEE 754 half precision value, the storage of float16 weights,
+// to float. Every half precision value is exactly representable.
+inline float Float16ToFloat(TfLiteFloat16 value) {
+  const uint32_t sign = static_cast<uint32_t>(value.data & 0x8000) << 16;
+  const uint32_t exponent = (value.data >> 10) & 0x1f;
+  const uint32_t mantissa = value.data & 0x3ff;
+  uint32_t bits;
+  if (exponent == 0x1f) {
+    // Infinity or NaN.
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  } else {
+    // Zero or subnormal, mantissa * 2^-24.
+    const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216);
+    return sign != 0 ? -magnitude : magnitude;
+  }
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+void Float16ToFloat(const TfLiteFloat16* values, int size, float* result);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_MICRO_MICRO_UTILS_H_
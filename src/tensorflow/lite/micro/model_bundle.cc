@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_bundle.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/model_verifier.h"
+
+namespace tflite {
+namespace {
+
+constexpr size_t kHeaderWords = 4;
+constexpr size_t kModelEntryWords = 2;
+constexpr size_t kSharedEntryWords = 3;
+
+bool IsAligned(uint32_t offset) {
+  return offset % kModelBundleAlignment == 0;
+}
+
+}  // namespace
+
+ModelBundle::ModelBundle(const void* bundle_data, size_t bundle_size,
+                         ErrorReporter* error_reporter)
+    : bundle_data_(static_cast<const uint8_t*>(bundle_data)),
+      bundle_size_(bundle_size),
+      error_reporter_(error_reporter) {
+  initialization_status_ = CheckDirectories();
+}
+
+uint32_t ModelBundle::Word(size_t index) const {
+  return flatbuffers::ReadScalar<uint32_t>(bundle_data_ +
+                                           index * sizeof(uint32_t));
+}
+
+TfLiteStatus ModelBundle::CheckDirectories() {
+  if (reinterpret_cast<uintptr_t>(bundle_data_) % kModelBundleAlignment != 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Model bundle must be %d-byte aligned.",
+                         static_cast<int>(kModelBundleAlignment));
+    return kTfLiteError;
+  }
+  if (bundle_size_ < kHeaderWords * sizeof(uint32_t) ||
+      Word(0) != kModelBundleMagic) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Not a model bundle.");
+    return kTfLiteError;
+  }
+  if (Word(1) != kModelBundleVersion) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Model bundle version %u not supported, expected %u.",
+                         Word(1), kModelBundleVersion);
+    return kTfLiteError;
+  }
+  const uint32_t num_models = Word(2);
+  const uint32_t num_shared = Word(3);
+  // Bounds the counts before the directory size is computed from them.
+  const size_t max_entries = bundle_size_ / sizeof(uint32_t);
+  const size_t directory_words =
+      kHeaderWords + num_models * kModelEntryWords +
+      num_shared * kSharedEntryWords;
+  if (num_models == 0 || num_models > max_entries / kModelEntryWords ||
+      num_shared > max_entries / kSharedEntryWords ||
+      directory_words * sizeof(uint32_t) > bundle_size_) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Invalid model bundle directory.");
+    return kTfLiteError;
+  }
+  const size_t directory_end = directory_words * sizeof(uint32_t);
+
+  for (uint32_t i = 0; i < num_models; ++i) {
+    const uint32_t offset = Word(kHeaderWords + i * kModelEntryWords);
+    const uint32_t size = Word(kHeaderWords + i * kModelEntryWords + 1);
+    if (!IsAligned(offset) || offset < directory_end ||
+        offset > bundle_size_ || size > bundle_size_ - offset) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Model %u is outside of the model bundle.", i);
+      return kTfLiteError;
+    }
+  }
+  const size_t shared_directory = kHeaderWords + num_models * kModelEntryWords;
+  for (uint32_t i = 0; i < num_shared; ++i) {
+    const uint32_t offset = Word(shared_directory + i * kSharedEntryWords);
+    const uint32_t size = Word(shared_directory + i * kSharedEntryWords + 1);
+    if (!IsAligned(offset) || offset < directory_end + sizeof(uint32_t) ||
+        offset > bundle_size_ || size > bundle_size_ - offset ||
+        Word(offset / sizeof(uint32_t) - 1) != size) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter_, "Shared buffer %u is outside of the model bundle.",
+          i);
+      return kTfLiteError;
+    }
+  }
+  num_models_ = static_cast<int>(num_models);
+  num_shared_ = static_cast<int>(num_shared);
+  return kTfLiteOk;
+}
+
+const void* ModelBundle::model_data(int index) const {
+  if (index < 0 || index >= num_models_) {
+    return nullptr;
+  }
+  return bundle_data_ + Word(kHeaderWords + index * kModelEntryWords);
+}
+
+size_t ModelBundle::model_extent(int index) const {
+  if (index < 0 || index >= num_models_) {
+    return 0;
+  }
+  return bundle_size_ - Word(kHeaderWords + index * kModelEntryWords);
+}
+
+const Model* ModelBundle::GetModel(int index) const {
+  const void* data = model_data(index);
+  return data == nullptr ? nullptr : ::tflite::GetModel(data);
+}
+
+TfLiteStatus ModelBundle::VerifySharedBuffers() const {
+  const size_t shared_directory = kHeaderWords + num_models_ * kModelEntryWords;
+  for (int i = 0; i < num_shared_; ++i) {
+    const size_t entry = shared_directory + i * kSharedEntryWords;
+    if (ComputeCrc32(bundle_data_ + Word(entry), Word(entry + 1)) !=
+        Word(entry + 2)) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Shared buffer %d does not match its hash.", i);
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
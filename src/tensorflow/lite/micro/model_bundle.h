@@ -0,0 +1,97 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MODEL_BUNDLE_H_
+#define TENSORFLOW_LITE_MICRO_MODEL_BUNDLE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// A model bundle stores several models that share constant buffers, for
+// example one backbone with different heads, so that the shared weights are
+// in flash only once.
+//
+// Flatbuffer offsets are relative and point forward, so the bundle places the
+// shared buffers after all models and the Buffer tables of every model that
+// uses one point at the same copy. Each model of a bundle is an ordinary
+// model to the MicroAllocator and the kernels: it gets its own interpreter
+// and memory plan, and all its constant tensors with shared buffers point
+// into the shared region. Switching between models of a bundle, directly or
+// with ModelHotSwap, only plans the new model.
+//
+// Layout, all words little-endian uint32, offsets from the start of the
+// bundle:
+//
+//   kModelBundleMagic, kModelBundleVersion, num_models, num_shared
+//   num_models x {offset, size}: the model flatbuffers.
+//   num_shared x {offset, size, hash}: the data of the shared buffers, each
+//       preceded by its flatbuffer vector length, and its ComputeCrc32().
+//   The model flatbuffers, then the shared buffers, with the models and the
+//       data of the shared buffers 16-byte aligned.
+//
+// The tools/bundle_models host tool writes bundles; it shares buffers
+// with the same content hash and bytes. Shared buffers are read-only, so the
+// models of a bundle for a big-endian target are converted with
+// tools/convert_byte_order before bundling.
+constexpr uint32_t kModelBundleMagic = 0x424d4654;  // "TFMB"
+constexpr uint32_t kModelBundleVersion = 1;
+constexpr size_t kModelBundleAlignment = 16;
+
+class ModelBundle {
+ public:
+  // Checks the header and the directories of the bundle at `bundle_data`,
+  // which must be kModelBundleAlignment aligned. Check initialization_status()
+  // before use.
+  ModelBundle(const void* bundle_data, size_t bundle_size,
+              ErrorReporter* error_reporter);
+
+  TfLiteStatus initialization_status() const { return initialization_status_; }
+
+  int num_models() const { return num_models_; }
+  int num_shared_buffers() const { return num_shared_; }
+
+  // The model at `index`, nullptr if there is no such model.
+  const Model* GetModel(int index) const;
+
+  // Start of the flatbuffer of the model at `index`, and the number of bytes
+  // to pass as model size to the checks of model_verifier.h: the shared
+  // buffers are past the end of the model, so the model extends to the end of
+  // the bundle.
+  const void* model_data(int index) const;
+  size_t model_extent(int index) const;
+
+  // Recomputes the hash of every shared buffer, a pass over all shared bytes.
+  TfLiteStatus VerifySharedBuffers() const;
+
+ private:
+  uint32_t Word(size_t index) const;
+  TfLiteStatus CheckDirectories();
+
+  const uint8_t* bundle_data_;
+  size_t bundle_size_;
+  ErrorReporter* error_reporter_;
+  int num_models_ = 0;
+  int num_shared_ = 0;
+  TfLiteStatus initialization_status_ = kTfLiteError;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MODEL_BUNDLE_H_
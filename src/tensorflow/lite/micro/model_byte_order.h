@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MODEL_BYTE_ORDER_H_
+#define TENSORFLOW_LITE_MICRO_MODEL_BYTE_ORDER_H_
+
+#include <cstdint>
+
+namespace tflite {
+
+// Models converted to the byte order of the target.
+//
+// The flatbuffer structure of a model is little-endian and always read
+// through the flatbuffers accessors, but the runtime uses constant tensor
+// data, metadata tables, tensor dims and node input/output lists in place.
+// A plain model has little-endian buffers, so on a big-endian host
+// MicroInterpreter::AllocateTensors() byte-swaps every constant tensor in
+// place, which needs a writable model, and the MicroAllocator copies every
+// dims and index array into the arena.
+//
+// The convert_byte_order host tool (tools/convert_byte_order.cc) stores
+// the buffers in the byte order of the target instead, and adds a metadata
+// entry with ready-made copies of those arrays:
+//
+// | Metadata component |                 Value                                |
+// |    name:string     | “HostByteOrder”                                      |
+// |    buffer:unit     | Index of buffer containing the byte order table      |
+//
+// The table is a list of 32-bit integers in the byte order of the target:
+//
+// |   Offset   |                            Value                             |
+// |     0      | kHostByteOrderMark, reads back as such on the target only    |
+// |     1      | Byte order table format version – set to 0                   |
+// |     2      | Number of tensors of subgraph 0: t                           |
+// |     3      | Number of operators of subgraph 0: o                         |
+// |   4 + i    | Offset of the dims array of tensor #i, or -1                 |
+// | 4 + t + 2j | Offset of the inputs array of operator #j                    |
+// | 5 + t + 2j | Offset of the outputs array of operator #j                   |
+//
+// Offsets count 32-bit words from the start of the table and point at
+// TfLiteIntArray images: a size followed by that many values.
+//
+// A model with a matching mark is used as it is, so loading takes no time or
+// arena space proportional to the weights and the model can stay in read-only
+// memory. Building with TF_LITE_MICRO_REQUIRE_HOST_BYTE_ORDER removes the
+// in-place conversion, and big-endian targets then reject plain models.
+constexpr char kHostByteOrderMetadata[] = "HostByteOrder";
+constexpr uint32_t kHostByteOrderMark = 0x01020304;
+constexpr int32_t kHostByteOrderVersion = 0;
+constexpr int kHostByteOrderHeaderSize = 4;
+
+// Indices into the offsets of the byte order table.
+inline int HostByteOrderDimsIndex(int tensor_index) {
+  return kHostByteOrderHeaderSize + tensor_index;
+}
+
+inline int HostByteOrderInputsIndex(int num_tensors, int operator_index) {
+  return kHostByteOrderHeaderSize + num_tensors + 2 * operator_index;
+}
+
+inline int HostByteOrderOutputsIndex(int num_tensors, int operator_index) {
+  return HostByteOrderInputsIndex(num_tensors, operator_index) + 1;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MODEL_BYTE_ORDER_H_
@@ -0,0 +1,136 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_hot_swap.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+namespace tflite {
+namespace {
+
+// Alignment of the second region, as MicroAllocator aligns its arena.
+constexpr size_t kRegionAlignment = 16;
+
+}  // namespace
+
+ModelHotSwap::ModelHotSwap(uint8_t* tensor_arena, size_t tensor_arena_size,
+                           ErrorReporter* error_reporter,
+                           tflite::Profiler* profiler)
+    : error_reporter_(error_reporter), profiler_(profiler), state_(kNoUpdate) {
+  uint8_t* arena_end = tensor_arena + tensor_arena_size;
+  regions_[0] = tensor_arena;
+  regions_[1] =
+      AlignPointerUp(tensor_arena + tensor_arena_size / 2, kRegionAlignment);
+  region_size_ = arena_end - regions_[1];
+}
+
+ModelHotSwap::~ModelHotSwap() {
+  Destroy(0);
+  Destroy(1);
+}
+
+void ModelHotSwap::Destroy(int slot) {
+  if (interpreters_[slot] != nullptr) {
+    interpreters_[slot]->~MicroInterpreter();
+    interpreters_[slot] = nullptr;
+  }
+}
+
+TfLiteStatus ModelHotSwap::Load(const Model* model,
+                                const MicroOpResolver& op_resolver) {
+  if (interpreter() != nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "A model is already loaded, use BeginUpdate().");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(BeginUpdate(model, op_resolver));
+  bool ready = false;
+  while (!ready) {
+    TF_LITE_ENSURE_STATUS(UpdateStep(&ready));
+  }
+  SwitchIfReady();
+  return kTfLiteOk;
+}
+
+TfLiteStatus ModelHotSwap::BeginUpdate(const Model* model,
+                                       const MicroOpResolver& op_resolver) {
+  if (state_.load(std::memory_order_acquire) != kNoUpdate) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Model update already in progress, finish it or "
+                         "call AbortUpdate() first.");
+    return kTfLiteError;
+  }
+  const int slot = active_ ^ 1;
+  interpreters_[slot] = new (storage_[slot])
+      MicroInterpreter(model, op_resolver, regions_[slot], region_size_,
+                       error_reporter_, profiler_);
+  if (interpreters_[slot]->initialization_status() != kTfLiteOk) {
+    Destroy(slot);
+    return kTfLiteError;
+  }
+  state_.store(kLoading, std::memory_order_relaxed);
+  return kTfLiteOk;
+}
+
+TfLiteStatus ModelHotSwap::UpdateStep(bool* ready) {
+  *ready = false;
+  const int state = state_.load(std::memory_order_acquire);
+  if (state == kReady) {
+    *ready = true;
+    return kTfLiteOk;
+  }
+  if (state != kLoading) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "No model update in progress.");
+    return kTfLiteError;
+  }
+  bool done = false;
+  if (shadow()->AllocateTensorsStep(&done) != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Model update failed.");
+    AbortUpdate();
+    return kTfLiteError;
+  }
+  if (done) {
+    // Publishes the loaded interpreter to SwitchIfReady().
+    state_.store(kReady, std::memory_order_release);
+    *ready = true;
+  }
+  return kTfLiteOk;
+}
+
+void ModelHotSwap::AbortUpdate() {
+  Destroy(active_ ^ 1);
+  state_.store(kNoUpdate, std::memory_order_relaxed);
+}
+
+bool ModelHotSwap::SwitchIfReady() {
+  if (state_.load(std::memory_order_acquire) != kReady) {
+    return false;
+  }
+  const int previous = active_;
+  active_ ^= 1;
+  Destroy(previous);
+  // Hands the free region back to BeginUpdate().
+  state_.store(kNoUpdate, std::memory_order_release);
+  return true;
+}
+
+}  // namespace tflite
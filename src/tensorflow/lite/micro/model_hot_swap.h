@@ -0,0 +1,119 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MODEL_HOT_SWAP_H_
+#define TENSORFLOW_LITE_MICRO_MODEL_HOT_SWAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Replaces the model being served without stopping inference, for example
+// after an over-the-air update.
+//
+// The tensor arena is split into two equal regions. One holds the interpreter
+// that serves, the other one is where the next model is loaded, in small
+// steps that can run between invocations or on a lower priority thread while
+// the serving interpreter keeps invoking:
+//
+//   ModelHotSwap hot_swap(arena, kArenaSize, error_reporter);
+//   hot_swap.Load(model, op_resolver);
+//   ...
+//   // Update task:
+//   hot_swap.BeginUpdate(new_model, op_resolver);
+//   bool ready = false;
+//   while (!ready) {
+//     TF_LITE_ENSURE_STATUS(hot_swap.UpdateStep(&ready));
+//     ... yield ...
+//   }
+//   // Inference task:
+//   hot_swap.SwitchIfReady();
+//   ... fill hot_swap.interpreter()->input(0) ...
+//   hot_swap.interpreter()->Invoke();
+//
+// Each step is one part of MicroInterpreter::AllocateTensors(): reading the
+// model and allocating its tensor structs, the Init or Prepare of one
+// operator, or the memory plan. The switch only exchanges pointers, and the
+// previous interpreter is destroyed so its region holds the next update.
+//
+// BeginUpdate(), UpdateStep() and AbortUpdate() are called from one thread,
+// SwitchIfReady(), interpreter() and Invoke() from one, possibly different,
+// thread. AbortUpdate() must not run once UpdateStep() reported the update
+// ready. The op resolver, error reporter and profiler are shared by both
+// interpreters and must allow that.
+class ModelHotSwap {
+ public:
+  ModelHotSwap(uint8_t* tensor_arena, size_t tensor_arena_size,
+               ErrorReporter* error_reporter,
+               tflite::Profiler* profiler = nullptr);
+  ~ModelHotSwap();
+
+  // Loads the first model in one go. Fails if a model is already loaded.
+  TfLiteStatus Load(const Model* model, const MicroOpResolver& op_resolver);
+
+  // The serving interpreter, nullptr until a model is loaded.
+  MicroInterpreter* interpreter() { return interpreters_[active_]; }
+
+  // Starts loading `model` into the free region. External contexts of the
+  // new interpreter, shadow(), are set after this and before UpdateStep().
+  TfLiteStatus BeginUpdate(const Model* model,
+                           const MicroOpResolver& op_resolver);
+
+  // The interpreter being loaded, nullptr if there is no update.
+  MicroInterpreter* shadow() { return interpreters_[active_ ^ 1]; }
+
+  // Runs one loading step, sets `ready` once the new model can be switched
+  // to. A failed update is dropped.
+  TfLiteStatus UpdateStep(bool* ready);
+
+  // Drops the update being loaded.
+  void AbortUpdate();
+
+  // Switches to the new model if it has been loaded and returns true, in
+  // which case the inputs of interpreter() are those of the new model. Call
+  // between invocations.
+  bool SwitchIfReady();
+
+  // Bytes of each of the two regions.
+  size_t region_size() const { return region_size_; }
+
+ private:
+  enum UpdateState { kNoUpdate, kLoading, kReady };
+
+  void Destroy(int slot);
+
+  uint8_t* regions_[2];
+  size_t region_size_;
+  ErrorReporter* error_reporter_;
+  tflite::Profiler* profiler_;
+
+  alignas(MicroInterpreter) uint8_t storage_[2][sizeof(MicroInterpreter)];
+  MicroInterpreter* interpreters_[2] = {nullptr, nullptr};
+  // Slot of the serving interpreter, the other one holds the update. Only
+  // changed by SwitchIfReady() while the state is kReady.
+  int active_ = 0;
+  std::atomic<int> state_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MODEL_HOT_SWAP_H_
@@ -0,0 +1,402 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_verifier.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+
+// Largest element count accepted for a tensor, which keeps the byte size of
+// any supported type within an int32_t.
+constexpr int64_t kMaxTensorElements = INT32_MAX / 16;
+
+// Generated tables derive privately from flatbuffers::Table, which has the
+// field verification helpers.
+template <typename T>
+const flatbuffers::Table* AsTable(const T* object) {
+  return reinterpret_cast<const flatbuffers::Table*>(object);
+}
+
+// Bounds checks the parts of a model that the MicroAllocator and
+// MicroInterpreter read, skipping names, descriptions, sparsity, shape
+// signatures and other fields TFLite Micro never touches.
+class StructureChecker {
+ public:
+  StructureChecker(const uint8_t* data, size_t size,
+                   ErrorReporter* error_reporter)
+      : data_(data),
+        size_(size),
+        verifier_(data, size),
+        error_reporter_(error_reporter) {}
+
+  TfLiteStatus Check() {
+    if (size_ < 2 * sizeof(flatbuffers::uoffset_t) ||
+        !ModelBufferHasIdentifier(data_) ||
+        !verifier_.VerifyOffset(0)) {
+      return Fail("header");
+    }
+    model_ = GetModel(data_);
+    const flatbuffers::Table* table = AsTable(model_);
+    if (!table->VerifyTableStart(verifier_) ||
+        !table->VerifyField<uint32_t>(verifier_, Model::VT_VERSION) ||
+        !table->VerifyOffset(verifier_, Model::VT_OPERATOR_CODES) ||
+        !verifier_.VerifyVector(model_->operator_codes()) ||
+        !verifier_.VerifyVectorOfTables(model_->operator_codes()) ||
+        !table->VerifyOffset(verifier_, Model::VT_BUFFERS) ||
+        !verifier_.VerifyVector(model_->buffers()) ||
+        !verifier_.VerifyVectorOfTables(model_->buffers()) ||
+        !table->VerifyOffset(verifier_, Model::VT_METADATA) ||
+        !verifier_.VerifyVector(model_->metadata()) ||
+        !verifier_.VerifyVectorOfTables(model_->metadata()) ||
+        !table->VerifyOffset(verifier_, Model::VT_SUBGRAPHS) ||
+        !verifier_.VerifyVector(model_->subgraphs())) {
+      return Fail("model");
+    }
+    if (model_->subgraphs() == nullptr || model_->subgraphs()->size() == 0 ||
+        model_->buffers() == nullptr) {
+      return Fail("model");
+    }
+    TF_LITE_ENSURE_STATUS(CheckMetadata());
+    for (size_t i = 0; i < model_->subgraphs()->size(); ++i) {
+      TF_LITE_ENSURE_STATUS(CheckSubGraph(model_->subgraphs()->Get(i)));
+    }
+    if (!verifier_.EndTable()) {
+      return Fail("model");
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  TfLiteStatus Fail(const char* part) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Model is corrupted (%s).", part);
+    return kTfLiteError;
+  }
+
+  // Returns the data of buffer `index`, which may be nullptr.
+  const flatbuffers::Vector<uint8_t>* BufferData(uint32_t index) const {
+    return model_->buffers()->Get(index)->data();
+  }
+
+  TfLiteStatus CheckMetadata() {
+    if (model_->metadata() == nullptr) {
+      return kTfLiteOk;
+    }
+    for (size_t i = 0; i < model_->metadata()->size(); ++i) {
+      const Metadata* metadata = model_->metadata()->Get(i);
+      if (metadata->name() == nullptr ||
+          metadata->buffer() >= model_->buffers()->size()) {
+        return Fail("metadata");
+      }
+      const flatbuffers::Vector<uint8_t>* data =
+          BufferData(metadata->buffer());
+      const size_t entries =
+          data != nullptr ? data->size() / sizeof(int32_t) : 0;
+      // Tables are read in host byte order, like the MicroAllocator does.
+      const uint32_t* table =
+          entries > 0 ? reinterpret_cast<const uint32_t*>(data->data())
+                      : nullptr;
+      // Names are matched by prefix, like the MicroAllocator does.
+      if (strncmp(metadata->name()->c_str(), kOfflineMemAllocMetadata,
+                  strlen(kOfflineMemAllocMetadata)) == 0) {
+        // The offline planner reads the tensor count and that many offsets.
+        if (entries < 3 || entries - 3 < table[2]) {
+          return Fail("offline memory allocation");
+        }
+      } else if (strncmp(metadata->name()->c_str(),
+                         kCompressedWeightsMetadata,
+                         strlen(kCompressedWeightsMetadata)) == 0) {
+        compressed_table_ = entries >= 3 ? table : nullptr;
+        compressed_entries_ = entries;
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  // Compressed tensors hold less data than their shape implies.
+  bool IsCompressed(size_t tensor_index) const {
+    if (compressed_table_ == nullptr) {
+      return false;
+    }
+    const uint32_t count = compressed_table_[2];
+    for (uint32_t i = 0; i < count && 3 + 4 * i < compressed_entries_; ++i) {
+      if (compressed_table_[3 + 4 * i] == tensor_index) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // All entries of `indices` must be below `limit`, or -1 if `optional`.
+  static bool IndicesInRange(const flatbuffers::Vector<int32_t>* indices,
+                             size_t limit, bool optional) {
+    if (indices == nullptr) {
+      return true;
+    }
+    for (size_t i = 0; i < indices->size(); ++i) {
+      const int32_t index = indices->Get(i);
+      if (index == -1 && optional) {
+        continue;
+      }
+      if (index < 0 || static_cast<size_t>(index) >= limit) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  TfLiteStatus CheckSubGraph(const SubGraph* subgraph) {
+    const flatbuffers::Table* table = AsTable(subgraph);
+    if (!table->VerifyTableStart(verifier_) ||
+        !table->VerifyOffset(verifier_, SubGraph::VT_TENSORS) ||
+        !verifier_.VerifyVector(subgraph->tensors()) ||
+        !table->VerifyOffset(verifier_, SubGraph::VT_INPUTS) ||
+        !verifier_.VerifyVector(subgraph->inputs()) ||
+        !table->VerifyOffset(verifier_, SubGraph::VT_OUTPUTS) ||
+        !verifier_.VerifyVector(subgraph->outputs()) ||
+        !table->VerifyOffset(verifier_, SubGraph::VT_OPERATORS) ||
+        !verifier_.VerifyVector(subgraph->operators())) {
+      return Fail("subgraph");
+    }
+    if (subgraph->tensors() == nullptr || subgraph->operators() == nullptr) {
+      return Fail("subgraph");
+    }
+    const size_t num_tensors = subgraph->tensors()->size();
+    if (!IndicesInRange(subgraph->inputs(), num_tensors, false) ||
+        !IndicesInRange(subgraph->outputs(), num_tensors, false)) {
+      return Fail("subgraph inputs/outputs");
+    }
+    for (size_t i = 0; i < num_tensors; ++i) {
+      TF_LITE_ENSURE_STATUS(CheckTensor(subgraph->tensors()->Get(i), i));
+    }
+    for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+      TF_LITE_ENSURE_STATUS(
+          CheckOperator(subgraph->operators()->Get(i), num_tensors));
+    }
+    if (!verifier_.EndTable()) {
+      return Fail("subgraph");
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus CheckTensor(const Tensor* tensor, size_t tensor_index) {
+    const flatbuffers::Table* table = AsTable(tensor);
+    if (!table->VerifyTableStart(verifier_) ||
+        !table->VerifyOffset(verifier_, Tensor::VT_SHAPE) ||
+        !verifier_.VerifyVector(tensor->shape()) ||
+        !table->VerifyField<int8_t>(verifier_, Tensor::VT_TYPE) ||
+        !table->VerifyField<uint32_t>(verifier_, Tensor::VT_BUFFER) ||
+        !table->VerifyField<uint8_t>(verifier_, Tensor::VT_IS_VARIABLE) ||
+        !table->VerifyOffset(verifier_, Tensor::VT_QUANTIZATION)) {
+      return Fail("tensor");
+    }
+    if (tensor->quantization() != nullptr) {
+      TF_LITE_ENSURE_STATUS(CheckQuantization(tensor->quantization()));
+    }
+    if (!verifier_.EndTable()) {
+      return Fail("tensor");
+    }
+
+    int64_t element_count = 1;
+    if (tensor->shape() != nullptr) {
+      for (size_t i = 0; i < tensor->shape()->size(); ++i) {
+        const int32_t dim = tensor->shape()->Get(i);
+        if (dim < 0) {
+          return Fail("tensor shape");
+        }
+        element_count *= dim;
+        if (element_count > kMaxTensorElements) {
+          return Fail("tensor shape");
+        }
+      }
+    }
+    if (tensor->buffer() >= model_->buffers()->size()) {
+      return Fail("tensor buffer index");
+    }
+    const flatbuffers::Vector<uint8_t>* data = BufferData(tensor->buffer());
+    if (data != nullptr && data->size() > 0) {
+      size_t bytes;
+      size_t type_size;
+      TF_LITE_ENSURE_STATUS(
+          BytesRequiredForTensor(*tensor, &bytes, &type_size, error_reporter_));
+      if (data->size() < bytes && !IsCompressed(tensor_index)) {
+        return Fail("tensor buffer size");
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus CheckQuantization(
+      const QuantizationParameters* quantization) {
+    const flatbuffers::Table* table = AsTable(quantization);
+    if (!table->VerifyTableStart(verifier_) ||
+        !table->VerifyOffset(verifier_, QuantizationParameters::VT_SCALE) ||
+        !verifier_.VerifyVector(quantization->scale()) ||
+        !table->VerifyOffset(verifier_,
+                             QuantizationParameters::VT_ZERO_POINT) ||
+        !verifier_.VerifyVector(quantization->zero_point()) ||
+        !table->VerifyField<int32_t>(
+            verifier_, QuantizationParameters::VT_QUANTIZED_DIMENSION) ||
+        !verifier_.EndTable()) {
+      return Fail("quantization");
+    }
+    // The allocator reads one zero point per scale.
+    if (quantization->scale() != nullptr &&
+        quantization->zero_point() != nullptr &&
+        quantization->zero_point()->size() > 0 &&
+        quantization->zero_point()->size() < quantization->scale()->size()) {
+      return Fail("quantization");
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus CheckOperator(const Operator* op, size_t num_tensors) {
+    const flatbuffers::Table* table = AsTable(op);
+    if (!table->VerifyTableStart(verifier_) ||
+        !table->VerifyField<uint32_t>(verifier_, Operator::VT_OPCODE_INDEX) ||
+        !table->VerifyOffset(verifier_, Operator::VT_INPUTS) ||
+        !verifier_.VerifyVector(op->inputs()) ||
+        !table->VerifyOffset(verifier_, Operator::VT_OUTPUTS) ||
+        !verifier_.VerifyVector(op->outputs()) ||
+        !table->VerifyField<uint8_t>(verifier_,
+                                     Operator::VT_BUILTIN_OPTIONS_TYPE) ||
+        !table->VerifyOffset(verifier_, Operator::VT_BUILTIN_OPTIONS) ||
+        !VerifyBuiltinOptions(verifier_, op->builtin_options(),
+                              op->builtin_options_type()) ||
+        !table->VerifyOffset(verifier_, Operator::VT_CUSTOM_OPTIONS) ||
+        !verifier_.VerifyVector(op->custom_options()) ||
+        !verifier_.EndTable()) {
+      return Fail("operator");
+    }
+    if (model_->operator_codes() == nullptr ||
+        op->opcode_index() >= model_->operator_codes()->size()) {
+      return Fail("operator code index");
+    }
+    if (op->inputs() == nullptr || op->outputs() == nullptr ||
+        !IndicesInRange(op->inputs(), num_tensors, true) ||
+        !IndicesInRange(op->outputs(), num_tensors, false)) {
+      return Fail("operator inputs/outputs");
+    }
+    return kTfLiteOk;
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+  flatbuffers::Verifier verifier_;
+  ErrorReporter* error_reporter_;
+  const Model* model_ = nullptr;
+  const uint32_t* compressed_table_ = nullptr;
+  size_t compressed_entries_ = 0;
+};
+
+uint32_t HeadDigest(const void* model_data, size_t model_size) {
+  return ComputeCrc32(model_data, model_size < kModelHeadDigestBytes
+                                      ? model_size
+                                      : kModelHeadDigestBytes);
+}
+
+}  // namespace
+
+uint32_t ComputeCrc32(const void* data, size_t size, uint32_t crc) {
+  // Nibble-wise table, small enough for any target.
+  static const uint32_t kTable[16] = {
+      0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+      0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+      0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc = kTable[(crc ^ bytes[i]) & 0x0f] ^ (crc >> 4);
+    crc = kTable[(crc ^ (bytes[i] >> 4)) & 0x0f] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+TfLiteStatus CheckModelStructure(const void* model_data, size_t model_size,
+                                 ErrorReporter* error_reporter) {
+  if (model_data == nullptr ||
+      model_size >= FLATBUFFERS_MAX_BUFFER_SIZE) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Model is corrupted (size).");
+    return kTfLiteError;
+  }
+  StructureChecker checker(static_cast<const uint8_t*>(model_data),
+                           model_size, error_reporter);
+  return checker.Check();
+}
+
+TfLiteStatus VerifyModelOnInstall(const void* model_data, size_t model_size,
+                                  ErrorReporter* error_reporter,
+                                  ModelVerificationRecord* record) {
+  TFLITE_DCHECK(record != nullptr);
+  *record = {};
+  TF_LITE_ENSURE_STATUS(
+      CheckModelStructure(model_data, model_size, error_reporter));
+  flatbuffers::Verifier verifier(static_cast<const uint8_t*>(model_data),
+                                 model_size);
+  if (!VerifyModelBuffer(verifier)) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Model failed verification.");
+    return kTfLiteError;
+  }
+  record->magic = kModelVerificationMagic;
+  record->model_size = static_cast<uint32_t>(model_size);
+  record->head_digest = HeadDigest(model_data, model_size);
+  record->model_digest = ComputeCrc32(model_data, model_size);
+  record->flags = kModelVerified;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CheckModelOnBoot(const void* model_data, size_t model_size,
+                              const ModelVerificationRecord& record,
+                              ErrorReporter* error_reporter) {
+  if (record.magic != kModelVerificationMagic ||
+      (record.flags & kModelVerified) == 0) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Model has not been verified.");
+    return kTfLiteError;
+  }
+  if (model_data == nullptr || record.model_size != model_size ||
+      record.head_digest != HeadDigest(model_data, model_size)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model does not match its verification record.");
+    return kTfLiteError;
+  }
+  return CheckModelStructure(model_data, model_size, error_reporter);
+}
+
+TfLiteStatus VerifyModelDigest(const void* model_data, size_t model_size,
+                               const ModelVerificationRecord& record,
+                               ErrorReporter* error_reporter) {
+  if (model_data == nullptr || record.model_size != model_size ||
+      record.model_digest != ComputeCrc32(model_data, model_size)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Model does not match its verification record.");
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,93 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MODEL_VERIFIER_H_
+#define TENSORFLOW_LITE_MICRO_MODEL_VERIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+
+namespace tflite {
+
+// Model integrity checks for models that arrive over the air or live in
+// storage that may be corrupted. The MicroInterpreter trusts the flatbuffer
+// it is given, so a model should pass these checks before tflite::GetModel()
+// is called on it.
+//
+// The checks are split in two so that boot time does not pay for a full
+// verification:
+//
+//  - VerifyModelOnInstall() runs once, when a model is written. It runs the
+//    complete flatbuffers verifier and the structural checks below, and fills
+//    in a ModelVerificationRecord that the application stores next to the
+//    model.
+//  - CheckModelOnBoot() runs on every boot. It matches the stored record
+//    against the model size and a digest of its first bytes, then runs only
+//    the structural checks: the bounds of every table, vector and string that
+//    the MicroAllocator and MicroInterpreter read, plus tensor, buffer and
+//    operator code indices, tensor dimensions and constant buffer sizes.
+//
+// VerifyModelDigest() recomputes the digest of the whole model, for
+// applications that can afford a pass over all of its bytes.
+
+constexpr uint32_t kModelVerificationMagic = 0x564d4654;  // "TFMV"
+// Number of bytes at the start of the model covered by the boot digest. The
+// flatbuffer root and most tables are written there.
+constexpr size_t kModelHeadDigestBytes = 1024;
+
+enum ModelVerificationFlags : uint32_t {
+  kModelVerified = 1,
+};
+
+struct ModelVerificationRecord {
+  uint32_t magic;
+  uint32_t model_size;
+  // CRC-32 of the first kModelHeadDigestBytes of the model.
+  uint32_t head_digest;
+  // CRC-32 of the whole model.
+  uint32_t model_digest;
+  uint32_t flags;
+};
+
+// Fully verifies a model and fills in `record`. On failure the record is
+// cleared, so it never claims an unverified model.
+TfLiteStatus VerifyModelOnInstall(const void* model_data, size_t model_size,
+                                  ErrorReporter* error_reporter,
+                                  ModelVerificationRecord* record);
+
+// Checks a previously verified model before use.
+TfLiteStatus CheckModelOnBoot(const void* model_data, size_t model_size,
+                              const ModelVerificationRecord& record,
+                              ErrorReporter* error_reporter);
+
+// Checks only the parts of a model the MicroAllocator and MicroInterpreter
+// read. Cost is linear in the number of tensors, operators and buffers, not
+// in the model size.
+TfLiteStatus CheckModelStructure(const void* model_data, size_t model_size,
+                                 ErrorReporter* error_reporter);
+
+// Compares the digest of the whole model against the record.
+TfLiteStatus VerifyModelDigest(const void* model_data, size_t model_size,
+                               const ModelVerificationRecord& record,
+                               ErrorReporter* error_reporter);
+
+// CRC-32 (IEEE 802.3) of `size` bytes, continuing from `crc` (0 to start).
+uint32_t ComputeCrc32(const void* data, size_t size, uint32_t crc = 0);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MODEL_VERIFIER_H_
@@ -0,0 +1,35 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_NODE_WEIGHTS_H_
+#define TENSORFLOW_LITE_MICRO_NODE_WEIGHTS_H_
+
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+
+namespace tflite {
+
+// Offline prepared weight data of one builtin node, described by model
+// metadata. The MicroAllocator attaches it through
+// TfLiteNode::custom_initial_data, which builtin operators do not otherwise
+// use, and kernels retrieve the parts with tflite::micro::GetPackedWeights()
+// and tflite::micro::GetCompressedWeights(). Unused parts are nullptr.
+struct NodeWeights {
+  const PackedWeights* packed;
+  const CompressedWeights* compressed;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_NODE_WEIGHTS_H_
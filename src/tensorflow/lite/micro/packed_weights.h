@@ -0,0 +1,117 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_PACKED_WEIGHTS_H_
+#define TENSORFLOW_LITE_MICRO_PACKED_WEIGHTS_H_
+
+#include <cstdint>
+
+namespace tflite {
+
+// Offline pre-packed int8 weights.
+//
+// The pack_weights host tool (tools/pack_weights.cc) stores the int8
+// filters of CONV_2D, DEPTHWISE_CONV_2D and FULLY_CONNECTED in the blocked
+// layouts below, together with "effective" biases that already contain the
+// input zero point contribution, as extra model buffers. A filter tensor
+// that only packed operators read is redirected to its packed buffer, the
+// tensor keeping the unpacked shape, so such a model needs a runtime that
+// attaches the packed weights. The packed data of each subgraph is
+// described by a metadata entry:
+//
+// | Metadata component |                 Value                                |
+// |    name:string     | “PackedWeights”                                      |
+// |    buffer:unit     | Index of buffer containing the packed weights table  |
+//
+// The table is a list of 32-bit integers:
+//
+// |   Offset  |                            Value                              |
+// |     0     | Packed weights format version – set to 0                      |
+// |     1     | Subgraph index to which the table applies                     |
+// |     2     | Number of entries following: n                                |
+// |  3 + 4*i  | Operator index of entry #i                                    |
+// |  4 + 4*i  | PackedWeightsLayout of entry #i                               |
+// |  5 + 4*i  | Buffer index of the packed filter of entry #i                 |
+// |  6 + 4*i  | Buffer index of the effective bias (int32) of entry #i        |
+//
+// With the effective bias, an output is `bias' + sum(filter * input)` over
+// the raw int8 values, where inputs in the padding area read as the input
+// zero point. The filter zero point must be 0, which is always the case for
+// int8 models.
+constexpr char kPackedWeightsMetadata[] = "PackedWeights";
+constexpr int32_t kPackedWeightsVersion = 0;
+
+enum PackedWeightsLayout {
+  // CONV_2D and FULLY_CONNECTED: blocks of 4 output channels x 16 input
+  // channels, ordered [out / 4][filter y][filter x][in / 16][4][16].
+  kPackedWeightsO4I16 = 1,
+  // DEPTHWISE_CONV_2D with a depth multiplier of 1: blocks of 16 channels
+  // holding all the filter taps of the block, ordered
+  // [channels / 16][filter y][filter x][16].
+  kPackedWeightsC16 = 2,
+};
+
+constexpr int kPackedOutputBlock = 4;
+constexpr int kPackedDepthBlock = 16;
+constexpr int kPackedChannelBlock = 16;
+
+// Packed weights of one node. The MicroAllocator attaches them to the node,
+// see node_weights.h. All pointers reference the model buffers.
+struct PackedWeights {
+  PackedWeightsLayout layout;
+  const int8_t* filter;
+  int filter_size;
+  const int32_t* effective_bias;
+  int effective_bias_size;
+};
+
+inline int PackedBlockCount(int size, int block) {
+  return (size + block - 1) / block;
+}
+
+// Size in bytes and element offset of the kPackedWeightsO4I16 layout, where
+// `tap` indexes the filter_height * filter_width spatial positions (a single
+// one for FULLY_CONNECTED).
+inline int PackedO4I16Size(int output_depth, int num_taps, int input_depth) {
+  return PackedBlockCount(output_depth, kPackedOutputBlock) *
+         kPackedOutputBlock * num_taps *
+         PackedBlockCount(input_depth, kPackedDepthBlock) * kPackedDepthBlock;
+}
+
+inline int PackedO4I16Offset(int output_channel, int tap, int input_channel,
+                             int num_taps, int input_depth) {
+  const int depth_blocks = PackedBlockCount(input_depth, kPackedDepthBlock);
+  const int block =
+      ((output_channel / kPackedOutputBlock) * num_taps + tap) * depth_blocks +
+      input_channel / kPackedDepthBlock;
+  return block * kPackedOutputBlock * kPackedDepthBlock +
+         (output_channel % kPackedOutputBlock) * kPackedDepthBlock +
+         input_channel % kPackedDepthBlock;
+}
+
+// Size in bytes and element offset of the kPackedWeightsC16 layout.
+inline int PackedC16Size(int channels, int num_taps) {
+  return PackedBlockCount(channels, kPackedChannelBlock) *
+         kPackedChannelBlock * num_taps;
+}
+
+inline int PackedC16Offset(int channel, int tap, int num_taps) {
+  return ((channel / kPackedChannelBlock) * num_taps + tap) *
+             kPackedChannelBlock +
+         channel % kPackedChannelBlock;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_PACKED_WEIGHTS_H_
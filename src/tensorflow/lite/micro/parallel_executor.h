@@ -0,0 +1,76 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_PARALLEL_EXECUTOR_H_
+#define TENSORFLOW_LITE_MICRO_PARALLEL_EXECUTOR_H_
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Runs the chunks of a kernel on several cores. When an executor is installed
+// with MicroInterpreter::SetExternalContext(kTfLiteMicroParallelContext,
+// executor) and MicroInterpreter::SetNumThreads() allows more than one
+// thread, the heavy kernels split their output channels or rows into chunks
+// (see ParallelFor() in micro/kernels/kernel_util.h) and hand them to Run().
+//
+// Chunks write disjoint parts of the output and only read shared data, so
+// they may run in any order and at the same time. An implementation can use
+// a thread pool on the host (see micro/thread_pool_executor.h) or tasks of
+// the RTOS pinned to each core.
+class ParallelExecutor : public TfLiteExternalContext {
+ public:
+  ParallelExecutor() {
+    type = kTfLiteMicroParallelContext;
+    Refresh = nullptr;
+  }
+  virtual ~ParallelExecutor() {}
+
+  // Number of chunks that can run at the same time, including the calling
+  // thread if it takes part.
+  virtual int num_workers() const = 0;
+
+  // Calls `task(user_data, index)` for every index in [0, num_tasks) and
+  // returns once all calls have finished.
+  virtual TfLiteStatus Run(int num_tasks,
+                           void (*task)(void* user_data, int index),
+                           void* user_data) = 0;
+};
+
+// Executor that runs the chunks one after the other on the calling thread.
+class SerialExecutor : public ParallelExecutor {
+ public:
+  int num_workers() const override { return 1; }
+
+  TfLiteStatus Run(int num_tasks, void (*task)(void* user_data, int index),
+                   void* user_data) override {
+    for (int i = 0; i < num_tasks; ++i) {
+      task(user_data, i);
+    }
+    return kTfLiteOk;
+  }
+};
+
+// Returns the executor installed on `context`, or nullptr if there is none.
+inline ParallelExecutor* GetParallelExecutor(TfLiteContext* context) {
+  if (context->GetExternalContext == nullptr) {
+    return nullptr;
+  }
+  return static_cast<ParallelExecutor*>(
+      context->GetExternalContext(context, kTfLiteMicroParallelContext));
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_PARALLEL_EXECUTOR_H_
@@ -0,0 +1,414 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/patch_execution.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/graph_rewriter.h"
+#include "tensorflow/lite/micro/kernels/separable_conv.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace internal {
+
+namespace {
+
+constexpr int kInputTensor = 0;
+constexpr int kFilterTensor = 1;
+
+bool IsSubgraphOutput(const SubGraph* subgraph, int tensor_index) {
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    if (subgraph->outputs()->Get(i) == tensor_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the number of node inputs reading `tensor_index`.
+int CountConsumers(const NodeAndRegistration* node_and_registrations,
+                   int node_count, int tensor_index) {
+  int count = 0;
+  for (int i = 0; i < node_count; ++i) {
+    const TfLiteIntArray* inputs = node_and_registrations[i].node.inputs;
+    for (int n = 0; n < inputs->size; ++n) {
+      if (inputs->data[n] == tensor_index) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+bool IsBatchOfOneImage(const TfLiteEvalTensor& tensor) {
+  return tensor.dims->size == 4 && tensor.dims->data[0] == 1;
+}
+
+struct ConvGeometry {
+  int stride_height;
+  int stride_width;
+  int dilation_height;
+  int dilation_width;
+  TfLitePadding* padding;
+};
+
+bool IsFusedSeparableConv(const TfLiteRegistration& registration) {
+  return registration.builtin_code == BuiltinOperator_CUSTOM &&
+         registration.custom_name != nullptr &&
+         strcmp(registration.custom_name,
+                ops::micro::kFusedSeparableConvName) == 0;
+}
+
+// Reads the parameters of a node that can run on patches, returns false for
+// other nodes. A fused separable convolution has the geometry of its
+// depthwise stage, the pointwise stage works on single pixels.
+bool GetConvGeometry(const NodeAndRegistration& node_and_registration,
+                     ConvGeometry* geometry) {
+  const TfLiteNode& node = node_and_registration.node;
+  const int32_t op = node_and_registration.registration->builtin_code;
+  if (IsFusedSeparableConv(*node_and_registration.registration)) {
+    auto* params =
+        static_cast<ops::micro::FusedSeparableConvParams*>(node.builtin_data);
+    geometry->stride_height = params->depthwise.stride_height;
+    geometry->stride_width = params->depthwise.stride_width;
+    geometry->dilation_height = 1;
+    geometry->dilation_width = 1;
+    geometry->padding = &params->depthwise.padding;
+    return true;
+  }
+  if (op == BuiltinOperator_CONV_2D) {
+    auto* params = static_cast<TfLiteConvParams*>(node.builtin_data);
+    geometry->stride_height = params->stride_height;
+    geometry->stride_width = params->stride_width;
+    geometry->dilation_height = params->dilation_height_factor;
+    geometry->dilation_width = params->dilation_width_factor;
+    geometry->padding = &params->padding;
+    return true;
+  }
+  if (op == BuiltinOperator_DEPTHWISE_CONV_2D) {
+    auto* params = static_cast<TfLiteDepthwiseConvParams*>(node.builtin_data);
+    geometry->stride_height = params->stride_height;
+    geometry->stride_width = params->stride_width;
+    geometry->dilation_height = params->dilation_height_factor;
+    geometry->dilation_width = params->dilation_width_factor;
+    geometry->padding = &params->padding;
+    // The kernel pads as if the filter was not dilated.
+    return geometry->dilation_height == 1 && geometry->dilation_width == 1;
+  }
+  return false;
+}
+
+TfLiteIntArray* CreateImageDims(MicroAllocator* allocator, int height,
+                                int width, int depth) {
+  TfLiteIntArray* dims = static_cast<TfLiteIntArray*>(
+      allocator->AllocatePersistentBuffer(TfLiteIntArrayGetSizeInBytes(4)));
+  if (dims != nullptr) {
+    dims->size = 4;
+    dims->data[0] = 1;
+    dims->data[1] = height;
+    dims->data[2] = width;
+    dims->data[3] = depth;
+  }
+  return dims;
+}
+
+}  // namespace
+
+TfLiteStatus PatchExecutor::Plan(MicroAllocator* allocator,
+                                 ErrorReporter* error_reporter,
+                                 const SubGraph* subgraph,
+                                 NodeAndRegistration* node_and_registrations,
+                                 TfLiteEvalTensor* eval_tensors,
+                                 int num_operators, int num_patches) {
+  num_operators_ = 0;
+  const int node_count = subgraph->operators()->size();
+  TF_LITE_ENSURE(error_reporter, num_operators > 0);
+  TF_LITE_ENSURE(error_reporter, num_operators <= node_count);
+  TF_LITE_ENSURE(error_reporter, num_patches > 0);
+
+  Operator* operators = static_cast<Operator*>(
+      allocator->AllocatePersistentBuffer(sizeof(Operator) * num_operators));
+  TF_LITE_ENSURE(error_reporter, operators != nullptr);
+
+  // Checks the chain and works out the padding of every operator, keeping
+  // the model untouched until the whole chain is known to fit. Nodes removed
+  // by the graph rewriter are skipped.
+  int first_operator = -1;
+  int last_operator = -1;
+  int output_tensor = -1;
+  for (int i = 0; i < num_operators; ++i) {
+    Operator& op = operators[i];
+    op.elided = IsElidedNode(node_and_registrations[i]);
+    if (op.elided) {
+      continue;
+    }
+    const TfLiteNode& node = node_and_registrations[i].node;
+    const bool chained = first_operator >= 0;
+    ConvGeometry geometry;
+    if (!GetConvGeometry(node_and_registrations[i], &geometry) ||
+        node.outputs->size != 1 ||
+        (chained && node.inputs->data[kInputTensor] != output_tensor) ||
+        (chained && (IsSubgraphOutput(subgraph, output_tensor) ||
+                     CountConsumers(node_and_registrations, node_count,
+                                    output_tensor) != 1))) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Operator %d cannot run on patches, the first "
+                           "operators must be a chain of convolutions.",
+                           i);
+      return kTfLiteError;
+    }
+    const int input_tensor = node.inputs->data[kInputTensor];
+    output_tensor = node.outputs->data[0];
+    const TfLiteEvalTensor& input = eval_tensors[input_tensor];
+    const TfLiteEvalTensor& filter =
+        eval_tensors[node.inputs->data[kFilterTensor]];
+    const TfLiteEvalTensor& output = eval_tensors[output_tensor];
+    if (!IsBatchOfOneImage(input) || !IsBatchOfOneImage(output) ||
+        filter.dims->size != 4 ||
+        TfLiteTypeSizeOf(input.type, &op.element_size) != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Operator %d cannot run on patches, it needs 4D "
+                           "tensors with a batch of 1.",
+                           i);
+      return kTfLiteError;
+    }
+    op.input_tensor = input_tensor;
+    op.input_height = input.dims->data[1];
+    op.input_width = input.dims->data[2];
+    op.depth = input.dims->data[3];
+    op.stride_height = geometry.stride_height;
+
+    const int filter_height = filter.dims->data[1];
+    const int filter_width = filter.dims->data[2];
+    int output_height, output_width;
+    const TfLitePaddingValues padding = ComputePaddingHeightWidth(
+        geometry.stride_height, geometry.stride_width,
+        geometry.dilation_height, geometry.dilation_width, op.input_height,
+        op.input_width, filter_height, filter_width, *geometry.padding,
+        &output_height, &output_width);
+    TF_LITE_ENSURE_EQ(error_reporter, output_height, output.dims->data[1]);
+    TF_LITE_ENSURE_EQ(error_reporter, output_width, output.dims->data[2]);
+    op.padding_top = padding.height;
+    op.padding_left = padding.width;
+    op.output_height = output_height;
+    // Wide enough for a VALID convolution to give the output width.
+    const int covered_width =
+        (output_width - 1) * geometry.stride_width +
+        (filter_width - 1) * geometry.dilation_width + 1;
+    op.tile_width = op.input_width + op.padding_left;
+    if (op.tile_width < covered_width) {
+      op.tile_width = covered_width;
+    }
+    // Rows are filled below, once the patch height of every operator is
+    // known. The tile rows are those of the filter window.
+    op.tile_height = (filter_height - 1) * geometry.dilation_height + 1;
+
+    op.padding_value = 0;
+    if (input.type == kTfLiteInt8 || input.type == kTfLiteUInt8) {
+      const auto* quantization =
+          subgraph->tensors()->Get(input_tensor)->quantization();
+      if (quantization != nullptr && quantization->zero_point() != nullptr &&
+          quantization->zero_point()->size() > 0) {
+        op.padding_value =
+            static_cast<uint8_t>(quantization->zero_point()->Get(0));
+      }
+    } else if (input.type != kTfLiteFloat32 && input.type != kTfLiteInt16) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Operator %d cannot run on patches, type %s is "
+                           "not supported.",
+                           i, TfLiteTypeGetName(input.type));
+      return kTfLiteError;
+    }
+    op.input_data = nullptr;
+    op.input_dims = nullptr;
+    if (!chained) {
+      first_operator = i;
+    }
+    last_operator = i;
+  }
+  if (first_operator < 0) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "No operator left to run on patches.");
+    return kTfLiteError;
+  }
+
+  const TfLiteEvalTensor& output = eval_tensors[output_tensor];
+  const int output_height = output.dims->data[1];
+  const int output_width = output.dims->data[2];
+  const int output_depth = output.dims->data[3];
+  const int patch_height = (output_height + num_patches - 1) / num_patches;
+  size_t output_element_size;
+  TF_LITE_ENSURE_STATUS(
+      TfLiteTypeSizeOf(output.type, &output_element_size));
+
+  // Walks the chain backwards: every operator computes the rows the tile of
+  // the next one needs.
+  int rows = patch_height;
+  for (int i = last_operator; i >= first_operator; --i) {
+    Operator& op = operators[i];
+    if (op.elided) {
+      continue;
+    }
+    op.tile_height += (rows - 1) * op.stride_height;
+    op.tile_dims =
+        CreateImageDims(allocator, op.tile_height, op.tile_width, op.depth);
+    TF_LITE_ENSURE(error_reporter, op.tile_dims != nullptr);
+    if (i > first_operator) {
+      // The output of the previous operator, shrunk to one patch.
+      TfLiteEvalTensor& intermediate = eval_tensors[op.input_tensor];
+      intermediate.dims = CreateImageDims(allocator, op.tile_height,
+                                          op.input_width, op.depth);
+      TF_LITE_ENSURE(error_reporter, intermediate.dims != nullptr);
+    }
+    rows = op.tile_height;
+    ConvGeometry geometry;
+    GetConvGeometry(node_and_registrations[i], &geometry);
+    *geometry.padding = kTfLitePaddingValid;
+  }
+  output_view_dims_ =
+      CreateImageDims(allocator, patch_height, output_width, output_depth);
+  TF_LITE_ENSURE(error_reporter, output_view_dims_ != nullptr);
+
+  node_and_registrations_ = node_and_registrations;
+  eval_tensors_ = eval_tensors;
+  operators_ = operators;
+  num_operators_ = num_operators;
+  first_operator_ = first_operator;
+  last_operator_ = last_operator;
+  num_patches_ = (output_height + patch_height - 1) / patch_height;
+  patch_height_ = patch_height;
+  output_tensor_ = output_tensor;
+  output_row_bytes_ = output_width * output_depth * output_element_size;
+  return kTfLiteOk;
+}
+
+TfLiteStatus PatchExecutor::RequestTile(TfLiteContext* context, int index) {
+  Operator& op = operators_[index];
+  if (op.elided) {
+    return kTfLiteOk;
+  }
+  return context->RequestScratchBufferInArena(
+      context, op.tile_height * op.tile_width * op.depth * op.element_size,
+      &op.tile_buffer_index);
+}
+
+void PatchExecutor::BindOperator(TfLiteContext* context, int patch,
+                                 int index) {
+  Operator& op = operators_[index];
+  if (op.elided) {
+    return;
+  }
+  // First input row of the patch, found by walking back from the output.
+  int first_row = patch * patch_height_;
+  for (int i = last_operator_; i >= index; --i) {
+    if (!operators_[i].elided) {
+      first_row = first_row * operators_[i].stride_height -
+                  operators_[i].padding_top;
+    }
+  }
+
+  TfLiteEvalTensor* input = &eval_tensors_[op.input_tensor];
+  op.input_data = input->data.data;
+  op.input_dims = input->dims;
+  // The first operator reads its whole input, the others the rows the
+  // previous operator wrote for this patch.
+  const uint8_t* source = static_cast<const uint8_t*>(op.input_data);
+  uint8_t* tile = static_cast<uint8_t*>(
+      context->GetScratchBuffer(context, op.tile_buffer_index));
+  const size_t pixel_bytes = op.depth * op.element_size;
+  const size_t row_bytes = op.input_width * pixel_bytes;
+  const size_t left_bytes = op.padding_left * pixel_bytes;
+  const size_t tile_row_bytes = op.tile_width * pixel_bytes;
+  for (int y = 0; y < op.tile_height; ++y) {
+    const int row = first_row + y;
+    uint8_t* tile_row = tile + y * tile_row_bytes;
+    if (row < 0 || row >= op.input_height) {
+      memset(tile_row, op.padding_value, tile_row_bytes);
+      continue;
+    }
+    const uint8_t* source_row =
+        source + (index == first_operator_ ? row : y) * row_bytes;
+    memset(tile_row, op.padding_value, left_bytes);
+    memcpy(tile_row + left_bytes, source_row, row_bytes);
+    memset(tile_row + left_bytes + row_bytes, op.padding_value,
+           tile_row_bytes - left_bytes - row_bytes);
+  }
+  input->data.data = tile;
+  input->dims = op.tile_dims;
+
+  if (index == last_operator_) {
+    TfLiteEvalTensor* output = &eval_tensors_[output_tensor_];
+    output_data_ = output->data.data;
+    output_dims_ = output->dims;
+    const int output_row = patch * patch_height_;
+    const int output_height = output_dims_->data[1];
+    output_view_dims_->data[1] = output_height - output_row < patch_height_
+                                     ? output_height - output_row
+                                     : patch_height_;
+    output->data.data =
+        static_cast<uint8_t*>(output_data_) + output_row * output_row_bytes_;
+    output->dims = output_view_dims_;
+  }
+}
+
+void PatchExecutor::UnbindOperator(int index) {
+  Operator& op = operators_[index];
+  if (op.elided) {
+    return;
+  }
+  TfLiteEvalTensor* input = &eval_tensors_[op.input_tensor];
+  input->data.data = op.input_data;
+  input->dims = op.input_dims;
+  if (index == last_operator_) {
+    TfLiteEvalTensor* output = &eval_tensors_[output_tensor_];
+    output->data.data = output_data_;
+    output->dims = output_dims_;
+  }
+}
+
+int PatchExecutor::OperatorIndex(const TfLiteNode* node) const {
+  for (int i = 0; i < num_operators_; ++i) {
+    if (&node_and_registrations_[i].node == node) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void PatchExecutor::Bind(TfLiteContext* context, TfLiteNode* node) {
+  const int index = OperatorIndex(node);
+  if (index >= 0) {
+    BindOperator(context, 0, index);
+  }
+}
+
+void PatchExecutor::Unbind(TfLiteNode* node) {
+  const int index = OperatorIndex(node);
+  if (index >= 0) {
+    UnbindOperator(index);
+  }
+}
+
+}  // namespace internal
+}  // namespace tflite
@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_PATCH_EXECUTION_H_
+#define TENSORFLOW_LITE_MICRO_PATCH_EXECUTION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/kernel_tuner.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace internal {
+
+// Runs the first operators of a model patch by patch, to cut the peak memory
+// of models whose early layers work on large feature maps, see
+// MicroInterpreter::SetPatchExecution().
+//
+// The operators must form a chain of CONV_2D and DEPTHWISE_CONV_2D nodes with
+// a batch of 1, each one feeding only the next. The chain is checked after the
+// graph rewrites of micro/graph_rewriter.h: nodes they removed are skipped,
+// for example a QUANTIZE folded into the first convolution, and a fused
+// separable convolution takes part as one operator at the index of its 1x1
+// CONV_2D. The output of the last one is
+// split into bands of rows, the patches, and the chain runs once per patch on
+// the rows each operator needs for it. The intermediate tensors of the chain
+// then hold the rows of one patch, overlapping rows (the halo of the patch)
+// are computed again by the next patch. The input and the output of the chain
+// keep their full size.
+//
+// Padding is made explicit: the operators are switched to VALID padding and
+// read a tile scratch buffer holding the input rows of the patch surrounded by
+// the padding, filled with the zero point of the input. The kernels run
+// unchanged, on tensors that BindOperator() points at the views of a patch
+// and UnbindOperator() restores.
+class PatchExecutor : public TunedNodeBinder {
+ public:
+  // Number of operators run on patches, 0 before Plan().
+  int num_operators() const { return num_operators_; }
+  int num_patches() const { return num_patches_; }
+
+  // Checks that the first `num_operators` operators can run on patches and
+  // rewrites them to do so, splitting the output of the last one into at most
+  // `num_patches` bands. Called once the nodes and tensors of the model are
+  // allocated, before the operators are prepared.
+  TfLiteStatus Plan(MicroAllocator* allocator, ErrorReporter* error_reporter,
+                    const SubGraph* subgraph,
+                    NodeAndRegistration* node_and_registrations,
+                    TfLiteEvalTensor* eval_tensors, int num_operators,
+                    int num_patches);
+
+  // Requests the tile buffer of operator `index`, from its Prepare step.
+  TfLiteStatus RequestTile(TfLiteContext* context, int index);
+
+  // Fills the tile of operator `index` for `patch` and points the input of
+  // the operator at it, and for the last operator its output at the rows of
+  // the patch.
+  void BindOperator(TfLiteContext* context, int patch, int index);
+  void UnbindOperator(int index);
+
+  // Binds the operators to the first patch while the KernelTuner times them.
+  void Bind(TfLiteContext* context, TfLiteNode* node) override;
+  void Unbind(TfLiteNode* node) override;
+
+ private:
+  struct Operator {
+    // Removed by a graph rewrite, the operator does not run.
+    bool elided;
+    int input_tensor;
+    int input_height;
+    int input_width;
+    int depth;
+    int stride_height;
+    int padding_top;
+    int padding_left;
+    int output_height;
+    int tile_height;
+    int tile_width;
+    size_t element_size;
+    uint8_t padding_value;
+    TfLiteIntArray* tile_dims;
+    int tile_buffer_index;
+    // Input of the operator while it is bound.
+    void* input_data;
+    TfLiteIntArray* input_dims;
+  };
+
+  int OperatorIndex(const TfLiteNode* node) const;
+
+  NodeAndRegistration* node_and_registrations_ = nullptr;
+  TfLiteEvalTensor* eval_tensors_ = nullptr;
+  Operator* operators_ = nullptr;
+  int num_operators_ = 0;
+  // First and last operators that run.
+  int first_operator_ = -1;
+  int last_operator_ = -1;
+  int num_patches_ = 0;
+  // Rows of the output of the last operator in a patch.
+  int patch_height_ = 0;
+  int output_tensor_ = -1;
+  size_t output_row_bytes_ = 0;
+  TfLiteIntArray* output_view_dims_ = nullptr;
+  void* output_data_ = nullptr;
+  TfLiteIntArray* output_dims_ = nullptr;
+};
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_PATCH_EXECUTION_H_
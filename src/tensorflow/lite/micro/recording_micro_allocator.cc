@@ -72,15 +72,15 @@ RecordingMicroAllocator::GetSimpleMemoryAllocator() const {
 }
 
 void RecordingMicroAllocator::PrintAllocations() const {
-  TF_LITE_REPORT_ERROR(
+  TF_LITE_REPORT_INFO(
       error_reporter(),
       "[RecordingMicroAllocator] Arena allocation total %d bytes",
       recording_memory_allocator_->GetUsedBytes());
-  TF_LITE_REPORT_ERROR(
+  TF_LITE_REPORT_INFO(
       error_reporter(),
       "[RecordingMicroAllocator] Arena allocation head %d bytes",
       recording_memory_allocator_->GetHeadUsedBytes());
-  TF_LITE_REPORT_ERROR(
+  TF_LITE_REPORT_INFO(
       error_reporter(),
       "[RecordingMicroAllocator] Arena allocation tail %d bytes",
       recording_memory_allocator_->GetTailUsedBytes());
@@ -104,9 +104,9 @@ void RecordingMicroAllocator::PrintAllocations() const {
 void RecordingMicroAllocator::PrintRecordedAllocation(
     RecordedAllocationType allocation_type, const char* allocation_name,
     const char* allocation_description) const {
-#ifndef TF_LITE_STRIP_ERROR_STRINGS
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_INFO
   RecordedAllocation allocation = GetRecordedAllocation(allocation_type);
-  TF_LITE_REPORT_ERROR(
+  TF_LITE_REPORT_INFO(
       error_reporter(),
       "[RecordingMicroAllocator] '%s' used %d bytes with alignment overhead "
       "(requested %d bytes for %d %s)",
@@ -847,7 +847,7 @@ void ReportOpError(struct TfLiteContext* context, const char* format, ...) {
   ErrorReporter* error_reporter = static_cast<ErrorReporter*>(context->impl_);
   va_list args;
   va_start(args, format);
-  TF_LITE_REPORT_ERROR(error_reporter, format, args);
+  error_reporter->ReportFromContext(format, args);
   va_end(args);
 #endif
 }
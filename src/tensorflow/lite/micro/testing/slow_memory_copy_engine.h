@@ -0,0 +1,88 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_TESTING_SLOW_MEMORY_COPY_ENGINE_H_
+#define TENSORFLOW_LITE_MICRO_TESTING_SLOW_MEMORY_COPY_ENGINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/weight_copy_engine.h"
+
+namespace tflite {
+namespace testing {
+
+// Copy engine that behaves like a slow asynchronous DMA from external memory,
+// for exercising weight prefetch on the host. StartCopy() only records the
+// request and fills the destination with a marker pattern. Wait() burns
+// `delay_per_byte` iterations of busy work per byte and then performs the
+// copy, so a kernel that reads a tile before waiting for it computes with
+// garbage, and one that overlaps copies badly is visibly slow.
+class SlowMemoryCopyEngine : public WeightCopyEngine {
+ public:
+  explicit SlowMemoryCopyEngine(int delay_per_byte = 0,
+                                size_t max_tile_size = kDefaultWeightTileSize)
+      : delay_per_byte_(delay_per_byte), max_tile_size_(max_tile_size) {}
+
+  size_t MaxTileSize() const override { return max_tile_size_; }
+
+  TfLiteStatus StartCopy(void* dst, const void* src, size_t bytes) override {
+    if (pending_dst_ != nullptr) {
+      // Only one copy may be in flight.
+      return kTfLiteError;
+    }
+    std::memset(dst, kMarker, bytes);
+    pending_dst_ = dst;
+    pending_src_ = src;
+    pending_bytes_ = bytes;
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Wait() override {
+    if (pending_dst_ == nullptr) {
+      return kTfLiteOk;
+    }
+    for (size_t i = 0; i < pending_bytes_ * delay_per_byte_; ++i) {
+      sink_ = sink_ + 1;
+    }
+    std::memcpy(pending_dst_, pending_src_, pending_bytes_);
+    pending_dst_ = nullptr;
+    copy_count_++;
+    bytes_copied_ += pending_bytes_;
+    return kTfLiteOk;
+  }
+
+  int copy_count() const { return copy_count_; }
+  size_t bytes_copied() const { return bytes_copied_; }
+
+ private:
+  static constexpr uint8_t kMarker = 0x5a;
+
+  const size_t delay_per_byte_;
+  const size_t max_tile_size_;
+  void* pending_dst_ = nullptr;
+  const void* pending_src_ = nullptr;
+  size_t pending_bytes_ = 0;
+  int copy_count_ = 0;
+  size_t bytes_copied_ = 0;
+  volatile uint32_t sink_ = 0;
+};
+
+}  // namespace testing
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_TESTING_SLOW_MEMORY_COPY_ENGINE_H_
@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_THREAD_POOL_EXECUTOR_H_
+#define TENSORFLOW_LITE_MICRO_THREAD_POOL_EXECUTOR_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/parallel_executor.h"
+
+namespace tflite {
+
+// ParallelExecutor for hosts with std::thread, for example to measure the
+// scaling of a model before porting it to the RTOS of a multi-core target:
+//
+//   ThreadPoolExecutor executor(4);
+//   interpreter.SetExternalContext(kTfLiteMicroParallelContext, &executor);
+//   interpreter.SetNumThreads(executor.num_workers());
+//
+// The calling thread runs chunks as well, so `num_threads` - 1 threads are
+// started. Run() is meant to be called from one thread at a time.
+class ThreadPoolExecutor : public ParallelExecutor {
+ public:
+  explicit ThreadPoolExecutor(int num_threads) {
+    for (int i = 1; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  ~ThreadPoolExecutor() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_ready_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  int num_workers() const override {
+    return static_cast<int>(threads_.size()) + 1;
+  }
+
+  TfLiteStatus Run(int num_tasks, void (*task)(void* user_data, int index),
+                   void* user_data) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = task;
+    user_data_ = user_data;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    pending_tasks_ = num_tasks;
+    work_ready_.notify_all();
+    RunTasks(&lock);
+    work_done_.wait(lock, [this]() { return pending_tasks_ == 0; });
+    return kTfLiteOk;
+  }
+
+ private:
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_ready_.wait(lock,
+                       [this]() { return stop_ || next_task_ < num_tasks_; });
+      if (stop_) {
+        return;
+      }
+      RunTasks(&lock);
+    }
+  }
+
+  // Claims and runs tasks of the current Run() until none are left. Called
+  // and returns with `lock` held.
+  void RunTasks(std::unique_lock<std::mutex>* lock) {
+    while (next_task_ < num_tasks_) {
+      const int index = next_task_++;
+      lock->unlock();
+      task_(user_data_, index);
+      lock->lock();
+      if (--pending_tasks_ == 0) {
+        work_done_.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  void (*task_)(void* user_data, int index) = nullptr;
+  void* user_data_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int pending_tasks_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_THREAD_POOL_EXECUTOR_H_
@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_WEIGHT_COPY_ENGINE_H_
+#define TENSORFLOW_LITE_MICRO_WEIGHT_COPY_ENGINE_H_
+
+#include <cstddef>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+constexpr size_t kDefaultWeightTileSize = 2048;
+
+// Moves weights from slow memory (external flash, PSRAM) into fast memory
+// ahead of their use. When an engine is installed with
+// MicroInterpreter::SetExternalContext(kTfLiteMicroWeightCopyContext, engine)
+// before AllocateTensors(), the int8 CONV_2D and FULLY_CONNECTED kernels
+// reserve two weight tile buffers in the arena and copy the next tile into one
+// while computing on the other (see micro/kernels/weight_prefetch.h).
+//
+// StartCopy() may return before the copy is done, for example after
+// programming a DMA channel. The kernels call Wait() before reading a tile and
+// before starting the next copy, so at most one copy is in flight.
+class WeightCopyEngine : public TfLiteExternalContext {
+ public:
+  WeightCopyEngine() {
+    type = kTfLiteMicroWeightCopyContext;
+    Refresh = nullptr;
+  }
+  virtual ~WeightCopyEngine() {}
+
+  // Returns true if weights at `data` are slow to read and should be staged
+  // in fast memory. Called once per weight tensor from the kernel's Prepare.
+  virtual bool IsSlowMemory(const void* data, size_t bytes) const {
+    return true;
+  }
+
+  // Largest weight tile, in bytes, to stage in fast memory. The kernels
+  // reserve two tiles of up to this size in the arena.
+  virtual size_t MaxTileSize() const { return kDefaultWeightTileSize; }
+
+  // Starts copying `bytes` bytes from `src` to `dst`.
+  virtual TfLiteStatus StartCopy(void* dst, const void* src, size_t bytes) = 0;
+
+  // Blocks until all started copies have completed.
+  virtual TfLiteStatus Wait() = 0;
+};
+
+// Synchronous engine that copies with memcpy, for targets without DMA.
+class MemcpyWeightCopyEngine : public WeightCopyEngine {
+ public:
+  TfLiteStatus StartCopy(void* dst, const void* src, size_t bytes) override {
+    std::memcpy(dst, src, bytes);
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Wait() override { return kTfLiteOk; }
+};
+
+// Returns the engine installed on `context`, or nullptr if there is none.
+inline WeightCopyEngine* GetWeightCopyEngine(TfLiteContext* context) {
+  if (context->GetExternalContext == nullptr) {
+    return nullptr;
+  }
+  return static_cast<WeightCopyEngine*>(
+      context->GetExternalContext(context, kTfLiteMicroWeightCopyContext));
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_WEIGHT_COPY_ENGINE_H_
@@ -0,0 +1,257 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/c/log_config.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_string.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+// The tests expect what the log configuration this file is compiled with
+// keeps: tests/CMakeLists.txt builds it once for every log level and once
+// with TF_LITE_LOG_INTERNING.
+
+// Without messages, the string section of interned messages is empty.
+#if defined(TF_LITE_LOG_INTERNING) && \
+    TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_ERROR
+#define TF_LITE_TEST_INTERNED_MESSAGES
+#endif
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxMessageLength = 128;
+
+// Keeps the last message it was given.
+class RecordingErrorReporter : public ErrorReporter {
+ public:
+  int Report(const char* format, va_list args) override {
+    ++num_reports;
+    MicroVsnprintf(text, kMaxMessageLength, format, args);
+    return 0;
+  }
+
+#ifdef TF_LITE_LOG_INTERNING
+  int ReportInterned(uint32_t id, const uint32_t* words,
+                     int num_words) override {
+    ++num_interned;
+    interned_id = id;
+    num_interned_words = num_words;
+    std::memcpy(interned_words, words, sizeof(interned_words));
+    return 0;
+  }
+
+  int num_interned = 0;
+  uint32_t interned_id = 0;
+  uint32_t interned_words[kMaxInternedLogArgs] = {};
+  int num_interned_words = 0;
+#endif
+
+  int num_reports = 0;
+  char text[kMaxMessageLength] = {};
+};
+
+// TfLiteContext::ReportError() of the interpreter and the kernel tests.
+void ReportToReporter(TfLiteContext* context, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  static_cast<ErrorReporter*>(context->impl_)->ReportFromContext(format, args);
+  va_end(args);
+}
+
+TfLiteStatus EnsurePositive(TfLiteContext* context, int value) {
+  TF_LITE_ENSURE(context, value > 0);
+  return kTfLiteOk;
+}
+
+// Number of messages `reporter` got, formatted or interned.
+int NumMessages(const RecordingErrorReporter& reporter) {
+#ifdef TF_LITE_LOG_INTERNING
+  return reporter.num_reports + reporter.num_interned;
+#else
+  return reporter.num_reports;
+#endif
+}
+
+// Expects the last message of `reporter` to be `format` with `text` as the
+// formatted message, or interned with the words `expected_words`.
+void ExpectMessage(const RecordingErrorReporter& reporter, const char* format,
+                   const char* text, const uint32_t* expected_words,
+                   int num_words) {
+#ifdef TF_LITE_TEST_INTERNED_MESSAGES
+  TF_LITE_MICRO_EXPECT_EQ(0, reporter.num_reports);
+  TF_LITE_MICRO_EXPECT_EQ(1, reporter.num_interned);
+  TF_LITE_MICRO_EXPECT_EQ(
+      0,
+      std::strcmp(format, __start_tflite_log_strings + reporter.interned_id));
+  TF_LITE_MICRO_EXPECT_EQ(num_words, reporter.num_interned_words);
+  for (int i = 0; i < num_words; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_words[i], reporter.interned_words[i]);
+  }
+#else
+  TF_LITE_MICRO_EXPECT_EQ(1, reporter.num_reports);
+  TF_LITE_MICRO_EXPECT_EQ(0, std::strcmp(text, reporter.text));
+#endif
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(ReportsErrorsFromErrorLevel) {
+  tflite::testing::RecordingErrorReporter reporter;
+  TF_LITE_REPORT_ERROR(&reporter, "error %d of %u", -5, 3u);
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_ERROR
+  const uint32_t words[] = {0xfffffffbu, 3};
+  tflite::testing::ExpectMessage(reporter, "error %d of %u", "error -5 of 3",
+                                 words, 2);
+#else
+  TF_LITE_MICRO_EXPECT_EQ(0, tflite::testing::NumMessages(reporter));
+#endif
+}
+
+TF_LITE_MICRO_TEST(ReportsInfoOnlyAtInfoLevel) {
+  tflite::testing::RecordingErrorReporter reporter;
+  TF_LITE_REPORT_INFO(&reporter, "arena %d bytes", 1024);
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_INFO
+  const uint32_t words[] = {1024};
+  tflite::testing::ExpectMessage(reporter, "arena %d bytes",
+                                 "arena 1024 bytes", words, 1);
+#else
+  TF_LITE_MICRO_EXPECT_EQ(0, tflite::testing::NumMessages(reporter));
+#endif
+}
+
+TF_LITE_MICRO_TEST(StrippedMessagesDoNotEvaluateArguments) {
+  tflite::testing::RecordingErrorReporter reporter;
+  int evaluations = 0;
+  TF_LITE_REPORT_ERROR(&reporter, "%d", ++evaluations);
+  TF_LITE_REPORT_INFO(&reporter, "%d", ++evaluations);
+  TF_LITE_MICRO_EXPECT_EQ(TF_LITE_LOG_LEVEL, evaluations);
+  TF_LITE_MICRO_EXPECT_EQ(TF_LITE_LOG_LEVEL,
+                          tflite::testing::NumMessages(reporter));
+}
+
+TF_LITE_MICRO_TEST(KernelLogReachesTheReporter) {
+  tflite::testing::RecordingErrorReporter reporter;
+  TfLiteContext context = {};
+  context.impl_ = static_cast<tflite::ErrorReporter*>(&reporter);
+  context.ReportError = tflite::testing::ReportToReporter;
+  TF_LITE_KERNEL_LOG(&context, "kernel %d scale %f", -3, 0.5f);
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_ERROR
+  char text[tflite::testing::kMaxMessageLength];
+  MicroSnprintf(text, tflite::testing::kMaxMessageLength, "kernel %d scale %f",
+                -3, 0.5);
+  // -3 and the bits of 0.5f.
+  const uint32_t words[] = {0xfffffffdu, 0x3f000000u};
+  tflite::testing::ExpectMessage(reporter, "kernel %d scale %f", text, words,
+                                 2);
+#else
+  TF_LITE_MICRO_EXPECT_EQ(0, tflite::testing::NumMessages(reporter));
+#endif
+}
+
+TF_LITE_MICRO_TEST(FailedEnsureReturnsAnError) {
+  tflite::testing::RecordingErrorReporter reporter;
+  TfLiteContext context = {};
+  context.impl_ = static_cast<tflite::ErrorReporter*>(&reporter);
+  context.ReportError = tflite::testing::ReportToReporter;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          tflite::testing::EnsurePositive(&context, 1));
+  TF_LITE_MICRO_EXPECT_EQ(0, tflite::testing::NumMessages(reporter));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::EnsurePositive(&context, 0));
+  TF_LITE_MICRO_EXPECT_EQ(TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_ERROR ? 1 : 0,
+                          tflite::testing::NumMessages(reporter));
+}
+
+// A format held in a char array, not a literal.
+TF_LITE_MICRO_TEST(ReportsFormatArrays) {
+  tflite::testing::RecordingErrorReporter reporter;
+  const char kFormat[] = "array format %u";
+  TF_LITE_REPORT_ERROR(&reporter, kFormat, 7u);
+#if TF_LITE_LOG_LEVEL >= TF_LITE_LOG_LEVEL_ERROR
+  const uint32_t words[] = {7};
+  tflite::testing::ExpectMessage(reporter, kFormat, "array format 7", words,
+                                 1);
+#else
+  TF_LITE_MICRO_EXPECT_EQ(0, tflite::testing::NumMessages(reporter));
+#endif
+}
+
+#ifdef TF_LITE_TEST_INTERNED_MESSAGES
+TF_LITE_MICRO_TEST(InternsEveryCallSite) {
+  tflite::testing::RecordingErrorReporter reporter;
+  uint32_t ids[2];
+  for (int i = 0; i < 2; ++i) {
+    TF_LITE_REPORT_ERROR(&reporter, "first call site");
+    ids[i] = reporter.interned_id;
+  }
+  TF_LITE_REPORT_ERROR(&reporter, "second call site");
+  // One copy per call site, not per call.
+  TF_LITE_MICRO_EXPECT_EQ(ids[0], ids[1]);
+  TF_LITE_MICRO_EXPECT(ids[0] != reporter.interned_id);
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, std::strcmp("second call site",
+                     __start_tflite_log_strings + reporter.interned_id));
+}
+#endif  // TF_LITE_TEST_INTERNED_MESSAGES
+
+#ifdef TF_LITE_LOG_INTERNING
+TF_LITE_MICRO_TEST(EncodesLittleEndianFrames) {
+  const uint32_t words[tflite::kMaxInternedLogArgs] = {0x01020304u,
+                                                       0xa0b0c0d0u};
+  uint8_t frame[tflite::kMaxInternedLogFrameSize];
+  const uint8_t expected[] = {0xfe, 2,    0x2a, 0,    0,    0,    0x04, 0x03,
+                              0x02, 0x01, 0xd0, 0xc0, 0xb0, 0xa0};
+  TF_LITE_MICRO_EXPECT_EQ(
+      static_cast<int>(sizeof(expected)),
+      tflite::EncodeInternedLogFrame(0x2a, words, 2, frame));
+  for (size_t i = 0; i < sizeof(expected); ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], frame[i]);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(
+      tflite::kMaxInternedLogFrameSize,
+      tflite::EncodeInternedLogFrame(0x2a, words, tflite::kMaxInternedLogArgs,
+                                     frame));
+}
+
+// A reporter that does not handle interned messages gets them as text that
+// decode_interned_log reads too.
+TF_LITE_MICRO_TEST(FormatsInternedMessagesForOtherReporters) {
+  class TextErrorReporter : public tflite::ErrorReporter {
+   public:
+    int Report(const char* format, va_list args) override {
+      MicroVsnprintf(text, tflite::testing::kMaxMessageLength, format, args);
+      return 0;
+    }
+    char text[tflite::testing::kMaxMessageLength];
+  };
+  TextErrorReporter reporter;
+  const uint32_t words[tflite::kMaxInternedLogArgs] = {5, 0xff};
+  reporter.ReportInterned(0x2a, words, 2);
+  TF_LITE_MICRO_EXPECT_EQ(0, std::strcmp("@0x2a 0x5 0xff", reporter.text));
+}
+#endif  // TF_LITE_LOG_INTERNING
+
+TF_LITE_MICRO_TESTS_END
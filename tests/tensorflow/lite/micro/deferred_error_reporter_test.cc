@@ -0,0 +1,217 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/deferred_error_reporter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_string.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxMessageLength = 128;
+
+bool StringsEqual(const char* expected, const char* actual) {
+  return std::strcmp(expected, actual) == 0;
+}
+
+// Reports through ErrorReporter::Report(), which TF_LITE_REPORT_ERROR only
+// calls when messages are neither stripped nor interned.
+template <typename... Args>
+void Report(ErrorReporter* reporter, const char* format, Args... args) {
+  reporter->Report(format, args...);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+
+TF_LITE_MICRO_TEST(FormatsLikeMicroSnprintf) {
+  tflite::DeferredLogRecord records[4];
+  tflite::DeferredErrorReporter reporter(records, 4);
+  const char kFormat[] = "Node %s (number %d) %u%% of %x, scale %f";
+  tflite::testing::Report(&reporter, kFormat, "CONV_2D", -3, 42u, 0xbeefu,
+                          0.25f);
+
+  char expected[tflite::testing::kMaxMessageLength];
+  MicroSnprintf(expected, tflite::testing::kMaxMessageLength, kFormat,
+                "CONV_2D", -3, 42u, 0xbeefu, 0.25f);
+  char actual[tflite::testing::kMaxMessageLength];
+  TF_LITE_MICRO_EXPECT(
+      reporter.FormatNext(actual, tflite::testing::kMaxMessageLength));
+  TF_LITE_MICRO_EXPECT(tflite::testing::StringsEqual(expected, actual));
+  TF_LITE_MICRO_EXPECT(
+      !reporter.FormatNext(actual, tflite::testing::kMaxMessageLength));
+}
+
+TF_LITE_MICRO_TEST(KeepsOrderAcrossWrapAround) {
+  tflite::DeferredLogRecord records[3];
+  tflite::DeferredErrorReporter reporter(records, 3);
+  char message[tflite::testing::kMaxMessageLength];
+  char expected[tflite::testing::kMaxMessageLength];
+  int next_to_read = 0;
+  for (int i = 0; i < 10; ++i) {
+    tflite::testing::Report(&reporter, "message %d", i);
+    // Leaves one or two messages stored between rounds.
+    if (i % 2 == 1) {
+      while (next_to_read < i) {
+        TF_LITE_MICRO_EXPECT(
+            reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+        MicroSnprintf(expected, tflite::testing::kMaxMessageLength,
+                      "message %d", next_to_read++);
+        TF_LITE_MICRO_EXPECT(tflite::testing::StringsEqual(expected, message));
+      }
+    }
+  }
+  TF_LITE_MICRO_EXPECT_EQ(0u, reporter.dropped_count());
+}
+
+TF_LITE_MICRO_TEST(DropsAndCountsWhenFull) {
+  tflite::DeferredLogRecord records[2];
+  tflite::DeferredErrorReporter reporter(records, 2);
+  tflite::testing::Report(&reporter, "first");
+  tflite::testing::Report(&reporter, "second");
+  tflite::testing::Report(&reporter, "dropped");
+  tflite::testing::Report(&reporter, "dropped");
+  TF_LITE_MICRO_EXPECT_EQ(2u, reporter.dropped_count());
+
+  char message[tflite::testing::kMaxMessageLength];
+  TF_LITE_MICRO_EXPECT(
+      reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+  TF_LITE_MICRO_EXPECT(tflite::testing::StringsEqual("first", message));
+  // The freed record takes the next message.
+  tflite::testing::Report(&reporter, "third");
+  TF_LITE_MICRO_EXPECT_EQ(2u, reporter.dropped_count());
+  TF_LITE_MICRO_EXPECT_EQ(2, reporter.Flush());
+  TF_LITE_MICRO_EXPECT(
+      !reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+}
+
+TF_LITE_MICRO_TEST(CutsArgumentsPastTheLimit) {
+  tflite::DeferredLogRecord records[1];
+  tflite::DeferredErrorReporter reporter(records, 1);
+  tflite::testing::Report(&reporter, "%d %d %d %d %d %d %d %d", 1, 2, 3, 4,
+                          5, 6, 7, 8);
+  char message[tflite::testing::kMaxMessageLength];
+  TF_LITE_MICRO_EXPECT(
+      reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+  TF_LITE_MICRO_EXPECT(tflite::testing::StringsEqual("1 2 3 4 5 6 ", message));
+}
+
+// Messages are cut where MicroSnprintf() cuts them.
+TF_LITE_MICRO_TEST(TruncatesLikeMicroSnprintf) {
+  tflite::DeferredLogRecord records[1];
+  tflite::DeferredErrorReporter reporter(records, 1);
+  const char kFormat[] = "tensor %s is too large";
+  for (int length = 1; length < 32; ++length) {
+    tflite::testing::Report(&reporter, kFormat, "input_image");
+    char expected[32];
+    MicroSnprintf(expected, length, kFormat, "input_image");
+    char message[32];
+    TF_LITE_MICRO_EXPECT(reporter.FormatNext(message, length));
+    TF_LITE_MICRO_EXPECT(tflite::testing::StringsEqual(expected, message));
+  }
+}
+
+// One thread reports while another formats, as with an interrupt handler
+// and the main loop. Every message must arrive once, in order, or be counted
+// as dropped.
+TF_LITE_MICRO_TEST(ReportAndFormatConcurrently) {
+  constexpr int kNumMessages = 20000;
+  tflite::DeferredLogRecord records[8];
+  tflite::DeferredErrorReporter reporter(records, 8);
+  std::atomic<bool> finished(false);
+  std::thread producer([&reporter, &finished]() {
+    for (int i = 0; i < kNumMessages; ++i) {
+      tflite::testing::Report(&reporter, "%d", i);
+    }
+    finished.store(true);
+  });
+
+  char message[tflite::testing::kMaxMessageLength];
+  int received = 0;
+  int last = -1;
+  bool in_order = true;
+  while (true) {
+    // Reads `finished` first, so no message reported before it is missed.
+    const bool producer_finished = finished.load();
+    if (!reporter.FormatNext(message, tflite::testing::kMaxMessageLength)) {
+      if (producer_finished) {
+        break;
+      }
+      continue;
+    }
+    const int value = static_cast<int>(std::strtol(message, nullptr, 10));
+    in_order &= value > last;
+    last = value;
+    ++received;
+  }
+  producer.join();
+  TF_LITE_MICRO_EXPECT(in_order);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(kNumMessages),
+                          received + reporter.dropped_count());
+}
+
+#ifdef TF_LITE_LOG_INTERNING
+TF_LITE_MICRO_TEST(KeepsInternedMessages) {
+  tflite::DeferredLogRecord records[2];
+  tflite::DeferredErrorReporter reporter(records, 2);
+  const uint32_t words[tflite::kMaxInternedLogArgs] = {1, 2, 3, 4, 5, 6, 7};
+  reporter.ReportInterned(0x2a, words, 7);
+  TF_LITE_REPORT_ERROR(&reporter, "plain %d", 5);
+  // The words past kMaxDeferredLogArgs are cut.
+  char message[tflite::testing::kMaxMessageLength];
+  TF_LITE_MICRO_EXPECT(
+      reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+  TF_LITE_MICRO_EXPECT(tflite::testing::StringsEqual(
+      "@0x2a 0x1 0x2 0x3 0x4 0x5 0x6", message));
+  TF_LITE_MICRO_EXPECT(
+      reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+  TF_LITE_MICRO_EXPECT_EQ('@', message[0]);
+
+  reporter.ReportInterned(0x2a, words, 0);
+  TF_LITE_MICRO_EXPECT_EQ(1, reporter.Flush());
+  TF_LITE_MICRO_EXPECT(
+      !reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+}
+#endif  // TF_LITE_LOG_INTERNING
+
+#else
+
+TF_LITE_MICRO_TEST(StoresNothingWithStrippedStrings) {
+  tflite::DeferredLogRecord records[2];
+  tflite::DeferredErrorReporter reporter(records, 2);
+  tflite::testing::Report(&reporter, "message %d", 1);
+  char message[tflite::testing::kMaxMessageLength];
+  TF_LITE_MICRO_EXPECT(
+      !reporter.FormatNext(message, tflite::testing::kMaxMessageLength));
+  TF_LITE_MICRO_EXPECT_EQ(0, reporter.Flush());
+}
+
+#endif  // TF_LITE_STRIP_ERROR_STRINGS
+
+TF_LITE_MICRO_TESTS_END
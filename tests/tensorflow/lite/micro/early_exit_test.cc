@@ -0,0 +1,253 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/early_exit.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr int kNumClasses = 4;
+
+const float kInput[kNumClasses] = {0.5f, 2.0f, -1.0f, 0.25f};
+
+// A cascade of two classifiers on a float 1x4 input: head 0 is the SOFTMAX
+// of the input, head 1 the SOFTMAX of a FULLY_CONNECTED layer that sharpens
+// the scores.
+const Model* BuildCascade(TestModelBuilder* builder) {
+  static const float kWeights[kNumClasses * kNumClasses] = {
+      3.0f, 0.0f, 0.0f, 0.0f,  //
+      0.0f, 3.0f, 0.0f, 0.0f,  //
+      0.0f, 0.0f, 3.0f, 0.0f,  //
+      0.0f, 0.0f, 0.0f, 3.0f,
+  };
+  const int input = builder->AddTensor({1, kNumClasses}, TensorType_FLOAT32);
+  const int first_head =
+      builder->AddTensor({1, kNumClasses}, TensorType_FLOAT32);
+  const int weights = builder->AddTensor({kNumClasses, kNumClasses},
+                                         TensorType_FLOAT32, kWeights,
+                                         sizeof(kWeights));
+  const int logits = builder->AddTensor({1, kNumClasses}, TensorType_FLOAT32);
+  const int second_head =
+      builder->AddTensor({1, kNumClasses}, TensorType_FLOAT32);
+  SoftmaxOptionsT softmax_options;
+  softmax_options.beta = 1.0f;
+  builder->AddOperator(BuiltinOperator_SOFTMAX, {input}, {first_head},
+                       softmax_options);
+  builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                       {input, weights, -1}, {logits},
+                       FullyConnectedOptionsT());
+  builder->AddOperator(BuiltinOperator_SOFTMAX, {logits}, {second_head},
+                       softmax_options);
+  return builder->Finish({input}, {first_head, second_head});
+}
+
+// Softmax of `scale` times the input.
+float ExpectedScore(int index, float scale) {
+  float sum = 0.0f;
+  for (int i = 0; i < kNumClasses; ++i) {
+    sum += std::exp(scale * kInput[i]);
+  }
+  return std::exp(scale * kInput[index]) / sum;
+}
+
+// user_data of CountingCheck().
+struct CountedThreshold {
+  ScoreThreshold threshold;
+  int calls;
+};
+
+bool CountingCheck(const TfLiteEvalTensor* head, void* user_data) {
+  CountedThreshold* counted = static_cast<CountedThreshold*>(user_data);
+  ++counted->calls;
+  return MaxScoreAtLeast(head, &counted->threshold);
+}
+
+// Runs the cascade with an exit after each SOFTMAX and the given thresholds,
+// copies both heads and returns the exit taken.
+int RunCascade(float first_threshold, float second_threshold,
+               CountedThreshold* first, CountedThreshold* second,
+               float* first_head, float* second_head) {
+  static uint8_t arena[kArenaSize];
+  TestModelBuilder builder;
+  const Model* model = BuildCascade(&builder);
+  AllOpsResolver resolver;
+  MicroInterpreter interpreter(model, resolver, arena, kArenaSize,
+                               micro_test::reporter);
+  *first = {{first_threshold, 1.0f, 0}, 0};
+  *second = {{second_threshold, 1.0f, 0}, 0};
+  const EarlyExit exits[] = {
+      {0, 0, CountingCheck, first},
+      {2, 1, CountingCheck, second},
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetEarlyExits(exits, 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  for (int i = 0; i < kNumClasses; ++i) {
+    interpreter.input(0)->data.f[i] = kInput[i];
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  for (int i = 0; i < kNumClasses; ++i) {
+    first_head[i] = interpreter.output(0)->data.f[i];
+    second_head[i] = interpreter.output(1)->data.f[i];
+  }
+  return interpreter.early_exit_taken();
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(MaxScoreAtLeastReadsEveryType) {
+  int shape[] = {1, 3};
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  float float_scores[] = {0.1f, 0.7f, 0.2f};
+  int8_t int8_scores[] = {-100, 50, 0};
+  uint8_t uint8_scores[] = {10, 200, 30};
+  int32_t int32_scores[] = {1, 2, 3};
+  TfLiteEvalTensor head = {};
+  head.dims = dims;
+
+  tflite::ScoreThreshold threshold = {0.7f, 1.0f, 0};
+  head.type = kTfLiteFloat32;
+  head.data.f = float_scores;
+  TF_LITE_MICRO_EXPECT(tflite::MaxScoreAtLeast(&head, &threshold));
+  threshold.threshold = 0.75f;
+  TF_LITE_MICRO_EXPECT(!tflite::MaxScoreAtLeast(&head, &threshold));
+
+  // (50 + 128) / 256 = 0.6953125.
+  threshold = {0.69f, 1.0f / 256, -128};
+  head.type = kTfLiteInt8;
+  head.data.int8 = int8_scores;
+  TF_LITE_MICRO_EXPECT(tflite::MaxScoreAtLeast(&head, &threshold));
+  threshold.threshold = 0.7f;
+  TF_LITE_MICRO_EXPECT(!tflite::MaxScoreAtLeast(&head, &threshold));
+
+  // 200 / 256 = 0.78125.
+  threshold = {0.78f, 1.0f / 256, 0};
+  head.type = kTfLiteUInt8;
+  head.data.uint8 = uint8_scores;
+  TF_LITE_MICRO_EXPECT(tflite::MaxScoreAtLeast(&head, &threshold));
+  threshold.threshold = 0.79f;
+  TF_LITE_MICRO_EXPECT(!tflite::MaxScoreAtLeast(&head, &threshold));
+
+  threshold = {-1.0f, 1.0f, 0};
+  head.type = kTfLiteInt32;
+  head.data.i32 = int32_scores;
+  TF_LITE_MICRO_EXPECT(!tflite::MaxScoreAtLeast(&head, &threshold));
+}
+
+TF_LITE_MICRO_TEST(ExitsAtFirstConfidentHead) {
+  tflite::testing::CountedThreshold first;
+  tflite::testing::CountedThreshold second;
+  float first_head[tflite::testing::kNumClasses];
+  float second_head[tflite::testing::kNumClasses];
+  // The first head peaks at 0.69.
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, tflite::testing::RunCascade(0.6f, 0.6f, &first, &second,
+                                     first_head, second_head));
+  TF_LITE_MICRO_EXPECT_EQ(1, first.calls);
+  TF_LITE_MICRO_EXPECT_EQ(0, second.calls);
+  for (int i = 0; i < tflite::testing::kNumClasses; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(tflite::testing::ExpectedScore(i, 1.0f),
+                              first_head[i], 1e-5f);
+  }
+}
+
+TF_LITE_MICRO_TEST(RunsCascadeUntilConfident) {
+  tflite::testing::CountedThreshold first;
+  tflite::testing::CountedThreshold second;
+  float first_head[tflite::testing::kNumClasses];
+  float second_head[tflite::testing::kNumClasses];
+  // The second head peaks at 0.98.
+  TF_LITE_MICRO_EXPECT_EQ(
+      1, tflite::testing::RunCascade(0.9f, 0.9f, &first, &second, first_head,
+                                     second_head));
+  TF_LITE_MICRO_EXPECT_EQ(1, first.calls);
+  TF_LITE_MICRO_EXPECT_EQ(1, second.calls);
+  for (int i = 0; i < tflite::testing::kNumClasses; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(tflite::testing::ExpectedScore(i, 3.0f),
+                              second_head[i], 1e-5f);
+  }
+}
+
+TF_LITE_MICRO_TEST(RunsAllOperatorsWhenNoHeadIsConfident) {
+  tflite::testing::CountedThreshold first;
+  tflite::testing::CountedThreshold second;
+  float first_head[tflite::testing::kNumClasses];
+  float second_head[tflite::testing::kNumClasses];
+  TF_LITE_MICRO_EXPECT_EQ(
+      -1, tflite::testing::RunCascade(0.999f, 0.999f, &first, &second,
+                                      first_head, second_head));
+  TF_LITE_MICRO_EXPECT_EQ(1, first.calls);
+  TF_LITE_MICRO_EXPECT_EQ(1, second.calls);
+  for (int i = 0; i < tflite::testing::kNumClasses; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(tflite::testing::ExpectedScore(i, 1.0f),
+                              first_head[i], 1e-5f);
+    TF_LITE_MICRO_EXPECT_NEAR(tflite::testing::ExpectedScore(i, 3.0f),
+                              second_head[i], 1e-5f);
+  }
+}
+
+TF_LITE_MICRO_TEST(SetEarlyExitsRejectsInvalidExits) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model = tflite::testing::BuildCascade(&builder);
+  tflite::AllOpsResolver resolver;
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  tflite::ScoreThreshold threshold = {0.5f, 1.0f, 0};
+  const tflite::EarlyExit decreasing[] = {
+      {2, 1, tflite::MaxScoreAtLeast, &threshold},
+      {0, 0, tflite::MaxScoreAtLeast, &threshold},
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          interpreter.SetEarlyExits(decreasing, 2));
+  const tflite::EarlyExit past_last_operator[] = {
+      {3, 1, tflite::MaxScoreAtLeast, &threshold},
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          interpreter.SetEarlyExits(past_last_operator, 1));
+  const tflite::EarlyExit not_an_output[] = {
+      {0, 2, tflite::MaxScoreAtLeast, &threshold},
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          interpreter.SetEarlyExits(not_an_output, 1));
+  const tflite::EarlyExit without_check[] = {{0, 0, nullptr, &threshold}};
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          interpreter.SetEarlyExits(without_check, 1));
+
+  // A rejected array leaves no exits, so the whole model runs.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(-1, interpreter.early_exit_taken());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetEarlyExits(nullptr, 0));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,510 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/graph_rewriter.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/float16_weights.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Every rewrite leaves a pattern alone when one of its intermediate tensors is
+// a model output. Each test therefore builds its pattern twice, once with the
+// intermediate tensor exposed, and expects the rewritten model to compute
+// exactly what the original operators compute.
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 64 * 1024;
+constexpr size_t kMaxOutputBytes = 1024;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+std::vector<int8_t> RandomInt8(int size, uint32_t seed) {
+  Random random(seed);
+  std::vector<int8_t> values(size);
+  for (int8_t& value : values) {
+    value = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  return values;
+}
+
+std::vector<int32_t> RandomInt32(int size, int range, uint32_t seed) {
+  Random random(seed);
+  std::vector<int32_t> values(size);
+  for (int32_t& value : values) {
+    value = random.Next(-range, range);
+  }
+  return values;
+}
+
+// Random float16 weights, multiples of 1/64 in [-1, 1].
+std::vector<uint16_t> RandomHalf(int size, uint32_t seed) {
+  Random random(seed);
+  std::vector<uint16_t> values(size);
+  for (uint16_t& value : values) {
+    value = FloatToHalf(static_cast<float>(random.Next(-64, 64)) / 64.0f);
+  }
+  return values;
+}
+
+// Output of a model run, with the number of nodes a rewrite removed.
+struct ModelRun {
+  uint8_t output[kMaxOutputBytes];
+  size_t output_bytes;
+  int elided_nodes;
+};
+
+// Runs `model` on `input`, which fills input 0, and keeps output 0.
+void RunModel(const Model* model, const void* input, size_t input_bytes,
+              ModelRun* run) {
+  static uint8_t arena[kArenaSize];
+  AllOpsResolver resolver;
+  MicroInterpreter interpreter(model, resolver, arena, kArenaSize,
+                               micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(input_bytes, interpreter.input(0)->bytes);
+  std::memcpy(interpreter.input(0)->data.raw, input, input_bytes);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  run->output_bytes = interpreter.output(0)->bytes;
+  TF_LITE_MICRO_EXPECT_LE(run->output_bytes, kMaxOutputBytes);
+  std::memcpy(run->output, interpreter.output(0)->data.raw, run->output_bytes);
+  run->elided_nodes = 0;
+  for (size_t i = 0; i < interpreter.operators_size(); ++i) {
+    if (internal::IsElidedNode(interpreter.node_and_registration(i))) {
+      ++run->elided_nodes;
+    }
+  }
+}
+
+// Runs the model built by `build` with and without its intermediate tensor
+// exposed, and expects `expected_elided_nodes` nodes to be removed from the
+// first one only, with identical outputs.
+template <typename BuildFn>
+void TestRewriteKeepsOutput(BuildFn build, const void* input,
+                            size_t input_bytes, int expected_elided_nodes) {
+  TestModelBuilder rewritten_builder;
+  TestModelBuilder plain_builder;
+  ModelRun rewritten;
+  ModelRun plain;
+  RunModel(build(&rewritten_builder, /*expose_intermediate=*/false), input,
+           input_bytes, &rewritten);
+  RunModel(build(&plain_builder, /*expose_intermediate=*/true), input,
+           input_bytes, &plain);
+  TF_LITE_MICRO_EXPECT_EQ(expected_elided_nodes, rewritten.elided_nodes);
+  TF_LITE_MICRO_EXPECT_EQ(0, plain.elided_nodes);
+  TF_LITE_MICRO_EXPECT_EQ(plain.output_bytes, rewritten.output_bytes);
+  for (size_t i = 0; i < plain.output_bytes; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(plain.output[i], rewritten.output[i]);
+  }
+}
+
+// SPACE_TO_BATCH_ND -> CONV_2D or DEPTHWISE_CONV_2D -> BATCH_TO_SPACE_ND on
+// an int8 1x8x8x3 input, the converter's form of a 3x3 convolution with a
+// dilation of 2 and SAME padding.
+const Model* BuildDilatedConvolution(TestModelBuilder* builder,
+                                     bool expose_intermediate,
+                                     bool depthwise) {
+  static const int32_t kBlockShape[] = {2, 2};
+  static const int32_t kPaddings[] = {2, 2, 2, 2};
+  static const int32_t kCrops[] = {0, 0, 0, 0};
+  const int output_depth = depthwise ? 3 : 4;
+  static const std::vector<int8_t> filter = RandomInt8(3 * 3 * 3 * 4, 1);
+  static const std::vector<int32_t> bias = RandomInt32(4, 2000, 2);
+
+  const int input = builder->AddQuantizedTensor({1, 8, 8, 3},
+                                                TensorType_INT8, 0.05f, -3);
+  const int block_shape = builder->AddTensor(
+      {2}, TensorType_INT32, kBlockShape, sizeof(kBlockShape));
+  const int paddings = builder->AddTensor({2, 2}, TensorType_INT32, kPaddings,
+                                          sizeof(kPaddings));
+  const int crops =
+      builder->AddTensor({2, 2}, TensorType_INT32, kCrops, sizeof(kCrops));
+  const int batched_input = builder->AddQuantizedTensor(
+      {4, 6, 6, 3}, TensorType_INT8, 0.05f, -3);
+  const std::vector<float> filter_scales = {0.01f, 0.02f, 0.015f, 0.03f};
+  const int filter_tensor = builder->AddPerChannelTensor(
+      {depthwise ? 1 : output_depth, 3, 3, depthwise ? output_depth : 3},
+      TensorType_INT8,
+      std::vector<float>(filter_scales.begin(),
+                         filter_scales.begin() + output_depth),
+      depthwise ? 3 : 0, filter.data(), 3 * 3 * 3 * output_depth);
+  const int bias_tensor =
+      builder->AddTensor({output_depth}, TensorType_INT32, bias.data(),
+                         output_depth * sizeof(int32_t));
+  const int batched_output = builder->AddQuantizedTensor(
+      {4, 4, 4, output_depth}, TensorType_INT8, 0.2f, 1);
+  const int output = builder->AddQuantizedTensor(
+      {1, 8, 8, output_depth}, TensorType_INT8, 0.2f, 1);
+
+  builder->AddOperator(BuiltinOperator_SPACE_TO_BATCH_ND,
+                       {input, block_shape, paddings}, {batched_input});
+  if (depthwise) {
+    DepthwiseConv2DOptionsT options;
+    options.padding = Padding_VALID;
+    options.stride_w = 1;
+    options.stride_h = 1;
+    options.depth_multiplier = 1;
+    builder->AddOperator(BuiltinOperator_DEPTHWISE_CONV_2D,
+                         {batched_input, filter_tensor, bias_tensor},
+                         {batched_output}, options);
+  } else {
+    Conv2DOptionsT options;
+    options.padding = Padding_VALID;
+    options.stride_w = 1;
+    options.stride_h = 1;
+    builder->AddOperator(BuiltinOperator_CONV_2D,
+                         {batched_input, filter_tensor, bias_tensor},
+                         {batched_output}, options);
+  }
+  builder->AddOperator(BuiltinOperator_BATCH_TO_SPACE_ND,
+                       {batched_output, block_shape, crops}, {output});
+  if (expose_intermediate) {
+    return builder->Finish({input}, {output, batched_input});
+  }
+  return builder->Finish({input}, {output});
+}
+
+// GREATER(input, threshold) -> SELECT_V2(mask, input, fallback) on a 1x16
+// input, with a scalar threshold and a full size fallback. Quantized tensors
+// share one scale and zero point, coarse enough to be compared raw.
+template <typename T>
+const Model* BuildComparisonSelect(TestModelBuilder* builder,
+                                   bool expose_intermediate, TensorType type) {
+  static const T kThreshold[] = {static_cast<T>(3)};
+  static T fallback[16];
+  for (int i = 0; i < 16; ++i) {
+    fallback[i] = static_cast<T>(i - 8);
+  }
+  int input, threshold, fallback_tensor, output;
+  if (type == TensorType_FLOAT32) {
+    input = builder->AddTensor({1, 16}, type);
+    threshold = builder->AddTensor({1}, type, kThreshold, sizeof(kThreshold));
+    fallback_tensor =
+        builder->AddTensor({1, 16}, type, fallback, sizeof(fallback));
+    output = builder->AddTensor({1, 16}, type);
+  } else {
+    input = builder->AddQuantizedTensor({1, 16}, type, 0.5f, -1);
+    threshold = builder->AddQuantizedTensor({1}, type, 0.5f, -1, kThreshold,
+                                            sizeof(kThreshold));
+    fallback_tensor = builder->AddQuantizedTensor({1, 16}, type, 0.5f, -1,
+                                                  fallback, sizeof(fallback));
+    output = builder->AddQuantizedTensor({1, 16}, type, 0.5f, -1);
+  }
+  const int mask = builder->AddTensor({1, 16}, TensorType_BOOL);
+  builder->AddOperator(BuiltinOperator_GREATER, {input, threshold}, {mask});
+  builder->AddOperator(BuiltinOperator_SELECT_V2,
+                       {mask, input, fallback_tensor}, {output});
+  if (expose_intermediate) {
+    return builder->Finish({input}, {output, mask});
+  }
+  return builder->Finish({input}, {output});
+}
+
+// QUANTIZE of uint8 pixels to int8 -> CONV_2D with a 3x3 filter, stride 2
+// and SAME padding on a 1x9x9x3 image.
+const Model* BuildQuantizedImageConv(TestModelBuilder* builder,
+                                     bool expose_intermediate) {
+  static const std::vector<int8_t> filter = RandomInt8(8 * 3 * 3 * 3, 7);
+  static const std::vector<int32_t> bias = RandomInt32(8, 3000, 8);
+  const float pixel_scale = 1.0f / 255;
+  const int pixels = builder->AddQuantizedTensor({1, 9, 9, 3},
+                                                 TensorType_UINT8, pixel_scale,
+                                                 0);
+  const int quantized = builder->AddQuantizedTensor(
+      {1, 9, 9, 3}, TensorType_INT8, pixel_scale, -128);
+  const int filter_tensor = builder->AddPerChannelTensor(
+      {8, 3, 3, 3}, TensorType_INT8,
+      {0.01f, 0.02f, 0.005f, 0.03f, 0.01f, 0.015f, 0.02f, 0.025f},
+      /*quantized_dimension=*/0, filter.data(), filter.size());
+  const int bias_tensor = builder->AddTensor(
+      {8}, TensorType_INT32, bias.data(), bias.size() * sizeof(int32_t));
+  const int output = builder->AddQuantizedTensor({1, 5, 5, 8},
+                                                 TensorType_INT8, 0.02f, -5);
+  builder->AddOperator(BuiltinOperator_QUANTIZE, {pixels}, {quantized});
+  Conv2DOptionsT options;
+  options.padding = Padding_SAME;
+  options.stride_w = 2;
+  options.stride_h = 2;
+  options.fused_activation_function = ActivationFunctionType_RELU;
+  builder->AddOperator(BuiltinOperator_CONV_2D,
+                       {quantized, filter_tensor, bias_tensor}, {output},
+                       options);
+  if (expose_intermediate) {
+    return builder->Finish({pixels}, {output, quantized});
+  }
+  return builder->Finish({pixels}, {output});
+}
+
+// DEPTHWISE_CONV_2D -> 1x1 CONV_2D on an int8 1x9x9x6 input, the separable
+// convolution of MobileNet. The depthwise convolution has a 3x3 filter,
+// SAME padding, `stride` and a bias if `depthwise_bias` is set.
+const Model* BuildSeparableConvolution(TestModelBuilder* builder,
+                                       bool expose_intermediate, int stride,
+                                       bool depthwise_bias) {
+  static const std::vector<int8_t> depthwise_filter =
+      RandomInt8(3 * 3 * 6, 10);
+  static const std::vector<int32_t> depthwise_bias_data =
+      RandomInt32(6, 2000, 11);
+  static const std::vector<int8_t> pointwise_filter = RandomInt8(10 * 6, 12);
+  static const std::vector<int32_t> pointwise_bias_data =
+      RandomInt32(10, 2000, 13);
+  const int output_size = (9 + stride - 1) / stride;
+
+  const int input = builder->AddQuantizedTensor({1, 9, 9, 6},
+                                                TensorType_INT8, 0.05f, 4);
+  const int depthwise_filter_tensor = builder->AddPerChannelTensor(
+      {1, 3, 3, 6}, TensorType_INT8,
+      {0.01f, 0.02f, 0.015f, 0.01f, 0.025f, 0.005f},
+      /*quantized_dimension=*/3, depthwise_filter.data(),
+      depthwise_filter.size());
+  const int depthwise_bias_tensor =
+      builder->AddTensor({6}, TensorType_INT32, depthwise_bias_data.data(),
+                         depthwise_bias_data.size() * sizeof(int32_t));
+  const int intermediate = builder->AddQuantizedTensor(
+      {1, output_size, output_size, 6}, TensorType_INT8, 0.04f, -128);
+  const int pointwise_filter_tensor = builder->AddPerChannelTensor(
+      {10, 1, 1, 6}, TensorType_INT8,
+      {0.01f, 0.02f, 0.015f, 0.01f, 0.025f, 0.005f, 0.01f, 0.02f, 0.03f,
+       0.01f},
+      /*quantized_dimension=*/0, pointwise_filter.data(),
+      pointwise_filter.size());
+  const int pointwise_bias_tensor =
+      builder->AddTensor({10}, TensorType_INT32, pointwise_bias_data.data(),
+                         pointwise_bias_data.size() * sizeof(int32_t));
+  const int output = builder->AddQuantizedTensor(
+      {1, output_size, output_size, 10}, TensorType_INT8, 0.1f, 3);
+
+  DepthwiseConv2DOptionsT depthwise_options;
+  depthwise_options.padding = Padding_SAME;
+  depthwise_options.stride_w = stride;
+  depthwise_options.stride_h = stride;
+  depthwise_options.depth_multiplier = 1;
+  depthwise_options.fused_activation_function = ActivationFunctionType_RELU6;
+  if (depthwise_bias) {
+    builder->AddOperator(
+        BuiltinOperator_DEPTHWISE_CONV_2D,
+        {input, depthwise_filter_tensor, depthwise_bias_tensor},
+        {intermediate}, depthwise_options);
+  } else {
+    builder->AddOperator(BuiltinOperator_DEPTHWISE_CONV_2D,
+                         {input, depthwise_filter_tensor}, {intermediate},
+                         depthwise_options);
+  }
+  Conv2DOptionsT pointwise_options;
+  pointwise_options.padding = Padding_SAME;
+  pointwise_options.stride_w = 1;
+  pointwise_options.stride_h = 1;
+  builder->AddOperator(
+      BuiltinOperator_CONV_2D,
+      {intermediate, pointwise_filter_tensor, pointwise_bias_tensor},
+      {output}, pointwise_options);
+  if (expose_intermediate) {
+    return builder->Finish({input}, {output, intermediate});
+  }
+  return builder->Finish({input}, {output});
+}
+
+// Float CONV_2D and FULLY_CONNECTED layers on a 1x6x6x2 input, whose
+// filters and biases are float16 constants behind DEQUANTIZE nodes, as the
+// float16 post-training quantization of the converter writes them.
+const Model* BuildFloat16Weights(TestModelBuilder* builder,
+                                 bool expose_intermediate) {
+  static const std::vector<uint16_t> conv_filter =
+      RandomHalf(3 * 3 * 3 * 2, 16);
+  static const std::vector<uint16_t> conv_bias = RandomHalf(3, 17);
+  static const std::vector<uint16_t> fc_weights = RandomHalf(5 * 48, 18);
+
+  const int input = builder->AddTensor({1, 6, 6, 2}, TensorType_FLOAT32);
+  const int conv_filter_half =
+      builder->AddTensor({3, 3, 3, 2}, TensorType_FLOAT16, conv_filter.data(),
+                         conv_filter.size() * sizeof(uint16_t));
+  const int conv_bias_half =
+      builder->AddTensor({3}, TensorType_FLOAT16, conv_bias.data(),
+                         conv_bias.size() * sizeof(uint16_t));
+  const int fc_weights_half =
+      builder->AddTensor({5, 48}, TensorType_FLOAT16, fc_weights.data(),
+                         fc_weights.size() * sizeof(uint16_t));
+  const int conv_filter_float =
+      builder->AddTensor({3, 3, 3, 2}, TensorType_FLOAT32);
+  const int conv_bias_float = builder->AddTensor({3}, TensorType_FLOAT32);
+  const int fc_weights_float = builder->AddTensor({5, 48}, TensorType_FLOAT32);
+  const int conv_output = builder->AddTensor({1, 4, 4, 3}, TensorType_FLOAT32);
+  const int output = builder->AddTensor({1, 5}, TensorType_FLOAT32);
+
+  builder->AddOperator(BuiltinOperator_DEQUANTIZE, {conv_filter_half},
+                       {conv_filter_float});
+  builder->AddOperator(BuiltinOperator_DEQUANTIZE, {conv_bias_half},
+                       {conv_bias_float});
+  builder->AddOperator(BuiltinOperator_DEQUANTIZE, {fc_weights_half},
+                       {fc_weights_float});
+  Conv2DOptionsT conv_options;
+  conv_options.padding = Padding_VALID;
+  conv_options.stride_w = 1;
+  conv_options.stride_h = 1;
+  conv_options.fused_activation_function = ActivationFunctionType_RELU;
+  builder->AddOperator(BuiltinOperator_CONV_2D,
+                       {input, conv_filter_float, conv_bias_float},
+                       {conv_output}, conv_options);
+  builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                       {conv_output, fc_weights_float, -1}, {output},
+                       FullyConnectedOptionsT());
+  if (expose_intermediate) {
+    return builder->Finish(
+        {input},
+        {output, conv_filter_float, conv_bias_float, fc_weights_float});
+  }
+  return builder->Finish({input}, {output});
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FoldsSpaceToBatchAroundConv) {
+  const std::vector<int8_t> input = tflite::testing::RandomInt8(8 * 8 * 3, 3);
+  tflite::testing::TestRewriteKeepsOutput(
+      [](tflite::testing::TestModelBuilder* builder, bool expose) {
+        return tflite::testing::BuildDilatedConvolution(builder, expose,
+                                                        /*depthwise=*/false);
+      },
+      input.data(), input.size(), /*expected_elided_nodes=*/2);
+}
+
+TF_LITE_MICRO_TEST(FoldsSpaceToBatchAroundDepthwiseConv) {
+  const std::vector<int8_t> input = tflite::testing::RandomInt8(8 * 8 * 3, 4);
+  tflite::testing::TestRewriteKeepsOutput(
+      [](tflite::testing::TestModelBuilder* builder, bool expose) {
+        return tflite::testing::BuildDilatedConvolution(builder, expose,
+                                                        /*depthwise=*/true);
+      },
+      input.data(), input.size(), /*expected_elided_nodes=*/2);
+}
+
+TF_LITE_MICRO_TEST(FusesGreaterIntoSelectFloat) {
+  float input[16];
+  tflite::testing::Random random(5);
+  for (float& value : input) {
+    value = 0.25f * static_cast<float>(random.Next(-40, 40));
+  }
+  tflite::testing::TestRewriteKeepsOutput(
+      [](tflite::testing::TestModelBuilder* builder, bool expose) {
+        return tflite::testing::BuildComparisonSelect<float>(
+            builder, expose, tflite::TensorType_FLOAT32);
+      },
+      input, sizeof(input), /*expected_elided_nodes=*/1);
+}
+
+TF_LITE_MICRO_TEST(FusesGreaterIntoSelectInt8) {
+  const std::vector<int8_t> input = tflite::testing::RandomInt8(16, 6);
+  tflite::testing::TestRewriteKeepsOutput(
+      [](tflite::testing::TestModelBuilder* builder, bool expose) {
+        return tflite::testing::BuildComparisonSelect<int8_t>(
+            builder, expose, tflite::TensorType_INT8);
+      },
+      input.data(), input.size(), /*expected_elided_nodes=*/1);
+}
+
+// The comparison kernels do not support int16, so the model must fail as it
+// does unfused instead of running through the fused SELECT.
+TF_LITE_MICRO_TEST(DoesNotFuseInt16ComparisonIntoSelect) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model =
+      tflite::testing::BuildComparisonSelect<int16_t>(
+          &builder, /*expose_intermediate=*/false, tflite::TensorType_INT16);
+  tflite::AllOpsResolver resolver;
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  for (size_t i = 0; i < interpreter.operators_size(); ++i) {
+    TF_LITE_MICRO_EXPECT(!tflite::internal::IsElidedNode(
+        interpreter.node_and_registration(i)));
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.Invoke());
+}
+
+TF_LITE_MICRO_TEST(FoldsInputQuantizeIntoShallowConv) {
+  uint8_t pixels[9 * 9 * 3];
+  tflite::testing::Random random(9);
+  for (uint8_t& pixel : pixels) {
+    pixel = static_cast<uint8_t>(random.Next(0, 255));
+  }
+  tflite::testing::TestRewriteKeepsOutput(
+      tflite::testing::BuildQuantizedImageConv, pixels, sizeof(pixels),
+      /*expected_elided_nodes=*/1);
+}
+
+TF_LITE_MICRO_TEST(FusesSeparableConvolution) {
+  const std::vector<int8_t> input =
+      tflite::testing::RandomInt8(9 * 9 * 6, 14);
+  tflite::testing::TestRewriteKeepsOutput(
+      [](tflite::testing::TestModelBuilder* builder, bool expose) {
+        return tflite::testing::BuildSeparableConvolution(
+            builder, expose, /*stride=*/1, /*depthwise_bias=*/true);
+      },
+      input.data(), input.size(), /*expected_elided_nodes=*/1);
+}
+
+TF_LITE_MICRO_TEST(FusesStridedSeparableConvolutionWithoutBias) {
+  const std::vector<int8_t> input =
+      tflite::testing::RandomInt8(9 * 9 * 6, 15);
+  tflite::testing::TestRewriteKeepsOutput(
+      [](tflite::testing::TestModelBuilder* builder, bool expose) {
+        return tflite::testing::BuildSeparableConvolution(
+            builder, expose, /*stride=*/2, /*depthwise_bias=*/false);
+      },
+      input.data(), input.size(), /*expected_elided_nodes=*/1);
+}
+
+TF_LITE_MICRO_TEST(FoldsFloat16Dequantize) {
+  float input[6 * 6 * 2];
+  tflite::testing::Random random(19);
+  for (float& value : input) {
+    value = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  tflite::testing::TestRewriteKeepsOutput(
+      tflite::testing::BuildFloat16Weights, input, sizeof(input),
+      /*expected_elided_nodes=*/3);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,191 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/reference/arg_min_max.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/kernels/micro_utils.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxInputSize = 4 * 5 * 37;
+constexpr int kMaxOutputSize = 5 * 37;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+TfLiteTensor CreateTensor(const float* data, TfLiteIntArray* dims) {
+  return CreateFloatTensor(data, dims);
+}
+
+template <typename T>
+TfLiteTensor CreateTensor(const T* data, TfLiteIntArray* dims) {
+  return CreateQuantizedTensor(data, dims, 0.5f, 0);
+}
+
+// Runs ARG_MAX or ARG_MIN over `axis` of `input_data`, of the shape
+// `input_dims`, and compares it with reference_ops::ArgMinMax, the generic
+// path of the kernel. Over the innermost axis the kernel takes its fast
+// path, which must resolve ties to the lowest index like the reference.
+template <typename T>
+void TestMatchesReference(const int* input_dims, const T* input_data,
+                          int axis, bool is_arg_max) {
+  const int num_dims = input_dims[0];
+  const int positive_axis = axis < 0 ? axis + num_dims : axis;
+  int output_dims[5] = {num_dims - 1};
+  for (int d = 0, o = 1; d < num_dims; ++d) {
+    if (d != positive_axis) {
+      output_dims[o++] = input_dims[d + 1];
+    }
+  }
+  const int output_size = ElementCount(*IntArrayFromInts(output_dims));
+  TF_LITE_MICRO_EXPECT_LE(ElementCount(*IntArrayFromInts(input_dims)),
+                          kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+
+  int axis_data[] = {axis};
+  int axis_dims[] = {1, 1};
+  int32_t output_data[kMaxOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateTensor(input_data, IntArrayFromInts(input_dims)),
+      CreateInt32Tensor(axis_data, IntArrayFromInts(axis_dims)),
+      CreateInt32Tensor(output_data, IntArrayFromInts(output_dims)),
+  };
+  int inputs_array_data[] = {2, 0, 1};
+  int outputs_array_data[] = {1, 2};
+  const TfLiteRegistration registration =
+      is_arg_max ? ops::micro::Register_ARG_MAX()
+                 : ops::micro::Register_ARG_MIN();
+  micro::KernelRunner runner(registration, tensors, 3,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             /*builtin_data=*/nullptr, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  int32_t expected_data[kMaxOutputSize];
+  const RuntimeShape input_shape(num_dims, input_dims + 1);
+  const RuntimeShape output_shape(num_dims - 1, output_dims + 1);
+  if (is_arg_max) {
+    reference_ops::ArgMinMax(input_shape, input_data, axis_data, output_shape,
+                             expected_data, ops::micro::Greater());
+  } else {
+    reference_ops::ArgMinMax(input_shape, input_data, axis_data, output_shape,
+                             expected_data, ops::micro::Less());
+  }
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+// Runs ARG_MAX and ARG_MIN over every axis, given as positive and as
+// negative index, of random values in [low, high]. A narrow range gives
+// rows with many ties.
+template <typename T>
+void TestAllAxes(const int* input_dims, int low, int high, uint32_t seed) {
+  Random random(seed);
+  T input_data[kMaxInputSize];
+  const int input_size = ElementCount(*IntArrayFromInts(input_dims));
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<T>(random.Next(low, high));
+  }
+  const int num_dims = input_dims[0];
+  for (int axis = -num_dims; axis < num_dims; ++axis) {
+    TestMatchesReference(input_dims, input_data, axis, /*is_arg_max=*/true);
+    TestMatchesReference(input_dims, input_data, axis, /*is_arg_max=*/false);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// Rows of 37, which leave a tail after the four accumulators.
+TF_LITE_MICRO_TEST(Int8WithTies) {
+  const int input_dims[] = {3, 4, 5, 37};
+  tflite::testing::TestAllAxes<int8_t>(input_dims, -3, 3, 1);
+}
+
+TF_LITE_MICRO_TEST(Int8FullRange) {
+  const int input_dims[] = {2, 5, 36};
+  tflite::testing::TestAllAxes<int8_t>(input_dims, -128, 127, 2);
+}
+
+TF_LITE_MICRO_TEST(Uint8WithTies) {
+  const int input_dims[] = {2, 6, 13};
+  tflite::testing::TestAllAxes<uint8_t>(input_dims, 250, 255, 3);
+}
+
+// Every value is 0 or -0.0f, which compare equal.
+TF_LITE_MICRO_TEST(FloatWithTies) {
+  const int input_dims[] = {3, 3, 4, 10};
+  tflite::testing::TestAllAxes<float>(input_dims, -2, 2, 4);
+  float zeros[3 * 4 * 10];
+  tflite::testing::Random random(5);
+  for (float& value : zeros) {
+    value = random.Next(0, 1) == 0 ? 0.0f : -0.0f;
+  }
+  for (int axis : {-1, 2, 0}) {
+    tflite::testing::TestMatchesReference(input_dims, zeros, axis, true);
+    tflite::testing::TestMatchesReference(input_dims, zeros, axis, false);
+  }
+}
+
+// Rows shorter than the four accumulators, and of a single element.
+TF_LITE_MICRO_TEST(ShortRows) {
+  const int input_dims_3[] = {2, 7, 3};
+  tflite::testing::TestAllAxes<int8_t>(input_dims_3, -2, 2, 6);
+  const int input_dims_1[] = {2, 7, 1};
+  tflite::testing::TestAllAxes<float>(input_dims_1, -2, 2, 7);
+}
+
+// A NaN first in a row wins, one elsewhere is skipped, like in the
+// reference.
+TF_LITE_MICRO_TEST(FloatNaN) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const int input_dims[] = {2, 3, 6};
+  const float input_data[] = {nan, 1.0f, 4.0f, -2.0f, 4.0f, 0.0f,  //
+                              1.0f, nan, 4.0f, -2.0f, 4.0f, 0.0f,  //
+                              1.0f, 3.0f, 2.0f, -2.0f, 0.0f, nan};
+  tflite::testing::TestMatchesReference(input_dims, input_data, -1, true);
+  tflite::testing::TestMatchesReference(input_dims, input_data, -1, false);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,586 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernel_tuner.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/node_weights.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/compressed_filter.h"
+#include "tensorflow/lite/micro/testing/float16_weights.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/slow_memory_copy_engine.h"
+#include "tensorflow/lite/micro/thread_pool_executor.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+// Index of the "winograd" variant among the int8 variants in
+// micro/kernels/conv.cc. It only runs when a KernelTuner selects it.
+constexpr int kWinogradVariant = 4;
+
+constexpr int kMaxInputSize = 9 * 11 * 8;
+constexpr int kMaxFilterSize = 6 * 3 * 3 * 20;
+// PackedO4I16Size() of the largest filter.
+constexpr int kMaxPackedFilterSize = 8 * 3 * 3 * 32;
+// Largest filter compressed with 4-bit indices, one palette per channel.
+constexpr int kMaxCompressedFilterSize = kMaxFilterSize + 6 * 16;
+constexpr int kMaxOutputSize = 9 * 11 * 6;
+constexpr int kMaxOutputChannels = 6;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+struct ConvCase {
+  TfLitePadding padding;
+  int stride;
+  int dilation;
+  int input_height;
+  int input_width;
+  int input_depth;
+  int output_depth;
+  // Every filter value is -127 or 127, the extremes of the transformed
+  // filter.
+  bool extreme_filter;
+  float output_scale;
+  uint32_t seed;
+};
+
+// External contexts installed on the kernel, nullptr for none.
+struct ConvEnvironment {
+  KernelTuner* tuner;
+  WeightCopyEngine* copy_engine;
+  ParallelExecutor* executor;
+  int num_threads;
+  // Runs on kPackedWeightsO4I16 weights packed like tools/pack_weights.cc
+  // does, with the filter tensor aliased to the packed data.
+  bool packed;
+  // If > 0, draws the filter from 2^index_bits values per tile of
+  // `tile_channels` output channels and runs on it palette compressed, with
+  // the filter tensor holding the compressed stream.
+  int index_bits;
+  int tile_channels;
+};
+
+// Runs a 3x3 CONV_2D in `environment` and compares it with
+// reference_integer_ops::ConvPerChannel on the same random int8 data.
+void TestConvMatchesReference(const ConvCase& test_case,
+                              const ConvEnvironment& environment) {
+  const int stride = test_case.stride;
+  const int dilation = test_case.dilation;
+  const int input_height = test_case.input_height;
+  const int input_width = test_case.input_width;
+  const int input_depth = test_case.input_depth;
+  const int output_depth = test_case.output_depth;
+  int output_height;
+  int output_width;
+  const TfLitePaddingValues padding = ComputePaddingHeightWidth(
+      stride, stride, dilation, dilation, input_height, input_width,
+      /*filter_height=*/3, /*filter_width=*/3, test_case.padding,
+      &output_height, &output_width);
+
+  const int input_size = input_height * input_width * input_depth;
+  const int filter_size = output_depth * 3 * 3 * input_depth;
+  const int output_size = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(filter_size, kMaxFilterSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxOutputChannels);
+
+  const float input_scale = 0.05f;
+  const int input_zero_point = -3;
+  const int output_zero_point = 5;
+  Random random(test_case.seed);
+  int8_t input_data[kMaxInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<int8_t>(random.Next(-128, 127));
+  }
+  const int channel_size = 3 * 3 * input_depth;
+  int8_t filter_data[kMaxFilterSize];
+  for (int i = 0; i < filter_size; ++i) {
+    if (environment.index_bits > 0) {
+      filter_data[i] = TestPaletteValue(
+          i / (environment.tile_channels * channel_size),
+          random.Next(0, (1 << environment.index_bits) - 1));
+    } else {
+      filter_data[i] =
+          static_cast<int8_t>(test_case.extreme_filter
+                                  ? (random.Next(0, 1) == 0 ? -127 : 127)
+                                  : random.Next(-127, 127));
+    }
+  }
+  int32_t bias_data[kMaxOutputChannels];
+  float filter_scales[kMaxOutputChannels + 1] = {
+      static_cast<float>(output_depth)};
+  int filter_zero_points[kMaxOutputChannels + 1] = {output_depth};
+  for (int c = 0; c < output_depth; ++c) {
+    bias_data[c] = random.Next(-2000, 2000);
+    filter_scales[c + 1] = 0.01f * static_cast<float>(c + 1);
+    filter_zero_points[c + 1] = 0;
+  }
+
+  int input_shape[] = {4, 1, input_height, input_width, input_depth};
+  int filter_shape[] = {4, output_depth, 3, 3, input_depth};
+  int bias_shape[] = {1, output_depth};
+  int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  TfLiteAffineQuantization filter_quantization = {
+      FloatArrayFromFloats(filter_scales), IntArrayFromInts(filter_zero_points),
+      0};
+  int8_t output_data[kMaxOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, IntArrayFromInts(input_shape),
+                            input_scale, input_zero_point),
+      CreateQuantizedTensor(filter_data, IntArrayFromInts(filter_shape), 1.0f,
+                            0),
+      CreateInt32Tensor(bias_data, IntArrayFromInts(bias_shape)),
+      CreateQuantizedTensor(output_data, IntArrayFromInts(output_shape),
+                            test_case.output_scale, output_zero_point),
+  };
+  tensors[1].quantization = {kTfLiteAffineQuantization, &filter_quantization};
+  // Only constant filters are transformed or prefetched.
+  tensors[1].allocation_type = kTfLiteMmapRo;
+
+  static int8_t packed_filter[kMaxPackedFilterSize];
+  int32_t effective_bias[kMaxOutputChannels];
+  const int packed_size = PackedO4I16Size(output_depth, 9, input_depth);
+  TF_LITE_MICRO_EXPECT_LE(packed_size, kMaxPackedFilterSize);
+  const PackedWeights packed = {kPackedWeightsO4I16, packed_filter,
+                                packed_size, effective_bias, output_depth};
+  const NodeWeights weights = {&packed, nullptr};
+  if (environment.packed) {
+    std::fill(packed_filter, packed_filter + packed_size, 0);
+    for (int c = 0; c < output_depth; ++c) {
+      effective_bias[c] = bias_data[c];
+      for (int tap = 0; tap < 9; ++tap) {
+        for (int d = 0; d < input_depth; ++d) {
+          const int8_t value = filter_data[(c * 9 + tap) * input_depth + d];
+          packed_filter[PackedO4I16Offset(c, tap, d, 9, input_depth)] = value;
+          effective_bias[c] -= input_zero_point * value;
+        }
+      }
+    }
+    tensors[1].data.int8 = packed_filter;
+  }
+
+  static uint8_t compressed_filter[kMaxCompressedFilterSize];
+  CompressedWeights compressed = {kCompressedWeightsPalette,
+                                  environment.index_bits,
+                                  environment.tile_channels, compressed_filter,
+                                  0};
+  const NodeWeights compressed_weights = {nullptr, &compressed};
+  if (environment.index_bits > 0) {
+    compressed.data_size =
+        CompressedWeightsSize(environment.index_bits,
+                              environment.tile_channels, output_depth,
+                              channel_size);
+    TF_LITE_MICRO_EXPECT_LE(compressed.data_size, kMaxCompressedFilterSize);
+    TF_LITE_MICRO_EXPECT(CompressFilter(filter_data, output_depth,
+                                        channel_size, environment.index_bits,
+                                        environment.tile_channels,
+                                        compressed_filter));
+    tensors[1].data.raw = reinterpret_cast<char*>(compressed_filter);
+  }
+
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  TfLiteConvParams params = {test_case.padding, stride,   stride,
+                             kTfLiteActNone,    dilation, dilation};
+  const TfLiteRegistration registration = ops::micro::Register_CONV_2D();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  runner.SetExternalContext(kTfLiteMicroKernelTunerContext,
+                            environment.tuner);
+  runner.SetExternalContext(kTfLiteMicroWeightCopyContext,
+                            environment.copy_engine);
+  runner.SetExternalContext(kTfLiteMicroParallelContext, environment.executor);
+  runner.SetNumThreads(environment.num_threads);
+  if (environment.packed) {
+    runner.SetNodeWeights(&weights);
+  } else if (environment.index_bits > 0) {
+    runner.SetNodeWeights(&compressed_weights);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  ConvParams op_params;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.stride_width = stride;
+  op_params.stride_height = stride;
+  op_params.dilation_width_factor = dilation;
+  op_params.dilation_height_factor = dilation;
+  op_params.input_offset = -input_zero_point;
+  op_params.output_offset = output_zero_point;
+  op_params.quantized_activation_min = -128;
+  op_params.quantized_activation_max = 127;
+  int32_t output_multiplier[kMaxOutputChannels];
+  int32_t output_shift[kMaxOutputChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    const double effective_scale =
+        static_cast<double>(input_scale) *
+        static_cast<double>(filter_scales[c + 1]) /
+        static_cast<double>(test_case.output_scale);
+    int shift;
+    QuantizeMultiplier(effective_scale, &output_multiplier[c], &shift);
+    output_shift[c] = shift;
+  }
+  int8_t expected_data[kMaxOutputSize];
+  reference_integer_ops::ConvPerChannel(
+      op_params, output_multiplier, output_shift,
+      RuntimeShape(4, input_shape + 1), input_data,
+      RuntimeShape(4, filter_shape + 1), filter_data,
+      RuntimeShape(1, bias_shape + 1), bias_data,
+      RuntimeShape(4, output_shape + 1), expected_data);
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+// Selects the Winograd variant through a loaded tuning decision.
+void TestWinogradMatchesReference(const ConvCase& test_case) {
+  KernelTuningDecision decisions[] = {
+      {BuiltinOperator_CONV_2D, kWinogradVariant}};
+  KernelTuner tuner(decisions, 1);
+  tuner.UseDecisions(1);
+  TestConvMatchesReference(test_case,
+                           {&tuner, nullptr, nullptr, 1, false, 0, 0});
+}
+
+// Streams the filter from slow memory in tiles of `tile_channels` output
+// channels.
+void TestPrefetchMatchesReference(const ConvCase& test_case,
+                                  int tile_channels, int num_threads) {
+  SlowMemoryCopyEngine copy_engine(
+      /*delay_per_byte=*/1, tile_channels * 3 * 3 * test_case.input_depth);
+  ThreadPoolExecutor executor(num_threads);
+  TestConvMatchesReference(
+      test_case, {nullptr, &copy_engine,
+                  num_threads > 1 ? &executor : nullptr, num_threads,
+                  false, 0, 0});
+  const int num_tiles =
+      (test_case.output_depth + tile_channels - 1) / tile_channels;
+  TF_LITE_MICRO_EXPECT_EQ(num_tiles, copy_engine.copy_count());
+}
+
+// Runs a dilated convolution on `num_threads` threads, which takes the
+// "dilated" variant unless the input is shallow.
+void TestDilatedMatchesReference(const ConvCase& test_case, int num_threads) {
+  ThreadPoolExecutor executor(num_threads);
+  TestConvMatchesReference(
+      test_case,
+      {nullptr, nullptr, num_threads > 1 ? &executor : nullptr, num_threads,
+       false, 0, 0});
+}
+
+// Runs on pre-packed weights on `num_threads` threads.
+void TestPackedMatchesReference(const ConvCase& test_case, int num_threads) {
+  ThreadPoolExecutor executor(num_threads);
+  TestConvMatchesReference(test_case,
+                           {nullptr, nullptr,
+                            num_threads > 1 ? &executor : nullptr, num_threads,
+                            /*packed=*/true, 0, 0});
+}
+
+// Runs on a filter palette compressed with `index_bits` bits per weight in
+// tiles of `tile_channels` output channels. With several threads the next
+// tile is decoded while the current one is computed.
+void TestCompressedMatchesReference(const ConvCase& test_case, int index_bits,
+                                    int tile_channels, int num_threads) {
+  ThreadPoolExecutor executor(num_threads);
+  TestConvMatchesReference(
+      test_case, {nullptr, nullptr, num_threads > 1 ? &executor : nullptr,
+                  num_threads, false, index_bits, tile_channels});
+}
+
+constexpr int kMaxFloatInputSize = 6 * 7 * 48;
+constexpr int kMaxFloatFilterSize = 5 * 3 * 3 * 48;
+constexpr int kMaxFloatOutputSize = 6 * 7 * 6;
+
+// Runs a 3x3 float CONV_2D on a constant float16 filter and, with
+// `float16_bias`, bias, and compares it with reference_ops::Conv on float32
+// copies of the same values. With `has_bias` false the node has no bias.
+void TestFloat16MatchesFloat(const ConvCase& test_case, bool has_bias,
+                             bool float16_bias) {
+  const int stride = test_case.stride;
+  const int dilation = test_case.dilation;
+  const int input_height = test_case.input_height;
+  const int input_width = test_case.input_width;
+  const int input_depth = test_case.input_depth;
+  const int output_depth = test_case.output_depth;
+  int output_height;
+  int output_width;
+  const TfLitePaddingValues padding = ComputePaddingHeightWidth(
+      stride, stride, dilation, dilation, input_height, input_width,
+      /*filter_height=*/3, /*filter_width=*/3, test_case.padding,
+      &output_height, &output_width);
+
+  const int input_size = input_height * input_width * input_depth;
+  const int filter_size = output_depth * 3 * 3 * input_depth;
+  const int output_size = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxFloatInputSize);
+  TF_LITE_MICRO_EXPECT_LE(filter_size, kMaxFloatFilterSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxFloatOutputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxOutputChannels);
+
+  // Multiples of 1/64, exactly representable as float16.
+  Random random(test_case.seed);
+  float input_data[kMaxFloatInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  float filter_data[kMaxFloatFilterSize];
+  for (int i = 0; i < filter_size; ++i) {
+    filter_data[i] = static_cast<float>(random.Next(-64, 64)) / 64.0f;
+  }
+  float bias_data[kMaxOutputChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    bias_data[c] = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  TfLiteFloat16 half_filter[kMaxFloatFilterSize];
+  FloatsToHalves(filter_data, filter_size, half_filter);
+  TfLiteFloat16 half_bias[kMaxOutputChannels];
+  FloatsToHalves(bias_data, output_depth, half_bias);
+
+  int input_shape[] = {4, 1, input_height, input_width, input_depth};
+  int filter_shape[] = {4, output_depth, 3, 3, input_depth};
+  int bias_shape[] = {1, output_depth};
+  int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  float output_data[kMaxFloatOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateFloatTensor(input_data, IntArrayFromInts(input_shape)),
+      CreateFloat16Tensor(half_filter, IntArrayFromInts(filter_shape)),
+      float16_bias
+          ? CreateFloat16Tensor(half_bias, IntArrayFromInts(bias_shape))
+          : CreateFloatTensor(bias_data, IntArrayFromInts(bias_shape)),
+      CreateFloatTensor(output_data, IntArrayFromInts(output_shape)),
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int inputs_without_bias_array_data[] = {2, 0, 1};
+  int outputs_array_data[] = {1, 3};
+  TfLiteConvParams params = {test_case.padding, stride,   stride,
+                             kTfLiteActRelu6,   dilation, dilation};
+  const TfLiteRegistration registration = ops::micro::Register_CONV_2D();
+  micro::KernelRunner runner(
+      registration, tensors, 4,
+      IntArrayFromInts(has_bias ? inputs_array_data
+                                : inputs_without_bias_array_data),
+      IntArrayFromInts(outputs_array_data), &params, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  ConvParams op_params;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.stride_width = stride;
+  op_params.stride_height = stride;
+  op_params.dilation_width_factor = dilation;
+  op_params.dilation_height_factor = dilation;
+  op_params.float_activation_min = 0.0f;
+  op_params.float_activation_max = 6.0f;
+  float expected_data[kMaxFloatOutputSize];
+  reference_ops::Conv(op_params, RuntimeShape(4, input_shape + 1), input_data,
+                      RuntimeShape(4, filter_shape + 1), filter_data,
+                      RuntimeShape(1, bias_shape + 1),
+                      has_bias ? bias_data : nullptr,
+                      RuntimeShape(4, output_shape + 1), expected_data,
+                      RuntimeShape(), nullptr);
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(WinogradSamePaddingOddOutput) {
+  tflite::testing::TestWinogradMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 5, 7, 4, 3, false, 0.5f, 1});
+}
+
+TF_LITE_MICRO_TEST(WinogradSamePaddingEvenOutput) {
+  tflite::testing::TestWinogradMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 6, 8, 3, 4, false, 0.5f, 2});
+}
+
+TF_LITE_MICRO_TEST(WinogradValidPaddingOddOutput) {
+  tflite::testing::TestWinogradMatchesReference(
+      {kTfLitePaddingValid, 1, 1, 9, 11, 8, 5, false, 2.0f, 3});
+}
+
+TF_LITE_MICRO_TEST(WinogradValidPaddingEvenOutput) {
+  tflite::testing::TestWinogradMatchesReference(
+      {kTfLitePaddingValid, 1, 1, 8, 6, 2, 2, false, 0.5f, 4});
+}
+
+TF_LITE_MICRO_TEST(WinogradExtremeFilterSamePadding) {
+  tflite::testing::TestWinogradMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 7, 5, 8, 6, true, 4.0f, 5});
+}
+
+TF_LITE_MICRO_TEST(WinogradExtremeFilterValidPadding) {
+  tflite::testing::TestWinogradMatchesReference(
+      {kTfLitePaddingValid, 1, 1, 7, 9, 8, 6, true, 4.0f, 6});
+}
+
+TF_LITE_MICRO_TEST(PrefetchedFilterSamePadding) {
+  tflite::testing::TestPrefetchMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 5, 7, 4, 5, false, 0.5f, 7},
+      /*tile_channels=*/2, /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PrefetchedFilterValidPaddingStride2) {
+  tflite::testing::TestPrefetchMatchesReference(
+      {kTfLitePaddingValid, 2, 1, 9, 11, 8, 6, false, 2.0f, 8},
+      /*tile_channels=*/1, /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PrefetchedFilterWithThreads) {
+  tflite::testing::TestPrefetchMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 7, 5, 8, 6, false, 2.0f, 9},
+      /*tile_channels=*/4, /*num_threads=*/4);
+}
+
+// Interior and border pixels, with a partial block of four output channels.
+TF_LITE_MICRO_TEST(DilatedSamePadding) {
+  tflite::testing::TestDilatedMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 9, 11, 8, 6, false, 2.0f, 10}, 1);
+}
+
+TF_LITE_MICRO_TEST(DilatedValidPaddingStride2) {
+  tflite::testing::TestDilatedMatchesReference(
+      {kTfLitePaddingValid, 2, 2, 9, 11, 5, 5, false, 1.0f, 11}, 1);
+}
+
+// No interior column: the window is wider than the input.
+TF_LITE_MICRO_TEST(DilatedWindowWiderThanInput) {
+  tflite::testing::TestDilatedMatchesReference(
+      {kTfLitePaddingSame, 1, 3, 9, 5, 6, 3, false, 1.0f, 12}, 1);
+}
+
+TF_LITE_MICRO_TEST(DilatedWithThreads) {
+  tflite::testing::TestDilatedMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 9, 11, 8, 6, true, 4.0f, 13}, 3);
+}
+
+// Partial blocks of four output channels and of 16 input channels, with
+// taps in the padding area.
+TF_LITE_MICRO_TEST(PackedSamePadding) {
+  tflite::testing::TestPackedMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 5, 7, 8, 6, false, 2.0f, 14}, 1);
+}
+
+// Two blocks of input channels.
+TF_LITE_MICRO_TEST(PackedValidPaddingStride2) {
+  tflite::testing::TestPackedMatchesReference(
+      {kTfLitePaddingValid, 2, 1, 5, 6, 20, 6, false, 4.0f, 15}, 1);
+}
+
+TF_LITE_MICRO_TEST(PackedDilatedWithThreads) {
+  tflite::testing::TestPackedMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 6, 5, 20, 5, false, 4.0f, 16}, 2);
+}
+
+// One channel per tile, whose 27 4-bit indices end in half a byte.
+TF_LITE_MICRO_TEST(CompressedFourBitChannelTiles) {
+  tflite::testing::TestCompressedMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 5, 7, 3, 6, false, 2.0f, 17},
+      /*index_bits=*/4, /*tile_channels=*/1, /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(CompressedTwoBitPartialLastTile) {
+  tflite::testing::TestCompressedMatchesReference(
+      {kTfLitePaddingValid, 2, 1, 9, 11, 8, 6, false, 2.0f, 18},
+      /*index_bits=*/2, /*tile_channels=*/4, /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(CompressedOneBitPartialLastTile) {
+  tflite::testing::TestCompressedMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 7, 5, 3, 5, false, 1.0f, 19},
+      /*index_bits=*/1, /*tile_channels=*/2, /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(CompressedPipelined) {
+  tflite::testing::TestCompressedMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 7, 5, 8, 6, false, 2.0f, 20},
+      /*index_bits=*/4, /*tile_channels=*/2, /*num_threads=*/3);
+}
+
+TF_LITE_MICRO_TEST(CompressedPipelinedPartialLastTile) {
+  tflite::testing::TestCompressedMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 9, 11, 8, 5, false, 2.0f, 21},
+      /*index_bits=*/2, /*tile_channels=*/2, /*num_threads=*/2);
+}
+
+// 3x3x48 float channels, two per 4 KB tile, the last tile partial.
+TF_LITE_MICRO_TEST(Float16WeightsPartialLastTile) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingSame, 1, 1, 6, 7, 48, 5, false, 0.0f, 40},
+      /*has_bias=*/true, /*float16_bias=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16WeightsOneTileStride2) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingValid, 2, 1, 6, 7, 4, 6, false, 0.0f, 41},
+      /*has_bias=*/true, /*float16_bias=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16FilterFloatBiasDilated) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingSame, 1, 2, 6, 7, 8, 3, false, 0.0f, 42},
+      /*has_bias=*/true, /*float16_bias=*/false);
+}
+
+TF_LITE_MICRO_TEST(Float16FilterWithoutBias) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingSame, 1, 1, 5, 5, 48, 4, false, 0.0f, 43},
+      /*has_bias=*/false, /*float16_bias=*/false);
+}
+
+TF_LITE_MICRO_TESTS_END
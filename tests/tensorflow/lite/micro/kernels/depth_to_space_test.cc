@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+template <typename T>
+void ValidateDepthToSpace(TfLiteTensor* tensors, int block_size,
+                          const T* expected_data, T* output_data,
+                          int output_size) {
+  int inputs_array_data[] = {1, 0};
+  int outputs_array_data[] = {1, 1};
+  TfLiteDepthToSpaceParams params = {block_size};
+  const TfLiteRegistration registration =
+      ops::micro::Register_DEPTH_TO_SPACE();
+  micro::KernelRunner runner(registration, tensors, 2,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(ShufflesDepthIntoBlocksFloat) {
+  int input_shape[] = {4, 1, 2, 2, 4};
+  const float input_data[] = {1, 2,  5,  6,  3,  4,  7,  8,
+                              9, 10, 13, 14, 11, 12, 15, 16};
+  int output_shape[] = {4, 1, 4, 4, 1};
+  const float expected_data[] = {1, 2,  3,  4,  5,  6,  7,  8,
+                                 9, 10, 11, 12, 13, 14, 15, 16};
+  float output_data[16];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateFloatTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape)),
+      tflite::testing::CreateFloatTensor(
+          output_data, tflite::testing::IntArrayFromInts(output_shape)),
+  };
+  tflite::testing::ValidateDepthToSpace(tensors, 2, expected_data,
+                                        output_data, 16);
+}
+
+TF_LITE_MICRO_TEST(ShufflesDepthIntoBlocksInt8) {
+  int input_shape[] = {4, 2, 1, 1, 8};
+  const int8_t input_data[] = {1, -1, 2, -2, 3, -3, 4, -4,
+                               5, -5, 6, -6, 7, -7, 8, -8};
+  int output_shape[] = {4, 2, 2, 2, 2};
+  int8_t output_data[16];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape), 0.5f, 0),
+      tflite::testing::CreateQuantizedTensor(
+          output_data, tflite::testing::IntArrayFromInts(output_shape), 0.5f,
+          0),
+  };
+  // One block per batch keeps the flat element order.
+  tflite::testing::ValidateDepthToSpace(tensors, 2, input_data, output_data,
+                                        16);
+}
+
+TF_LITE_MICRO_TEST(ShufflesDepthIntoBlocksWideInput) {
+  int input_shape[] = {4, 1, 1, 2, 4};
+  const int8_t input_data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  int output_shape[] = {4, 1, 2, 4, 1};
+  const int8_t expected_data[] = {1, 2, 5, 6, 3, 4, 7, 8};
+  int8_t output_data[8];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape), 1.0f, 0),
+      tflite::testing::CreateQuantizedTensor(
+          output_data, tflite::testing::IntArrayFromInts(output_shape), 1.0f,
+          0),
+  };
+  tflite::testing::ValidateDepthToSpace(tensors, 2, expected_data,
+                                        output_data, 8);
+}
+
+TF_LITE_MICRO_TEST(BlockSizeOneKeepsLayout) {
+  int shape[] = {4, 1, 2, 2, 2};
+  const float input_data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  float output_data[8];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateFloatTensor(
+          input_data, tflite::testing::IntArrayFromInts(shape)),
+      tflite::testing::CreateFloatTensor(
+          output_data, tflite::testing::IntArrayFromInts(shape)),
+  };
+  tflite::testing::ValidateDepthToSpace(tensors, 1, input_data, output_data,
+                                        8);
+}
+
+TF_LITE_MICRO_TESTS_END
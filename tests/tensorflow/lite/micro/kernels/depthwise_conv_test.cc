@@ -0,0 +1,403 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/depthwiseconv_float.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/node_weights.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/float16_weights.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/thread_pool_executor.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxInputSize = 10 * 9 * 20;
+constexpr int kMaxOutputChannels = 32;
+constexpr int kMaxFilterSize = 3 * 3 * kMaxOutputChannels;
+constexpr int kMaxOutputSize = 10 * 9 * kMaxOutputChannels;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+struct DepthwiseConvCase {
+  TfLitePadding padding;
+  int stride;
+  int dilation;
+  int input_height;
+  int input_width;
+  int input_depth;
+  int depth_multiplier;
+  TfLiteFusedActivation activation;
+  uint32_t seed;
+};
+
+// Runs a 3x3 int8 DEPTHWISE_CONV_2D on `num_threads` threads and compares it
+// with reference_integer_ops::DepthwiseConvPerChannel on the same random
+// data. With `packed` the kernel runs on kPackedWeightsC16 weights packed
+// like tools/pack_weights.cc does, with the filter tensor aliased to the
+// packed data.
+void TestDepthwiseMatchesReference(const DepthwiseConvCase& test_case,
+                                   int num_threads, bool packed = false) {
+  const int input_depth = test_case.input_depth;
+  const int output_depth = input_depth * test_case.depth_multiplier;
+  int output_height;
+  int output_width;
+  const TfLitePaddingValues padding = ComputePaddingHeightWidth(
+      test_case.stride, test_case.stride, test_case.dilation,
+      test_case.dilation, test_case.input_height, test_case.input_width,
+      /*filter_height=*/3, /*filter_width=*/3, test_case.padding,
+      &output_height, &output_width);
+
+  const int input_size =
+      test_case.input_height * test_case.input_width * input_depth;
+  const int filter_size = 3 * 3 * output_depth;
+  const int output_size = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(filter_size, kMaxFilterSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+
+  const float input_scale = 0.05f;
+  const int input_zero_point = 6;
+  const float output_scale = 0.2f;
+  const int output_zero_point = -9;
+  Random random(test_case.seed);
+  int8_t input_data[kMaxInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<int8_t>(random.Next(-128, 127));
+  }
+  int8_t filter_data[kMaxFilterSize];
+  for (int i = 0; i < filter_size; ++i) {
+    filter_data[i] = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  int32_t bias_data[kMaxOutputChannels];
+  float filter_scales[kMaxOutputChannels + 1] = {
+      static_cast<float>(output_depth)};
+  int filter_zero_points[kMaxOutputChannels + 1] = {output_depth};
+  for (int c = 0; c < output_depth; ++c) {
+    bias_data[c] = random.Next(-5000, 5000);
+    filter_scales[c + 1] = 0.005f * static_cast<float>(c % 7 + 1);
+    filter_zero_points[c + 1] = 0;
+  }
+
+  int input_shape[] = {4, 1, test_case.input_height, test_case.input_width,
+                       input_depth};
+  int filter_shape[] = {4, 1, 3, 3, output_depth};
+  int bias_shape[] = {1, output_depth};
+  int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  TfLiteAffineQuantization filter_quantization = {
+      FloatArrayFromFloats(filter_scales), IntArrayFromInts(filter_zero_points),
+      3};
+  int8_t output_data[kMaxOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, IntArrayFromInts(input_shape),
+                            input_scale, input_zero_point),
+      CreateQuantizedTensor(filter_data, IntArrayFromInts(filter_shape), 1.0f,
+                            0),
+      CreateInt32Tensor(bias_data, IntArrayFromInts(bias_shape)),
+      CreateQuantizedTensor(output_data, IntArrayFromInts(output_shape),
+                            output_scale, output_zero_point),
+  };
+  tensors[1].quantization = {kTfLiteAffineQuantization, &filter_quantization};
+  tensors[1].allocation_type = kTfLiteMmapRo;
+
+  int8_t packed_filter[kMaxFilterSize];
+  int32_t effective_bias[kMaxOutputChannels];
+  const int packed_size = PackedC16Size(output_depth, 9);
+  TF_LITE_MICRO_EXPECT_LE(packed_size, kMaxFilterSize);
+  const PackedWeights packed_weights = {kPackedWeightsC16, packed_filter,
+                                        packed_size, effective_bias,
+                                        output_depth};
+  const NodeWeights weights = {&packed_weights, nullptr};
+  if (packed) {
+    std::fill(packed_filter, packed_filter + packed_size, 0);
+    for (int c = 0; c < output_depth; ++c) {
+      effective_bias[c] = bias_data[c];
+      for (int tap = 0; tap < 9; ++tap) {
+        const int8_t value = filter_data[tap * output_depth + c];
+        packed_filter[PackedC16Offset(c, tap, 9)] = value;
+        effective_bias[c] -= input_zero_point * value;
+      }
+    }
+    tensors[1].data.int8 = packed_filter;
+  }
+
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  TfLiteDepthwiseConvParams params = {
+      test_case.padding,          test_case.stride,     test_case.stride,
+      test_case.depth_multiplier, test_case.activation, test_case.dilation,
+      test_case.dilation};
+  ThreadPoolExecutor executor(num_threads);
+  const TfLiteRegistration registration =
+      ops::micro::Register_DEPTHWISE_CONV_2D();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  if (num_threads > 1) {
+    runner.SetExternalContext(kTfLiteMicroParallelContext, &executor);
+  }
+  runner.SetNumThreads(num_threads);
+  if (packed) {
+    runner.SetNodeWeights(&weights);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  DepthwiseParams op_params;
+  op_params.padding_type = PaddingType::kSame;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.stride_width = test_case.stride;
+  op_params.stride_height = test_case.stride;
+  op_params.dilation_width_factor = test_case.dilation;
+  op_params.dilation_height_factor = test_case.dilation;
+  op_params.depth_multiplier = test_case.depth_multiplier;
+  op_params.input_offset = -input_zero_point;
+  op_params.weights_offset = 0;
+  op_params.output_offset = output_zero_point;
+  // Like the kernel, only clamps to the int8 range.
+  op_params.quantized_activation_min = -128;
+  op_params.quantized_activation_max = 127;
+  int32_t output_multiplier[kMaxOutputChannels];
+  int32_t output_shift[kMaxOutputChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    const double effective_scale = static_cast<double>(input_scale) *
+                                   static_cast<double>(filter_scales[c + 1]) /
+                                   static_cast<double>(output_scale);
+    int shift;
+    QuantizeMultiplier(effective_scale, &output_multiplier[c], &shift);
+    output_shift[c] = shift;
+  }
+  int8_t expected_data[kMaxOutputSize];
+  reference_integer_ops::DepthwiseConvPerChannel(
+      op_params, output_multiplier, output_shift,
+      RuntimeShape(4, input_shape + 1), input_data,
+      RuntimeShape(4, filter_shape + 1), filter_data,
+      RuntimeShape(1, bias_shape + 1), bias_data,
+      RuntimeShape(4, output_shape + 1), expected_data);
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+// Runs a 3x3 float DEPTHWISE_CONV_2D on a constant float16 filter and, with
+// `float16_bias`, bias, and compares it with reference_ops::DepthwiseConv on
+// float32 copies of the same values.
+void TestFloat16MatchesFloat(const DepthwiseConvCase& test_case,
+                             bool float16_bias) {
+  const int input_depth = test_case.input_depth;
+  const int output_depth = input_depth * test_case.depth_multiplier;
+  int output_height;
+  int output_width;
+  const TfLitePaddingValues padding = ComputePaddingHeightWidth(
+      test_case.stride, test_case.stride, test_case.dilation,
+      test_case.dilation, test_case.input_height, test_case.input_width,
+      /*filter_height=*/3, /*filter_width=*/3, test_case.padding,
+      &output_height, &output_width);
+
+  const int input_size =
+      test_case.input_height * test_case.input_width * input_depth;
+  const int filter_size = 3 * 3 * output_depth;
+  const int output_size = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(filter_size, kMaxFilterSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+
+  // Multiples of 1/64, exactly representable as float16.
+  Random random(test_case.seed);
+  float input_data[kMaxInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  float filter_data[kMaxFilterSize];
+  for (int i = 0; i < filter_size; ++i) {
+    filter_data[i] = static_cast<float>(random.Next(-64, 64)) / 64.0f;
+  }
+  float bias_data[kMaxOutputChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    bias_data[c] = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  TfLiteFloat16 half_filter[kMaxFilterSize];
+  FloatsToHalves(filter_data, filter_size, half_filter);
+  TfLiteFloat16 half_bias[kMaxOutputChannels];
+  FloatsToHalves(bias_data, output_depth, half_bias);
+
+  int input_shape[] = {4, 1, test_case.input_height, test_case.input_width,
+                       input_depth};
+  int filter_shape[] = {4, 1, 3, 3, output_depth};
+  int bias_shape[] = {1, output_depth};
+  int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  float output_data[kMaxOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateFloatTensor(input_data, IntArrayFromInts(input_shape)),
+      CreateFloat16Tensor(half_filter, IntArrayFromInts(filter_shape)),
+      float16_bias
+          ? CreateFloat16Tensor(half_bias, IntArrayFromInts(bias_shape))
+          : CreateFloatTensor(bias_data, IntArrayFromInts(bias_shape)),
+      CreateFloatTensor(output_data, IntArrayFromInts(output_shape)),
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  TfLiteDepthwiseConvParams params = {
+      test_case.padding,          test_case.stride,     test_case.stride,
+      test_case.depth_multiplier, test_case.activation, test_case.dilation,
+      test_case.dilation};
+  const TfLiteRegistration registration =
+      ops::micro::Register_DEPTHWISE_CONV_2D();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  DepthwiseParams op_params;
+  op_params.padding_type = PaddingType::kSame;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.stride_width = test_case.stride;
+  op_params.stride_height = test_case.stride;
+  op_params.dilation_width_factor = test_case.dilation;
+  op_params.dilation_height_factor = test_case.dilation;
+  op_params.depth_multiplier = test_case.depth_multiplier;
+  CalculateActivationRange(test_case.activation,
+                           &op_params.float_activation_min,
+                           &op_params.float_activation_max);
+  float expected_data[kMaxOutputSize];
+  reference_ops::DepthwiseConv(
+      op_params, RuntimeShape(4, input_shape + 1), input_data,
+      RuntimeShape(4, filter_shape + 1), filter_data,
+      RuntimeShape(1, bias_shape + 1), bias_data,
+      RuntimeShape(4, output_shape + 1), expected_data);
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(DepthMultiplier2SamePadding) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 10, 9, 4, 2, kTfLiteActNone, 1}, 1);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier4ValidPaddingStride2) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingValid, 2, 1, 10, 9, 3, 4, kTfLiteActNone, 2}, 1);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier8Dilated) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 9, 8, 4, 8, kTfLiteActNone, 3}, 1);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier2IgnoresActivation) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 2, 1, 7, 7, 2, 2, kTfLiteActRelu6, 4}, 1);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier4Threaded) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 10, 9, 4, 4, kTfLiteActNone, 5}, 3);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier3UsesReference) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingValid, 1, 1, 6, 5, 3, 3, kTfLiteActNone, 6}, 1);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier1DilatedThreaded) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 10, 9, 4, 1, kTfLiteActNone, 7}, 2);
+}
+
+// Interior and border pixels, with a partial block of 16 channels.
+TF_LITE_MICRO_TEST(DepthMultiplier1DilatedWideInput) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 1, 2, 9, 8, 20, 1, kTfLiteActNone, 8}, 1);
+}
+
+TF_LITE_MICRO_TEST(DepthMultiplier1DilatedValidPaddingStride2) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingValid, 2, 3, 10, 9, 5, 1, kTfLiteActNone, 9}, 2);
+}
+
+// Partial blocks of 16 channels, with taps in the padding area.
+TF_LITE_MICRO_TEST(PackedSamePadding) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 1, 1, 9, 8, 20, 1, kTfLiteActNone, 10}, 1,
+      /*packed=*/true);
+}
+
+TF_LITE_MICRO_TEST(PackedDilatedStride2Threaded) {
+  tflite::testing::TestDepthwiseMatchesReference(
+      {kTfLitePaddingSame, 2, 2, 10, 9, 20, 1, kTfLiteActNone, 11}, 3,
+      /*packed=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16WeightsDepthMultiplier2) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingSame, 1, 1, 10, 9, 4, 2, kTfLiteActRelu6, 12},
+      /*float16_bias=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16WeightsDilatedStride2) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingValid, 2, 2, 10, 9, 20, 1, kTfLiteActNone, 13},
+      /*float16_bias=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16FilterFloatBias) {
+  tflite::testing::TestFloat16MatchesFloat(
+      {kTfLitePaddingSame, 1, 1, 7, 7, 3, 3, kTfLiteActRelu, 14},
+      /*float16_bias=*/false);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,286 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+// Writes the FlexBuffer map that the converter stores as the custom options
+// of TFLite_Detection_PostProcess, with every value inline in 32 bits. Keys
+// must be added in sorted order, since lookups binary search them.
+class CustomOptionsBuilder {
+ public:
+  void AddInt(const char* key, int value) {
+    Add(key, kTypeInt, static_cast<uint32_t>(value));
+  }
+
+  void AddBool(const char* key, bool value) {
+    Add(key, kTypeBool, value ? 1 : 0);
+  }
+
+  void AddFloat(const char* key, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Add(key, kTypeFloat, bits);
+  }
+
+  // Serializes the map and returns its size in bytes.
+  size_t Finish() {
+    size_t key_offsets[kMaxEntries];
+    for (int i = 0; i < num_entries_; ++i) {
+      key_offsets[i] = size_;
+      for (const char* c = keys_[i]; *c != '\0'; ++c) {
+        PutByte(static_cast<uint8_t>(*c));
+      }
+      PutByte(0);
+    }
+    Align();
+    PutWord(num_entries_);
+    const size_t keys_vector = size_;
+    for (int i = 0; i < num_entries_; ++i) {
+      PutWord(static_cast<uint32_t>(size_ - key_offsets[i]));
+    }
+    const size_t map_prefix = size_;
+    PutWord(static_cast<uint32_t>(map_prefix - keys_vector));
+    PutWord(4);
+    PutWord(num_entries_);
+    const size_t values = size_;
+    for (int i = 0; i < num_entries_; ++i) {
+      PutWord(values_[i]);
+    }
+    for (int i = 0; i < num_entries_; ++i) {
+      PutByte(static_cast<uint8_t>(types_[i] << 2));
+    }
+    PutWord(static_cast<uint32_t>(size_ - values));
+    PutByte((kTypeMap << 2) | kWidth32Bits);
+    PutByte(4);
+    return size_;
+  }
+
+  const char* data() const { return reinterpret_cast<const char*>(buffer_); }
+
+ private:
+  enum {
+    kTypeInt = 1,
+    kTypeFloat = 3,
+    kTypeMap = 9,
+    kTypeBool = 26,
+    kWidth32Bits = 2,
+    kMaxEntries = 16,
+  };
+
+  void Add(const char* key, int type, uint32_t value) {
+    keys_[num_entries_] = key;
+    types_[num_entries_] = type;
+    values_[num_entries_] = value;
+    ++num_entries_;
+  }
+
+  void PutByte(uint8_t value) { buffer_[size_++] = value; }
+
+  void PutWord(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      PutByte(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  }
+
+  void Align() {
+    while (size_ % 4 != 0) {
+      PutByte(0);
+    }
+  }
+
+  const char* keys_[kMaxEntries];
+  int types_[kMaxEntries];
+  uint32_t values_[kMaxEntries];
+  int num_entries_ = 0;
+  uint8_t buffer_[512];
+  size_t size_ = 0;
+};
+
+constexpr int kNumBoxes = 6;
+constexpr int kNumClassesWithBackground = 3;
+constexpr int kMaxDetections = 3;
+
+// Two clusters of overlapping boxes and one isolated box, the standard
+// TFLite fixture for this op.
+const float kBoxEncodings[kNumBoxes * 4] = {
+    0.0, 0.0,  0.0, 0.0,  //
+    0.0, 1.0,  0.0, 0.0,  //
+    0.0, -1.0, 0.0, 0.0,  //
+    0.0, 0.0,  0.0, 0.0,  //
+    0.0, 1.0,  0.0, 0.0,  //
+    0.0, 0.0,  0.0, 0.0,  //
+};
+const float kClassPredictions[kNumBoxes * kNumClassesWithBackground] = {
+    0.0, 0.9,  0.8,   //
+    0.0, 0.75, 0.72,  //
+    0.0, 0.6,  0.5,   //
+    0.0, 0.93, 0.95,  //
+    0.0, 0.5,  0.4,   //
+    0.0, 0.3,  0.2,   //
+};
+const float kAnchors[kNumBoxes * 4] = {
+    0.5, 0.5,   1.0, 1.0,  //
+    0.5, 0.5,   1.0, 1.0,  //
+    0.5, 0.5,   1.0, 1.0,  //
+    0.5, 10.5,  1.0, 1.0,  //
+    0.5, 10.5,  1.0, 1.0,  //
+    0.5, 100.5, 1.0, 1.0,  //
+};
+
+size_t BuildOptions(bool use_regular_nms, float score_threshold,
+                    CustomOptionsBuilder* builder) {
+  builder->AddInt("detections_per_class", 1);
+  builder->AddFloat("h_scale", 5.0f);
+  builder->AddInt("max_classes_per_detection", 1);
+  builder->AddInt("max_detections", kMaxDetections);
+  builder->AddFloat("nms_iou_threshold", 0.5f);
+  builder->AddFloat("nms_score_threshold", score_threshold);
+  builder->AddInt("num_classes", kNumClassesWithBackground - 1);
+  builder->AddBool("use_regular_nms", use_regular_nms);
+  builder->AddFloat("w_scale", 5.0f);
+  builder->AddFloat("x_scale", 10.0f);
+  builder->AddFloat("y_scale", 10.0f);
+  return builder->Finish();
+}
+
+// Runs the op on the fixture with class predictions quantized to `T` and
+// checks the four outputs.
+template <typename T>
+void TestDetectionPostprocess(bool use_regular_nms, float score_threshold,
+                              int zero_point, const float* expected_boxes,
+                              const float* expected_classes,
+                              const float* expected_scores,
+                              int expected_num_detections) {
+  int box_encodings_shape[] = {3, 1, kNumBoxes, 4};
+  int class_predictions_shape[] = {3, 1, kNumBoxes,
+                                   kNumClassesWithBackground};
+  int anchors_shape[] = {2, kNumBoxes, 4};
+  int boxes_shape[] = {3, 1, kMaxDetections, 4};
+  int detections_shape[] = {2, 1, kMaxDetections};
+  int num_detections_shape[] = {1, 1};
+
+  T class_predictions_quantized[kNumBoxes * kNumClassesWithBackground];
+  float boxes_data[kMaxDetections * 4];
+  float classes_data[kMaxDetections];
+  float scores_data[kMaxDetections];
+  float num_detections_data[1];
+  TfLiteIntArray* detections_dims = IntArrayFromInts(detections_shape);
+  TfLiteTensor tensors[] = {
+      CreateFloatTensor(kBoxEncodings, IntArrayFromInts(box_encodings_shape)),
+      CreateQuantizedTensor(kClassPredictions, class_predictions_quantized,
+                            IntArrayFromInts(class_predictions_shape), 0.01f,
+                            zero_point),
+      CreateFloatTensor(kAnchors, IntArrayFromInts(anchors_shape)),
+      CreateFloatTensor(boxes_data, IntArrayFromInts(boxes_shape)),
+      CreateFloatTensor(classes_data, detections_dims),
+      CreateFloatTensor(scores_data, detections_dims),
+      CreateFloatTensor(num_detections_data,
+                        IntArrayFromInts(num_detections_shape)),
+  };
+  tensors[2].allocation_type = kTfLiteMmapRo;
+
+  CustomOptionsBuilder options;
+  const size_t options_size =
+      BuildOptions(use_regular_nms, score_threshold, &options);
+
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {4, 3, 4, 5, 6};
+  micro::KernelRunner runner(*ops::micro::Register_DETECTION_POSTPROCESS(),
+                             tensors, 7, IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             /*builtin_data=*/nullptr, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          runner.InitAndPrepare(options.data(), options_size));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  TF_LITE_MICRO_EXPECT_NEAR(expected_num_detections, num_detections_data[0],
+                            1e-6f);
+  for (int i = 0; i < expected_num_detections; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      TF_LITE_MICRO_EXPECT_NEAR(expected_boxes[i * 4 + j],
+                                boxes_data[i * 4 + j], 1e-5f);
+    }
+    TF_LITE_MICRO_EXPECT_NEAR(expected_classes[i], classes_data[i], 1e-6f);
+    TF_LITE_MICRO_EXPECT_NEAR(expected_scores[i], scores_data[i], 1e-5f);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FastNmsUInt8Scores) {
+  const float expected_boxes[] = {0.0, 10.0, 1.0, 11.0, 0.0, 0.0,
+                                  1.0, 1.0,  0.0, 100.0, 1.0, 101.0};
+  const float expected_classes[] = {1, 0, 0};
+  const float expected_scores[] = {0.95, 0.9, 0.3};
+  tflite::testing::TestDetectionPostprocess<uint8_t>(
+      /*use_regular_nms=*/false, /*score_threshold=*/0.0f, /*zero_point=*/0,
+      expected_boxes, expected_classes, expected_scores, 3);
+}
+
+TF_LITE_MICRO_TEST(FastNmsInt8Scores) {
+  const float expected_boxes[] = {0.0, 10.0, 1.0, 11.0, 0.0, 0.0,
+                                  1.0, 1.0,  0.0, 100.0, 1.0, 101.0};
+  const float expected_classes[] = {1, 0, 0};
+  const float expected_scores[] = {0.95, 0.9, 0.3};
+  tflite::testing::TestDetectionPostprocess<int8_t>(
+      /*use_regular_nms=*/false, /*score_threshold=*/0.0f,
+      /*zero_point=*/-128, expected_boxes, expected_classes, expected_scores,
+      3);
+}
+
+TF_LITE_MICRO_TEST(FastNmsDropsScoresBelowThreshold) {
+  const float expected_boxes[] = {0.0, 10.0, 1.0, 11.0};
+  const float expected_classes[] = {1};
+  const float expected_scores[] = {0.95};
+  tflite::testing::TestDetectionPostprocess<uint8_t>(
+      /*use_regular_nms=*/false, /*score_threshold=*/0.92f,
+      /*zero_point=*/0, expected_boxes, expected_classes, expected_scores, 1);
+}
+
+TF_LITE_MICRO_TEST(RegularNmsUInt8Scores) {
+  const float expected_boxes[] = {0.0, 10.0, 1.0, 11.0, 0.0, 10.0, 1.0, 11.0};
+  const float expected_classes[] = {1, 0};
+  const float expected_scores[] = {0.95, 0.93};
+  tflite::testing::TestDetectionPostprocess<uint8_t>(
+      /*use_regular_nms=*/true, /*score_threshold=*/0.0f, /*zero_point=*/0,
+      expected_boxes, expected_classes, expected_scores, 2);
+}
+
+TF_LITE_MICRO_TEST(RegularNmsInt8Scores) {
+  const float expected_boxes[] = {0.0, 10.0, 1.0, 11.0, 0.0, 10.0, 1.0, 11.0};
+  const float expected_classes[] = {1, 0};
+  const float expected_scores[] = {0.95, 0.93};
+  tflite::testing::TestDetectionPostprocess<int8_t>(
+      /*use_regular_nms=*/true, /*score_threshold=*/0.0f,
+      /*zero_point=*/-128, expected_boxes, expected_classes, expected_scores,
+      2);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,252 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+// Largest error, in output steps, of the interpolated int16 tables.
+constexpr int kInt16Tolerance = 2;
+
+typedef float (*FloatFunc)(float);
+
+float Abs(float x) { return std::abs(x); }
+float Sin(float x) { return std::sin(x); }
+float Cos(float x) { return std::cos(x); }
+float Exp(float x) { return std::exp(x); }
+float Log(float x) { return std::log(x); }
+float Sqrt(float x) { return std::sqrt(x); }
+float Rsqrt(float x) { return 1.f / std::sqrt(x); }
+float Square(float x) { return x * x; }
+
+// An op with quantization parameters that span its useful range.
+struct ElementwiseCase {
+  TfLiteRegistration (*registration)();
+  FloatFunc func;
+  float input_scale;
+  int input_zero_point;
+  float output_scale;
+  int output_zero_point;
+};
+
+const ElementwiseCase kInt8Cases[] = {
+    {ops::micro::Register_ABS, Abs, 0.05f, 10, 0.04f, -128},
+    {ops::micro::Register_SIN, Sin, 0.05f, 0, 1.0f / 128, 0},
+    {ops::micro::Register_COS, Cos, 0.05f, -30, 1.0f / 128, 0},
+    {ops::micro::Register_EXP, Exp, 1.0f / 32, 0, 0.22f, -128},
+    {ops::micro::Register_LOG, Log, 0.1f, -128, 0.025f, 0},
+    {ops::micro::Register_SQRT, Sqrt, 0.1f, -128, 0.02f, -128},
+    {ops::micro::Register_RSQRT, Rsqrt, 0.02f, -128, 0.03f, -128},
+    {ops::micro::Register_SQUARE, Square, 0.02f, 0, 0.026f, -128},
+};
+
+// int16 tensors are symmetric, so every case has zero points of 0.
+const ElementwiseCase kInt16Cases[] = {
+    {ops::micro::Register_ABS, Abs, 8.0f / 32768, 0, 8.0f / 32768, 0},
+    {ops::micro::Register_SIN, Sin, 8.0f / 32768, 0, 1.0f / 32768, 0},
+    {ops::micro::Register_COS, Cos, 8.0f / 32768, 0, 1.0f / 32768, 0},
+    {ops::micro::Register_EXP, Exp, 8.0f / 32768, 0, 3000.0f / 32768, 0},
+    {ops::micro::Register_LOG, Log, 100.0f / 32768, 0, 8.0f / 32768, 0},
+    {ops::micro::Register_SQRT, Sqrt, 100.0f / 32768, 0, 10.0f / 32768, 0},
+    {ops::micro::Register_RSQRT, Rsqrt, 4.0f / 32768, 0, 16.0f / 32768, 0},
+    {ops::micro::Register_SQUARE, Square, 4.0f / 32768, 0, 16.0f / 32768, 0},
+    // Outputs that saturate inside the input range.
+    {ops::micro::Register_EXP, Exp, 8.0f / 32768, 0, 100.0f / 32768, 0},
+    {ops::micro::Register_SQUARE, Square, 4.0f / 32768, 0, 3.0f / 32768, 0},
+    {ops::micro::Register_COS, Cos, 8.0f / 32768, 0, 0.5f / 32768, 0},
+};
+
+TfLiteStatus RunElementwise(const TfLiteRegistration& registration,
+                            TfLiteTensor* tensors) {
+  int inputs_array_data[] = {1, 0};
+  int outputs_array_data[] = {1, 1};
+  micro::KernelRunner runner(registration, tensors, 2,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             /*builtin_data=*/nullptr, micro_test::reporter);
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
+  return runner.Invoke();
+}
+
+// Quantizes `func(value)` as the kernels do, mapping results outside the
+// function domain to the real value 0.
+int Quantize(float value, float scale, int zero_point, int min_value,
+             int max_value) {
+  if (std::isnan(value)) {
+    return zero_point;
+  }
+  const float quantized = std::round(value / scale) + zero_point;
+  return static_cast<int>(std::fmin(
+      std::fmax(quantized, static_cast<float>(min_value)),
+      static_cast<float>(max_value)));
+}
+
+// Feeds every int8 value through the op, whose table must match the float
+// function exactly.
+void TestInt8MatchesFloat(const ElementwiseCase& test_case) {
+  int shape[] = {1, 256};
+  int8_t input_data[256];
+  int8_t output_data[256];
+  for (int i = 0; i < 256; ++i) {
+    input_data[i] = static_cast<int8_t>(i - 128);
+  }
+  TfLiteIntArray* dims = IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, dims, test_case.input_scale,
+                            test_case.input_zero_point),
+      CreateQuantizedTensor(output_data, dims, test_case.output_scale,
+                            test_case.output_zero_point),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          RunElementwise(test_case.registration(), tensors));
+  for (int i = 0; i < 256; ++i) {
+    const float value = test_case.input_scale *
+                        (input_data[i] - test_case.input_zero_point);
+    TF_LITE_MICRO_EXPECT_EQ(
+        Quantize(test_case.func(value), test_case.output_scale,
+                 test_case.output_zero_point, -128, 127),
+        output_data[i]);
+  }
+}
+
+// Feeds every int16 value through the op and bounds the error of the
+// interpolated table, including the segments computed in float.
+void TestInt16MatchesFloat(const ElementwiseCase& test_case) {
+  static int16_t input_data[65536];
+  static int16_t output_data[65536];
+  int shape[] = {1, 65536};
+  for (int i = 0; i < 65536; ++i) {
+    input_data[i] = static_cast<int16_t>(i - 32768);
+  }
+  TfLiteIntArray* dims = IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, dims, test_case.input_scale, 0),
+      CreateQuantizedTensor(output_data, dims, test_case.output_scale, 0),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          RunElementwise(test_case.registration(), tensors));
+  int max_error = 0;
+  for (int i = 0; i < 65536; ++i) {
+    const int expected =
+        Quantize(test_case.func(test_case.input_scale * input_data[i]),
+                 test_case.output_scale, 0, -32768, 32767);
+    const int error = std::abs(expected - output_data[i]);
+    if (error > max_error) {
+      max_error = error;
+    }
+  }
+  TF_LITE_MICRO_EXPECT_LE(max_error, kInt16Tolerance);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FloatOpsMatchMath) {
+  using tflite::testing::CreateFloatTensor;
+  int shape[] = {1, 4};
+  const float input_data[] = {0.25f, 1.0f, 2.0f, 9.0f};
+  float output_data[4];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  for (const tflite::testing::ElementwiseCase& test_case :
+       tflite::testing::kInt8Cases) {
+    TfLiteTensor tensors[] = {
+        CreateFloatTensor(input_data, dims),
+        CreateFloatTensor(output_data, dims),
+    };
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk, tflite::testing::RunElementwise(test_case.registration(),
+                                                   tensors));
+    for (int i = 0; i < 4; ++i) {
+      TF_LITE_MICRO_EXPECT_NEAR(test_case.func(input_data[i]), output_data[i],
+                                1e-5f);
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(Int8TablesMatchFloat) {
+  for (const tflite::testing::ElementwiseCase& test_case :
+       tflite::testing::kInt8Cases) {
+    tflite::testing::TestInt8MatchesFloat(test_case);
+  }
+}
+
+TF_LITE_MICRO_TEST(Int16TablesMatchFloat) {
+  for (const tflite::testing::ElementwiseCase& test_case :
+       tflite::testing::kInt16Cases) {
+    tflite::testing::TestInt16MatchesFloat(test_case);
+  }
+}
+
+TF_LITE_MICRO_TEST(Int16RejectsNonZeroZeroPoint) {
+  int shape[] = {1, 2};
+  const int16_t input_data[] = {1, 2};
+  int16_t output_data[2];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(input_data, dims, 0.01f, 3),
+      tflite::testing::CreateQuantizedTensor(output_data, dims, 0.01f, 0),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      tflite::testing::RunElementwise(tflite::ops::micro::Register_EXP(),
+                                      tensors));
+}
+
+TF_LITE_MICRO_TEST(RejectsUnsupportedType) {
+  int shape[] = {1, 2};
+  const int32_t input_data[] = {1, 2};
+  int32_t output_data[2];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateInt32Tensor(input_data, dims),
+      tflite::testing::CreateInt32Tensor(output_data, dims),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      tflite::testing::RunElementwise(tflite::ops::micro::Register_EXP(),
+                                      tensors));
+}
+
+TF_LITE_MICRO_TEST(LogicalNot) {
+  int shape[] = {1, 3};
+  const bool input_data[] = {true, false, true};
+  bool output_data[3];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateBoolTensor(input_data, dims),
+      tflite::testing::CreateBoolTensor(output_data, dims),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::RunElementwise(
+                     tflite::ops::micro::Register_LOGICAL_NOT(), tensors));
+  TF_LITE_MICRO_EXPECT_EQ(false, output_data[0]);
+  TF_LITE_MICRO_EXPECT_EQ(true, output_data[1]);
+  TF_LITE_MICRO_EXPECT_EQ(false, output_data[2]);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,515 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/kernel_tuner.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/node_weights.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/compressed_filter.h"
+#include "tensorflow/lite/micro/testing/float16_weights.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/slow_memory_copy_engine.h"
+#include "tensorflow/lite/micro/thread_pool_executor.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+// Indices of the int8 variants in micro/kernels/fully_connected.cc.
+constexpr int kReferenceVariant = 0;
+constexpr int kRows4Variant = 1;
+
+constexpr int kMaxInputSize = 3 * 40;
+constexpr int kMaxFilterSize = 10 * 40;
+constexpr int kMaxOutputSize = 3 * 10;
+constexpr int kMaxOutputChannels = 10;
+// PackedO4I16Size() of the largest filter.
+constexpr int kMaxPackedFilterSize = 12 * 48;
+// Largest filter compressed with 4-bit indices, one palette per channel.
+constexpr int kMaxCompressedFilterSize = kMaxFilterSize + 10 * 16;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+struct FullyConnectedCase {
+  int batches;
+  int accum_depth;
+  int output_depth;
+  // Gives every output channel its own filter scale.
+  bool per_channel;
+  float output_scale;
+  uint32_t seed;
+};
+
+// External contexts installed on the kernel, nullptr for none.
+struct FullyConnectedEnvironment {
+  KernelTuner* tuner;
+  WeightCopyEngine* copy_engine;
+  ParallelExecutor* executor;
+  int num_threads;
+  // Runs on kPackedWeightsO4I16 weights packed like tools/pack_weights.cc
+  // does, with the filter tensor aliased to the packed data.
+  bool packed;
+  // If > 0, draws the filter from 2^index_bits values per tile of
+  // `tile_channels` output channels and runs on it palette compressed, with
+  // the filter tensor holding the compressed stream.
+  int index_bits;
+  int tile_channels;
+};
+
+// Runs an int8 FULLY_CONNECTED in `environment` and compares it with the
+// reference per-channel kernel, as a 1x1 convolution, on the same random
+// data.
+void TestFullyConnectedMatchesReference(
+    const FullyConnectedCase& test_case,
+    const FullyConnectedEnvironment& environment) {
+  const int batches = test_case.batches;
+  const int accum_depth = test_case.accum_depth;
+  const int output_depth = test_case.output_depth;
+  const int input_size = batches * accum_depth;
+  const int filter_size = output_depth * accum_depth;
+  const int output_size = batches * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(filter_size, kMaxFilterSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxOutputChannels);
+
+  const float input_scale = 0.05f;
+  const int input_zero_point = 7;
+  const int output_zero_point = -4;
+  Random random(test_case.seed);
+  int8_t input_data[kMaxInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<int8_t>(random.Next(-128, 127));
+  }
+  int8_t filter_data[kMaxFilterSize];
+  for (int i = 0; i < filter_size; ++i) {
+    if (environment.index_bits > 0) {
+      filter_data[i] = TestPaletteValue(
+          i / (environment.tile_channels * accum_depth),
+          random.Next(0, (1 << environment.index_bits) - 1));
+    } else {
+      filter_data[i] = static_cast<int8_t>(random.Next(-127, 127));
+    }
+  }
+  int32_t bias_data[kMaxOutputChannels];
+  const int num_scales = test_case.per_channel ? output_depth : 1;
+  float filter_scales[kMaxOutputChannels + 1] = {
+      static_cast<float>(num_scales)};
+  int filter_zero_points[kMaxOutputChannels + 1] = {num_scales};
+  for (int c = 0; c < output_depth; ++c) {
+    bias_data[c] = random.Next(-2000, 2000);
+  }
+  for (int c = 0; c < num_scales; ++c) {
+    filter_scales[c + 1] = 0.02f * static_cast<float>(c % 4 + 1);
+    filter_zero_points[c + 1] = 0;
+  }
+
+  int input_shape[] = {2, batches, accum_depth};
+  int filter_shape[] = {2, output_depth, accum_depth};
+  int bias_shape[] = {1, output_depth};
+  int output_shape[] = {2, batches, output_depth};
+  TfLiteAffineQuantization filter_quantization = {
+      FloatArrayFromFloats(filter_scales), IntArrayFromInts(filter_zero_points),
+      0};
+  int8_t output_data[kMaxOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, IntArrayFromInts(input_shape),
+                            input_scale, input_zero_point),
+      CreateQuantizedTensor(filter_data, IntArrayFromInts(filter_shape),
+                            filter_scales[1], 0),
+      CreateInt32Tensor(bias_data, IntArrayFromInts(bias_shape)),
+      CreateQuantizedTensor(output_data, IntArrayFromInts(output_shape),
+                            test_case.output_scale, output_zero_point),
+  };
+  tensors[1].quantization = {kTfLiteAffineQuantization, &filter_quantization};
+  // Only constant filters are prefetched.
+  tensors[1].allocation_type = kTfLiteMmapRo;
+  tensors[2].params.scale = input_scale * filter_scales[1];
+
+  static int8_t packed_filter[kMaxPackedFilterSize];
+  int32_t effective_bias[kMaxOutputChannels];
+  const int packed_size = PackedO4I16Size(output_depth, 1, accum_depth);
+  TF_LITE_MICRO_EXPECT_LE(packed_size, kMaxPackedFilterSize);
+  const PackedWeights packed = {kPackedWeightsO4I16, packed_filter,
+                                packed_size, effective_bias, output_depth};
+  const NodeWeights weights = {&packed, nullptr};
+  if (environment.packed) {
+    std::fill(packed_filter, packed_filter + packed_size, 0);
+    for (int c = 0; c < output_depth; ++c) {
+      effective_bias[c] = bias_data[c];
+      for (int d = 0; d < accum_depth; ++d) {
+        const int8_t value = filter_data[c * accum_depth + d];
+        packed_filter[PackedO4I16Offset(c, 0, d, 1, accum_depth)] = value;
+        effective_bias[c] -= input_zero_point * value;
+      }
+    }
+    tensors[1].data.int8 = packed_filter;
+  }
+
+  static uint8_t compressed_filter[kMaxCompressedFilterSize];
+  CompressedWeights compressed = {kCompressedWeightsPalette,
+                                  environment.index_bits,
+                                  environment.tile_channels, compressed_filter,
+                                  0};
+  const NodeWeights compressed_weights = {nullptr, &compressed};
+  if (environment.index_bits > 0) {
+    compressed.data_size =
+        CompressedWeightsSize(environment.index_bits,
+                              environment.tile_channels, output_depth,
+                              accum_depth);
+    TF_LITE_MICRO_EXPECT_LE(compressed.data_size, kMaxCompressedFilterSize);
+    TF_LITE_MICRO_EXPECT(CompressFilter(filter_data, output_depth,
+                                        accum_depth, environment.index_bits,
+                                        environment.tile_channels,
+                                        compressed_filter));
+    tensors[1].data.raw = reinterpret_cast<char*>(compressed_filter);
+  }
+
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  TfLiteFullyConnectedParams params = {
+      kTfLiteActNone, kTfLiteFullyConnectedWeightsFormatDefault, false, false};
+  const TfLiteRegistration registration =
+      ops::micro::Register_FULLY_CONNECTED();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  runner.SetExternalContext(kTfLiteMicroKernelTunerContext,
+                            environment.tuner);
+  runner.SetExternalContext(kTfLiteMicroWeightCopyContext,
+                            environment.copy_engine);
+  runner.SetExternalContext(kTfLiteMicroParallelContext, environment.executor);
+  runner.SetNumThreads(environment.num_threads);
+  if (environment.packed) {
+    runner.SetNodeWeights(&weights);
+  } else if (environment.index_bits > 0) {
+    runner.SetNodeWeights(&compressed_weights);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  ConvParams op_params;
+  op_params.padding_values.width = 0;
+  op_params.padding_values.height = 0;
+  op_params.stride_width = 1;
+  op_params.stride_height = 1;
+  op_params.dilation_width_factor = 1;
+  op_params.dilation_height_factor = 1;
+  op_params.input_offset = -input_zero_point;
+  op_params.output_offset = output_zero_point;
+  op_params.quantized_activation_min = -128;
+  op_params.quantized_activation_max = 127;
+  int32_t output_multiplier[kMaxOutputChannels];
+  int32_t output_shift[kMaxOutputChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    const float filter_scale = filter_scales[c % num_scales + 1];
+    const double effective_scale = static_cast<double>(input_scale) *
+                                   static_cast<double>(filter_scale) /
+                                   static_cast<double>(test_case.output_scale);
+    int shift;
+    QuantizeMultiplier(effective_scale, &output_multiplier[c], &shift);
+    output_shift[c] = shift;
+  }
+  int8_t expected_data[kMaxOutputSize];
+  reference_integer_ops::ConvPerChannel(
+      op_params, output_multiplier, output_shift,
+      RuntimeShape({batches, 1, 1, accum_depth}), input_data,
+      RuntimeShape({output_depth, 1, 1, accum_depth}), filter_data,
+      RuntimeShape({output_depth}), bias_data,
+      RuntimeShape({batches, 1, 1, output_depth}), expected_data);
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+// Streams the filter from slow memory in tiles of `tile_channels` output
+// channels.
+void TestPrefetchMatchesReference(const FullyConnectedCase& test_case,
+                                  int tile_channels, int num_threads) {
+  SlowMemoryCopyEngine copy_engine(/*delay_per_byte=*/1,
+                                   tile_channels * test_case.accum_depth);
+  ThreadPoolExecutor executor(num_threads);
+  TestFullyConnectedMatchesReference(
+      test_case, {nullptr, &copy_engine, num_threads > 1 ? &executor : nullptr,
+                  num_threads, false, 0, 0});
+  const int num_tiles =
+      (test_case.output_depth + tile_channels - 1) / tile_channels;
+  TF_LITE_MICRO_EXPECT_EQ(num_tiles, copy_engine.copy_count());
+}
+
+// Selects the int8 variant `variant` through a loaded tuning decision.
+void TestVariantMatchesReference(const FullyConnectedCase& test_case,
+                                 int variant, int num_threads) {
+  KernelTuningDecision decisions[] = {
+      {BuiltinOperator_FULLY_CONNECTED, variant}};
+  KernelTuner tuner(decisions, 1);
+  tuner.UseDecisions(1);
+  ThreadPoolExecutor executor(num_threads);
+  TestFullyConnectedMatchesReference(
+      test_case, {&tuner, nullptr, num_threads > 1 ? &executor : nullptr,
+                  num_threads, false, 0, 0});
+}
+
+// Runs on pre-packed weights on `num_threads` threads.
+void TestPackedMatchesReference(const FullyConnectedCase& test_case,
+                                int num_threads) {
+  ThreadPoolExecutor executor(num_threads);
+  TestFullyConnectedMatchesReference(
+      test_case, {nullptr, nullptr, num_threads > 1 ? &executor : nullptr,
+                  num_threads, /*packed=*/true, 0, 0});
+}
+
+// Runs on a filter palette compressed with `index_bits` bits per weight in
+// tiles of `tile_channels` output channels. With several threads the next
+// tile is decoded while the current one is computed.
+void TestCompressedMatchesReference(const FullyConnectedCase& test_case,
+                                    int index_bits, int tile_channels,
+                                    int num_threads) {
+  ThreadPoolExecutor executor(num_threads);
+  TestFullyConnectedMatchesReference(
+      test_case, {nullptr, nullptr, num_threads > 1 ? &executor : nullptr,
+                  num_threads, false, index_bits, tile_channels});
+}
+
+constexpr int kMaxFloatInputSize = 2 * 300;
+constexpr int kMaxFloatFilterSize = 10 * 300;
+constexpr int kMaxFloatOutputSize = 2 * 10;
+
+// Runs a float FULLY_CONNECTED on a constant float16 filter and, with
+// `float16_bias`, bias, and compares it with reference_ops::FullyConnected on
+// float32 copies of the same values.
+void TestFloat16MatchesFloat(const FullyConnectedCase& test_case,
+                             bool float16_bias) {
+  const int batches = test_case.batches;
+  const int accum_depth = test_case.accum_depth;
+  const int output_depth = test_case.output_depth;
+  const int input_size = batches * accum_depth;
+  const int filter_size = output_depth * accum_depth;
+  const int output_size = batches * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxFloatInputSize);
+  TF_LITE_MICRO_EXPECT_LE(filter_size, kMaxFloatFilterSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxFloatOutputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxOutputChannels);
+
+  // Multiples of 1/64, exactly representable as float16.
+  Random random(test_case.seed);
+  float input_data[kMaxFloatInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  float filter_data[kMaxFloatFilterSize];
+  for (int i = 0; i < filter_size; ++i) {
+    filter_data[i] = static_cast<float>(random.Next(-64, 64)) / 64.0f;
+  }
+  float bias_data[kMaxOutputChannels];
+  for (int c = 0; c < output_depth; ++c) {
+    bias_data[c] = static_cast<float>(random.Next(-64, 64)) / 16.0f;
+  }
+  TfLiteFloat16 half_filter[kMaxFloatFilterSize];
+  FloatsToHalves(filter_data, filter_size, half_filter);
+  TfLiteFloat16 half_bias[kMaxOutputChannels];
+  FloatsToHalves(bias_data, output_depth, half_bias);
+
+  int input_shape[] = {2, batches, accum_depth};
+  int filter_shape[] = {2, output_depth, accum_depth};
+  int bias_shape[] = {1, output_depth};
+  int output_shape[] = {2, batches, output_depth};
+  float output_data[kMaxFloatOutputSize];
+  TfLiteTensor tensors[] = {
+      CreateFloatTensor(input_data, IntArrayFromInts(input_shape)),
+      CreateFloat16Tensor(half_filter, IntArrayFromInts(filter_shape)),
+      float16_bias
+          ? CreateFloat16Tensor(half_bias, IntArrayFromInts(bias_shape))
+          : CreateFloatTensor(bias_data, IntArrayFromInts(bias_shape)),
+      CreateFloatTensor(output_data, IntArrayFromInts(output_shape)),
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  TfLiteFullyConnectedParams params = {
+      kTfLiteActRelu, kTfLiteFullyConnectedWeightsFormatDefault, false, false};
+  const TfLiteRegistration registration =
+      ops::micro::Register_FULLY_CONNECTED();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+
+  FullyConnectedParams op_params;
+  op_params.float_activation_min = 0.0f;
+  op_params.float_activation_max = std::numeric_limits<float>::max();
+  float expected_data[kMaxFloatOutputSize];
+  reference_ops::FullyConnected(
+      op_params, RuntimeShape(2, input_shape + 1), input_data,
+      RuntimeShape(2, filter_shape + 1), filter_data,
+      RuntimeShape(1, bias_shape + 1), bias_data,
+      RuntimeShape(2, output_shape + 1), expected_data);
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(PrefetchedFilterOneChannelTiles) {
+  tflite::testing::TestPrefetchMatchesReference({1, 40, 7, false, 1.0f, 1},
+                                                /*tile_channels=*/1,
+                                                /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PrefetchedFilterPartialLastTile) {
+  tflite::testing::TestPrefetchMatchesReference({3, 24, 10, false, 1.0f, 2},
+                                                /*tile_channels=*/4,
+                                                /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PrefetchedFilterWithThreads) {
+  tflite::testing::TestPrefetchMatchesReference({2, 33, 9, false, 1.0f, 3},
+                                                /*tile_channels=*/3,
+                                                /*num_threads=*/4);
+}
+
+TF_LITE_MICRO_TEST(PerTensorReferenceVariant) {
+  tflite::testing::TestVariantMatchesReference(
+      {3, 40, 10, false, 1.0f, 4}, tflite::testing::kReferenceVariant,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PerTensorRows4Variant) {
+  tflite::testing::TestVariantMatchesReference(
+      {2, 37, 10, false, 1.0f, 5}, tflite::testing::kRows4Variant,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PerChannelReferenceVariant) {
+  tflite::testing::TestVariantMatchesReference(
+      {3, 40, 10, true, 1.0f, 6}, tflite::testing::kReferenceVariant,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PerChannelReferenceVariantWithThreads) {
+  tflite::testing::TestVariantMatchesReference(
+      {2, 40, 9, true, 1.0f, 7}, tflite::testing::kReferenceVariant,
+      /*num_threads=*/3);
+}
+
+TF_LITE_MICRO_TEST(PerChannelRows4Variant) {
+  tflite::testing::TestVariantMatchesReference(
+      {3, 29, 10, true, 0.5f, 8}, tflite::testing::kRows4Variant,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PerChannelPrefetchedFilter) {
+  tflite::testing::TestPrefetchMatchesReference({2, 24, 10, true, 1.0f, 9},
+                                                /*tile_channels=*/4,
+                                                /*num_threads=*/1);
+}
+
+// Partial blocks of four output channels and of 16 input channels.
+TF_LITE_MICRO_TEST(PackedPerTensor) {
+  tflite::testing::TestPackedMatchesReference({3, 37, 10, false, 1.0f, 10},
+                                              /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(PackedPerChannelWithThreads) {
+  tflite::testing::TestPackedMatchesReference({2, 40, 9, true, 0.5f, 11},
+                                              /*num_threads=*/3);
+}
+
+// One channel per tile, whose 37 4-bit indices end in half a byte.
+TF_LITE_MICRO_TEST(CompressedFourBitChannelTiles) {
+  tflite::testing::TestCompressedMatchesReference(
+      {3, 37, 10, false, 1.0f, 12}, /*index_bits=*/4, /*tile_channels=*/1,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(CompressedTwoBitPartialLastTile) {
+  tflite::testing::TestCompressedMatchesReference(
+      {2, 40, 10, true, 1.0f, 13}, /*index_bits=*/2, /*tile_channels=*/4,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(CompressedOneBitPartialLastTile) {
+  tflite::testing::TestCompressedMatchesReference(
+      {3, 29, 9, true, 0.5f, 14}, /*index_bits=*/1, /*tile_channels=*/2,
+      /*num_threads=*/1);
+}
+
+TF_LITE_MICRO_TEST(CompressedPipelined) {
+  tflite::testing::TestCompressedMatchesReference(
+      {2, 40, 10, true, 1.0f, 15}, /*index_bits=*/4, /*tile_channels=*/2,
+      /*num_threads=*/3);
+}
+
+TF_LITE_MICRO_TEST(CompressedPipelinedPartialLastTile) {
+  tflite::testing::TestCompressedMatchesReference(
+      {3, 33, 9, false, 1.0f, 16}, /*index_bits=*/2, /*tile_channels=*/4,
+      /*num_threads=*/2);
+}
+
+// 300 float weights per channel, three per 4 KB tile, the last tile partial.
+TF_LITE_MICRO_TEST(Float16WeightsPartialLastTile) {
+  tflite::testing::TestFloat16MatchesFloat({2, 300, 10, false, 0.0f, 30},
+                                           /*float16_bias=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16WeightsOneTile) {
+  tflite::testing::TestFloat16MatchesFloat({1, 40, 7, false, 0.0f, 31},
+                                           /*float16_bias=*/true);
+}
+
+TF_LITE_MICRO_TEST(Float16FilterFloatBias) {
+  tflite::testing::TestFloat16MatchesFloat({2, 300, 4, false, 0.0f, 32},
+                                           /*float16_bias=*/false);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,195 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/counting_executor.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxInputSize = 2 * 15 * 13 * 96;
+constexpr int kMaxOutputSize = 2 * 10 * 8 * 96;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+struct PoolCase {
+  bool max_pool;
+  // Runs on int8 instead of float data.
+  bool int8;
+  TfLitePadding padding;
+  int stride;
+  int filter_size;
+  int batches;
+  int input_height;
+  int input_width;
+  int depth;
+  uint32_t seed;
+};
+
+// Runs the pooling of `test_case` on `input_data` into `output_data`, with
+// `executor` installed unless it is nullptr.
+void RunPool(const PoolCase& test_case, void* input_data, void* output_data,
+             int output_height, int output_width,
+             ParallelExecutor* executor, int num_threads) {
+  int input_shape[] = {4, test_case.batches, test_case.input_height,
+                       test_case.input_width, test_case.depth};
+  int output_shape[] = {4, test_case.batches, output_height, output_width,
+                        test_case.depth};
+  TfLiteTensor tensors[] = {
+      test_case.int8
+          ? CreateQuantizedTensor(static_cast<int8_t*>(input_data),
+                                  IntArrayFromInts(input_shape), 0.1f, -3)
+          : CreateFloatTensor(static_cast<float*>(input_data),
+                              IntArrayFromInts(input_shape)),
+      test_case.int8
+          ? CreateQuantizedTensor(static_cast<int8_t*>(output_data),
+                                  IntArrayFromInts(output_shape), 0.1f, -3)
+          : CreateFloatTensor(static_cast<float*>(output_data),
+                              IntArrayFromInts(output_shape)),
+  };
+  int inputs_array_data[] = {1, 0};
+  int outputs_array_data[] = {1, 1};
+  TfLitePoolParams params = {test_case.padding,     test_case.stride,
+                             test_case.stride,      test_case.filter_size,
+                             test_case.filter_size, kTfLiteActRelu,
+                             {}};
+  const TfLiteRegistration registration =
+      test_case.max_pool ? ops::micro::Register_MAX_POOL_2D()
+                         : ops::micro::Register_AVERAGE_POOL_2D();
+  micro::KernelRunner runner(registration, tensors, 2,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  runner.SetExternalContext(kTfLiteMicroParallelContext, executor);
+  runner.SetNumThreads(num_threads);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+}
+
+// Runs the pooling of `test_case` on 2, 3 and 5 threads of a
+// ThreadPoolExecutor, which split the output rows into chunks that do not
+// all have the same size, and expects the output of the serial kernel.
+void TestThreadsMatchSerial(const PoolCase& test_case) {
+  int output_height;
+  int output_width;
+  ComputePaddingHeightWidth(test_case.stride, test_case.stride, 1, 1,
+                            test_case.input_height, test_case.input_width,
+                            test_case.filter_size, test_case.filter_size,
+                            test_case.padding, &output_height, &output_width);
+  const int input_size = test_case.batches * test_case.input_height *
+                         test_case.input_width * test_case.depth;
+  const int output_size =
+      test_case.batches * output_height * output_width * test_case.depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+
+  Random random(test_case.seed);
+  static int8_t int8_input[kMaxInputSize];
+  static float float_input[kMaxInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    int8_input[i] = static_cast<int8_t>(random.Next(-128, 127));
+    float_input[i] = static_cast<float>(random.Next(-1000, 1000)) / 64.0f;
+  }
+  void* input_data = test_case.int8 ? static_cast<void*>(int8_input)
+                                    : static_cast<void*>(float_input);
+  static int8_t int8_expected[kMaxOutputSize];
+  static float float_expected[kMaxOutputSize];
+  RunPool(test_case, input_data,
+          test_case.int8 ? static_cast<void*>(int8_expected)
+                         : static_cast<void*>(float_expected),
+          output_height, output_width, nullptr, 1);
+
+  const int64_t total_reads = static_cast<int64_t>(output_size) *
+                              test_case.filter_size * test_case.filter_size;
+  for (int num_threads : {2, 3, 5}) {
+    static int8_t int8_output[kMaxOutputSize];
+    static float float_output[kMaxOutputSize];
+    std::fill(int8_output, int8_output + output_size, 0);
+    std::fill(float_output, float_output + output_size, 0.0f);
+    CountingExecutor executor(num_threads);
+    RunPool(test_case, input_data,
+            test_case.int8 ? static_cast<void*>(int8_output)
+                           : static_cast<void*>(float_output),
+            output_height, output_width, &executor, num_threads);
+    const int expected_chunks = static_cast<int>(std::min<int64_t>(
+        {num_threads, output_height,
+         total_reads / micro::kMinParallelChunkMacs}));
+    TF_LITE_MICRO_EXPECT_GT(expected_chunks, 1);
+    TF_LITE_MICRO_EXPECT_EQ(expected_chunks, executor.last_num_tasks());
+    for (int i = 0; i < output_size; ++i) {
+      if (test_case.int8) {
+        TF_LITE_MICRO_EXPECT_EQ(int8_expected[i], int8_output[i]);
+      } else {
+        TF_LITE_MICRO_EXPECT_EQ(float_expected[i], float_output[i]);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+// 8 output rows, whose windows overlap and are padded at both ends.
+TF_LITE_MICRO_TEST(AveragePoolInt8SamePaddingStride2) {
+  tflite::testing::TestThreadsMatchSerial(
+      {false, true, kTfLitePaddingSame, 2, 5, 1, 15, 13, 96, 1});
+}
+
+TF_LITE_MICRO_TEST(MaxPoolInt8ValidPadding) {
+  tflite::testing::TestThreadsMatchSerial(
+      {true, true, kTfLitePaddingValid, 1, 3, 2, 12, 10, 96, 2});
+}
+
+// An even window, padded more at the bottom than at the top.
+TF_LITE_MICRO_TEST(AveragePoolFloatEvenWindowTwoBatches) {
+  tflite::testing::TestThreadsMatchSerial(
+      {false, false, kTfLitePaddingSame, 2, 4, 2, 13, 9, 64, 3});
+}
+
+TF_LITE_MICRO_TEST(MaxPoolFloatSamePadding) {
+  tflite::testing::TestThreadsMatchSerial(
+      {true, false, kTfLitePaddingSame, 1, 3, 1, 11, 12, 64, 4});
+}
+
+TF_LITE_MICRO_TESTS_END
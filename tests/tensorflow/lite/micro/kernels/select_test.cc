@@ -0,0 +1,224 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/kernels/select.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+// Runs `registration` on tensors {inputs..., output}, the output being the
+// last tensor, and checks it against `expected_data`.
+template <typename T>
+TfLiteStatus ValidateSelect(const TfLiteRegistration& registration,
+                            TfLiteTensor* tensors, int num_inputs,
+                            void* builtin_data, const T* expected_data,
+                            T* output_data, int output_size) {
+  int inputs_array_data[] = {num_inputs, 0, 1, 2, 3};
+  int outputs_array_data[] = {1, num_inputs};
+  micro::KernelRunner runner(registration, tensors, num_inputs + 1,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             builtin_data, micro_test::reporter);
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
+  TF_LITE_ENSURE_STATUS(runner.Invoke());
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(SelectSameShapeFloat) {
+  int shape[] = {2, 2, 3};
+  const bool condition_data[] = {true, false, false, true, true, false};
+  const float x_data[] = {1, 2, 3, 4, 5, 6};
+  const float y_data[] = {-1, -2, -3, -4, -5, -6};
+  const float expected_data[] = {1, -2, -3, 4, 5, -6};
+  float output_data[6];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateBoolTensor(condition_data, dims),
+      tflite::testing::CreateFloatTensor(x_data, dims),
+      tflite::testing::CreateFloatTensor(y_data, dims),
+      tflite::testing::CreateFloatTensor(output_data, dims),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::ValidateSelect(
+                     tflite::ops::micro::Register_SELECT(), tensors, 3,
+                     nullptr, expected_data, output_data, 6));
+}
+
+TF_LITE_MICRO_TEST(SelectScalarOperandsInt8) {
+  int shape[] = {1, 5};
+  int scalar_shape[] = {0};
+  const bool condition_data[] = {false, true, true, false, true};
+  const int8_t x_data[] = {7};
+  const int8_t y_data[] = {-9};
+  const int8_t expected_data[] = {-9, 7, 7, -9, 7};
+  int8_t output_data[5];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteIntArray* scalar_dims = tflite::testing::IntArrayFromInts(scalar_shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateBoolTensor(condition_data, dims),
+      tflite::testing::CreateQuantizedTensor(x_data, scalar_dims, 1.0f, 0),
+      tflite::testing::CreateQuantizedTensor(y_data, scalar_dims, 1.0f, 0),
+      tflite::testing::CreateQuantizedTensor(output_data, dims, 1.0f, 0),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::ValidateSelect(
+                     tflite::ops::micro::Register_SELECT_V2(), tensors, 3,
+                     nullptr, expected_data, output_data, 5));
+}
+
+TF_LITE_MICRO_TEST(SelectRankOneConditionPicksRows) {
+  int shape[] = {2, 3, 2};
+  int condition_shape[] = {1, 3};
+  const bool condition_data[] = {true, false, true};
+  const int32_t x_data[] = {1, 2, 3, 4, 5, 6};
+  const int32_t y_data[] = {10, 20, 30, 40, 50, 60};
+  const int32_t expected_data[] = {1, 2, 30, 40, 5, 6};
+  int32_t output_data[6];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateBoolTensor(
+          condition_data, tflite::testing::IntArrayFromInts(condition_shape)),
+      tflite::testing::CreateInt32Tensor(x_data, dims),
+      tflite::testing::CreateInt32Tensor(y_data, dims),
+      tflite::testing::CreateInt32Tensor(output_data, dims),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::ValidateSelect(
+                     tflite::ops::micro::Register_SELECT(), tensors, 3,
+                     nullptr, expected_data, output_data, 6));
+}
+
+TF_LITE_MICRO_TEST(SelectV2Broadcasts) {
+  int condition_shape[] = {2, 2, 1};
+  int x_shape[] = {2, 1, 3};
+  int y_shape[] = {2, 2, 3};
+  const bool condition_data[] = {false, true};
+  const float x_data[] = {1, 2, 3};
+  const float y_data[] = {-1, -2, -3, -4, -5, -6};
+  const float expected_data[] = {-1, -2, -3, 1, 2, 3};
+  float output_data[6];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateBoolTensor(
+          condition_data, tflite::testing::IntArrayFromInts(condition_shape)),
+      tflite::testing::CreateFloatTensor(
+          x_data, tflite::testing::IntArrayFromInts(x_shape)),
+      tflite::testing::CreateFloatTensor(
+          y_data, tflite::testing::IntArrayFromInts(y_shape)),
+      tflite::testing::CreateFloatTensor(
+          output_data, tflite::testing::IntArrayFromInts(y_shape)),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::ValidateSelect(
+                     tflite::ops::micro::Register_SELECT_V2(), tensors, 3,
+                     nullptr, expected_data, output_data, 6));
+}
+
+// A comparison folded in by the graph rewriter: inputs {lhs, x, y, rhs}.
+TF_LITE_MICRO_TEST(FusedComparisonInt8) {
+  int shape[] = {1, 6};
+  int scalar_shape[] = {0};
+  const int8_t lhs_data[] = {-3, 0, 4, 5, 6, 127};
+  const int8_t x_data[] = {1, 2, 3, 4, 5, 6};
+  const int8_t y_data[] = {0};
+  const int8_t rhs_data[] = {4};
+  const int8_t expected_data[] = {0, 0, 0, 4, 5, 6};
+  int8_t output_data[6];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteIntArray* scalar_dims = tflite::testing::IntArrayFromInts(scalar_shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(lhs_data, dims, 0.5f, 1),
+      tflite::testing::CreateQuantizedTensor(x_data, dims, 0.5f, 1),
+      tflite::testing::CreateQuantizedTensor(y_data, scalar_dims, 0.5f, 1),
+      tflite::testing::CreateQuantizedTensor(rhs_data, scalar_dims, 0.5f, 1),
+      tflite::testing::CreateQuantizedTensor(output_data, dims, 0.5f, 1),
+  };
+  tflite::ops::micro::FusedComparisonSelectParams params = {
+      tflite::BuiltinOperator_GREATER};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::ValidateSelect(
+                     tflite::ops::micro::Register_SELECT_V2(), tensors, 4,
+                     &params, expected_data, output_data, 6));
+}
+
+TF_LITE_MICRO_TEST(FusedComparisonFloatLessEqual) {
+  int shape[] = {1, 4};
+  const float lhs_data[] = {1.5f, 2.0f, 2.5f, -7.0f};
+  const float x_data[] = {1, 2, 3, 4};
+  const float y_data[] = {-1, -2, -3, -4};
+  const float rhs_data[] = {1.0f, 2.0f, 3.0f, -8.0f};
+  const float expected_data[] = {-1, 2, 3, -4};
+  float output_data[4];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateFloatTensor(lhs_data, dims),
+      tflite::testing::CreateFloatTensor(x_data, dims),
+      tflite::testing::CreateFloatTensor(y_data, dims),
+      tflite::testing::CreateFloatTensor(rhs_data, dims),
+      tflite::testing::CreateFloatTensor(output_data, dims),
+  };
+  tflite::ops::micro::FusedComparisonSelectParams params = {
+      tflite::BuiltinOperator_LESS_EQUAL};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::testing::ValidateSelect(
+                     tflite::ops::micro::Register_SELECT(), tensors, 4,
+                     &params, expected_data, output_data, 4));
+}
+
+TF_LITE_MICRO_TEST(FusedRejectsNonComparison) {
+  int shape[] = {1, 2};
+  const float data[] = {1, 2};
+  float output_data[2];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateFloatTensor(data, dims),
+      tflite::testing::CreateFloatTensor(data, dims),
+      tflite::testing::CreateFloatTensor(data, dims),
+      tflite::testing::CreateFloatTensor(data, dims),
+      tflite::testing::CreateFloatTensor(output_data, dims),
+  };
+  tflite::ops::micro::FusedComparisonSelectParams params = {
+      tflite::BuiltinOperator_ADD};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::testing::ValidateSelect(
+                        tflite::ops::micro::Register_SELECT(), tensors, 4,
+                        &params, data, output_data, 2));
+}
+
+TF_LITE_MICRO_TEST(RawComparisonNeedsStepOfOneUnitAfterShift) {
+  using tflite::ops::micro::ComparesQuantizedRaw;
+  TF_LITE_MICRO_EXPECT_TRUE(ComparesQuantizedRaw(1.0f));
+  TF_LITE_MICRO_EXPECT_TRUE(ComparesQuantizedRaw(1.0f / 256));
+  TF_LITE_MICRO_EXPECT_FALSE(ComparesQuantizedRaw(1.0f / 512));
+}
+
+TF_LITE_MICRO_TESTS_END
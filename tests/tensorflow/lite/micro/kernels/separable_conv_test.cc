@@ -0,0 +1,280 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/separable_conv.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxInputSize = 9 * 10 * 8;
+constexpr int kMaxOutputSize = 9 * 10 * 12;
+constexpr int kMaxDepth = 8;
+constexpr int kMaxOutputDepth = 12;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+struct SeparableConvCase {
+  TfLitePadding padding;
+  int stride;
+  int input_height;
+  int input_width;
+  int depth;
+  int output_depth;
+  bool has_bias;
+  TfLiteFusedActivation depthwise_activation;
+  TfLiteFusedActivation pointwise_activation;
+  uint32_t seed;
+};
+
+// Runs `registration` on tensors {inputs..., output}, the output being the
+// last tensor.
+TfLiteStatus RunKernel(const TfLiteRegistration& registration,
+                       TfLiteTensor* tensors, int tensors_size,
+                       int* inputs_array_data, void* builtin_data) {
+  int outputs_array_data[] = {1, tensors_size - 1};
+  micro::KernelRunner runner(registration, tensors, tensors_size,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             builtin_data, micro_test::reporter);
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
+  return runner.Invoke();
+}
+
+// Runs a 3x3 DEPTHWISE_CONV_2D followed by a 1x1 CONV_2D, then the fused
+// kernel on the same random int8 data, and expects identical outputs.
+void TestFusedMatchesSeparateKernels(const SeparableConvCase& test_case) {
+  const int depth = test_case.depth;
+  const int output_depth = test_case.output_depth;
+  int output_height;
+  int output_width;
+  ComputePaddingHeightWidth(test_case.stride, test_case.stride, 1, 1,
+                            test_case.input_height, test_case.input_width,
+                            /*filter_height=*/3, /*filter_width=*/3,
+                            test_case.padding, &output_height, &output_width);
+  const int input_size = test_case.input_height * test_case.input_width * depth;
+  const int intermediate_size = output_height * output_width * depth;
+  const int output_size = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(intermediate_size, kMaxOutputSize);
+  TF_LITE_MICRO_EXPECT_LE(output_size, kMaxOutputSize);
+  TF_LITE_MICRO_EXPECT_LE(depth, kMaxDepth);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxOutputDepth);
+
+  Random random(test_case.seed);
+  int8_t input_data[kMaxInputSize];
+  for (int i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<int8_t>(random.Next(-128, 127));
+  }
+  int8_t depthwise_filter_data[9 * kMaxDepth];
+  for (int i = 0; i < 9 * depth; ++i) {
+    depthwise_filter_data[i] = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  int8_t pointwise_filter_data[kMaxOutputDepth * kMaxDepth];
+  for (int i = 0; i < output_depth * depth; ++i) {
+    pointwise_filter_data[i] = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  int32_t depthwise_bias_data[kMaxDepth];
+  float depthwise_scales[kMaxDepth + 1] = {static_cast<float>(depth)};
+  int depthwise_zero_points[kMaxDepth + 1] = {depth};
+  for (int c = 0; c < depth; ++c) {
+    depthwise_bias_data[c] = random.Next(-3000, 3000);
+    depthwise_scales[c + 1] = 0.004f * static_cast<float>(c + 2);
+    depthwise_zero_points[c + 1] = 0;
+  }
+  int32_t pointwise_bias_data[kMaxOutputDepth];
+  float pointwise_scales[kMaxOutputDepth + 1] = {
+      static_cast<float>(output_depth)};
+  int pointwise_zero_points[kMaxOutputDepth + 1] = {output_depth};
+  for (int c = 0; c < output_depth; ++c) {
+    pointwise_bias_data[c] = random.Next(-3000, 3000);
+    pointwise_scales[c + 1] = 0.003f * static_cast<float>(c + 1);
+    pointwise_zero_points[c + 1] = 0;
+  }
+
+  const float input_scale = 0.05f;
+  const int input_zero_point = -7;
+  const float intermediate_scale = 0.08f;
+  const int intermediate_zero_point = 4;
+  const float output_scale = 0.1f;
+  const int output_zero_point = -2;
+
+  int input_shape[] = {4, 1, test_case.input_height, test_case.input_width,
+                       depth};
+  int depthwise_filter_shape[] = {4, 1, 3, 3, depth};
+  int depthwise_bias_shape[] = {1, depth};
+  int intermediate_shape[] = {4, 1, output_height, output_width, depth};
+  int pointwise_filter_shape[] = {4, output_depth, 1, 1, depth};
+  int pointwise_bias_shape[] = {1, output_depth};
+  int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  TfLiteAffineQuantization depthwise_quantization = {
+      FloatArrayFromFloats(depthwise_scales),
+      IntArrayFromInts(depthwise_zero_points), 3};
+  TfLiteAffineQuantization pointwise_quantization = {
+      FloatArrayFromFloats(pointwise_scales),
+      IntArrayFromInts(pointwise_zero_points), 0};
+
+  TfLiteTensor input = CreateQuantizedTensor(
+      input_data, IntArrayFromInts(input_shape), input_scale, input_zero_point);
+  TfLiteTensor depthwise_filter = CreateQuantizedTensor(
+      depthwise_filter_data, IntArrayFromInts(depthwise_filter_shape), 1.0f,
+      0);
+  depthwise_filter.quantization = {kTfLiteAffineQuantization,
+                                   &depthwise_quantization};
+  depthwise_filter.allocation_type = kTfLiteMmapRo;
+  TfLiteTensor depthwise_bias = CreateInt32Tensor(
+      depthwise_bias_data, IntArrayFromInts(depthwise_bias_shape));
+  depthwise_bias.allocation_type = kTfLiteMmapRo;
+  TfLiteTensor pointwise_filter = CreateQuantizedTensor(
+      pointwise_filter_data, IntArrayFromInts(pointwise_filter_shape), 1.0f,
+      0);
+  pointwise_filter.quantization = {kTfLiteAffineQuantization,
+                                   &pointwise_quantization};
+  pointwise_filter.allocation_type = kTfLiteMmapRo;
+  TfLiteTensor pointwise_bias = CreateInt32Tensor(
+      pointwise_bias_data, IntArrayFromInts(pointwise_bias_shape));
+  pointwise_bias.allocation_type = kTfLiteMmapRo;
+
+  // Two separate kernels, through the depthwise output.
+  int8_t intermediate_data[kMaxOutputSize];
+  TfLiteTensor intermediate = CreateQuantizedTensor(
+      intermediate_data, IntArrayFromInts(intermediate_shape),
+      intermediate_scale, intermediate_zero_point);
+  TfLiteDepthwiseConvParams depthwise_params = {
+      test_case.padding, test_case.stride, test_case.stride, 1,
+      test_case.depthwise_activation, 1, 1};
+  TfLiteTensor depthwise_tensors[] = {input, depthwise_filter, depthwise_bias,
+                                      intermediate};
+  int depthwise_inputs[] = {3, 0, 1, 2};
+  if (!test_case.has_bias) {
+    depthwise_inputs[0] = 2;
+    depthwise_tensors[2] = intermediate;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      RunKernel(ops::micro::Register_DEPTHWISE_CONV_2D(), depthwise_tensors,
+                depthwise_inputs[0] + 1, depthwise_inputs, &depthwise_params));
+
+  int8_t expected_data[kMaxOutputSize];
+  TfLiteTensor expected = CreateQuantizedTensor(
+      expected_data, IntArrayFromInts(output_shape), output_scale,
+      output_zero_point);
+  TfLiteConvParams pointwise_params = {
+      kTfLitePaddingValid, 1, 1, test_case.pointwise_activation, 1, 1};
+  TfLiteTensor pointwise_tensors[] = {intermediate, pointwise_filter,
+                                      pointwise_bias, expected};
+  int pointwise_inputs[] = {3, 0, 1, 2};
+  if (!test_case.has_bias) {
+    pointwise_inputs[0] = 2;
+    pointwise_tensors[2] = expected;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      RunKernel(ops::micro::Register_CONV_2D(), pointwise_tensors,
+                pointwise_inputs[0] + 1, pointwise_inputs, &pointwise_params));
+
+  // The fused kernel, with no tensor for the depthwise output.
+  int8_t output_data[kMaxOutputSize];
+  TfLiteTensor fused_tensors[] = {
+      input,
+      depthwise_filter,
+      depthwise_bias,
+      pointwise_filter,
+      pointwise_bias,
+      CreateQuantizedTensor(output_data, IntArrayFromInts(output_shape),
+                            output_scale, output_zero_point),
+  };
+  int fused_inputs[] = {ops::micro::kSeparableConvNumInputs, 0, 1, 2, 3, 4};
+  if (!test_case.has_bias) {
+    fused_inputs[1 + ops::micro::kSeparableConvDepthwiseBiasTensor] =
+        kTfLiteOptionalTensor;
+    fused_inputs[1 + ops::micro::kSeparableConvPointwiseBiasTensor] =
+        kTfLiteOptionalTensor;
+  }
+  ops::micro::FusedSeparableConvParams fused_params = {
+      depthwise_params, pointwise_params, intermediate_scale,
+      intermediate_zero_point};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      RunKernel(ops::micro::Register_FUSED_SEPARABLE_CONV_2D(), fused_tensors,
+                6, fused_inputs, &fused_params));
+
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FusedMatchesSeparateSamePadding) {
+  tflite::testing::TestFusedMatchesSeparateKernels(
+      {kTfLitePaddingSame, 1, 9, 10, 8, 12, true, kTfLiteActNone,
+       kTfLiteActNone, 1});
+}
+
+TF_LITE_MICRO_TEST(FusedMatchesSeparateValidPaddingStride2) {
+  tflite::testing::TestFusedMatchesSeparateKernels(
+      {kTfLitePaddingValid, 2, 9, 10, 5, 7, true, kTfLiteActNone,
+       kTfLiteActNone, 2});
+}
+
+TF_LITE_MICRO_TEST(FusedMatchesSeparateSamePaddingStride2) {
+  tflite::testing::TestFusedMatchesSeparateKernels(
+      {kTfLitePaddingSame, 2, 8, 7, 3, 4, true, kTfLiteActNone,
+       kTfLiteActNone, 3});
+}
+
+TF_LITE_MICRO_TEST(FusedMatchesSeparateWithoutBias) {
+  tflite::testing::TestFusedMatchesSeparateKernels(
+      {kTfLitePaddingSame, 1, 6, 6, 4, 6, false, kTfLiteActNone,
+       kTfLiteActNone, 4});
+}
+
+TF_LITE_MICRO_TEST(FusedMatchesSeparateWithActivations) {
+  tflite::testing::TestFusedMatchesSeparateKernels(
+      {kTfLitePaddingSame, 1, 7, 5, 8, 8, true, kTfLiteActRelu6,
+       kTfLiteActRelu, 5});
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,146 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+// tensors[1] and tensors[2] hold the block shape and the paddings, constant
+// if `constant_shape`, in which case Prepare decides whether the reorder is a
+// flat copy.
+template <typename T>
+void ValidateSpaceToBatchNd(TfLiteTensor* tensors, bool constant_shape,
+                            const T* expected_data, T* output_data,
+                            int output_size) {
+  if (constant_shape) {
+    tensors[1].allocation_type = kTfLiteMmapRo;
+    tensors[2].allocation_type = kTfLiteMmapRo;
+  }
+  int inputs_array_data[] = {3, 0, 1, 2};
+  int outputs_array_data[] = {1, 3};
+  const TfLiteRegistration registration =
+      ops::micro::Register_SPACE_TO_BATCH_ND();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             /*builtin_data=*/nullptr, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+  for (int i = 0; i < output_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_data[i], output_data[i]);
+  }
+}
+
+void TestSpaceToBatchNdFloat(bool constant_shape) {
+  int input_shape[] = {4, 1, 4, 4, 1};
+  const float input_data[] = {1, 2,  3,  4,  5,  6,  7,  8,
+                              9, 10, 11, 12, 13, 14, 15, 16};
+  int block_shape_shape[] = {1, 2};
+  const int32_t block_shape_data[] = {2, 2};
+  int paddings_shape[] = {2, 2, 2};
+  const int32_t paddings_data[] = {0, 0, 0, 0};
+  int output_shape[] = {4, 4, 2, 2, 1};
+  const float expected_data[] = {1, 3,  9,  11, 2, 4,  10, 12,
+                                 5, 7,  13, 15, 6, 8,  14, 16};
+  float output_data[16];
+  TfLiteTensor tensors[] = {
+      CreateFloatTensor(input_data, IntArrayFromInts(input_shape)),
+      CreateInt32Tensor(block_shape_data, IntArrayFromInts(block_shape_shape)),
+      CreateInt32Tensor(paddings_data, IntArrayFromInts(paddings_shape)),
+      CreateFloatTensor(output_data, IntArrayFromInts(output_shape)),
+  };
+  ValidateSpaceToBatchNd(tensors, constant_shape, expected_data, output_data,
+                         16);
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(ShufflesBlocksIntoBatchesConstantShape) {
+  tflite::testing::TestSpaceToBatchNdFloat(/*constant_shape=*/true);
+}
+
+TF_LITE_MICRO_TEST(ShufflesBlocksIntoBatchesRuntimeShape) {
+  tflite::testing::TestSpaceToBatchNdFloat(/*constant_shape=*/false);
+}
+
+// Padding is filled with the output zero point.
+TF_LITE_MICRO_TEST(PadsWithZeroPointInt8) {
+  int input_shape[] = {4, 1, 2, 2, 1};
+  const int8_t input_data[] = {1, 2, 3, 4};
+  int block_shape_shape[] = {1, 2};
+  const int32_t block_shape_data[] = {2, 2};
+  int paddings_shape[] = {2, 2, 2};
+  const int32_t paddings_data[] = {1, 1, 1, 1};
+  int output_shape[] = {4, 4, 2, 2, 1};
+  const int8_t expected_data[] = {-5, -5, -5, 4,  -5, -5, 3,  -5,
+                                  -5, 2,  -5, -5, 1,  -5, -5, -5};
+  int8_t output_data[16];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape), 0.5f,
+          -5),
+      tflite::testing::CreateInt32Tensor(
+          block_shape_data,
+          tflite::testing::IntArrayFromInts(block_shape_shape)),
+      tflite::testing::CreateInt32Tensor(
+          paddings_data, tflite::testing::IntArrayFromInts(paddings_shape)),
+      tflite::testing::CreateQuantizedTensor(
+          output_data, tflite::testing::IntArrayFromInts(output_shape), 0.5f,
+          -5),
+  };
+  tflite::testing::ValidateSpaceToBatchNd(tensors, /*constant_shape=*/true,
+                                          expected_data, output_data, 16);
+}
+
+// With a single input batch and blocks one row high, every output batch is a
+// contiguous run of input rows, so the kernel only copies.
+TF_LITE_MICRO_TEST(RowBlocksOfOneBatchKeepLayout) {
+  int input_shape[] = {4, 1, 2, 1, 3};
+  const int8_t input_data[] = {1, 2, 3, 4, 5, 6};
+  int block_shape_shape[] = {1, 2};
+  const int32_t block_shape_data[] = {2, 1};
+  int paddings_shape[] = {2, 2, 2};
+  const int32_t paddings_data[] = {0, 0, 0, 0};
+  int output_shape[] = {4, 2, 1, 1, 3};
+  int8_t output_data[6];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape), 1.0f, 0),
+      tflite::testing::CreateInt32Tensor(
+          block_shape_data,
+          tflite::testing::IntArrayFromInts(block_shape_shape)),
+      tflite::testing::CreateInt32Tensor(
+          paddings_data, tflite::testing::IntArrayFromInts(paddings_shape)),
+      tflite::testing::CreateQuantizedTensor(
+          output_data, tflite::testing::IntArrayFromInts(output_shape), 1.0f,
+          0),
+  };
+  tflite::testing::ValidateSpaceToBatchNd(tensors, /*constant_shape=*/true,
+                                          input_data, output_data, 6);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,192 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/counting_executor.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxInputSize = 2 * 2000;
+constexpr int kMaxFeatureWeightsSize = 30 * 2000;
+constexpr int kMaxFilters = 30;
+constexpr int kMaxStateSize = 2 * 8 * kMaxFilters;
+constexpr int kMaxOutputSize = 2 * kMaxFilters;
+// Invocations of every run, so that the state holds several outputs of the
+// feature matmul.
+constexpr int kNumInvocations = 3;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+struct SvdfCase {
+  int batches;
+  int input_size;
+  int num_filters;
+  int rank;
+  int memory_size;
+  uint32_t seed;
+};
+
+// Output and activation state after kNumInvocations invocations.
+struct SvdfRun {
+  int8_t output[kMaxOutputSize];
+  int16_t state[kMaxStateSize];
+};
+
+// Invokes an int8 SVDF with random weights kNumInvocations times on random
+// inputs, with `executor` installed unless it is nullptr.
+void RunSvdf(const SvdfCase& test_case, ParallelExecutor* executor,
+             int num_threads, SvdfRun* run) {
+  const int batches = test_case.batches;
+  const int input_size = test_case.input_size;
+  const int num_filters = test_case.num_filters;
+  const int num_units = num_filters / test_case.rank;
+  const int memory_size = test_case.memory_size;
+  TF_LITE_MICRO_EXPECT_LE(batches * input_size, kMaxInputSize);
+  TF_LITE_MICRO_EXPECT_LE(num_filters * input_size, kMaxFeatureWeightsSize);
+  TF_LITE_MICRO_EXPECT_LE(num_filters, kMaxFilters);
+  TF_LITE_MICRO_EXPECT_LE(batches * memory_size * num_filters, kMaxStateSize);
+
+  Random random(test_case.seed);
+  static int8_t feature_weights[kMaxFeatureWeightsSize];
+  for (int i = 0; i < num_filters * input_size; ++i) {
+    feature_weights[i] = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  int16_t time_weights[kMaxFilters * 8];
+  TF_LITE_MICRO_EXPECT_LE(memory_size, 8);
+  for (int i = 0; i < num_filters * memory_size; ++i) {
+    time_weights[i] = static_cast<int16_t>(random.Next(-1000, 1000));
+  }
+  int32_t bias[kMaxFilters];
+  for (int i = 0; i < num_units; ++i) {
+    bias[i] = random.Next(-20000, 20000);
+  }
+  std::fill(run->state, run->state + batches * memory_size * num_filters, 0);
+  int8_t input_data[kMaxInputSize];
+
+  int input_shape[] = {2, batches, input_size};
+  int feature_weights_shape[] = {2, num_filters, input_size};
+  int time_weights_shape[] = {2, num_filters, memory_size};
+  int bias_shape[] = {1, num_units};
+  int state_shape[] = {2, batches, memory_size * num_filters};
+  int output_shape[] = {2, batches, num_units};
+  const float state_scale = 0.005f;
+  const float time_weights_scale = 0.002f;
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, IntArrayFromInts(input_shape), 0.02f,
+                            -5),
+      CreateQuantizedTensor(feature_weights,
+                            IntArrayFromInts(feature_weights_shape), 0.01f,
+                            0),
+      CreateQuantizedTensor(time_weights, IntArrayFromInts(time_weights_shape),
+                            time_weights_scale, 0),
+      CreateInt32Tensor(bias, IntArrayFromInts(bias_shape)),
+      CreateQuantizedTensor(run->state, IntArrayFromInts(state_shape),
+                            state_scale, 0, /*is_variable=*/true),
+      CreateQuantizedTensor(run->output, IntArrayFromInts(output_shape), 2.0f,
+                            3),
+  };
+  tensors[3].params.scale = state_scale * time_weights_scale;
+  int inputs_array_data[] = {5, 0, 1, 2, 3, 4};
+  int outputs_array_data[] = {1, 5};
+  TfLiteSVDFParams params = {test_case.rank, kTfLiteActRelu, false};
+  const TfLiteRegistration registration = ops::micro::Register_SVDF();
+  micro::KernelRunner runner(registration, tensors, 6,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data), &params,
+                             micro_test::reporter);
+  runner.SetExternalContext(kTfLiteMicroParallelContext, executor);
+  runner.SetNumThreads(num_threads);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.InitAndPrepare());
+  for (int invocation = 0; invocation < kNumInvocations; ++invocation) {
+    for (int i = 0; i < batches * input_size; ++i) {
+      input_data[i] = static_cast<int8_t>(random.Next(-128, 127));
+    }
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+  }
+}
+
+// Runs the SVDF of `test_case` on 2, 3 and 4 threads of a
+// ThreadPoolExecutor, which split the filters into chunks that do not all
+// have the same size, and expects the output and state of the serial kernel.
+void TestThreadsMatchSerial(const SvdfCase& test_case) {
+  static SvdfRun expected;
+  RunSvdf(test_case, nullptr, 1, &expected);
+  const int output_size =
+      test_case.batches * test_case.num_filters / test_case.rank;
+  const int state_size =
+      test_case.batches * test_case.memory_size * test_case.num_filters;
+  const int64_t total_macs =
+      static_cast<int64_t>(test_case.num_filters) * test_case.batches *
+      (test_case.input_size + test_case.memory_size);
+  for (int num_threads : {2, 3, 4}) {
+    static SvdfRun run;
+    CountingExecutor executor(num_threads);
+    RunSvdf(test_case, &executor, num_threads, &run);
+    const int expected_chunks = static_cast<int>(std::min<int64_t>(
+        {num_threads, test_case.num_filters,
+         total_macs / micro::kMinParallelChunkMacs}));
+    TF_LITE_MICRO_EXPECT_GT(expected_chunks, 1);
+    TF_LITE_MICRO_EXPECT_EQ(expected_chunks, executor.last_num_tasks());
+    for (int i = 0; i < output_size; ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(expected.output[i], run.output[i]);
+    }
+    for (int i = 0; i < state_size; ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(expected.state[i], run.state[i]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(Int8ThreadsMatchSerial) {
+  tflite::testing::TestThreadsMatchSerial({2, 2000, 30, 2, 8, 1});
+}
+
+// 21 filters of rank 3, one batch.
+TF_LITE_MICRO_TEST(Int8Rank3ThreadsMatchSerial) {
+  tflite::testing::TestThreadsMatchSerial({1, 1800, 21, 3, 5, 2});
+}
+
+TF_LITE_MICRO_TESTS_END
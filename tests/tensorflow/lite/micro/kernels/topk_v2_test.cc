@@ -0,0 +1,214 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kMaxRowSize = 1000;
+constexpr int kMaxK = 8;
+
+// Runs TOPK_V2 on tensors {input, k, values, indices}.
+TfLiteStatus RunTopK(TfLiteTensor* tensors, bool constant_k) {
+  if (constant_k) {
+    tensors[1].allocation_type = kTfLiteMmapRo;
+  }
+  int inputs_array_data[] = {2, 0, 1};
+  int outputs_array_data[] = {2, 2, 3};
+  const TfLiteRegistration registration = ops::micro::Register_TOPK_V2();
+  micro::KernelRunner runner(registration, tensors, 4,
+                             IntArrayFromInts(inputs_array_data),
+                             IntArrayFromInts(outputs_array_data),
+                             /*builtin_data=*/nullptr, micro_test::reporter);
+  TF_LITE_ENSURE_STATUS(runner.InitAndPrepare());
+  return runner.Invoke();
+}
+
+// Picks the k best entries of `row` one at a time, larger values and then
+// lower indices first, to check the heap selection of the kernel.
+template <typename T>
+void NaiveTopK(const T* row, int size, int k, T* values, int32_t* indices) {
+  bool taken[kMaxRowSize] = {};
+  for (int i = 0; i < k; ++i) {
+    int best = -1;
+    for (int j = 0; j < size; ++j) {
+      if (!taken[j] && (best < 0 || row[j] > row[best])) {
+        best = j;
+      }
+    }
+    taken[best] = true;
+    values[i] = row[best];
+    indices[i] = best;
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TiesKeepLowerIndexFirstFloat) {
+  int input_shape[] = {1, 7};
+  const float input_data[] = {3, 9, 1, 9, 3, 7, 3};
+  int k_shape[] = {1, 1};
+  const int32_t k_data[] = {4};
+  int output_shape[] = {1, 4};
+  float values_data[4];
+  int32_t indices_data[4];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateFloatTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape)),
+      tflite::testing::CreateInt32Tensor(
+          k_data, tflite::testing::IntArrayFromInts(k_shape)),
+      tflite::testing::CreateFloatTensor(
+          values_data, tflite::testing::IntArrayFromInts(output_shape)),
+      tflite::testing::CreateInt32Tensor(
+          indices_data, tflite::testing::IntArrayFromInts(output_shape)),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, tflite::testing::RunTopK(tensors, true));
+  const float expected_values[] = {9, 9, 7, 3};
+  const int32_t expected_indices[] = {1, 3, 5, 0};
+  for (int i = 0; i < 4; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_values[i], values_data[i]);
+    TF_LITE_MICRO_EXPECT_EQ(expected_indices[i], indices_data[i]);
+  }
+}
+
+TF_LITE_MICRO_TEST(KEqualToRowSizeSortsRow) {
+  int shape[] = {2, 2, 3};
+  const int32_t input_data[] = {5, -1, 8, 0, 0, -4};
+  int k_shape[] = {0};
+  const int32_t k_data[] = {3};
+  int32_t values_data[6];
+  int32_t indices_data[6];
+  TfLiteIntArray* dims = tflite::testing::IntArrayFromInts(shape);
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateInt32Tensor(input_data, dims),
+      tflite::testing::CreateInt32Tensor(
+          k_data, tflite::testing::IntArrayFromInts(k_shape)),
+      tflite::testing::CreateInt32Tensor(values_data, dims),
+      tflite::testing::CreateInt32Tensor(indices_data, dims),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, tflite::testing::RunTopK(tensors, true));
+  const int32_t expected_values[] = {8, 5, -1, 0, 0, -4};
+  const int32_t expected_indices[] = {2, 0, 1, 0, 1, 2};
+  for (int i = 0; i < 6; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_values[i], values_data[i]);
+    TF_LITE_MICRO_EXPECT_EQ(expected_indices[i], indices_data[i]);
+  }
+}
+
+TF_LITE_MICRO_TEST(LargeClassCountMatchesNaiveSelectionInt8) {
+  constexpr int kRows = 2;
+  constexpr int kRowSize = tflite::testing::kMaxRowSize;
+  constexpr int kK = tflite::testing::kMaxK;
+  int input_shape[] = {2, kRows, kRowSize};
+  static int8_t input_data[kRows * kRowSize];
+  uint32_t state = 12345;
+  for (int i = 0; i < kRows * kRowSize; ++i) {
+    state = state * 1664525u + 1013904223u;
+    // Few distinct values, so that the selection has to break many ties.
+    input_data[i] = static_cast<int8_t>(static_cast<int>(state >> 24) % 64);
+  }
+  int k_shape[] = {1, 1};
+  const int32_t k_data[] = {kK};
+  int output_shape[] = {2, kRows, kK};
+  int8_t values_data[kRows * kK];
+  int32_t indices_data[kRows * kK];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape), 0.1f, 3),
+      tflite::testing::CreateInt32Tensor(
+          k_data, tflite::testing::IntArrayFromInts(k_shape)),
+      tflite::testing::CreateQuantizedTensor(
+          values_data, tflite::testing::IntArrayFromInts(output_shape), 0.1f,
+          3),
+      tflite::testing::CreateInt32Tensor(
+          indices_data, tflite::testing::IntArrayFromInts(output_shape)),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, tflite::testing::RunTopK(tensors, true));
+  for (int row = 0; row < kRows; ++row) {
+    int8_t expected_values[kK];
+    int32_t expected_indices[kK];
+    tflite::testing::NaiveTopK(input_data + row * kRowSize, kRowSize, kK,
+                               expected_values, expected_indices);
+    for (int i = 0; i < kK; ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(expected_values[i], values_data[row * kK + i]);
+      TF_LITE_MICRO_EXPECT_EQ(expected_indices[i],
+                              indices_data[row * kK + i]);
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(RejectsRuntimeK) {
+  int input_shape[] = {1, 3};
+  const float input_data[] = {1, 2, 3};
+  int k_shape[] = {1, 1};
+  const int32_t k_data[] = {1};
+  int output_shape[] = {1, 1};
+  float values_data[1];
+  int32_t indices_data[1];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateFloatTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape)),
+      tflite::testing::CreateInt32Tensor(
+          k_data, tflite::testing::IntArrayFromInts(k_shape)),
+      tflite::testing::CreateFloatTensor(
+          values_data, tflite::testing::IntArrayFromInts(output_shape)),
+      tflite::testing::CreateInt32Tensor(
+          indices_data, tflite::testing::IntArrayFromInts(output_shape)),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunTopK(tensors, false));
+}
+
+// Values are copied unchanged, so they must keep the input quantization.
+TF_LITE_MICRO_TEST(RejectsRequantizedValues) {
+  int input_shape[] = {1, 3};
+  const int8_t input_data[] = {1, 2, 3};
+  int k_shape[] = {1, 1};
+  const int32_t k_data[] = {1};
+  int output_shape[] = {1, 1};
+  int8_t values_data[1];
+  int32_t indices_data[1];
+  TfLiteTensor tensors[] = {
+      tflite::testing::CreateQuantizedTensor(
+          input_data, tflite::testing::IntArrayFromInts(input_shape), 0.5f, 0),
+      tflite::testing::CreateInt32Tensor(
+          k_data, tflite::testing::IntArrayFromInts(k_shape)),
+      tflite::testing::CreateQuantizedTensor(
+          values_data, tflite::testing::IntArrayFromInts(output_shape), 0.25f,
+          0),
+      tflite::testing::CreateInt32Tensor(
+          indices_data, tflite::testing::IntArrayFromInts(output_shape)),
+  };
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunTopK(tensors, true));
+  tensors[2].params.scale = 0.5f;
+  tensors[2].params.zero_point = 1;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunTopK(tensors, true));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,158 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 8 * 1024;
+
+// Number of calls to the Prepare of FailingOnceResolver.
+int num_prepares = 0;
+
+// Prepare of the RELU kernel.
+TfLiteStatus (*relu_prepare)(TfLiteContext* context, TfLiteNode* node);
+
+// Fails the first Prepare only, then runs the Prepare of the kernel.
+TfLiteStatus PrepareFailingOnce(TfLiteContext* context, TfLiteNode* node) {
+  if (num_prepares++ == 0) {
+    return kTfLiteError;
+  }
+  return relu_prepare(context, node);
+}
+
+// Resolves RELU to a kernel whose first Prepare fails, so that running the
+// failed step again would succeed, and the other operators as
+// AllOpsResolver.
+class FailingOnceResolver : public MicroOpResolver {
+ public:
+  FailingOnceResolver() {
+    registration_ = *resolver_.FindOp(BuiltinOperator_RELU);
+    relu_prepare = registration_.prepare;
+    registration_.prepare = PrepareFailingOnce;
+  }
+
+  const TfLiteRegistration* FindOp(BuiltinOperator op) const override {
+    if (op == BuiltinOperator_RELU) {
+      return &registration_;
+    }
+    return resolver_.FindOp(op);
+  }
+
+  const TfLiteRegistration* FindOp(const char* op) const override {
+    return resolver_.FindOp(op);
+  }
+
+  BuiltinParseFunction GetOpDataParser(BuiltinOperator op) const override {
+    return resolver_.GetOpDataParser(op);
+  }
+
+ private:
+  AllOpsResolver resolver_;
+  TfLiteRegistration registration_;
+};
+
+const Model* BuildReluModel(TestModelBuilder* builder) {
+  const int input = builder->AddTensor({1, 8}, TensorType_FLOAT32);
+  const int output = builder->AddTensor({1, 8}, TensorType_FLOAT32);
+  builder->AddOperator(BuiltinOperator_RELU, {input}, {output});
+  return builder->Finish({input}, {output});
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FailedAllocationIsFinal) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model = tflite::testing::BuildReluModel(&builder);
+  tflite::testing::FailingOnceResolver resolver;
+  tflite::testing::num_prepares = 0;
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.initialization_status());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(1, tflite::testing::num_prepares);
+}
+
+TF_LITE_MICRO_TEST(FailedAllocationStepIsFinal) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model = tflite::testing::BuildReluModel(&builder);
+  tflite::testing::FailingOnceResolver resolver;
+  tflite::testing::num_prepares = 0;
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  bool done = false;
+  // Starts the allocation and runs the Init of the operator.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensorsStep(&done));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensorsStep(&done));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          interpreter.AllocateTensorsStep(&done));
+  TF_LITE_MICRO_EXPECT(!done);
+  for (int i = 0; i < 3; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                            interpreter.AllocateTensorsStep(&done));
+    TF_LITE_MICRO_EXPECT(!done);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(1, tflite::testing::num_prepares);
+}
+
+TF_LITE_MICRO_TEST(AllocatesOnANewInterpreterAfterAFailure) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model = tflite::testing::BuildReluModel(&builder);
+  tflite::testing::FailingOnceResolver resolver;
+  tflite::testing::num_prepares = 0;
+  {
+    tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                         tflite::testing::kArenaSize,
+                                         micro_test::reporter);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.AllocateTensors());
+  }
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  const float input[] = {-2.0f, -1.0f, 0.0f, 0.5f, 1.0f, 2.0f, -0.5f, 3.0f};
+  for (int i = 0; i < 8; ++i) {
+    interpreter.input(0)->data.f[i] = input[i];
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  for (int i = 0; i < 8; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(input[i] > 0.0f ? input[i] : 0.0f,
+                            interpreter.output(0)->data.f[i]);
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
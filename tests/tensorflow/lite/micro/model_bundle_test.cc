@@ -0,0 +1,273 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_bundle.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// tests/CMakeLists.txt builds the bundle_models tool for this test.
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr size_t kMaxBundleSize = 8 * 1024;
+constexpr int kInputSize = 24;
+constexpr int kOutputSize = 10;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+// An int8 FULLY_CONNECTED whose 240 byte filter is the same in every model
+// and whose bias, below the 64 bytes bundle_models shares by default,
+// depends on `seed`.
+void BuildModel(TestModelBuilder* builder, uint32_t seed) {
+  Random filter_random(1);
+  int8_t filter_data[kOutputSize * kInputSize];
+  for (int8_t& value : filter_data) {
+    value = static_cast<int8_t>(filter_random.Next(-127, 127));
+  }
+  Random bias_random(seed);
+  int32_t bias_data[kOutputSize];
+  for (int32_t& value : bias_data) {
+    value = bias_random.Next(-3000, 3000);
+  }
+  const int input = builder->AddQuantizedTensor({1, kInputSize},
+                                                TensorType_INT8, 0.05f, -3);
+  const int filter = builder->AddQuantizedTensor(
+      {kOutputSize, kInputSize}, TensorType_INT8, 0.01f, 0, filter_data,
+      sizeof(filter_data));
+  const int bias = builder->AddQuantizedTensor(
+      {kOutputSize}, TensorType_INT32, 0.0005f, 0, bias_data,
+      sizeof(bias_data));
+  const int output = builder->AddQuantizedTensor({1, kOutputSize},
+                                                 TensorType_INT8, 0.1f, 4);
+  builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                       {input, filter, bias}, {output});
+  builder->Finish({input}, {output});
+}
+
+// Bundles the models built by `builders` with bundle_models into `bundle`
+// and returns the size of the bundle, 0 if the tool failed.
+size_t BundleModels(const TestModelBuilder* builders, int num_models,
+                    uint8_t* bundle) {
+  const std::string prefix = TFLITE_MICRO_TEST_NAME;
+  const std::string bundle_path = prefix + ".bundle";
+  std::string command = std::string(TFLITE_MICRO_BUNDLE_MODELS) + " " +
+                        bundle_path;
+  for (int i = 0; i < num_models; ++i) {
+    const std::string model_path =
+        prefix + "_" + std::to_string(i) + ".tflite";
+    std::ofstream model_file(model_path, std::ios::binary);
+    model_file.write(reinterpret_cast<const char*>(builders[i].data()),
+                     builders[i].size());
+    if (!model_file) {
+      return 0;
+    }
+    command += " " + model_path;
+  }
+  command += " > /dev/null";
+  if (std::system(command.c_str()) != 0) {
+    return 0;
+  }
+  std::ifstream bundle_file(bundle_path, std::ios::binary);
+  const std::vector<char> data((std::istreambuf_iterator<char>(bundle_file)),
+                               std::istreambuf_iterator<char>());
+  if (data.size() > kMaxBundleSize) {
+    return 0;
+  }
+  std::memcpy(bundle, data.data(), data.size());
+  return data.size();
+}
+
+// Runs `model` on fixed input data.
+void RunModel(const Model* model, int8_t* output) {
+  static uint8_t arena[kArenaSize];
+  AllOpsResolver resolver;
+  MicroInterpreter interpreter(model, resolver, arena, kArenaSize,
+                               micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  Random random(2);
+  for (int i = 0; i < kInputSize; ++i) {
+    interpreter.input(0)->data.int8[i] =
+        static_cast<int8_t>(random.Next(-128, 127));
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  std::memcpy(output, interpreter.output(0)->data.int8, kOutputSize);
+}
+
+// Data of the FULLY_CONNECTED filter of `model`.
+const uint8_t* FilterData(const Model* model) {
+  const SubGraph* subgraph = model->subgraphs()->Get(0);
+  const Tensor* filter =
+      subgraph->tensors()->Get(subgraph->operators()->Get(0)->inputs()->Get(1));
+  return model->buffers()->Get(filter->buffer())->data()->data();
+}
+
+void WriteWord(uint8_t* bundle, int index, uint32_t value) {
+  flatbuffers::WriteScalar<uint32_t>(bundle + index * sizeof(uint32_t),
+                                     value);
+}
+
+// Builds a bundle of two models that share their filter.
+size_t BuildBundle(uint8_t* bundle) {
+  TestModelBuilder builders[2];
+  BuildModel(&builders[0], 10);
+  BuildModel(&builders[1], 11);
+  const size_t size = BundleModels(builders, 2, bundle);
+  TF_LITE_MICRO_EXPECT_GT(size, static_cast<size_t>(0));
+  return size;
+}
+
+// Expects the bundle to be rejected.
+void ExpectInvalid(const uint8_t* bundle, size_t size) {
+  ModelBundle model_bundle(bundle, size, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, model_bundle.initialization_status());
+  TF_LITE_MICRO_EXPECT_EQ(0, model_bundle.num_models());
+  TF_LITE_MICRO_EXPECT(model_bundle.GetModel(0) == nullptr);
+}
+
+alignas(kModelBundleAlignment) uint8_t bundle_data[kMaxBundleSize + 16];
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(BundledModelsShareBuffersAndRun) {
+  uint8_t* bundle = tflite::testing::bundle_data;
+  const size_t size = tflite::testing::BuildBundle(bundle);
+  tflite::ModelBundle model_bundle(bundle, size, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, model_bundle.initialization_status());
+  TF_LITE_MICRO_EXPECT_EQ(2, model_bundle.num_models());
+  TF_LITE_MICRO_EXPECT_EQ(1, model_bundle.num_shared_buffers());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, model_bundle.VerifySharedBuffers());
+  TF_LITE_MICRO_EXPECT(
+      tflite::testing::FilterData(model_bundle.GetModel(0)) ==
+      tflite::testing::FilterData(model_bundle.GetModel(1)));
+
+  for (int i = 0; i < 2; ++i) {
+    tflite::testing::TestModelBuilder builder;
+    tflite::testing::BuildModel(&builder, 10 + i);
+    int8_t expected[tflite::testing::kOutputSize];
+    tflite::testing::RunModel(tflite::GetModel(builder.data()), expected);
+    int8_t output[tflite::testing::kOutputSize];
+    tflite::testing::RunModel(model_bundle.GetModel(i), output);
+    for (int j = 0; j < tflite::testing::kOutputSize; ++j) {
+      TF_LITE_MICRO_EXPECT_EQ(expected[j], output[j]);
+    }
+    TF_LITE_MICRO_EXPECT_EQ(
+        size - (static_cast<const uint8_t*>(model_bundle.model_data(i)) -
+                bundle),
+        model_bundle.model_extent(i));
+  }
+}
+
+TF_LITE_MICRO_TEST(RejectsOutOfRangeModelIndex) {
+  uint8_t* bundle = tflite::testing::bundle_data;
+  const size_t size = tflite::testing::BuildBundle(bundle);
+  tflite::ModelBundle model_bundle(bundle, size, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, model_bundle.initialization_status());
+  for (int index : {-1, 2, 1000}) {
+    TF_LITE_MICRO_EXPECT(model_bundle.GetModel(index) == nullptr);
+    TF_LITE_MICRO_EXPECT(model_bundle.model_data(index) == nullptr);
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(0),
+                            model_bundle.model_extent(index));
+  }
+}
+
+TF_LITE_MICRO_TEST(RejectsTruncatedBundle) {
+  uint8_t* bundle = tflite::testing::bundle_data;
+  const size_t size = tflite::testing::BuildBundle(bundle);
+  // Shorter than the header, the directories and the shared buffer.
+  tflite::testing::ExpectInvalid(bundle, 8);
+  tflite::testing::ExpectInvalid(bundle, 20);
+  tflite::testing::ExpectInvalid(bundle, size - 16);
+}
+
+TF_LITE_MICRO_TEST(RejectsCorruptHeader) {
+  uint8_t* bundle = tflite::testing::bundle_data;
+  const size_t size = tflite::testing::BuildBundle(bundle);
+  const struct {
+    int word;
+    uint32_t value;
+  } corruptions[] = {
+      {0, tflite::kModelBundleMagic + 1},
+      {1, tflite::kModelBundleVersion + 1},
+      // No models, more models or shared buffers than fit in the bundle.
+      {2, 0},
+      {2, 0x40000000},
+      {3, 0x40000000},
+      // A model before the end of the directories, a misaligned one, one
+      // past the end.
+      {4, 16},
+      {4, 36},
+      {5, 0x10000},
+  };
+  for (const auto& corruption : corruptions) {
+    tflite::testing::BuildBundle(bundle);
+    tflite::testing::WriteWord(bundle, corruption.word, corruption.value);
+    tflite::testing::ExpectInvalid(bundle, size);
+  }
+}
+
+TF_LITE_MICRO_TEST(RejectsMisalignedBundle) {
+  uint8_t* bundle = tflite::testing::bundle_data;
+  const size_t size = tflite::testing::BuildBundle(bundle);
+  std::memmove(bundle + 4, bundle, size);
+  tflite::testing::ExpectInvalid(bundle + 4, size);
+}
+
+TF_LITE_MICRO_TEST(DetectsCorruptSharedBuffer) {
+  uint8_t* bundle = tflite::testing::bundle_data;
+  const size_t size = tflite::testing::BuildBundle(bundle);
+  tflite::ModelBundle model_bundle(bundle, size, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, model_bundle.initialization_status());
+  uint8_t* filter = const_cast<uint8_t*>(
+      tflite::testing::FilterData(model_bundle.GetModel(0)));
+  filter[17] ^= 1;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, model_bundle.VerifySharedBuffers());
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,221 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_byte_order.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// tests/CMakeLists.txt builds the convert_byte_order tool for this test and
+// builds the test once more with TF_LITE_MICRO_REQUIRE_HOST_BYTE_ORDER. The
+// model files are named after TFLITE_MICRO_TEST_NAME so that both can run at
+// the same time.
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 16 * 1024;
+constexpr int kInputSize = 24;
+constexpr int kOutputSize = 10;
+
+const char kPlainModelPath[] = TFLITE_MICRO_TEST_NAME "_plain.tflite";
+const char kConvertedModelPath[] = TFLITE_MICRO_TEST_NAME "_converted.tflite";
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+// An int8 FULLY_CONNECTED, whose int32 bias and dims are the arrays the
+// conversion changes on big-endian targets.
+void BuildModel(TestModelBuilder* builder) {
+  Random random(1);
+  int8_t filter_data[kOutputSize * kInputSize];
+  for (int8_t& value : filter_data) {
+    value = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  int32_t bias_data[kOutputSize];
+  for (int32_t& value : bias_data) {
+    value = random.Next(-3000, 3000);
+  }
+  const int input = builder->AddQuantizedTensor({1, kInputSize},
+                                                TensorType_INT8, 0.05f, -3);
+  const int filter = builder->AddQuantizedTensor(
+      {kOutputSize, kInputSize}, TensorType_INT8, 0.01f, 0, filter_data,
+      sizeof(filter_data));
+  const int bias = builder->AddQuantizedTensor(
+      {kOutputSize}, TensorType_INT32, 0.0005f, 0, bias_data,
+      sizeof(bias_data));
+  const int output = builder->AddQuantizedTensor({1, kOutputSize},
+                                                 TensorType_INT8, 0.1f, 4);
+  builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                       {input, filter, bias}, {output});
+  builder->Finish({input}, {output});
+}
+
+// Converts the model built by `builder` with convert_byte_order, for the
+// byte order of the host or the other one. Returns the converted
+// flatbuffer, empty if the tool failed.
+std::vector<char> ConvertModel(const TestModelBuilder& builder,
+                               bool host_byte_order) {
+  std::ofstream plain_file(kPlainModelPath, std::ios::binary);
+  plain_file.write(reinterpret_cast<const char*>(builder.data()),
+                   builder.size());
+  plain_file.close();
+  const bool little_endian = host_byte_order == FLATBUFFERS_LITTLEENDIAN;
+  const std::string command =
+      std::string(TFLITE_MICRO_CONVERT_BYTE_ORDER) +
+      (little_endian ? " --little_endian " : " ") + kPlainModelPath + " " +
+      kConvertedModelPath + " > /dev/null";
+  if (!plain_file || std::system(command.c_str()) != 0) {
+    return std::vector<char>();
+  }
+  std::ifstream converted_file(kConvertedModelPath, std::ios::binary);
+  return std::vector<char>((std::istreambuf_iterator<char>(converted_file)),
+                           std::istreambuf_iterator<char>());
+}
+
+// Returns the byte order table of a converted model.
+int32_t* GetByteOrderTable(std::vector<char>* model_data) {
+  const Model* model = GetModel(model_data->data());
+  for (size_t i = 0; i < model->metadata()->size(); ++i) {
+    const Metadata* metadata = model->metadata()->Get(i);
+    if (metadata->name()->str() == kHostByteOrderMetadata) {
+      const uint8_t* table =
+          model->buffers()->Get(metadata->buffer())->data()->data();
+      return reinterpret_cast<int32_t*>(const_cast<uint8_t*>(table));
+    }
+  }
+  return nullptr;
+}
+
+// Allocates and, if that succeeds, runs the model on fixed input data.
+TfLiteStatus RunModel(const void* model_data, int8_t* output) {
+  static uint8_t arena[kArenaSize];
+  AllOpsResolver resolver;
+  MicroInterpreter interpreter(GetModel(model_data), resolver, arena,
+                               kArenaSize, micro_test::reporter);
+  TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+  Random random(2);
+  for (int i = 0; i < kInputSize; ++i) {
+    interpreter.input(0)->data.int8[i] =
+        static_cast<int8_t>(random.Next(-128, 127));
+  }
+  TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+  std::memcpy(output, interpreter.output(0)->data.int8, kOutputSize);
+  return kTfLiteOk;
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(ConvertedModelMatchesPlainModel) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  std::vector<char> converted =
+      tflite::testing::ConvertModel(builder, /*host_byte_order=*/true);
+  TF_LITE_MICRO_EXPECT(!converted.empty());
+  TF_LITE_MICRO_EXPECT(tflite::testing::GetByteOrderTable(&converted) !=
+                       nullptr);
+  int8_t converted_output[tflite::testing::kOutputSize];
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      tflite::testing::RunModel(converted.data(), converted_output));
+
+  // A plain model needs the in-place conversion on big-endian hosts, which
+  // TF_LITE_MICRO_REQUIRE_HOST_BYTE_ORDER leaves out.
+  int8_t plain_output[tflite::testing::kOutputSize];
+  const TfLiteStatus plain_status =
+      tflite::testing::RunModel(builder.data(), plain_output);
+#if defined(TF_LITE_MICRO_REQUIRE_HOST_BYTE_ORDER) && !FLATBUFFERS_LITTLEENDIAN
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, plain_status);
+#else
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, plain_status);
+  for (int i = 0; i < tflite::testing::kOutputSize; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(plain_output[i], converted_output[i]);
+  }
+#endif
+}
+
+TF_LITE_MICRO_TEST(RejectsModelConvertedForOtherByteOrder) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  const std::vector<char> converted =
+      tflite::testing::ConvertModel(builder, /*host_byte_order=*/false);
+  TF_LITE_MICRO_EXPECT(!converted.empty());
+  int8_t output[tflite::testing::kOutputSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunModel(converted.data(), output));
+}
+
+TF_LITE_MICRO_TEST(RejectsCorruptByteOrderMark) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  std::vector<char> converted =
+      tflite::testing::ConvertModel(builder, /*host_byte_order=*/true);
+  int32_t* table = tflite::testing::GetByteOrderTable(&converted);
+  TF_LITE_MICRO_EXPECT(table != nullptr);
+  table[0] = 0x01020305;
+  int8_t output[tflite::testing::kOutputSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunModel(converted.data(), output));
+}
+
+TF_LITE_MICRO_TEST(RejectsArraysThatDoNotMatchTheModel) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  std::vector<char> converted =
+      tflite::testing::ConvertModel(builder, /*host_byte_order=*/true);
+  int32_t* table = tflite::testing::GetByteOrderTable(&converted);
+  TF_LITE_MICRO_EXPECT(table != nullptr);
+  // The last dim of the input tensor, [1, kInputSize].
+  const int32_t dims_offset = table[tflite::HostByteOrderDimsIndex(0)];
+  TF_LITE_MICRO_EXPECT_EQ(tflite::testing::kInputSize,
+                          table[dims_offset + 2]);
+  table[dims_offset + 2] = tflite::testing::kInputSize + 1;
+  int8_t output[tflite::testing::kOutputSize];
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          tflite::testing::RunModel(converted.data(), output));
+}
+
+TF_LITE_MICRO_TESTS_END
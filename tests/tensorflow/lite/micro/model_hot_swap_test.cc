@@ -0,0 +1,252 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_hot_swap.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 32 * 1024;
+constexpr int kInputSize = 16;
+constexpr int kOutputSize = 8;
+
+// Builds an int8 FULLY_CONNECTED model whose weights depend on `seed`, so
+// that the outputs tell the models apart. `num_layers` chains that many
+// layers of kInputSize outputs before the last one, to make larger models.
+const Model* BuildModel(TestModelBuilder* builder, int seed,
+                        int num_layers = 0) {
+  static int8_t weights[kInputSize * kInputSize];
+  for (int i = 0; i < kInputSize * kInputSize; ++i) {
+    weights[i] = static_cast<int8_t>((i * (2 * seed + 1) + seed) % 255 - 127);
+  }
+  FullyConnectedOptionsT options;
+  const int input =
+      builder->AddQuantizedTensor({1, kInputSize}, TensorType_INT8, 0.1f, 0);
+  int layer_input = input;
+  for (int layer = 0; layer < num_layers; ++layer) {
+    const int filter = builder->AddQuantizedTensor(
+        {kInputSize, kInputSize}, TensorType_INT8, 0.01f, 0, weights,
+        kInputSize * kInputSize);
+    const int layer_output =
+        builder->AddQuantizedTensor({1, kInputSize}, TensorType_INT8, 0.1f, 0);
+    builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                         {layer_input, filter, -1}, {layer_output}, options);
+    layer_input = layer_output;
+  }
+  const int filter = builder->AddQuantizedTensor(
+      {kOutputSize, kInputSize}, TensorType_INT8, 0.01f, 0, weights,
+      kOutputSize * kInputSize);
+  const int output =
+      builder->AddQuantizedTensor({1, kOutputSize}, TensorType_INT8, 0.05f, 0);
+  builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                       {layer_input, filter, -1}, {output}, options);
+  return builder->Finish({input}, {output});
+}
+
+void FillInput(TfLiteTensor* input) {
+  for (int i = 0; i < kInputSize; ++i) {
+    input->data.int8[i] = static_cast<int8_t>(i * 9 - 70);
+  }
+}
+
+// Output of `model` run by a standalone interpreter.
+void RunReference(const Model* model, int8_t* output) {
+  static uint8_t arena[kArenaSize];
+  AllOpsResolver resolver;
+  MicroInterpreter interpreter(model, resolver, arena, kArenaSize,
+                               micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  FillInput(interpreter.input(0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  std::memcpy(output, interpreter.output(0)->data.int8, kOutputSize);
+}
+
+// Invokes the serving interpreter and expects the output of `expected`.
+void ExpectServes(ModelHotSwap* hot_swap, const int8_t* expected) {
+  MicroInterpreter* interpreter = hot_swap->interpreter();
+  TF_LITE_MICRO_EXPECT(interpreter != nullptr);
+  FillInput(interpreter->input(0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter->Invoke());
+  for (int i = 0; i < kOutputSize; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(expected[i], interpreter->output(0)->data.int8[i]);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(ServesOldModelWhileUpdateLoads) {
+  tflite::testing::TestModelBuilder builder_a;
+  tflite::testing::TestModelBuilder builder_b;
+  const tflite::Model* model_a = tflite::testing::BuildModel(&builder_a, 1);
+  const tflite::Model* model_b =
+      tflite::testing::BuildModel(&builder_b, 2, /*num_layers=*/2);
+  int8_t expected_a[tflite::testing::kOutputSize];
+  int8_t expected_b[tflite::testing::kOutputSize];
+  tflite::testing::RunReference(model_a, expected_a);
+  tflite::testing::RunReference(model_b, expected_b);
+  TF_LITE_MICRO_EXPECT(
+      std::memcmp(expected_a, expected_b, tflite::testing::kOutputSize) != 0);
+
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::AllOpsResolver resolver;
+  tflite::ModelHotSwap hot_swap(arena, tflite::testing::kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT(hot_swap.interpreter() == nullptr);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.Load(model_a, resolver));
+  tflite::testing::ExpectServes(&hot_swap, expected_a);
+  TF_LITE_MICRO_EXPECT(!hot_swap.SwitchIfReady());
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.BeginUpdate(model_b, resolver));
+  TF_LITE_MICRO_EXPECT(hot_swap.shadow() != nullptr);
+  bool ready = false;
+  int steps = 0;
+  while (!ready) {
+    TF_LITE_MICRO_EXPECT(!hot_swap.SwitchIfReady());
+    tflite::testing::ExpectServes(&hot_swap, expected_a);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.UpdateStep(&ready));
+    ++steps;
+  }
+  // Tensor structs, Init and Prepare of three operators, memory plan.
+  TF_LITE_MICRO_EXPECT_GE(steps, 5);
+  tflite::testing::ExpectServes(&hot_swap, expected_a);
+  TF_LITE_MICRO_EXPECT(hot_swap.SwitchIfReady());
+  tflite::testing::ExpectServes(&hot_swap, expected_b);
+  TF_LITE_MICRO_EXPECT(hot_swap.shadow() == nullptr);
+  TF_LITE_MICRO_EXPECT(!hot_swap.SwitchIfReady());
+
+  // The region of model A is reused for the next update.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.BeginUpdate(model_a, resolver));
+  ready = false;
+  while (!ready) {
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.UpdateStep(&ready));
+  }
+  TF_LITE_MICRO_EXPECT(hot_swap.SwitchIfReady());
+  tflite::testing::ExpectServes(&hot_swap, expected_a);
+}
+
+TF_LITE_MICRO_TEST(LoadFailsOnceLoaded) {
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model = tflite::testing::BuildModel(&builder, 1);
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::AllOpsResolver resolver;
+  tflite::ModelHotSwap hot_swap(arena, tflite::testing::kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.Load(model, resolver));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, hot_swap.Load(model, resolver));
+}
+
+TF_LITE_MICRO_TEST(AbortedAndFailedUpdatesKeepServing) {
+  tflite::testing::TestModelBuilder builder_a;
+  tflite::testing::TestModelBuilder builder_b;
+  tflite::testing::TestModelBuilder large_builder;
+  const tflite::Model* model_a = tflite::testing::BuildModel(&builder_a, 1);
+  const tflite::Model* model_b = tflite::testing::BuildModel(&builder_b, 2);
+  int8_t expected_a[tflite::testing::kOutputSize];
+  tflite::testing::RunReference(model_a, expected_a);
+
+  // Regions of 2 KB are too small for the 60 layers of the large model.
+  constexpr size_t kSmallArenaSize = 4 * 1024;
+  static uint8_t arena[kSmallArenaSize];
+  tflite::AllOpsResolver resolver;
+  tflite::ModelHotSwap hot_swap(arena, kSmallArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.Load(model_a, resolver));
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.BeginUpdate(model_b, resolver));
+  // Only one update at a time.
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          hot_swap.BeginUpdate(model_b, resolver));
+  bool ready = false;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.UpdateStep(&ready));
+  hot_swap.AbortUpdate();
+  TF_LITE_MICRO_EXPECT(hot_swap.shadow() == nullptr);
+  TF_LITE_MICRO_EXPECT(!hot_swap.SwitchIfReady());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, hot_swap.UpdateStep(&ready));
+  tflite::testing::ExpectServes(&hot_swap, expected_a);
+
+  const tflite::Model* large_model =
+      tflite::testing::BuildModel(&large_builder, 3, /*num_layers=*/60);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          hot_swap.BeginUpdate(large_model, resolver));
+  TfLiteStatus status = kTfLiteOk;
+  ready = false;
+  while (status == kTfLiteOk && !ready) {
+    status = hot_swap.UpdateStep(&ready);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, status);
+  TF_LITE_MICRO_EXPECT(hot_swap.shadow() == nullptr);
+  TF_LITE_MICRO_EXPECT(!hot_swap.SwitchIfReady());
+  tflite::testing::ExpectServes(&hot_swap, expected_a);
+}
+
+// The update runs on its own thread while the main thread keeps invoking, as
+// with an update task beside the inference task.
+TF_LITE_MICRO_TEST(UpdatesFromAnotherThread) {
+  tflite::testing::TestModelBuilder builder_a;
+  tflite::testing::TestModelBuilder builder_b;
+  const tflite::Model* model_a = tflite::testing::BuildModel(&builder_a, 1);
+  const tflite::Model* model_b =
+      tflite::testing::BuildModel(&builder_b, 2, /*num_layers=*/3);
+  int8_t expected_a[tflite::testing::kOutputSize];
+  int8_t expected_b[tflite::testing::kOutputSize];
+  tflite::testing::RunReference(model_a, expected_a);
+  tflite::testing::RunReference(model_b, expected_b);
+
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::AllOpsResolver resolver;
+  tflite::ModelHotSwap hot_swap(arena, tflite::testing::kArenaSize,
+                                micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.Load(model_a, resolver));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, hot_swap.BeginUpdate(model_b, resolver));
+
+  std::atomic<bool> update_ok(true);
+  std::thread updater([&hot_swap, &update_ok]() {
+    bool ready = false;
+    while (!ready) {
+      if (hot_swap.UpdateStep(&ready) != kTfLiteOk) {
+        update_ok.store(false);
+        return;
+      }
+      std::this_thread::yield();
+    }
+  });
+  while (!hot_swap.SwitchIfReady()) {
+    tflite::testing::ExpectServes(&hot_swap, expected_a);
+    if (!update_ok.load()) {
+      break;
+    }
+  }
+  updater.join();
+  TF_LITE_MICRO_EXPECT(update_ok.load());
+  tflite::testing::ExpectServes(&hot_swap, expected_b);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,186 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/model_verifier.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kWeightsSize = 2048;
+
+// Builds input -> FULLY_CONNECTED -> output with 2 KB of weights, so that
+// the weights end past the bytes covered by the boot digest.
+// `bad_input` replaces the index of the input tensor of the operator.
+void BuildModel(TestModelBuilder* builder, int bad_input = -1) {
+  static int8_t weights[kWeightsSize];
+  for (int i = 0; i < kWeightsSize; ++i) {
+    weights[i] = static_cast<int8_t>(i * 7);
+  }
+  const int input =
+      builder->AddQuantizedTensor({1, 64}, TensorType_INT8, 0.1f, 0);
+  const int filter = builder->AddQuantizedTensor(
+      {32, 64}, TensorType_INT8, 0.01f, 0, weights, sizeof(weights));
+  const int output =
+      builder->AddQuantizedTensor({1, 32}, TensorType_INT8, 0.5f, 0);
+  builder->AddOperator(BuiltinOperator_FULLY_CONNECTED,
+                       {bad_input >= 0 ? bad_input : input, filter, -1},
+                       {output});
+  builder->Finish({input}, {output});
+}
+
+// Returns the offset of the last byte of the weights in the flatbuffer.
+size_t FindWeightsEnd(const TestModelBuilder& builder) {
+  const Model* model = GetModel(builder.data());
+  const Tensor* filter = model->subgraphs()->Get(0)->tensors()->Get(1);
+  const flatbuffers::Vector<uint8_t>* weights =
+      model->buffers()->Get(filter->buffer())->data();
+  return static_cast<size_t>(weights->data() - builder.data()) +
+         weights->size() - 1;
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(Crc32CheckValue) {
+  const char kInput[] = "123456789";
+  TF_LITE_MICRO_EXPECT_EQ(0xcbf43926u, tflite::ComputeCrc32(kInput, 9));
+  // Digests can be computed piecewise.
+  TF_LITE_MICRO_EXPECT_EQ(
+      0xcbf43926u,
+      tflite::ComputeCrc32(kInput + 4, 5, tflite::ComputeCrc32(kInput, 4)));
+}
+
+TF_LITE_MICRO_TEST(ValidModelPassesEveryCheck) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  tflite::ModelVerificationRecord record;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      tflite::VerifyModelOnInstall(builder.data(), builder.size(),
+                                   micro_test::reporter, &record));
+  TF_LITE_MICRO_EXPECT_EQ(tflite::kModelVerificationMagic, record.magic);
+  TF_LITE_MICRO_EXPECT_EQ(builder.size(),
+                          static_cast<size_t>(record.model_size));
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(tflite::kModelVerified),
+                          record.flags);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::CheckModelOnBoot(builder.data(), builder.size(),
+                                          record, micro_test::reporter));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::VerifyModelDigest(builder.data(), builder.size(),
+                                           record, micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(BootRejectsUnverifiedRecord) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  tflite::ModelVerificationRecord record = {};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::CheckModelOnBoot(builder.data(), builder.size(),
+                                             record, micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(BootRejectsOtherModelSize) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  tflite::ModelVerificationRecord record;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      tflite::VerifyModelOnInstall(builder.data(), builder.size(),
+                                   micro_test::reporter, &record));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      tflite::CheckModelOnBoot(builder.data(), builder.size() - 4, record,
+                               micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(BootRejectsChangedHead) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  tflite::ModelVerificationRecord record;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      tflite::VerifyModelOnInstall(builder.data(), builder.size(),
+                                   micro_test::reporter, &record));
+  builder.data()[tflite::kModelHeadDigestBytes - 1] ^= 0x10;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::CheckModelOnBoot(builder.data(), builder.size(),
+                                             record, micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(OnlyFullDigestCatchesChangedWeights) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  tflite::ModelVerificationRecord record;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      tflite::VerifyModelOnInstall(builder.data(), builder.size(),
+                                   micro_test::reporter, &record));
+  const size_t weights_end = tflite::testing::FindWeightsEnd(builder);
+  TF_LITE_MICRO_EXPECT_GE(weights_end, tflite::kModelHeadDigestBytes);
+  builder.data()[weights_end] ^= 0x01;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::CheckModelOnBoot(builder.data(), builder.size(),
+                                          record, micro_test::reporter));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::VerifyModelDigest(builder.data(), builder.size(),
+                                              record, micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(StructureRejectsTruncatedModel) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::CheckModelStructure(builder.data(), 64,
+                                                micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(StructureRejectsRootOutOfBounds) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder);
+  const uint32_t root = static_cast<uint32_t>(builder.size()) + 16;
+  std::memcpy(builder.data(), &root, sizeof(root));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, tflite::CheckModelStructure(
+                        builder.data(), builder.size(), micro_test::reporter));
+}
+
+TF_LITE_MICRO_TEST(InstallRejectsBadTensorIndexAndClearsRecord) {
+  tflite::testing::TestModelBuilder builder;
+  tflite::testing::BuildModel(&builder, /*bad_input=*/7);
+  tflite::ModelVerificationRecord record;
+  record.magic = tflite::kModelVerificationMagic;
+  record.flags = tflite::kModelVerified;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      tflite::VerifyModelOnInstall(builder.data(), builder.size(),
+                                   micro_test::reporter, &record));
+  TF_LITE_MICRO_EXPECT_EQ(0u, record.magic);
+  TF_LITE_MICRO_EXPECT_EQ(0u, record.flags);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,242 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/patch_execution.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr size_t kArenaSize = 64 * 1024;
+constexpr int kImageSize = 24;
+constexpr int kInputSize = kImageSize * kImageSize * 3;
+constexpr int kOutputSize = 12 * 12 * 4;
+
+// Linear congruential generator, so that the random data is the same on
+// every host.
+class Random {
+ public:
+  explicit Random(uint32_t seed) : state_(seed) {}
+
+  // Returns a number in [low, high].
+  int Next(int low, int high) {
+    state_ = state_ * 1664525u + 1013904223u;
+    return low + static_cast<int>((state_ >> 8) %
+                                  static_cast<uint32_t>(high - low + 1));
+  }
+
+ private:
+  uint32_t state_;
+};
+
+std::vector<int8_t> RandomInt8(int size, uint32_t seed) {
+  Random random(seed);
+  std::vector<int8_t> values(size);
+  for (int8_t& value : values) {
+    value = static_cast<int8_t>(random.Next(-127, 127));
+  }
+  return values;
+}
+
+std::vector<int32_t> RandomInt32(int size, uint32_t seed) {
+  Random random(seed);
+  std::vector<int32_t> values(size);
+  for (int32_t& value : values) {
+    value = random.Next(-3000, 3000);
+  }
+  return values;
+}
+
+std::vector<float> FilterScales(int size) {
+  std::vector<float> scales(size);
+  for (int i = 0; i < size; ++i) {
+    scales[i] = 0.005f * static_cast<float>(i % 5 + 1);
+  }
+  return scales;
+}
+
+// Adds an int8 convolution with a per-channel filter and a bias. A depthwise
+// convolution keeps the depth of its input.
+int AddConv(TestModelBuilder* builder, BuiltinOperator op, int input,
+            int input_depth, int output_depth, int filter_size, int stride,
+            int output_image_size, float output_scale, uint32_t seed) {
+  const bool depthwise = op == BuiltinOperator_DEPTHWISE_CONV_2D;
+  const int filter_elements =
+      filter_size * filter_size * output_depth * (depthwise ? 1 : input_depth);
+  const std::vector<int8_t> filter_data = RandomInt8(filter_elements, seed);
+  const std::vector<int32_t> bias_data = RandomInt32(output_depth, seed + 100);
+  const int filter = builder->AddPerChannelTensor(
+      {depthwise ? 1 : output_depth, filter_size, filter_size,
+       depthwise ? output_depth : input_depth},
+      TensorType_INT8, FilterScales(output_depth), depthwise ? 3 : 0,
+      filter_data.data(), filter_elements);
+  const int bias =
+      builder->AddTensor({output_depth}, TensorType_INT32, bias_data.data(),
+                         output_depth * sizeof(int32_t));
+  const int output = builder->AddQuantizedTensor(
+      {1, output_image_size, output_image_size, output_depth},
+      TensorType_INT8, output_scale, -10);
+  if (depthwise) {
+    DepthwiseConv2DOptionsT options;
+    options.padding = Padding_SAME;
+    options.stride_w = stride;
+    options.stride_h = stride;
+    options.depth_multiplier = 1;
+    options.fused_activation_function = ActivationFunctionType_RELU6;
+    builder->AddOperator(op, {input, filter, bias}, {output}, options);
+  } else {
+    Conv2DOptionsT options;
+    options.padding = Padding_SAME;
+    options.stride_w = stride;
+    options.stride_h = stride;
+    options.fused_activation_function = ActivationFunctionType_RELU;
+    builder->AddOperator(op, {input, filter, bias}, {output}, options);
+  }
+  return output;
+}
+
+// The first layers of a MobileNet on a 24x24x3 image: a 3x3 CONV_2D to 16
+// channels, a strided 3x3 DEPTHWISE_CONV_2D and its 1x1 CONV_2D to 8
+// channels, which the graph rewriter fuses, then a 1x1 CONV_2D to 4 channels.
+// With `uint8_image` the model starts with a QUANTIZE of uint8 pixels, which
+// the graph rewriter folds into the first convolution. With
+// `expose_first_output` the output of the first convolution is a model
+// output too.
+const Model* BuildMobileNetPrefix(TestModelBuilder* builder, bool uint8_image,
+                                  bool expose_first_output = false) {
+  const int image = builder->AddQuantizedTensor(
+      {1, kImageSize, kImageSize, 3},
+      uint8_image ? TensorType_UINT8 : TensorType_INT8, 1.0f / 255,
+      uint8_image ? 0 : -128);
+  int input = image;
+  if (uint8_image) {
+    input = builder->AddQuantizedTensor({1, kImageSize, kImageSize, 3},
+                                        TensorType_INT8, 1.0f / 255, -128);
+    builder->AddOperator(BuiltinOperator_QUANTIZE, {image}, {input});
+  }
+  const int first = AddConv(builder, BuiltinOperator_CONV_2D, input, 3, 16,
+                            3, 1, kImageSize, 0.05f, 1);
+  const int depthwise = AddConv(builder, BuiltinOperator_DEPTHWISE_CONV_2D,
+                                first, 16, 16, 3, 2, 12, 0.04f, 2);
+  const int pointwise = AddConv(builder, BuiltinOperator_CONV_2D, depthwise,
+                                16, 8, 1, 1, 12, 0.1f, 3);
+  const int output = AddConv(builder, BuiltinOperator_CONV_2D, pointwise, 8,
+                             4, 1, 1, 12, 0.2f, 4);
+  if (expose_first_output) {
+    return builder->Finish({image}, {output, first});
+  }
+  return builder->Finish({image}, {output});
+}
+
+// Runs `model` with its first `num_operators` operators on `num_patches`
+// patches, or as a whole for 0 operators, and returns the arena it used.
+size_t RunModel(const Model* model, int num_operators, int num_patches,
+                const void* input, int8_t* output) {
+  static uint8_t arena[kArenaSize];
+  AllOpsResolver resolver;
+  MicroInterpreter interpreter(model, resolver, arena, kArenaSize,
+                               micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, interpreter.SetPatchExecution(num_operators, num_patches));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  std::memcpy(interpreter.input(0)->data.raw, input, kInputSize);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<size_t>(kOutputSize),
+                          interpreter.output(0)->bytes);
+  std::memcpy(output, interpreter.output(0)->data.int8, kOutputSize);
+  return interpreter.arena_used_bytes();
+}
+
+// Expects the model run on patches to compute what the whole model computes.
+void TestPatchesMatchWholeModel(bool uint8_image, int num_operators) {
+  TestModelBuilder builder;
+  const Model* model = BuildMobileNetPrefix(&builder, uint8_image);
+  const std::vector<int8_t> input = RandomInt8(kInputSize, 5);
+  int8_t expected[kOutputSize];
+  const size_t whole_arena = RunModel(model, 0, 0, input.data(), expected);
+  for (int num_patches : {1, 2, 3, 4, 7}) {
+    int8_t output[kOutputSize];
+    const size_t patched_arena =
+        RunModel(model, num_operators, num_patches, input.data(), output);
+    for (int i = 0; i < kOutputSize; ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(expected[i], output[i]);
+    }
+    // The 24x24x16 output of the first convolution dominates the arena.
+    if (num_patches >= 4) {
+      TF_LITE_MICRO_EXPECT_LT(patched_arena, whole_arena);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(PatchedChainMatchesWholeModel) {
+  // The fused separable convolution counts as the operators 1 and 2.
+  tflite::testing::TestPatchesMatchWholeModel(/*uint8_image=*/false, 3);
+}
+
+TF_LITE_MICRO_TEST(PatchedChainWithFoldedQuantizeMatchesWholeModel) {
+  tflite::testing::TestPatchesMatchWholeModel(/*uint8_image=*/true, 4);
+}
+
+TF_LITE_MICRO_TEST(PatchedWholeChainMatchesWholeModel) {
+  tflite::testing::TestPatchesMatchWholeModel(/*uint8_image=*/false, 4);
+}
+
+TF_LITE_MICRO_TEST(RejectsInvalidPatchExecution) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model =
+      tflite::testing::BuildMobileNetPrefix(&builder, /*uint8_image=*/false);
+  tflite::AllOpsResolver resolver;
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchExecution(3, 0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchExecution(5, 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchExecution(-1, 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchExecution(3, 2));
+}
+
+TF_LITE_MICRO_TEST(RejectsChainWithExposedIntermediate) {
+  static uint8_t arena[tflite::testing::kArenaSize];
+  tflite::testing::TestModelBuilder builder;
+  const tflite::Model* model = tflite::testing::BuildMobileNetPrefix(
+      &builder, /*uint8_image=*/false, /*expose_first_output=*/true);
+  tflite::AllOpsResolver resolver;
+  tflite::MicroInterpreter interpreter(model, resolver, arena,
+                                       tflite::testing::kArenaSize,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetPatchExecution(3, 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.AllocateTensors());
+}
+
+TF_LITE_MICRO_TESTS_END
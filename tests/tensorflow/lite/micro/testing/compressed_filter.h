@@ -0,0 +1,75 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_TESTING_COMPRESSED_FILTER_H_
+#define TENSORFLOW_LITE_MICRO_TESTING_COMPRESSED_FILTER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/micro/compressed_weights.h"
+
+namespace tflite {
+namespace testing {
+
+// Value `index` of the palette of tile `tile`, for test filters that are
+// drawn from at most 2^index_bits distinct values per tile.
+inline int8_t TestPaletteValue(int tile, int index) {
+  return static_cast<int8_t>((tile * 37 + index * 53) % 255 - 127);
+}
+
+// Palette compresses the int8 `filter` of `num_channels` output channels of
+// `channel_size` weights like tools/compress_weights.cc does, see
+// micro/compressed_weights.h, into `stream`, which must hold
+// CompressedWeightsSize() bytes. Every tile must hold at most 2^index_bits
+// distinct values. Returns false if one does not.
+inline bool CompressFilter(const int8_t* filter, int num_channels,
+                           int channel_size, int index_bits,
+                           int tile_channels, uint8_t* stream) {
+  const int tile_size =
+      CompressedTileSize(index_bits, tile_channels, channel_size);
+  const int num_tiles = CompressedTileCount(tile_channels, num_channels);
+  std::fill(stream, stream + num_tiles * tile_size, 0);
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    const int first = tile * tile_channels * channel_size;
+    const int count =
+        std::min(tile_channels, num_channels - tile * tile_channels) *
+        channel_size;
+    std::vector<int8_t> palette(filter + first, filter + first + count);
+    std::sort(palette.begin(), palette.end());
+    palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+    if (palette.size() > (1u << index_bits)) {
+      return false;
+    }
+    uint8_t* tile_stream = stream + tile * tile_size;
+    std::copy(palette.begin(), palette.end(),
+              reinterpret_cast<int8_t*>(tile_stream));
+    uint8_t* indices = tile_stream + (1 << index_bits);
+    for (int i = 0; i < count; ++i) {
+      const int index = static_cast<int>(
+          std::lower_bound(palette.begin(), palette.end(), filter[first + i]) -
+          palette.begin());
+      const int bit = i * index_bits;
+      indices[bit / 8] |= static_cast<uint8_t>(index << (bit % 8));
+    }
+  }
+  return true;
+}
+
+}  // namespace testing
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_TESTING_COMPRESSED_FILTER_H_
@@ -0,0 +1,51 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_TESTING_COUNTING_EXECUTOR_H_
+#define TENSORFLOW_LITE_MICRO_TESTING_COUNTING_EXECUTOR_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/parallel_executor.h"
+#include "tensorflow/lite/micro/thread_pool_executor.h"
+
+namespace tflite {
+namespace testing {
+
+// ThreadPoolExecutor that remembers how many chunks the last Run() got, so
+// that a test can tell that a kernel really split its work.
+class CountingExecutor : public ParallelExecutor {
+ public:
+  explicit CountingExecutor(int num_threads) : pool_(num_threads) {}
+
+  int num_workers() const override { return pool_.num_workers(); }
+
+  TfLiteStatus Run(int num_tasks, void (*task)(void* user_data, int index),
+                   void* user_data) override {
+    last_num_tasks_ = num_tasks;
+    return pool_.Run(num_tasks, task, user_data);
+  }
+
+  // Chunks of the last Run(), 0 if the kernel never called it.
+  int last_num_tasks() const { return last_num_tasks_; }
+
+ private:
+  ThreadPoolExecutor pool_;
+  int last_num_tasks_ = 0;
+};
+
+}  // namespace testing
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_TESTING_COUNTING_EXECUTOR_H_
@@ -0,0 +1,65 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_TESTING_FLOAT16_WEIGHTS_H_
+#define TENSORFLOW_LITE_MICRO_TESTING_FLOAT16_WEIGHTS_H_
+
+#include <cmath>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+
+namespace tflite {
+namespace testing {
+
+// IEEE half precision bits of `value`, which must be 0 or a normal float16
+// with at most 11 significant bits.
+inline uint16_t FloatToHalf(float value) {
+  if (value == 0.0f) {
+    return 0;
+  }
+  int exponent;
+  const float mantissa = std::frexp(std::fabs(value), &exponent);
+  const uint16_t sign = value < 0.0f ? 0x8000 : 0;
+  return sign | static_cast<uint16_t>((exponent + 14) << 10) |
+         static_cast<uint16_t>((mantissa * 2.0f - 1.0f) * 1024.0f);
+}
+
+// Converts `size` floats, each exactly representable as float16, to
+// `half_values`.
+inline void FloatsToHalves(const float* values, int size,
+                           TfLiteFloat16* half_values) {
+  for (int i = 0; i < size; ++i) {
+    half_values[i].data = FloatToHalf(values[i]);
+  }
+}
+
+// A constant float16 tensor, as the float16 post-training quantization of
+// the converter writes filters and biases.
+inline TfLiteTensor CreateFloat16Tensor(const TfLiteFloat16* data,
+                                        TfLiteIntArray* dims) {
+  TfLiteTensor tensor = CreateFloatTensor(nullptr, dims);
+  tensor.type = kTfLiteFloat16;
+  tensor.data.f16 = const_cast<TfLiteFloat16*>(data);
+  tensor.bytes = ElementCount(*dims) * sizeof(TfLiteFloat16);
+  tensor.allocation_type = kTfLiteMmapRo;
+  return tensor;
+}
+
+}  // namespace testing
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_TESTING_FLOAT16_WEIGHTS_H_
@@ -0,0 +1,167 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_TESTING_TEST_MODEL_BUILDER_H_
+#define TENSORFLOW_LITE_MICRO_TESTING_TEST_MODEL_BUILDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "third_party/flatbuffers/include/flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace testing {
+
+// Builds single subgraph models in memory with the object API of the schema,
+// for host tests of the interpreter and of the graph rewrites. Tensor and
+// operator indices are returned in the order they are added.
+class TestModelBuilder {
+ public:
+  TestModelBuilder() {
+    model_.version = TFLITE_SCHEMA_VERSION;
+    // Buffer 0 is the empty buffer of every tensor without constant data.
+    model_.buffers.emplace_back(new BufferT());
+    model_.subgraphs.emplace_back(new SubGraphT());
+  }
+
+  // Adds a tensor, constant if `data` is given.
+  int AddTensor(std::initializer_list<int32_t> shape, TensorType type,
+                const void* data = nullptr, size_t bytes = 0) {
+    std::unique_ptr<TensorT> tensor(new TensorT());
+    tensor->shape = shape;
+    tensor->type = type;
+    tensor->buffer = 0;
+    if (data != nullptr) {
+      std::unique_ptr<BufferT> buffer(new BufferT());
+      const uint8_t* begin = static_cast<const uint8_t*>(data);
+      buffer->data.assign(begin, begin + bytes);
+      model_.buffers.push_back(std::move(buffer));
+      tensor->buffer = static_cast<uint32_t>(model_.buffers.size() - 1);
+    }
+    SubGraphT* subgraph = model_.subgraphs[0].get();
+    subgraph->tensors.push_back(std::move(tensor));
+    return static_cast<int>(subgraph->tensors.size() - 1);
+  }
+
+  // Adds a tensor quantized with one scale and zero point.
+  int AddQuantizedTensor(std::initializer_list<int32_t> shape,
+                         TensorType type, float scale, int64_t zero_point,
+                         const void* data = nullptr, size_t bytes = 0) {
+    const int index = AddTensor(shape, type, data, bytes);
+    SetQuantization(index, {scale}, {zero_point}, 0);
+    return index;
+  }
+
+  // Adds a constant tensor quantized along `quantized_dimension` with one
+  // scale per channel and zero points of 0, like the filters of int8
+  // convolutions.
+  int AddPerChannelTensor(std::initializer_list<int32_t> shape,
+                          TensorType type, const std::vector<float>& scales,
+                          int quantized_dimension, const void* data,
+                          size_t bytes) {
+    const int index = AddTensor(shape, type, data, bytes);
+    SetQuantization(index, scales, std::vector<int64_t>(scales.size(), 0),
+                    quantized_dimension);
+    return index;
+  }
+
+  // Adds an operator without options.
+  int AddOperator(BuiltinOperator op, std::initializer_list<int32_t> inputs,
+                  std::initializer_list<int32_t> outputs) {
+    return AddOperatorWithOptions(op, inputs, outputs, BuiltinOptionsUnion());
+  }
+
+  // Adds an operator with builtin options, an object API table such as
+  // Conv2DOptionsT.
+  template <typename OptionsT>
+  int AddOperator(BuiltinOperator op, std::initializer_list<int32_t> inputs,
+                  std::initializer_list<int32_t> outputs,
+                  OptionsT options) {
+    BuiltinOptionsUnion options_union;
+    options_union.Set(std::move(options));
+    return AddOperatorWithOptions(op, inputs, outputs,
+                                  std::move(options_union));
+  }
+
+  // Serializes the model with the given subgraph inputs and outputs. The
+  // model stays valid until the next call or the destruction of the builder.
+  const Model* Finish(std::initializer_list<int32_t> inputs,
+                      std::initializer_list<int32_t> outputs) {
+    SubGraphT* subgraph = model_.subgraphs[0].get();
+    subgraph->inputs = inputs;
+    subgraph->outputs = outputs;
+    builder_.Clear();
+    FinishModelBuffer(builder_, Model::Pack(builder_, &model_));
+    return GetModel(builder_.GetBufferPointer());
+  }
+
+  // The flatbuffer serialized by the last call to Finish().
+  uint8_t* data() const { return builder_.GetBufferPointer(); }
+  size_t size() const { return builder_.GetSize(); }
+
+ private:
+  void SetQuantization(int index, const std::vector<float>& scales,
+                       const std::vector<int64_t>& zero_points,
+                       int quantized_dimension) {
+    std::unique_ptr<QuantizationParametersT> quantization(
+        new QuantizationParametersT());
+    quantization->scale = scales;
+    quantization->zero_point = zero_points;
+    quantization->quantized_dimension = quantized_dimension;
+    model_.subgraphs[0]->tensors[index]->quantization =
+        std::move(quantization);
+  }
+
+  int AddOperatorWithOptions(BuiltinOperator op,
+                             std::initializer_list<int32_t> inputs,
+                             std::initializer_list<int32_t> outputs,
+                             BuiltinOptionsUnion options) {
+    int opcode_index = -1;
+    for (size_t i = 0; i < model_.operator_codes.size(); ++i) {
+      if (model_.operator_codes[i]->builtin_code == op) {
+        opcode_index = static_cast<int>(i);
+      }
+    }
+    if (opcode_index < 0) {
+      std::unique_ptr<OperatorCodeT> code(new OperatorCodeT());
+      code->builtin_code = op;
+      code->version = 1;
+      model_.operator_codes.push_back(std::move(code));
+      opcode_index = static_cast<int>(model_.operator_codes.size() - 1);
+    }
+    std::unique_ptr<OperatorT> op_table(new OperatorT());
+    op_table->opcode_index = static_cast<uint32_t>(opcode_index);
+    op_table->inputs = inputs;
+    op_table->outputs = outputs;
+    op_table->builtin_options = std::move(options);
+    SubGraphT* subgraph = model_.subgraphs[0].get();
+    subgraph->operators.push_back(std::move(op_table));
+    return static_cast<int>(subgraph->operators.size() - 1);
+  }
+
+  ModelT model_;
+  flatbuffers::FlatBufferBuilder builder_;
+};
+
+}  // namespace testing
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_TESTING_TEST_MODEL_BUILDER_H_
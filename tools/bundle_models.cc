@@ -0,0 +1,282 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that writes a model bundle, see
+// tensorflow/lite/micro/model_bundle.h for the format.
+//
+// Usage: bundle_models [--min_shared_size=<bytes>] <output.bundle>
+//                      <input.tflite> ...
+//
+// Constant buffers of at least --min_shared_size bytes (default 64) that have
+// the same content, in one model or across models, are stored once. Buffers
+// of variable tensors are never shared. The order of the input models is the
+// order of the models in the bundle.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/model_bundle.h"
+#include "tensorflow/lite/micro/model_verifier.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+constexpr size_t kDefaultMinSharedSize = 64;
+
+// A buffer of one of the input models.
+struct BufferRef {
+  size_t model;
+  size_t buffer;
+};
+
+// Buffers with identical content, stored once in the bundle.
+struct SharedBuffer {
+  std::vector<uint8_t> data;
+  uint32_t hash;
+  std::vector<BufferRef> refs;
+  uint32_t offset = 0;
+};
+
+size_t AlignUp(size_t offset) {
+  return (offset + kModelBundleAlignment - 1) / kModelBundleAlignment *
+         kModelBundleAlignment;
+}
+
+void WriteWord(std::vector<uint8_t>* bundle, size_t offset, uint32_t value) {
+  flatbuffers::WriteScalar(bundle->data() + offset, value);
+}
+
+bool LoadModel(const char* path, std::unique_ptr<ModelT>* model) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return false;
+  }
+  const std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t*>(data.data()),
+                                 data.size());
+  if (!VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s is not a valid model\n", path);
+    return false;
+  }
+  *model = UnPackModel(data.data());
+  return true;
+}
+
+// Marks the buffers of variable tensors, which must stay with their model.
+std::vector<bool> VariableBuffers(const ModelT& model) {
+  std::vector<bool> variable(model.buffers.size(), false);
+  for (const auto& subgraph : model.subgraphs) {
+    for (const auto& tensor : subgraph->tensors) {
+      if (tensor->is_variable && tensor->buffer < variable.size()) {
+        variable[tensor->buffer] = true;
+      }
+    }
+  }
+  return variable;
+}
+
+// Groups the buffers of all models by content and keeps the groups with more
+// than one buffer.
+std::vector<SharedBuffer> FindSharedBuffers(
+    const std::vector<std::unique_ptr<ModelT>>& models,
+    size_t min_shared_size) {
+  std::vector<SharedBuffer> groups;
+  std::map<std::tuple<uint32_t, size_t>, std::vector<size_t>> by_hash;
+  for (size_t m = 0; m < models.size(); ++m) {
+    const std::vector<bool> variable = VariableBuffers(*models[m]);
+    // Buffer 0 is the empty sentinel buffer.
+    for (size_t b = 1; b < models[m]->buffers.size(); ++b) {
+      const std::vector<uint8_t>& data = models[m]->buffers[b]->data;
+      if (variable[b] || data.size() < min_shared_size) {
+        continue;
+      }
+      const uint32_t hash = ComputeCrc32(data.data(), data.size());
+      std::vector<size_t>& candidates =
+          by_hash[std::make_tuple(hash, data.size())];
+      SharedBuffer* group = nullptr;
+      for (size_t candidate : candidates) {
+        if (groups[candidate].data == data) {
+          group = &groups[candidate];
+          break;
+        }
+      }
+      if (group == nullptr) {
+        candidates.push_back(groups.size());
+        groups.emplace_back();
+        group = &groups.back();
+        group->data = data;
+        group->hash = hash;
+      }
+      group->refs.push_back({m, b});
+    }
+  }
+  std::vector<SharedBuffer> shared;
+  for (SharedBuffer& group : groups) {
+    if (group.refs.size() > 1) {
+      shared.push_back(std::move(group));
+    }
+  }
+  return shared;
+}
+
+// Offset, from the start of its flatbuffer, of the data field of a Buffer
+// table.
+size_t DataFieldOffset(const uint8_t* model_data, size_t buffer_index) {
+  const Buffer* buffer = GetModel(model_data)->buffers()->Get(buffer_index);
+  const uint8_t* table = reinterpret_cast<const uint8_t*>(buffer);
+  const flatbuffers::voffset_t field =
+      reinterpret_cast<const flatbuffers::Table*>(buffer)
+          ->GetOptionalFieldOffset(Buffer::VT_DATA);
+  return table + field - model_data;
+}
+
+int Run(size_t min_shared_size, const char* output_path, int num_inputs,
+        char** input_paths) {
+  std::vector<std::unique_ptr<ModelT>> models(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    if (!LoadModel(input_paths[i], &models[i])) {
+      return 1;
+    }
+  }
+  std::vector<SharedBuffer> shared =
+      FindSharedBuffers(models, min_shared_size);
+
+  // Shared buffers keep a one byte placeholder in their models, so that the
+  // Buffer tables have a data field to point at the shared copy.
+  for (const SharedBuffer& buffer : shared) {
+    for (const BufferRef& ref : buffer.refs) {
+      models[ref.model]->buffers[ref.buffer]->data.assign(1, 0);
+    }
+  }
+  std::vector<std::unique_ptr<flatbuffers::FlatBufferBuilder>> builders;
+  for (const auto& model : models) {
+    builders.emplace_back(new flatbuffers::FlatBufferBuilder());
+    FinishModelBuffer(*builders.back(),
+                      Model::Pack(*builders.back(), model.get()));
+  }
+
+  // Lays out the directories, the models and the shared buffers.
+  const size_t directory_words = 4 + 2 * models.size() + 3 * shared.size();
+  size_t offset = directory_words * sizeof(uint32_t);
+  std::vector<size_t> model_offsets;
+  for (const auto& builder : builders) {
+    offset = AlignUp(offset);
+    model_offsets.push_back(offset);
+    offset += builder->GetSize();
+  }
+  for (SharedBuffer& buffer : shared) {
+    offset = AlignUp(offset + sizeof(uint32_t));
+    buffer.offset = static_cast<uint32_t>(offset);
+    offset += buffer.data.size();
+  }
+
+  std::vector<uint8_t> bundle(AlignUp(offset), 0);
+  WriteWord(&bundle, 0, kModelBundleMagic);
+  WriteWord(&bundle, 4, kModelBundleVersion);
+  WriteWord(&bundle, 8, static_cast<uint32_t>(models.size()));
+  WriteWord(&bundle, 12, static_cast<uint32_t>(shared.size()));
+  size_t entry = 16;
+  for (size_t m = 0; m < builders.size(); ++m) {
+    WriteWord(&bundle, entry, static_cast<uint32_t>(model_offsets[m]));
+    WriteWord(&bundle, entry + 4,
+              static_cast<uint32_t>(builders[m]->GetSize()));
+    entry += 8;
+    memcpy(bundle.data() + model_offsets[m], builders[m]->GetBufferPointer(),
+           builders[m]->GetSize());
+  }
+  for (const SharedBuffer& buffer : shared) {
+    const uint32_t size = static_cast<uint32_t>(buffer.data.size());
+    WriteWord(&bundle, entry, buffer.offset);
+    WriteWord(&bundle, entry + 4, size);
+    WriteWord(&bundle, entry + 8, buffer.hash);
+    entry += 12;
+    // The shared copy is a flatbuffer vector: its length, then its data.
+    WriteWord(&bundle, buffer.offset - sizeof(uint32_t), size);
+    memcpy(bundle.data() + buffer.offset, buffer.data.data(), size);
+    // Points the data field of every Buffer table that uses it at the copy.
+    // The copy is after all models, so the offset is positive as flatbuffers
+    // require.
+    for (const BufferRef& ref : buffer.refs) {
+      const size_t field =
+          model_offsets[ref.model] +
+          DataFieldOffset(builders[ref.model]->GetBufferPointer(), ref.buffer);
+      WriteWord(&bundle, field,
+                static_cast<uint32_t>(buffer.offset - sizeof(uint32_t) -
+                                      field));
+    }
+  }
+
+  for (size_t m = 0; m < models.size(); ++m) {
+    flatbuffers::Verifier verifier(bundle.data() + model_offsets[m],
+                                   bundle.size() - model_offsets[m]);
+    if (!VerifyModelBuffer(verifier)) {
+      fprintf(stderr, "Bundled model %d does not verify\n",
+              static_cast<int>(m));
+      return 1;
+    }
+  }
+  std::ofstream output_file(output_path, std::ios::binary);
+  output_file.write(reinterpret_cast<const char*>(bundle.data()),
+                    bundle.size());
+  if (!output_file) {
+    fprintf(stderr, "Could not write %s\n", output_path);
+    return 1;
+  }
+  size_t saved = 0;
+  for (const SharedBuffer& buffer : shared) {
+    saved += (buffer.refs.size() - 1) * buffer.data.size();
+  }
+  printf("Bundled %d models, %d shared buffers, %d bytes saved.\n",
+         num_inputs, static_cast<int>(shared.size()),
+         static_cast<int>(saved));
+  return 0;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  size_t min_shared_size = tflite::kDefaultMinSharedSize;
+  int arg = 1;
+  const char kMinSharedSizeFlag[] = "--min_shared_size=";
+  if (arg < argc && strncmp(argv[arg], kMinSharedSizeFlag,
+                            strlen(kMinSharedSizeFlag)) == 0) {
+    min_shared_size = strtoul(argv[arg] + strlen(kMinSharedSizeFlag),
+                              nullptr, 10);
+    ++arg;
+  }
+  if (argc - arg < 2) {
+    fprintf(stderr,
+            "Usage: %s [--min_shared_size=<bytes>] <output.bundle> "
+            "<input.tflite> ...\n",
+            argv[0]);
+    return 1;
+  }
+  return tflite::Run(min_shared_size, argv[arg], argc - arg - 1,
+                     argv + arg + 1);
+}
@@ -0,0 +1,371 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that palette compresses the int8 filters of a .tflite model, see
+// tensorflow/lite/micro/compressed_weights.h for the format.
+//
+// Usage: compress_weights [--bits=4] [--tile_channels=4] [--cluster]
+//                         <input.tflite> <output.tflite>
+//
+// Filters of CONV_2D and FULLY_CONNECTED operators in the first subgraph are
+// compressed when every tile has at most 2^bits distinct values, which is
+// lossless. With --cluster, tiles with more values are clustered down to
+// 2^bits values by 1-D k-means instead, which changes the model. Filters
+// shared with other operators or already pre-packed by pack_weights are
+// left as they are; run pack_weights first if both are wanted.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+struct Options {
+  int index_bits = 4;
+  int tile_channels = 4;
+  bool cluster = false;
+};
+
+const MetadataT* FindMetadata(const ModelT& model, const char* name) {
+  for (const auto& metadata : model.metadata) {
+    if (metadata->name == name) {
+      return metadata.get();
+    }
+  }
+  return nullptr;
+}
+
+// Returns the operators of the first subgraph that have pre-packed weights,
+// whose filter must stay uncompressed. pack_weights writes one table per
+// subgraph.
+std::set<int> PackedOperators(const ModelT& model) {
+  std::set<int> operators;
+  for (const auto& metadata : model.metadata) {
+    if (metadata->name != kPackedWeightsMetadata ||
+        metadata->buffer >= model.buffers.size()) {
+      continue;
+    }
+    const std::vector<uint8_t>& data = model.buffers[metadata->buffer]->data;
+    std::vector<int32_t> table(data.size() / sizeof(int32_t));
+    memcpy(table.data(), data.data(), table.size() * sizeof(int32_t));
+    if (table.size() < 3 || table[1] != 0) {
+      continue;
+    }
+    for (size_t i = 3; i + 3 < table.size(); i += 4) {
+      operators.insert(table[i]);
+    }
+  }
+  return operators;
+}
+
+// Computes a palette of at most `size` values for the histogram of a tile.
+// Tiles with few enough distinct values get them exactly, others are
+// clustered with weighted 1-D k-means.
+std::vector<int8_t> ComputePalette(const std::vector<int>& histogram,
+                                   int size, bool cluster, bool* exact) {
+  std::vector<int8_t> palette;
+  for (int v = 0; v < 256; ++v) {
+    if (histogram[v] > 0) {
+      palette.push_back(static_cast<int8_t>(v - 128));
+    }
+  }
+  *exact = static_cast<int>(palette.size()) <= size;
+  if (*exact || !cluster) {
+    return palette;
+  }
+
+  // Start from the quantiles of the distribution.
+  int total = 0;
+  for (int count : histogram) {
+    total += count;
+  }
+  std::vector<double> centers(size);
+  int seen = 0;
+  int next = 0;
+  for (int v = 0; v < 256 && next < size; ++v) {
+    seen += histogram[v];
+    while (next < size && seen * size >= (2 * next + 1) * total / 2) {
+      centers[next++] = v - 128;
+    }
+  }
+  for (int iteration = 0; iteration < 32; ++iteration) {
+    std::vector<double> sums(size, 0.0);
+    std::vector<int> counts(size, 0);
+    for (int v = 0; v < 256; ++v) {
+      if (histogram[v] == 0) {
+        continue;
+      }
+      int best = 0;
+      for (int c = 1; c < size; ++c) {
+        if (std::fabs(centers[c] - (v - 128)) <
+            std::fabs(centers[best] - (v - 128))) {
+          best = c;
+        }
+      }
+      sums[best] += static_cast<double>(histogram[v]) * (v - 128);
+      counts[best] += histogram[v];
+    }
+    for (int c = 0; c < size; ++c) {
+      if (counts[c] > 0) {
+        centers[c] = sums[c] / counts[c];
+      }
+    }
+  }
+  palette.clear();
+  for (double center : centers) {
+    palette.push_back(static_cast<int8_t>(std::lround(center)));
+  }
+  return palette;
+}
+
+int NearestEntry(const std::vector<int8_t>& palette, int8_t value) {
+  int best = 0;
+  for (size_t i = 1; i < palette.size(); ++i) {
+    if (std::abs(palette[i] - value) < std::abs(palette[best] - value)) {
+      best = static_cast<int>(i);
+    }
+  }
+  return best;
+}
+
+// Compresses a [channels][channel_size] int8 tensor, or returns false if
+// some tile needs more than 2^bits values and clustering is off.
+bool Compress(const int8_t* values, int num_channels, int channel_size,
+              const Options& options, std::vector<uint8_t>* output,
+              int* clustered_tiles) {
+  const int bits = options.index_bits;
+  const int palette_size = 1 << bits;
+  const int tile_size =
+      CompressedTileSize(bits, options.tile_channels, channel_size);
+  output->assign(CompressedWeightsSize(bits, options.tile_channels,
+                                       num_channels, channel_size),
+                 0);
+  *clustered_tiles = 0;
+  const int num_tiles = CompressedTileCount(options.tile_channels,
+                                            num_channels);
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    const int first_channel = tile * options.tile_channels;
+    const int channels =
+        std::min(options.tile_channels, num_channels - first_channel);
+    const int8_t* tile_values = values + first_channel * channel_size;
+    const int count = channels * channel_size;
+
+    std::vector<int> histogram(256, 0);
+    for (int i = 0; i < count; ++i) {
+      ++histogram[tile_values[i] + 128];
+    }
+    bool exact;
+    const std::vector<int8_t> palette =
+        ComputePalette(histogram, palette_size, options.cluster, &exact);
+    if (static_cast<int>(palette.size()) > palette_size) {
+      return false;
+    }
+    if (!exact) {
+      ++*clustered_tiles;
+    }
+
+    uint8_t* destination = output->data() + tile * tile_size;
+    memcpy(destination, palette.data(), palette.size());
+    uint8_t* indices = destination + palette_size;
+    for (int i = 0; i < count; ++i) {
+      const int bit = i * bits;
+      indices[bit / 8] |= NearestEntry(palette, tile_values[i]) << (bit % 8);
+    }
+  }
+  return true;
+}
+
+int Run(const Options& options, const char* input_path,
+        const char* output_path) {
+  std::ifstream input_file(input_path, std::ios::binary);
+  if (!input_file) {
+    fprintf(stderr, "Could not open %s\n", input_path);
+    return 1;
+  }
+  const std::vector<char> input_data(
+      (std::istreambuf_iterator<char>(input_file)),
+      std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(input_data.data()), input_data.size());
+  if (!VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s is not a valid model\n", input_path);
+    return 1;
+  }
+  std::unique_ptr<ModelT> model = UnPackModel(input_data.data());
+  if (FindMetadata(*model, kCompressedWeightsMetadata) != nullptr) {
+    fprintf(stderr, "%s already contains compressed weights\n", input_path);
+    return 1;
+  }
+  if (model->subgraphs.empty()) {
+    fprintf(stderr, "%s has no subgraphs\n", input_path);
+    return 1;
+  }
+
+  SubGraphT& subgraph = *model->subgraphs[0];
+  const std::set<int> packed_operators = PackedOperators(*model);
+  // A tensor qualifies if every use is the filter of an int8 CONV_2D or
+  // FULLY_CONNECTED without packed weights.
+  std::vector<bool> candidate(subgraph.tensors.size(), false);
+  std::vector<bool> rejected(subgraph.tensors.size(), false);
+  for (size_t i = 0; i < subgraph.operators.size(); ++i) {
+    const OperatorT& op = *subgraph.operators[i];
+    const BuiltinOperator code =
+        model->operator_codes[op.opcode_index]->builtin_code;
+    const bool supported =
+        (code == BuiltinOperator_CONV_2D ||
+         code == BuiltinOperator_FULLY_CONNECTED) &&
+        op.inputs.size() >= 2 && op.inputs[0] >= 0 &&
+        subgraph.tensors[op.inputs[0]]->type == TensorType_INT8 &&
+        packed_operators.count(static_cast<int>(i)) == 0;
+    for (size_t j = 0; j < op.inputs.size(); ++j) {
+      const int tensor = op.inputs[j];
+      if (tensor < 0) {
+        continue;
+      }
+      if (supported && j == 1) {
+        candidate[tensor] = true;
+      } else {
+        rejected[tensor] = true;
+      }
+    }
+  }
+  for (int output : subgraph.outputs) {
+    rejected[output] = true;
+  }
+
+  std::vector<int32_t> table = {kCompressedWeightsVersion, /*subgraph=*/0,
+                                /*n=*/0};
+  size_t original_bytes = 0;
+  size_t compressed_bytes = 0;
+  for (size_t t = 0; t < subgraph.tensors.size(); ++t) {
+    TensorT& tensor = *subgraph.tensors[t];
+    if (!candidate[t] || rejected[t] || tensor.type != TensorType_INT8 ||
+        tensor.buffer == 0 || tensor.buffer >= model->buffers.size() ||
+        tensor.shape.empty()) {
+      continue;
+    }
+    const std::vector<uint8_t>& data = model->buffers[tensor.buffer]->data;
+    const int num_channels = tensor.shape[0];
+    int channel_size = 1;
+    for (size_t i = 1; i < tensor.shape.size(); ++i) {
+      channel_size *= tensor.shape[i];
+    }
+    if (data.empty() ||
+        static_cast<int>(data.size()) != num_channels * channel_size) {
+      continue;
+    }
+    std::vector<uint8_t> compressed;
+    int clustered_tiles;
+    if (!Compress(reinterpret_cast<const int8_t*>(data.data()), num_channels,
+                  channel_size, options, &compressed, &clustered_tiles) ||
+        compressed.size() >= data.size()) {
+      printf("Skipped %s\n", tensor.name.c_str());
+      continue;
+    }
+    if (clustered_tiles > 0) {
+      printf("Clustered %d tiles of %s\n", clustered_tiles,
+             tensor.name.c_str());
+    }
+    original_bytes += data.size();
+    compressed_bytes += compressed.size();
+
+    // Buffers may be shared between tensors, so the compressed data always
+    // goes into a new one.
+    std::unique_ptr<BufferT> buffer(new BufferT());
+    buffer->data = std::move(compressed);
+    model->buffers.push_back(std::move(buffer));
+    const uint32_t original_buffer = tensor.buffer;
+    tensor.buffer = static_cast<uint32_t>(model->buffers.size() - 1);
+    bool shared = false;
+    for (const auto& other : subgraph.tensors) {
+      shared |= other->buffer == original_buffer;
+    }
+    if (!shared) {
+      model->buffers[original_buffer]->data.clear();
+    }
+
+    table.push_back(static_cast<int32_t>(t));
+    table.push_back(kCompressedWeightsPalette);
+    table.push_back(options.index_bits);
+    table.push_back(options.tile_channels);
+    ++table[2];
+  }
+
+  std::unique_ptr<BufferT> table_buffer(new BufferT());
+  table_buffer->data.resize(table.size() * sizeof(int32_t));
+  memcpy(table_buffer->data.data(), table.data(), table_buffer->data.size());
+  model->buffers.push_back(std::move(table_buffer));
+  std::unique_ptr<MetadataT> metadata(new MetadataT());
+  metadata->name = kCompressedWeightsMetadata;
+  metadata->buffer = static_cast<uint32_t>(model->buffers.size() - 1);
+  model->metadata.push_back(std::move(metadata));
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, model.get()));
+  std::ofstream output_file(output_path, std::ios::binary);
+  output_file.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                    builder.GetSize());
+  if (!output_file) {
+    fprintf(stderr, "Could not write %s\n", output_path);
+    return 1;
+  }
+  printf("Compressed %d tensors from %zu to %zu bytes.\n", table[2],
+         original_bytes, compressed_bytes);
+  return 0;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  tflite::Options options;
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--bits=", 7) == 0) {
+      options.index_bits = atoi(argv[i] + 7);
+    } else if (strncmp(argv[i], "--tile_channels=", 16) == 0) {
+      options.tile_channels = atoi(argv[i] + 16);
+    } else if (strcmp(argv[i], "--cluster") == 0) {
+      options.cluster = true;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() != 2 ||
+      (options.index_bits != 1 && options.index_bits != 2 &&
+       options.index_bits != 4) ||
+      options.tile_channels <= 0) {
+    fprintf(stderr,
+            "Usage: %s [--bits=1|2|4] [--tile_channels=N] [--cluster] "
+            "<input.tflite> <output.tflite>\n",
+            argv[0]);
+    return 1;
+  }
+  return tflite::Run(options, paths[0], paths[1]);
+}
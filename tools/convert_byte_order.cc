@@ -0,0 +1,265 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that converts the buffers of a .tflite model to the byte order
+// of the target, see tensorflow/lite/micro/model_byte_order.h for the format.
+//
+// Usage: convert_byte_order [--little_endian] <input.tflite> <output.tflite>
+//
+// The target is big-endian unless --little_endian is given. Constant tensors
+// are converted according to their type, and the int32 tables of the
+// OfflineMemoryAllocation, PackedWeights and CompressedWeights metadata as
+// well as the effective biases of packed weights are converted word by word.
+// Other metadata is copied unchanged. Run this tool last: the other model
+// tools expect little-endian buffers.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/model_byte_order.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+
+// Size of the units whose bytes are reversed for a big-endian target, 0 if
+// the type cannot be converted.
+int SwapUnitSize(TensorType type) {
+  switch (type) {
+    case TensorType_UINT8:
+    case TensorType_INT8:
+    case TensorType_BOOL:
+      return 1;
+    case TensorType_FLOAT16:
+    case TensorType_INT16:
+      return 2;
+    case TensorType_FLOAT32:
+    case TensorType_INT32:
+    case TensorType_COMPLEX64:
+      return 4;
+    case TensorType_INT64:
+    case TensorType_FLOAT64:
+    case TensorType_COMPLEX128:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Records that `buffer` holds units of `unit_size` bytes. Fails if another
+// user of the buffer disagrees.
+bool SetUnitSize(uint32_t buffer, int unit_size,
+                 std::map<uint32_t, int>* unit_sizes) {
+  auto it = unit_sizes->find(buffer);
+  if (it != unit_sizes->end() && it->second != unit_size) {
+    fprintf(stderr, "Buffer %u is used with different element sizes\n",
+            buffer);
+    return false;
+  }
+  (*unit_sizes)[buffer] = unit_size;
+  return true;
+}
+
+void ReverseUnits(std::vector<uint8_t>* data, int unit_size) {
+  for (size_t i = 0; i + unit_size <= data->size(); i += unit_size) {
+    std::reverse(data->begin() + i, data->begin() + i + unit_size);
+  }
+}
+
+// Reads word `index` of a little-endian int32 metadata table.
+int32_t TableWord(const std::vector<uint8_t>& table, size_t index) {
+  if ((index + 1) * sizeof(int32_t) > table.size()) {
+    return -1;
+  }
+  return flatbuffers::ReadScalar<int32_t>(table.data() +
+                                          index * sizeof(int32_t));
+}
+
+// Empty arrays are left out of the packed model, their offset stays -1.
+void AppendArray(const std::vector<int32_t>& values,
+                 std::vector<int32_t>* table, size_t offset_index) {
+  if (values.empty()) {
+    return;
+  }
+  (*table)[offset_index] = static_cast<int32_t>(table->size());
+  table->push_back(static_cast<int32_t>(values.size()));
+  table->insert(table->end(), values.begin(), values.end());
+}
+
+int Run(bool big_endian, const char* input_path, const char* output_path) {
+  std::ifstream input_file(input_path, std::ios::binary);
+  if (!input_file) {
+    fprintf(stderr, "Could not open %s\n", input_path);
+    return 1;
+  }
+  const std::vector<char> input_data(
+      (std::istreambuf_iterator<char>(input_file)),
+      std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(input_data.data()), input_data.size());
+  if (!VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s is not a valid model\n", input_path);
+    return 1;
+  }
+  std::unique_ptr<ModelT> model = UnPackModel(input_data.data());
+  if (model->subgraphs.empty()) {
+    fprintf(stderr, "%s has no subgraphs\n", input_path);
+    return 1;
+  }
+
+  // Element size of every buffer that needs converting.
+  std::map<uint32_t, int> unit_sizes;
+  for (const auto& subgraph : model->subgraphs) {
+    for (const auto& tensor : subgraph->tensors) {
+      if (tensor->buffer == 0 || tensor->buffer >= model->buffers.size() ||
+          model->buffers[tensor->buffer]->data.empty()) {
+        continue;
+      }
+      const int unit_size = SwapUnitSize(tensor->type);
+      if (unit_size == 0) {
+        fprintf(stderr, "Tensor %s of type %s can not be converted\n",
+                tensor->name.c_str(), EnumNameTensorType(tensor->type));
+        return 1;
+      }
+      if (!SetUnitSize(tensor->buffer, unit_size, &unit_sizes)) {
+        return 1;
+      }
+    }
+  }
+  for (const auto& metadata : model->metadata) {
+    if (metadata->name == kHostByteOrderMetadata) {
+      fprintf(stderr, "%s has already been converted\n", input_path);
+      return 1;
+    }
+    if (metadata->buffer >= model->buffers.size()) {
+      fprintf(stderr, "Metadata %s has an invalid buffer\n",
+              metadata->name.c_str());
+      return 1;
+    }
+    const bool is_table = metadata->name == kOfflineMemAllocMetadata ||
+                          metadata->name == kPackedWeightsMetadata ||
+                          metadata->name == kCompressedWeightsMetadata;
+    if (!is_table) {
+      printf("Copying metadata %s unchanged.\n", metadata->name.c_str());
+      continue;
+    }
+    if (!SetUnitSize(metadata->buffer, sizeof(int32_t), &unit_sizes)) {
+      return 1;
+    }
+    if (metadata->name == kPackedWeightsMetadata) {
+      const std::vector<uint8_t>& table =
+          model->buffers[metadata->buffer]->data;
+      for (int32_t i = 0; i < TableWord(table, 2); ++i) {
+        const int32_t bias_buffer = TableWord(table, 6 + 4 * i);
+        if (bias_buffer < 0 ||
+            static_cast<size_t>(bias_buffer) >= model->buffers.size() ||
+            !SetUnitSize(bias_buffer, sizeof(int32_t), &unit_sizes)) {
+          fprintf(stderr, "Invalid PackedWeights metadata\n");
+          return 1;
+        }
+      }
+    }
+  }
+
+  // Host byte order copies of the dims and node index arrays.
+  const SubGraphT& subgraph = *model->subgraphs[0];
+  const int num_tensors = subgraph.tensors.size();
+  const int num_operators = subgraph.operators.size();
+  std::vector<int32_t> table(
+      HostByteOrderInputsIndex(num_tensors, num_operators), -1);
+  table[0] = static_cast<int32_t>(kHostByteOrderMark);
+  table[1] = kHostByteOrderVersion;
+  table[2] = num_tensors;
+  table[3] = num_operators;
+  for (int i = 0; i < num_tensors; ++i) {
+    AppendArray(subgraph.tensors[i]->shape, &table,
+                HostByteOrderDimsIndex(i));
+  }
+  for (int i = 0; i < num_operators; ++i) {
+    AppendArray(subgraph.operators[i]->inputs, &table,
+                HostByteOrderInputsIndex(num_tensors, i));
+    AppendArray(subgraph.operators[i]->outputs, &table,
+                HostByteOrderOutputsIndex(num_tensors, i));
+  }
+
+  // Buffers are little-endian, so only a big-endian target changes them.
+  std::vector<uint8_t> table_data(table.size() * sizeof(int32_t));
+  for (size_t i = 0; i < table.size(); ++i) {
+    flatbuffers::WriteScalar<int32_t>(&table_data[i * sizeof(int32_t)],
+                                      table[i]);
+  }
+  if (big_endian) {
+    for (const auto& buffer_unit : unit_sizes) {
+      ReverseUnits(&model->buffers[buffer_unit.first]->data,
+                   buffer_unit.second);
+    }
+    ReverseUnits(&table_data, sizeof(int32_t));
+  }
+
+  std::unique_ptr<BufferT> buffer(new BufferT());
+  buffer->data = table_data;
+  model->buffers.push_back(std::move(buffer));
+  std::unique_ptr<MetadataT> metadata(new MetadataT());
+  metadata->name = kHostByteOrderMetadata;
+  metadata->buffer = static_cast<uint32_t>(model->buffers.size() - 1);
+  model->metadata.push_back(std::move(metadata));
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, model.get()));
+  std::ofstream output_file(output_path, std::ios::binary);
+  output_file.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                    builder.GetSize());
+  if (!output_file) {
+    fprintf(stderr, "Could not write %s\n", output_path);
+    return 1;
+  }
+  printf("Converted %zu buffers for a %s-endian target.\n",
+         big_endian ? unit_sizes.size() : 0, big_endian ? "big" : "little");
+  return 0;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  bool big_endian = true;
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--little_endian") == 0) {
+      big_endian = false;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() != 2) {
+    fprintf(stderr,
+            "Usage: %s [--little_endian] <input.tflite> <output.tflite>\n",
+            argv[0]);
+    return 1;
+  }
+  return tflite::Run(big_endian, paths[0], paths[1]);
+}
@@ -0,0 +1,380 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that turns the log of an application built with
+// TF_LITE_LOG_INTERNING back into text, see tensorflow/lite/c/log_config.h.
+//
+// Usage: decode_interned_log <application.elf> [<log file>]
+//        decode_interned_log --table <application.elf>
+//
+// Reads the log from standard input if no file is given, and replaces every
+// interned message with its format string from the tflite_log_strings
+// section of the ELF file, formatted with the arguments. Interned messages are
+// the binary frames MicroErrorReporter writes, see
+// tensorflow/lite/core/api/interned_log.h, or "@<id> <args>" text from
+// reporters that format them. %s arguments are read from the loaded sections
+// of the ELF file, which covers type and operator names; other strings, for
+// example tensor names from the model, are printed as their address. Other
+// text is copied unchanged. --table prints the id and format string of every
+// message instead.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/interned_log.h"
+
+namespace {
+
+constexpr char kLogStringsSection[] = "tflite_log_strings";
+constexpr uint32_t kSectionNoBits = 8;  // SHT_NOBITS
+constexpr uint64_t kSectionAlloc = 2;   // SHF_ALLOC
+
+struct Section {
+  std::string name;
+  uint32_t type;
+  uint64_t flags;
+  uint64_t address;
+  uint64_t offset;
+  uint64_t size;
+};
+
+class ElfFile {
+ public:
+  bool Load(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      fprintf(stderr, "Could not open %s\n", path);
+      return false;
+    }
+    data_.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+    if (data_.size() < 64 || memcmp(data_.data(), "\x7f" "ELF", 4) != 0) {
+      fprintf(stderr, "%s is not an ELF file\n", path);
+      return false;
+    }
+    is_64_bit_ = data_[4] == 2;
+    is_big_endian_ = data_[5] == 2;
+    const uint64_t section_offset = is_64_bit_ ? Read(0x28, 8) : Read(0x20, 4);
+    const int entry_size = Read(is_64_bit_ ? 0x3a : 0x2e, 2);
+    const int num_sections = Read(is_64_bit_ ? 0x3c : 0x30, 2);
+    const int names_index = Read(is_64_bit_ ? 0x3e : 0x32, 2);
+    if (section_offset + static_cast<uint64_t>(entry_size) * num_sections >
+            data_.size() ||
+        names_index >= num_sections) {
+      fprintf(stderr, "%s has invalid section headers\n", path);
+      return false;
+    }
+    std::vector<uint32_t> name_offsets;
+    for (int i = 0; i < num_sections; ++i) {
+      const uint64_t header = section_offset + i * entry_size;
+      Section section;
+      name_offsets.push_back(Read(header, 4));
+      section.type = Read(header + 4, 4);
+      if (is_64_bit_) {
+        section.flags = Read(header + 8, 8);
+        section.address = Read(header + 16, 8);
+        section.offset = Read(header + 24, 8);
+        section.size = Read(header + 32, 8);
+      } else {
+        section.flags = Read(header + 8, 4);
+        section.address = Read(header + 12, 4);
+        section.offset = Read(header + 16, 4);
+        section.size = Read(header + 20, 4);
+      }
+      if (section.type != kSectionNoBits &&
+          section.offset + section.size > data_.size()) {
+        fprintf(stderr, "%s has invalid section headers\n", path);
+        return false;
+      }
+      sections_.push_back(section);
+    }
+    for (int i = 0; i < num_sections; ++i) {
+      sections_[i].name = String(sections_[names_index], name_offsets[i]);
+    }
+    return true;
+  }
+
+  const Section* FindSection(const char* name) const {
+    for (const Section& section : sections_) {
+      if (section.name == name) {
+        return &section;
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns the string at `offset` in `section`, or an empty string.
+  std::string String(const Section& section, uint64_t offset) const {
+    std::string result;
+    if (section.type == kSectionNoBits) {
+      return result;
+    }
+    for (uint64_t i = offset; i < section.size; ++i) {
+      const char c = data_[section.offset + i];
+      if (c == '\0') {
+        break;
+      }
+      result += c;
+    }
+    return result;
+  }
+
+  // Finds the string at `address` in the loaded image.
+  bool StringAtAddress(uint32_t address, std::string* result) const {
+    for (const Section& section : sections_) {
+      if ((section.flags & kSectionAlloc) != 0 &&
+          section.type != kSectionNoBits && address >= section.address &&
+          address < section.address + section.size) {
+        *result = String(section, address - section.address);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  uint64_t Read(uint64_t offset, int size) const {
+    uint64_t value = 0;
+    for (int i = 0; i < size; ++i) {
+      const int byte = is_big_endian_ ? i : size - 1 - i;
+      value = (value << 8) | static_cast<uint8_t>(data_[offset + byte]);
+    }
+    return value;
+  }
+
+  std::vector<char> data_;
+  std::vector<Section> sections_;
+  bool is_64_bit_ = false;
+  bool is_big_endian_ = false;
+};
+
+// Formats `format` with the 32-bit words of an interned message, with the
+// conversions of MicroVsnprintf().
+std::string Format(const ElfFile& elf, const std::string& format,
+                   const std::vector<uint32_t>& args) {
+  std::string result;
+  size_t arg_index = 0;
+  char buffer[32];
+  for (size_t i = 0; i < format.size(); ++i) {
+    if (format[i] != '%' || i + 1 == format.size()) {
+      result += format[i];
+      continue;
+    }
+    const char conversion = format[++i];
+    if (conversion == '%') {
+      result += '%';
+      continue;
+    }
+    if (strchr("dufxs", conversion) == nullptr) {
+      // Not a conversion, for example a modulo in the text of a failed
+      // TF_LITE_ENSURE.
+      result += '%';
+      result += conversion;
+      continue;
+    }
+    if (arg_index == args.size()) {
+      result += "<missing>";
+      continue;
+    }
+    const uint32_t arg = args[arg_index++];
+    switch (conversion) {
+      case 'd':
+        snprintf(buffer, sizeof(buffer), "%d", static_cast<int32_t>(arg));
+        break;
+      case 'u':
+        snprintf(buffer, sizeof(buffer), "%u", arg);
+        break;
+      case 'x':
+        snprintf(buffer, sizeof(buffer), "0x%x", arg);
+        break;
+      case 'f': {
+        float value;
+        memcpy(&value, &arg, sizeof(value));
+        snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value));
+        break;
+      }
+      case 's': {
+        std::string string;
+        if (elf.StringAtAddress(arg, &string)) {
+          result += string;
+          continue;
+        }
+        snprintf(buffer, sizeof(buffer), "<string at 0x%x>", arg);
+        break;
+      }
+    }
+    result += buffer;
+  }
+  return result;
+}
+
+// Decodes the message starting at `message` ("@0x<id> 0x<arg> ...").
+bool Decode(const ElfFile& elf, const Section& strings, const char* message,
+            std::string* result) {
+  std::vector<uint32_t> words;
+  const char* current = message + 1;
+  while (*current != '\0' && *current != '\r' && *current != '\n') {
+    char* end;
+    words.push_back(static_cast<uint32_t>(strtoul(current, &end, 16)));
+    if (end == current) {
+      return false;
+    }
+    current = end;
+    while (*current == ' ') {
+      ++current;
+    }
+  }
+  if (words.empty() || words[0] >= strings.size) {
+    return false;
+  }
+  const std::vector<uint32_t> args(words.begin() + 1, words.end());
+  *result = Format(elf, elf.String(strings, words[0]), args);
+  return true;
+}
+
+// Decodes the binary frame at `start` in `log`. Returns the size of the
+// frame, or 0 if it is not a complete frame.
+size_t DecodeFrame(const ElfFile& elf, const Section& strings,
+                   const std::string& log, size_t start,
+                   std::string* result) {
+  if (start + 6 > log.size()) {
+    return 0;
+  }
+  const int num_words = static_cast<uint8_t>(log[start + 1]);
+  const size_t size = 2 + 4 * (num_words + 1);
+  if (num_words > tflite::kMaxInternedLogArgs || start + size > log.size()) {
+    return 0;
+  }
+  std::vector<uint32_t> words;
+  for (size_t offset = start + 2; offset < start + size; offset += 4) {
+    uint32_t word = 0;
+    for (int byte = 3; byte >= 0; --byte) {
+      word = (word << 8) | static_cast<uint8_t>(log[offset + byte]);
+    }
+    words.push_back(word);
+  }
+  if (words[0] >= strings.size) {
+    return 0;
+  }
+  const std::vector<uint32_t> args(words.begin() + 1, words.end());
+  *result = Format(elf, elf.String(strings, words[0]), args);
+  return size;
+}
+
+// Prints one line of text, decoding an "@<id> <args>" message in it.
+void PrintLine(const ElfFile& elf, const Section& strings, std::string line) {
+  const size_t start = line.find("@0x");
+  std::string decoded;
+  if (start != std::string::npos &&
+      Decode(elf, strings, line.c_str() + start, &decoded)) {
+    line = line.substr(0, start) + decoded;
+  }
+  printf("%s\n", line.c_str());
+}
+
+int PrintTable(const ElfFile& elf, const Section& strings) {
+  uint64_t offset = 0;
+  while (offset < strings.size) {
+    const std::string format = elf.String(strings, offset);
+    printf("0x%llx %s\n", static_cast<unsigned long long>(offset),
+           format.c_str());
+    offset += format.size() + 1;
+    // Skips the padding between strings.
+    while (offset < strings.size && elf.String(strings, offset).empty()) {
+      ++offset;
+    }
+  }
+  return 0;
+}
+
+int Run(bool table, const char* elf_path, std::istream& log) {
+  ElfFile elf;
+  if (!elf.Load(elf_path)) {
+    return 1;
+  }
+  const Section* strings = elf.FindSection(kLogStringsSection);
+  if (strings == nullptr || strings->type == kSectionNoBits) {
+    fprintf(stderr, "%s has no %s section\n", elf_path, kLogStringsSection);
+    return 1;
+  }
+  if (table) {
+    return PrintTable(elf, *strings);
+  }
+  const std::string data((std::istreambuf_iterator<char>(log)),
+                         std::istreambuf_iterator<char>());
+  std::string line;
+  size_t i = 0;
+  while (i < data.size()) {
+    const uint8_t byte = static_cast<uint8_t>(data[i]);
+    std::string decoded;
+    const size_t frame_size =
+        byte == tflite::kInternedLogFrameStart
+            ? DecodeFrame(elf, *strings, data, i, &decoded)
+            : 0;
+    if (frame_size > 0) {
+      // A frame ends the text before it, which has no line break when it
+      // comes from the same message.
+      if (!line.empty()) {
+        PrintLine(elf, *strings, line);
+        line.clear();
+      }
+      printf("%s\n", decoded.c_str());
+      i += frame_size;
+      continue;
+    }
+    if (byte == '\n') {
+      PrintLine(elf, *strings, line);
+      line.clear();
+    } else {
+      line += data[i];
+    }
+    ++i;
+  }
+  if (!line.empty()) {
+    PrintLine(elf, *strings, line);
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc == 3 && strcmp(argv[1], "--table") == 0) {
+    return Run(true, argv[2], std::cin);
+  }
+  if (argc == 2) {
+    return Run(false, argv[1], std::cin);
+  }
+  if (argc == 3) {
+    std::ifstream log(argv[2], std::ios::binary);
+    if (!log) {
+      fprintf(stderr, "Could not open %s\n", argv[2]);
+      return 1;
+    }
+    return Run(false, argv[1], log);
+  }
+  fprintf(stderr,
+          "Usage: %s <application.elf> [<log file>]\n"
+          "       %s --table <application.elf>\n",
+          argv[0], argv[0]);
+  return 1;
+}
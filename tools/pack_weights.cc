@@ -0,0 +1,379 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host tool that adds pre-packed int8 weights to a .tflite model, see
+// tensorflow/lite/micro/packed_weights.h for the format.
+//
+// Usage: pack_weights <input.tflite> <output.tflite>
+//
+// Every int8 CONV_2D, DEPTHWISE_CONV_2D (depth multiplier 1) and
+// FULLY_CONNECTED with a constant filter is packed, in every subgraph.
+// Operators that do not qualify are left as they are. A filter that only
+// packed operators read is replaced by its packed copy, so packing does not
+// grow the model by more than the block padding and the effective biases.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/micro/compressed_weights.h"
+#include "tensorflow/lite/micro/packed_weights.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+int64_t ZeroPoint(const TensorT& tensor, int index) {
+  if (tensor.quantization == nullptr ||
+      static_cast<int>(tensor.quantization->zero_point.size()) <= index) {
+    return 0;
+  }
+  return tensor.quantization->zero_point[index];
+}
+
+bool HasZeroFilterZeroPoints(const TensorT& filter) {
+  if (filter.quantization == nullptr) {
+    return false;
+  }
+  for (int64_t zero_point : filter.quantization->zero_point) {
+    if (zero_point != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const std::vector<uint8_t>* ConstantData(const ModelT& model,
+                                         const TensorT& tensor) {
+  if (tensor.buffer == 0 || tensor.buffer >= model.buffers.size()) {
+    return nullptr;
+  }
+  const std::vector<uint8_t>& data = model.buffers[tensor.buffer]->data;
+  return data.empty() ? nullptr : &data;
+}
+
+uint32_t AddBuffer(ModelT* model, const void* data, size_t size) {
+  std::unique_ptr<BufferT> buffer(new BufferT());
+  buffer->data.resize(size);
+  memcpy(buffer->data.data(), data, size);
+  model->buffers.push_back(std::move(buffer));
+  return static_cast<uint32_t>(model->buffers.size() - 1);
+}
+
+// Packed filter and effective bias of one operator.
+struct PackedOperator {
+  PackedWeightsLayout layout;
+  std::vector<int8_t> filter;
+  std::vector<int32_t> effective_bias;
+};
+
+// Starts the effective bias from the (optional) int32 bias tensor.
+bool InitEffectiveBias(const ModelT& model, const SubGraphT& subgraph,
+                       const OperatorT& op, int output_depth,
+                       std::vector<int32_t>* effective_bias) {
+  effective_bias->assign(output_depth, 0);
+  if (op.inputs.size() < 3 || op.inputs[2] < 0) {
+    return true;
+  }
+  const TensorT& bias = *subgraph.tensors[op.inputs[2]];
+  const std::vector<uint8_t>* data = ConstantData(model, bias);
+  if (bias.type != TensorType_INT32 || data == nullptr ||
+      data->size() != output_depth * sizeof(int32_t)) {
+    return false;
+  }
+  memcpy(effective_bias->data(), data->data(), data->size());
+  return true;
+}
+
+// CONV_2D filters are [out][y][x][in], FULLY_CONNECTED filters [out][in].
+bool PackO4I16(const ModelT& model, const SubGraphT& subgraph,
+               const OperatorT& op, PackedOperator* packed) {
+  const TensorT& input = *subgraph.tensors[op.inputs[0]];
+  const TensorT& filter = *subgraph.tensors[op.inputs[1]];
+  const std::vector<uint8_t>* filter_data = ConstantData(model, filter);
+  if (filter_data == nullptr || filter.shape.size() < 2) {
+    return false;
+  }
+  const int output_depth = filter.shape.front();
+  const int input_depth = filter.shape.back();
+  const int num_taps = static_cast<int>(filter_data->size()) /
+                       (output_depth * input_depth);
+  if (output_depth * num_taps * input_depth !=
+      static_cast<int>(filter_data->size())) {
+    return false;
+  }
+  if (!InitEffectiveBias(model, subgraph, op, output_depth,
+                         &packed->effective_bias)) {
+    return false;
+  }
+
+  const int32_t input_zero_point = static_cast<int32_t>(ZeroPoint(input, 0));
+  const int8_t* filter_values =
+      reinterpret_cast<const int8_t*>(filter_data->data());
+  packed->layout = kPackedWeightsO4I16;
+  packed->filter.assign(PackedO4I16Size(output_depth, num_taps, input_depth),
+                        0);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    int32_t filter_sum = 0;
+    for (int tap = 0; tap < num_taps; ++tap) {
+      for (int in_c = 0; in_c < input_depth; ++in_c) {
+        const int8_t value =
+            filter_values[(out_c * num_taps + tap) * input_depth + in_c];
+        packed->filter[PackedO4I16Offset(out_c, tap, in_c, num_taps,
+                                         input_depth)] = value;
+        filter_sum += value;
+      }
+    }
+    packed->effective_bias[out_c] -= input_zero_point * filter_sum;
+  }
+  return true;
+}
+
+// DEPTHWISE_CONV_2D filters are [1][y][x][channels].
+bool PackC16(const ModelT& model, const SubGraphT& subgraph,
+             const OperatorT& op, PackedOperator* packed) {
+  const DepthwiseConv2DOptionsT* options =
+      op.builtin_options.AsDepthwiseConv2DOptions();
+  if (options == nullptr || options->depth_multiplier != 1) {
+    return false;
+  }
+  const TensorT& input = *subgraph.tensors[op.inputs[0]];
+  const TensorT& filter = *subgraph.tensors[op.inputs[1]];
+  const std::vector<uint8_t>* filter_data = ConstantData(model, filter);
+  if (filter_data == nullptr || filter.shape.size() != 4) {
+    return false;
+  }
+  const int channels = filter.shape[3];
+  const int num_taps = filter.shape[1] * filter.shape[2];
+  if (channels * num_taps != static_cast<int>(filter_data->size())) {
+    return false;
+  }
+  if (!InitEffectiveBias(model, subgraph, op, channels,
+                         &packed->effective_bias)) {
+    return false;
+  }
+
+  const int32_t input_zero_point = static_cast<int32_t>(ZeroPoint(input, 0));
+  const int8_t* filter_values =
+      reinterpret_cast<const int8_t*>(filter_data->data());
+  packed->layout = kPackedWeightsC16;
+  packed->filter.assign(PackedC16Size(channels, num_taps), 0);
+  for (int c = 0; c < channels; ++c) {
+    int32_t filter_sum = 0;
+    for (int tap = 0; tap < num_taps; ++tap) {
+      const int8_t value = filter_values[tap * channels + c];
+      packed->filter[PackedC16Offset(c, tap, num_taps)] = value;
+      filter_sum += value;
+    }
+    packed->effective_bias[c] -= input_zero_point * filter_sum;
+  }
+  return true;
+}
+
+bool PackOperator(const ModelT& model, const SubGraphT& subgraph,
+                  const OperatorT& op, PackedOperator* packed) {
+  if (op.opcode_index >= model.operator_codes.size() ||
+      op.inputs.size() < 2 || op.inputs[0] < 0 || op.inputs[1] < 0) {
+    return false;
+  }
+  const TensorT& input = *subgraph.tensors[op.inputs[0]];
+  const TensorT& filter = *subgraph.tensors[op.inputs[1]];
+  if (input.type != TensorType_INT8 || filter.type != TensorType_INT8 ||
+      !HasZeroFilterZeroPoints(filter)) {
+    return false;
+  }
+  switch (model.operator_codes[op.opcode_index]->builtin_code) {
+    case BuiltinOperator_CONV_2D:
+      return PackO4I16(model, subgraph, op, packed);
+    case BuiltinOperator_FULLY_CONNECTED: {
+      const FullyConnectedOptionsT* options =
+          op.builtin_options.AsFullyConnectedOptions();
+      const bool default_format =
+          options == nullptr ||
+          options->weights_format == FullyConnectedOptionsWeightsFormat_DEFAULT;
+      return default_format && filter.shape.size() == 2 &&
+             PackO4I16(model, subgraph, op, packed);
+    }
+    case BuiltinOperator_DEPTHWISE_CONV_2D:
+      return PackC16(model, subgraph, op, packed);
+    default:
+      return false;
+  }
+}
+
+int Run(const char* input_path, const char* output_path) {
+  std::ifstream input_file(input_path, std::ios::binary);
+  if (!input_file) {
+    fprintf(stderr, "Could not open %s\n", input_path);
+    return 1;
+  }
+  const std::vector<char> input_data(
+      (std::istreambuf_iterator<char>(input_file)),
+      std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(input_data.data()), input_data.size());
+  if (!VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s is not a valid model\n", input_path);
+    return 1;
+  }
+  std::unique_ptr<ModelT> model = UnPackModel(input_data.data());
+  for (const auto& metadata : model->metadata) {
+    if (metadata->name == kPackedWeightsMetadata) {
+      fprintf(stderr, "%s already contains packed weights\n", input_path);
+      return 1;
+    }
+    if (metadata->name == kCompressedWeightsMetadata) {
+      fprintf(stderr, "%s has compressed weights, pack before compressing\n",
+              input_path);
+      return 1;
+    }
+  }
+  if (model->subgraphs.empty()) {
+    fprintf(stderr, "%s has no subgraphs\n", input_path);
+    return 1;
+  }
+
+  int num_packed = 0;
+  int num_kept = 0;
+  std::vector<uint32_t> replaced_buffers;
+  for (size_t s = 0; s < model->subgraphs.size(); ++s) {
+    SubGraphT& subgraph = *model->subgraphs[s];
+    std::vector<int32_t> table = {kPackedWeightsVersion,
+                                  static_cast<int32_t>(s), /*n=*/0};
+    // Packed filter buffer of every packed filter tensor, and the number of
+    // packed operators reading it.
+    std::map<int32_t, uint32_t> packed_buffers;
+    std::map<int32_t, int> packed_uses;
+    for (size_t i = 0; i < subgraph.operators.size(); ++i) {
+      PackedOperator packed;
+      if (!PackOperator(*model, subgraph, *subgraph.operators[i], &packed)) {
+        continue;
+      }
+      // A filter shared by packed operators is packed the same way for
+      // all of them, only the effective biases differ.
+      const int32_t filter = subgraph.operators[i]->inputs[1];
+      auto existing = packed_buffers.find(filter);
+      const std::vector<uint8_t>* existing_data =
+          existing != packed_buffers.end()
+              ? &model->buffers[existing->second]->data
+              : nullptr;
+      uint32_t filter_buffer;
+      if (existing_data != nullptr &&
+          existing_data->size() == packed.filter.size() &&
+          memcmp(existing_data->data(), packed.filter.data(),
+                 packed.filter.size()) == 0) {
+        filter_buffer = existing->second;
+      } else {
+        filter_buffer =
+            AddBuffer(model.get(), packed.filter.data(), packed.filter.size());
+        // Mixed layouts keep the original filter.
+        packed_uses[filter] = existing_data != nullptr ? -1 : 0;
+        packed_buffers[filter] = filter_buffer;
+      }
+      if (packed_uses[filter] >= 0) {
+        ++packed_uses[filter];
+      }
+      table.push_back(static_cast<int32_t>(i));
+      table.push_back(packed.layout);
+      table.push_back(static_cast<int32_t>(filter_buffer));
+      table.push_back(static_cast<int32_t>(AddBuffer(
+          model.get(), packed.effective_bias.data(),
+          packed.effective_bias.size() * sizeof(int32_t))));
+      ++table[2];
+    }
+    if (table[2] == 0) {
+      continue;
+    }
+    num_packed += table[2];
+
+    // Packed kernels never read the original filter, so a filter only read
+    // by packed operators is replaced by its packed copy. The tensor keeps
+    // its shape, which describes the unpacked filter.
+    std::map<int32_t, int> uses;
+    for (const auto& op : subgraph.operators) {
+      for (int32_t tensor : op->inputs) {
+        ++uses[tensor];
+      }
+    }
+    for (int32_t tensor : subgraph.outputs) {
+      ++uses[tensor];
+    }
+    for (const auto& entry : packed_buffers) {
+      TensorT& filter = *subgraph.tensors[entry.first];
+      if (packed_uses[entry.first] != uses[entry.first]) {
+        printf("Kept the original of %s, which other operators read.\n",
+               filter.name.c_str());
+        ++num_kept;
+        continue;
+      }
+      replaced_buffers.push_back(filter.buffer);
+      filter.buffer = entry.second;
+    }
+
+    std::unique_ptr<MetadataT> metadata(new MetadataT());
+    metadata->name = kPackedWeightsMetadata;
+    metadata->buffer =
+        AddBuffer(model.get(), table.data(), table.size() * sizeof(int32_t));
+    model->metadata.push_back(std::move(metadata));
+  }
+
+  // Buffers may be shared between tensors of any subgraph, so an original
+  // filter is only dropped once nothing references it any more.
+  std::set<uint32_t> referenced;
+  for (const auto& subgraph : model->subgraphs) {
+    for (const auto& tensor : subgraph->tensors) {
+      referenced.insert(tensor->buffer);
+    }
+  }
+  for (const auto& metadata : model->metadata) {
+    referenced.insert(metadata->buffer);
+  }
+  for (uint32_t buffer : replaced_buffers) {
+    if (referenced.count(buffer) == 0) {
+      model->buffers[buffer]->data.clear();
+    }
+  }
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, model.get()));
+  std::ofstream output_file(output_path, std::ios::binary);
+  output_file.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                    builder.GetSize());
+  if (!output_file) {
+    fprintf(stderr, "Could not write %s\n", output_path);
+    return 1;
+  }
+  printf("Packed %d operators, %d original filters kept.\n", num_packed,
+         num_kept);
+  return 0;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <input.tflite> <output.tflite>\n", argv[0]);
+    return 1;
+  }
+  return tflite::Run(argv[1], argv[2]);
+}